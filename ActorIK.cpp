@@ -0,0 +1,303 @@
+#include "ActorIK.h"
+#include "IKSolver.h"
+#include "WorkerPool.h"
+#include "utils.h"
+
+#include "f4se/GameForms.h"
+#include "f4se/GameRTTI.h"
+
+namespace F4VRBody {
+
+	ActorIKScheduler* g_actorIK = nullptr;
+
+	// the arm solver's proportions are tuned around this arm length, other actors use the stock skeleton
+	static const float kDefaultArmLength = 36.74f;
+
+	static const char* armNames[2][7] = {
+		{ "RArm_Collarbone", "RArm_UpperArm", "RArm_UpperTwist1", "RArm_ForeArm1", "RArm_ForeArm2", "RArm_ForeArm3", "RArm_Hand" },
+		{ "LArm_Collarbone", "LArm_UpperArm", "LArm_UpperTwist1", "LArm_ForeArm1", "LArm_ForeArm2", "LArm_ForeArm3", "LArm_Hand" }
+	};
+
+	static const char* legNames[2][3] = {
+		{ "RLeg_Thigh", "RLeg_Calf", "RLeg_Foot" },
+		{ "LLeg_Thigh", "LLeg_Calf", "LLeg_Foot" }
+	};
+
+	bool ActorBody::bind() {
+		// the handle table says whether the actor is still there without going through the form map and the rtti cast
+		// every frame.   the lookup takes a reference which is handed straight back, nothing can unload it on this thread
+		TESObjectREFR* refr = nullptr;
+		if (!LookupREFRByHandle(&_handle, &refr) || !refr) {
+			_root = nullptr;
+			return false;
+		}
+		refr->handleRefObject.DecRefHandle();
+
+		Actor* actor = _actor;
+		if (refr != actor || !actor->unkF0 || !actor->unkF0->rootNode) {
+			_root = nullptr;
+			return false;
+		}
+
+		NiNode* root = actor->unkF0->rootNode->GetAsNiNode();
+		if (root == _root) {
+			return true;
+		}
+
+		// new 3D, look everything up again
+		_root = nullptr;
+		_chest = getChildNode("Chest", root);
+
+		for (auto i = 0; i < 2; i++) {
+			_hip[i] = getChildNode(legNames[i][0], root);
+			_knee[i] = getChildNode(legNames[i][1], root);
+			_foot[i] = getChildNode(legNames[i][2], root);
+
+			_arm[i].shoulder = getChildNode(armNames[i][0], root);
+			_arm[i].upper = getChildNode(armNames[i][1], root);
+			_arm[i].upperT1 = getChildNode(armNames[i][2], root);
+			_arm[i].forearm1 = getChildNode(armNames[i][3], root);
+			_arm[i].forearm2 = getChildNode(armNames[i][4], root);
+			_arm[i].forearm3 = getChildNode(armNames[i][5], root);
+			_arm[i].hand = getChildNode(armNames[i][6], root);
+
+			if (!_hip[i] || !_knee[i] || !_foot[i] || !_arm[i].shoulder || !_arm[i].upper || !_arm[i].forearm1 || !_arm[i].hand) {
+				_MESSAGE("actor ik: %08X is missing limb nodes", _formId);
+				return false;
+			}
+		}
+
+		if (!_chest) {
+			return false;
+		}
+
+		_root = root;
+		_limbs = LimbIK();
+		return true;
+	}
+
+	bool ActorBody::prepareLeg(bool isLeft, LegJob& job) {
+		int side = isLeft ? 1 : 0;
+		ActorIKTarget& target = _targets[FRIK_LIMB_RIGHT_LEG + side];
+
+		if (!target.active) {
+			return false;
+		}
+
+		job.hip = _hip[side];
+		job.knee = _knee[side];
+		job.foot = _foot[side];
+
+		LegIKInput& in = job.in;
+		in.isLeft = isLeft;
+		in.inPowerArmor = false;
+		in.footPos = target.pos;
+		return _limbs.prepareLeg(job);
+	}
+
+	bool ActorBody::prepareArm(bool isLeft, ArmJob& job) {
+		int side = isLeft ? 1 : 0;
+		ActorIKTarget& target = _targets[FRIK_LIMB_RIGHT_ARM + side];
+		ArmNodes& arm = _arm[side];
+
+		if (!target.active || vec3_len(arm.upper->m_worldTransform.pos - target.pos) > 200.0) {
+			return false;
+		}
+
+		job.arm = arm;
+
+		NiMatrix43 rootRot = _root->m_worldTransform.rot;
+		NiPoint3 forwardDir = vec3_norm(NiPoint3(rootRot.data[1][0], rootRot.data[1][1], 0));
+
+		ArmIKInput& in = job.in;
+		in.isLeft = isLeft;
+		in.inPowerArmor = false;
+		in.handPos = target.pos;
+		in.handRot = arm.hand->m_worldTransform.rot;
+		in.forwardDir = forwardDir;
+		in.sidewaysRDir = NiPoint3(forwardDir.y, -forwardDir.x, 0);
+		in.chestZ = _chest->m_worldTransform.pos.z;
+		in.rootScale = _root->m_localTransform.scale;
+		in.armLength = kDefaultArmLength;
+		return _limbs.prepareArm(job);
+	}
+
+	// a limb whose inputs haven't moved gets last frame's solve put back by prepare and isn't solved again.   the world
+	// update still runs for it since the animation wrote over the limb in between
+	void ActorBody::solve() {
+		LegJob legs[2];
+		ArmJob arms[2];
+		bool active[2];
+		bool solve[2];
+		WorkerJob jobs[2];
+		int count = 0;
+
+		_limbs.beginFrame();
+
+		for (auto i = 0; i < 2; i++) {
+			active[i] = _targets[FRIK_LIMB_RIGHT_LEG + i].active;
+			solve[i] = active[i] && prepareLeg(i == 1, legs[i]);
+			if (solve[i]) {
+				jobs[count++] = { runLegJob, &legs[i] };
+			}
+		}
+
+		g_ikWorkers->run(jobs, count);
+
+		for (auto i = 0; i < 2; i++) {
+			if (solve[i]) {
+				_limbs.applyLeg(legs[i]);
+			}
+			if (active[i]) {
+				updateTransformsDown(_hip[i], true);
+			}
+		}
+
+		count = 0;
+		for (auto i = 0; i < 2; i++) {
+			active[i] = _targets[FRIK_LIMB_RIGHT_ARM + i].active;
+			solve[i] = active[i] && prepareArm(i == 1, arms[i]);
+			if (solve[i]) {
+				jobs[count++] = { runArmJob, &arms[i] };
+			}
+		}
+
+		g_ikWorkers->run(jobs, count);
+
+		for (auto i = 0; i < 2; i++) {
+			if (solve[i]) {
+				_limbs.applyArm(arms[i]);
+			}
+			if (active[i]) {
+				updateTransformsDown(_arm[i].shoulder->GetAsNiNode(), true);
+			}
+		}
+	}
+
+	void ActorBody::reapply() {
+		_limbs.beginFrame();
+
+		for (auto i = 0; i < 2; i++) {
+			FRIKTelemetryLimb leg = (FRIKTelemetryLimb)(FRIK_LIMB_RIGHT_LEG + i);
+			if (_targets[leg].active && _limbs.reapply(leg)) {
+				updateTransformsDown(_hip[i], true);
+			}
+		}
+
+		for (auto i = 0; i < 2; i++) {
+			FRIKTelemetryLimb arm = (FRIKTelemetryLimb)(FRIK_LIMB_RIGHT_ARM + i);
+			if (_targets[arm].active && _limbs.reapply(arm)) {
+				updateTransformsDown(_arm[i].shoulder->GetAsNiNode(), true);
+			}
+		}
+	}
+
+	ActorBody* ActorIKScheduler::find(UInt32 a_formId) {
+		for (auto body : _actors) {
+			if (body->getFormId() == a_formId) {
+				return body;
+			}
+		}
+		return nullptr;
+	}
+
+	bool ActorIKScheduler::add(UInt32 a_formId) {
+		std::lock_guard<std::mutex> lock(_lock);
+
+		if (find(a_formId)) {
+			return true;
+		}
+		if ((int)_actors.size() >= c_actorIKMaxActors) {
+			_MESSAGE("actor ik: already running %d actors, %08X not added", (int)_actors.size(), a_formId);
+			return false;
+		}
+
+		// the form lookup and cast happen once here, from then on the body goes through the handle
+		Actor* actor = DYNAMIC_CAST(LookupFormByID(a_formId), TESForm, Actor);
+		UInt32 handle = *g_invalidRefHandle;
+		if (!actor || !CreateHandleByREFR(&handle, actor) || handle == *g_invalidRefHandle) {
+			_MESSAGE("actor ik: %08X is not an actor", a_formId);
+			return false;
+		}
+
+		_actors.push_back(new ActorBody(a_formId, actor, handle));
+		return true;
+	}
+
+	void ActorIKScheduler::remove(UInt32 a_formId) {
+		std::lock_guard<std::mutex> lock(_lock);
+
+		for (auto it = _actors.begin(); it != _actors.end(); ++it) {
+			if ((*it)->getFormId() == a_formId) {
+				delete *it;
+				_actors.erase(it);
+				_cursor = 0;
+				return;
+			}
+		}
+	}
+
+	bool ActorIKScheduler::setTarget(UInt32 a_formId, FRIKTelemetryLimb a_limb, bool a_active, NiPoint3 a_pos) {
+		std::lock_guard<std::mutex> lock(_lock);
+
+		ActorBody* body = find(a_formId);
+		if (!body || a_limb >= FRIK_LIMB_COUNT) {
+			return false;
+		}
+
+		body->setTarget(a_limb, a_active, a_pos);
+		return true;
+	}
+
+	void ActorIKScheduler::run(NiPoint3 a_viewer) {
+		std::lock_guard<std::mutex> lock(_lock);
+
+		_frame++;
+		_solved = 0;
+		_reapplied = 0;
+
+		size_t count = _actors.size();
+		if (count == 0) {
+			return;
+		}
+
+		LARGE_INTEGER start;
+		LARGE_INTEGER now;
+		QueryPerformanceCounter(&start);
+
+		// the first actor the budget didn't reach, it goes first next frame
+		size_t next = count;
+
+		for (size_t i = 0; i < count; i++) {
+			if (next == count) {
+				QueryPerformanceCounter(&now);
+				double ms = (double)(now.QuadPart - start.QuadPart) * 1000.0 / (double)_freq.QuadPart;
+				if (ms > c_actorIKBudgetMs) {
+					next = i;
+				}
+			}
+
+			size_t index = (_cursor + i) % count;
+			ActorBody* body = _actors[index];
+
+			if (!body->bind()) {
+				continue;
+			}
+
+			// far away actors are spread over the frames by their slot so they don't all land on the same one
+			bool far = vec3_len(body->getPosition() - a_viewer) > c_actorIKFarDistance;
+			bool waiting = far && c_actorIKFarInterval > 1 && (_frame + index) % c_actorIKFarInterval != 0;
+
+			if (next != count || waiting) {
+				body->reapply();
+				_reapplied++;
+				continue;
+			}
+
+			body->solve();
+			_solved++;
+		}
+
+		_cursor = (_cursor + next) % count;
+	}
+}
@@ -0,0 +1,121 @@
+#pragma once
+#include "F4VRBody.h"
+#include "LimbIK.h"
+#include "api/FRIKTelemetry.h"
+
+#include "f4se/GameReferences.h"
+
+#include <mutex>
+#include <vector>
+
+namespace F4VRBody {
+
+	// a hand or foot goal for another actor, the limb keeps its animated pose while there is none
+	struct ActorIKTarget {
+		bool active = false;
+		NiPoint3 pos;
+	};
+
+	// Everything one actor needs to run the limb solvers that the player body uses.   Nothing in here looks at the player,
+	// the limb nodes come from the actor's own 3D and are looked up again whenever that changes.   Targets are in world
+	// space and the limbs are in the FRIK telemetry order (right arm, left arm, right leg, left leg).   The solve itself,
+	// the solve cache and the residuals / flags are the same LimbIK the player body uses.
+	class ActorBody {
+	public:
+		// a_actor and a_handle come from the scheduler's add, the actor is only used again after the handle confirms it
+		ActorBody(UInt32 a_formId, Actor* a_actor, UInt32 a_handle) : _formId(a_formId), _actor(a_actor), _handle(a_handle) {
+			_root = nullptr;
+		}
+
+		UInt32 getFormId() {
+			return _formId;
+		}
+
+		void setTarget(FRIKTelemetryLimb a_limb, bool a_active, NiPoint3 a_pos) {
+			_targets[a_limb].active = a_active;
+			_targets[a_limb].pos = a_pos;
+		}
+
+		// false while the actor isn't loaded or its skeleton is missing a limb
+		bool bind();
+
+		NiPoint3 getPosition() {
+			return _root ? _root->m_worldTransform.pos : NiPoint3(0, 0, 0);
+		}
+
+		// legs then arms, each pair on the ik workers
+		void solve();
+
+		// a frame the scheduler left this actor out, the limbs with a target keep their last solve instead of going back to
+		// the animation
+		void reapply();
+
+		// residuals and flags from the last solve, like Skeleton's
+		LimbIK& getLimbs() {
+			return _limbs;
+		}
+
+	private:
+		bool prepareLeg(bool isLeft, LegJob& job);
+		bool prepareArm(bool isLeft, ArmJob& job);
+
+		UInt32 _formId;
+		Actor* _actor;
+		UInt32 _handle;
+		NiNode* _root;
+		NiNode* _chest;
+		NiNode* _hip[2];
+		NiNode* _knee[2];
+		NiNode* _foot[2];
+		ArmNodes _arm[2];       // right, left
+		LimbIK _limbs;
+		ActorIKTarget _targets[FRIK_LIMB_COUNT];
+	};
+
+	// Runs the other actors after the player body.   Each frame picks up where the last one stopped and solves actors until
+	// the time budget is used up, so with lots of actors they just get updated every few frames instead of the frame
+	// getting longer.   Actors further away than c_actorIKFarDistance only get a solve every c_actorIKFarInterval frames.
+	// Only the solve is spread out, every actor with targets gets its last solve put back each frame so the limbs don't
+	// flicker back to the animation in between.
+	// Adding, removing and targets come from papyrus threads, run() is on the main thread.
+	class ActorIKScheduler {
+	public:
+		ActorIKScheduler() {
+			QueryPerformanceFrequency(&_freq);
+		}
+
+		bool add(UInt32 a_formId);
+		void remove(UInt32 a_formId);
+		bool setTarget(UInt32 a_formId, FRIKTelemetryLimb a_limb, bool a_active, NiPoint3 a_pos);
+
+		// a_viewer is where far away is measured from
+		void run(NiPoint3 a_viewer);
+
+		// actors solved in the last run
+		int getSolved() {
+			return _solved;
+		}
+
+		// actors that only had their last solve put back in the last run
+		int getReapplied() {
+			return _reapplied;
+		}
+
+	private:
+		ActorBody* find(UInt32 a_formId);
+
+		std::mutex _lock;
+		std::vector<ActorBody*> _actors;
+		size_t _cursor = 0;
+		uint64_t _frame = 0;
+		int _solved = 0;
+		int _reapplied = 0;
+		LARGE_INTEGER _freq;
+	};
+
+	extern ActorIKScheduler* g_actorIK;
+
+	inline void InitActorIK() {
+		g_actorIK = new ActorIKScheduler();
+	}
+}
@@ -0,0 +1,66 @@
+#include "BetterScopesChannel.h"
+
+namespace F4VRBody {
+
+	BetterScopesChannel* g_scopesChannel = nullptr;
+
+	void BetterScopesChannel::dispatch(UInt32 a_type, void* a_data, UInt32 a_len) {
+		_sequence++;
+		g_messaging->Dispatch(g_pluginHandle, a_type, a_data, a_len, "FO4VRBETTERSCOPES");
+	}
+
+	void BetterScopesChannel::sendReticle(NiPoint3 a_value) {
+		_payload.value = a_value;
+		_payload.sequence = _sequence + 1;
+		dispatch(kScopes_Reticle, (void*)&_payload, sizeof(BetterScopesPayload));
+	}
+
+	void BetterScopesChannel::sendGripConfig(bool a_dynamicGripping, bool a_force) {
+		if (_gripKnown && (_gripConfig == a_dynamicGripping) && !a_force) {
+			return;
+		}
+
+		_gripKnown = true;
+		_gripConfig = a_dynamicGripping;
+		dispatch(kScopes_GripConfig, (void*)a_dynamicGripping, sizeof(bool));
+	}
+
+	void BetterScopesChannel::sendZoomToggle() {
+		flush();
+		dispatch(kScopes_ZoomToggle, nullptr, 0);
+	}
+
+	void BetterScopesChannel::sendReticleReset() {
+		_movePending = false;
+		sendReticle(NiPoint3(0, 0, 0));
+	}
+
+	void BetterScopesChannel::sendReticleSave() {
+		// the last move has to land before the save
+		if (_movePending) {
+			_movePending = false;
+			sendReticle(_move);
+		}
+		sendReticle(NiPoint3(0, 1, 0));
+	}
+
+	void BetterScopesChannel::moveReticle(float a_x, float a_z) {
+		_move = NiPoint3(a_x, 0, a_z);
+		_movePending = true;
+	}
+
+	void BetterScopesChannel::flush() {
+		if (!_movePending) {
+			return;
+		}
+
+		ULONGLONG now = GetTickCount64();
+		if (_minIntervalMs && (now - _lastMoveTime) < _minIntervalMs) {
+			return;
+		}
+
+		_lastMoveTime = now;
+		_movePending = false;
+		sendReticle(_move);
+	}
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include "F4VRBody.h"
+
+namespace F4VRBody {
+
+	// message types shared with FO4VRBetterScopes
+	enum BetterScopesMessage {
+		kScopes_GripConfig = 15,    // to scopes: data is the bool itself.   from scopes: looking through scope
+		kScopes_ZoomToggle = 16,    // to scopes: no data
+		kScopes_Reticle = 17,       // to scopes: BetterScopesPayload, (0,0,0) reset, (0,1,0) save, (x,0,z) move
+		kScopes_RateLimit = 18      // from scopes: data is the minimum ms between reticle moves, 0 for no limit
+	};
+
+	// value first so receivers that read the data as a NiPoint3* keep working
+	struct BetterScopesPayload {
+		NiPoint3 value;
+		UInt32 sequence;
+	};
+
+	// All FRIK -> BetterScopes traffic goes through here.   Reticle moves from the thumbstick are coalesced so at most one
+	// (the latest) goes out per frame, and fewer if the receiver asked for a rate limit.   The grip config is only sent when
+	// it actually changes.   One-off commands go out right away but after any pending move so the order is kept.
+	// Every dispatch bumps the sequence number, reticle payloads carry it.
+	class BetterScopesChannel {
+	public:
+		void sendGripConfig(bool a_dynamicGripping, bool a_force = false);
+		void sendZoomToggle();
+		void sendReticleReset();
+		void sendReticleSave();
+		void moveReticle(float a_x, float a_z);
+
+		// end of frame, sends the coalesced reticle move if the rate limit allows it
+		void flush();
+
+		void setMinInterval(UInt32 a_ms) {
+			_minIntervalMs = a_ms;
+		}
+
+		UInt32 getSequence() {
+			return _sequence;
+		}
+
+	private:
+		void dispatch(UInt32 a_type, void* a_data, UInt32 a_len);
+		void sendReticle(NiPoint3 a_value);
+
+		UInt32 _sequence = 0;
+		BetterScopesPayload _payload;
+
+		bool _gripKnown = false;
+		bool _gripConfig = false;
+
+		bool _movePending = false;
+		NiPoint3 _move;
+		UInt32 _minIntervalMs = 0;
+		ULONGLONG _lastMoveTime = 0;
+	};
+
+	extern BetterScopesChannel* g_scopesChannel;
+
+	inline void InitScopesChannel() {
+		g_scopesChannel = new BetterScopesChannel();
+		g_scopesChannel->setMinInterval(c_scopeMessageIntervalMs);
+	}
+}
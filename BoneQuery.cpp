@@ -0,0 +1,104 @@
+#include "BoneQuery.h"
+#include "utils.h"
+
+namespace F4VRBody {
+
+	std::map<UInt32, std::unique_ptr<BoneQuery>> boneQueries;
+	UInt32 nextBoneQueryHandle = 1;
+
+	static std::unique_ptr<BoneQuery> fingertips;
+
+	BoneQuery::BoneQuery(std::vector<BSFixedString>& a_names) {
+		_names = a_names;
+		_index.resize(_names.size(), -1);
+		_tree = nullptr;
+	}
+
+	void BoneQuery::resolve(BSFlattenedBoneTree* a_tree) {
+		_tree = a_tree;
+
+		for (UInt32 i = 0; i < _names.size(); i++) {
+			int index = BSFlattenedBoneTree_GetBoneIndex(a_tree, &_names[i]);
+			_index[i] = (index >= 0 && index < a_tree->numTransforms) ? index : -1;
+		}
+	}
+
+	NiTransform* BoneQuery::getWorld(BSFlattenedBoneTree* a_tree, UInt32 a_bone) {
+		int index = _index[a_bone];
+
+		if (index < 0) {
+			return nullptr;
+		}
+
+		return &a_tree->transforms[index].world;
+	}
+
+	void BoneQuery::getPositions(BSFlattenedBoneTree* a_tree, VMArray<float>& a_out) {
+		if (a_tree != _tree) {
+			resolve(a_tree);
+		}
+
+		for (UInt32 i = 0; i < _names.size(); i++) {
+			NiTransform* world = getWorld(a_tree, i);
+			NiPoint3 pos = world ? world->pos : NiPoint3(0, 0, 0);
+
+			a_out.Push(&pos.x);
+			a_out.Push(&pos.y);
+			a_out.Push(&pos.z);
+		}
+	}
+
+	void BoneQuery::getTransforms(BSFlattenedBoneTree* a_tree, VMArray<float>& a_out) {
+		if (a_tree != _tree) {
+			resolve(a_tree);
+		}
+
+		for (UInt32 i = 0; i < _names.size(); i++) {
+			NiTransform* world = getWorld(a_tree, i);
+			NiPoint3 pos = world ? world->pos : NiPoint3(0, 0, 0);
+			float heading = 0.0f;
+			float roll = 0.0f;
+			float attitude = 0.0f;
+
+			if (world) {
+				Matrix44 rot;
+				rot.makeTransformMatrix(world->rot, NiPoint3(0, 0, 0));
+				rot.getEulerAngles(&heading, &roll, &attitude);
+				heading = rads_to_degrees(heading);
+				roll = rads_to_degrees(roll);
+				attitude = rads_to_degrees(attitude);
+			}
+
+			a_out.Push(&pos.x);
+			a_out.Push(&pos.y);
+			a_out.Push(&pos.z);
+			a_out.Push(&heading);
+			a_out.Push(&roll);
+			a_out.Push(&attitude);
+		}
+	}
+
+	BoneQuery* getFingertipQuery() {
+		if (!fingertips) {
+			static const char* tips[10] = {
+				"RArm_Finger13", "RArm_Finger23", "RArm_Finger33", "RArm_Finger43", "RArm_Finger53",
+				"LArm_Finger13", "LArm_Finger23", "LArm_Finger33", "LArm_Finger43", "LArm_Finger53"
+			};
+
+			std::vector<BSFixedString> names;
+			for (auto i = 0; i < 10; i++) {
+				names.push_back(BSFixedString(tips[i]));
+			}
+			fingertips = std::make_unique<BoneQuery>(names);
+		}
+
+		return fingertips.get();
+	}
+
+	void clearBoneQueries() {
+		if (!boneQueries.empty()) {
+			_MESSAGE("dropping %d bone queries", (int)boneQueries.size());
+		}
+		boneQueries.clear();
+	}
+}
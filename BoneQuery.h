@@ -0,0 +1,45 @@
+#pragma once
+#include "F4VRBody.h"
+#include "BSFlattenedBoneTree.h"
+
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace F4VRBody {
+
+	// A list of bones a script asked for once through RegisterBoneQuery.   The names are turned into bone tree indices
+	// the first time the query runs (and again whenever the player's bone tree changes, e.g. getting into power armor)
+	// so every later call is just an indexed read per bone.
+	class BoneQuery {
+	public:
+		BoneQuery(std::vector<BSFixedString>& a_names);
+
+		UInt32 size() {
+			return (UInt32)_names.size();
+		}
+
+		// pushes x, y, z per bone.   unknown bones give 0, 0, 0
+		void getPositions(BSFlattenedBoneTree* a_tree, VMArray<float>& a_out);
+
+		// pushes x, y, z, heading, roll, attitude (degrees) per bone
+		void getTransforms(BSFlattenedBoneTree* a_tree, VMArray<float>& a_out);
+
+	private:
+		void resolve(BSFlattenedBoneTree* a_tree);
+		NiTransform* getWorld(BSFlattenedBoneTree* a_tree, UInt32 a_bone);
+
+		std::vector<BSFixedString> _names;
+		std::vector<int> _index;
+		BSFlattenedBoneTree* _tree;
+	};
+
+	extern std::map<UInt32, std::unique_ptr<BoneQuery>> boneQueries;
+	extern UInt32 nextBoneQueryHandle;
+
+	BoneQuery* getFingertipQuery();
+
+	// script handles don't survive a load, called on new game and before a save is loaded.   handles keep counting up
+	// so a stale one a script kept in a variable never finds someone else's query
+	void clearBoneQueries();
+}
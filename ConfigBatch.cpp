@@ -0,0 +1,262 @@
+#include "ConfigBatch.h"
+#include "BetterScopesChannel.h"
+#include "Skeleton.h"
+
+#include <cmath>
+
+namespace F4VRBody {
+
+	extern Skeleton* playerSkelly;
+
+	ConfigTransactions* g_configTransactions = nullptr;
+
+	// apply is for settings that have to be pushed somewhere besides their c_ variable, nullptr for the rest
+	struct FloatSetting {
+		const char* name;
+		float* value;
+		float min;
+		float max;
+		void (*apply)();
+	};
+
+	struct BoolSetting {
+		const char* name;
+		bool* value;
+		void (*apply)();
+	};
+
+	static void applyVrScale() {
+		Setting* set = GetINISetting("fVrScale:VR");
+		if (set) {
+			set->SetDouble(c_fVrScale);
+		}
+	}
+
+	static void applyPlayerHeight() {
+		if (playerSkelly) {
+			playerSkelly->setBodyLen();
+		}
+	}
+
+	static void applyStaticGripping() {
+		// only goes out to better scopes if it changed
+		g_scopesChannel->sendGripConfig(!c_staticGripping);
+	}
+
+	// keys are the same names used in FRIK.ini
+	static const FloatSetting floatSettings[] = {
+		{ "PlayerHeight", &c_playerHeight, 60.0f, 200.0f, applyPlayerHeight },
+		{ "fVrScale", &c_fVrScale, 40.0f, 120.0f, applyVrScale },
+		{ "playerOffset_forward", &c_playerOffset_forward, -50.0f, 50.0f },
+		{ "playerOffset_up", &c_playerOffset_up, -50.0f, 50.0f },
+		{ "powerArmor_forward", &c_powerArmor_forward, -50.0f, 50.0f },
+		{ "powerArmor_up", &c_powerArmor_up, -50.0f, 50.0f },
+		{ "armLength", &c_armLength, 10.0f, 80.0f },
+		{ "cameraHeightOffset", &c_cameraHeight, -100.0f, 100.0f },
+		{ "powerArmor_cameraHeightOffset", &c_PACameraHeight, -100.0f, 100.0f },
+		{ "handUI_X", &c_handUI_X, -50.0f, 50.0f },
+		{ "handUI_Y", &c_handUI_Y, -50.0f, 50.0f },
+		{ "handUI_Z", &c_handUI_Z, -50.0f, 50.0f },
+		{ "DampenHandsRotation", &c_dampenHandsRotation, 0.0f, 1.0f },
+		{ "DampenHandsTranslation", &c_dampenHandsTranslation, 0.0f, 1.0f },
+	};
+
+	static const BoolSetting boolSettings[] = {
+		{ "showPAHUD", &c_showPAHUD },
+		{ "hidePipboy", &c_hidePipboy },
+		{ "EnableArmsOnlyMode", &c_armsOnly },
+		{ "EnableStaticGripping", &c_staticGripping, applyStaticGripping },
+		{ "HideHead", &c_hideHead },
+		{ "DampenHands", &c_dampenHands },
+		{ "SelfieMode", &c_selfieMode },
+		{ "EnableRepositionMode", &c_repositionMasterMode },
+	};
+
+	static const FloatSetting* findFloat(const std::string& a_name) {
+		for (auto& setting : floatSettings) {
+			if (!_stricmp(setting.name, a_name.c_str())) {
+				return &setting;
+			}
+		}
+		return nullptr;
+	}
+
+	static const BoolSetting* findBool(const std::string& a_name) {
+		for (auto& setting : boolSettings) {
+			if (!_stricmp(setting.name, a_name.c_str())) {
+				return &setting;
+			}
+		}
+		return nullptr;
+	}
+
+	UInt32 ConfigTransactions::begin() {
+		std::lock_guard<std::mutex> lock(_lock);
+
+		UInt32 id = _next++;
+		_open[id] = ConfigBatch();
+		return id;
+	}
+
+	bool ConfigTransactions::setFloats(UInt32 a_batch, std::vector<std::string>& a_keys, std::vector<float>& a_values) {
+		std::lock_guard<std::mutex> lock(_lock);
+
+		auto found = _open.find(a_batch);
+		if (found == _open.end() || a_keys.size() != a_values.size()) {
+			return false;
+		}
+
+		for (UInt32 i = 0; i < a_keys.size(); i++) {
+			found->second.floats[a_keys[i]] = a_values[i];
+		}
+		return true;
+	}
+
+	bool ConfigTransactions::setBools(UInt32 a_batch, std::vector<std::string>& a_keys, std::vector<bool>& a_values) {
+		std::lock_guard<std::mutex> lock(_lock);
+
+		auto found = _open.find(a_batch);
+		if (found == _open.end() || a_keys.size() != a_values.size()) {
+			return false;
+		}
+
+		for (UInt32 i = 0; i < a_keys.size(); i++) {
+			found->second.bools[a_keys[i]] = a_values[i];
+		}
+		return true;
+	}
+
+	bool ConfigTransactions::setFingers(UInt32 a_batch, bool a_isLeft, std::vector<float>& a_values) {
+		std::lock_guard<std::mutex> lock(_lock);
+
+		auto found = _open.find(a_batch);
+		if (found == _open.end() || a_values.size() != 5) {
+			return false;
+		}
+
+		int hand = a_isLeft ? 1 : 0;
+		found->second.hasFingers[hand] = true;
+		for (auto i = 0; i < 5; i++) {
+			found->second.fingers[hand][i] = a_values[i];
+		}
+		return true;
+	}
+
+	bool ConfigTransactions::validate(ConfigBatch& a_batch) {
+		for (auto& entry : a_batch.floats) {
+			const FloatSetting* setting = findFloat(entry.first);
+
+			if (!setting) {
+				_MESSAGE("config batch: unknown setting %s", entry.first.c_str());
+				return false;
+			}
+			if (!std::isfinite(entry.second) || entry.second < setting->min || entry.second > setting->max) {
+				_MESSAGE("config batch: %s = %f is outside %f - %f", setting->name, entry.second, setting->min, setting->max);
+				return false;
+			}
+		}
+
+		for (auto& entry : a_batch.bools) {
+			if (!findBool(entry.first)) {
+				_MESSAGE("config batch: unknown setting %s", entry.first.c_str());
+				return false;
+			}
+		}
+
+		for (auto hand = 0; hand < 2; hand++) {
+			if (!a_batch.hasFingers[hand]) {
+				continue;
+			}
+			for (auto i = 0; i < 5; i++) {
+				if (!std::isfinite(a_batch.fingers[hand][i]) || a_batch.fingers[hand][i] < 0.0f || a_batch.fingers[hand][i] > 1.0f) {
+					_MESSAGE("config batch: finger values have to be 0 - 1");
+					return false;
+				}
+			}
+		}
+
+		return true;
+	}
+
+	bool ConfigTransactions::commit(UInt32 a_batch, bool a_persist) {
+		std::lock_guard<std::mutex> lock(_lock);
+
+		auto found = _open.find(a_batch);
+		if (found == _open.end()) {
+			return false;
+		}
+
+		ConfigBatch batch = found->second;
+		_open.erase(found);
+
+		if (!validate(batch)) {
+			return false;
+		}
+
+		batch.persist = a_persist;
+		_ready.push_back(batch);
+		return true;
+	}
+
+	void ConfigTransactions::abort(UInt32 a_batch) {
+		std::lock_guard<std::mutex> lock(_lock);
+		_open.erase(a_batch);
+	}
+
+	void ConfigTransactions::apply(ConfigBatch& a_batch) {
+		// every value goes in before any hook runs so a hook never sees half the batch
+		std::vector<void (*)()> hooks;
+
+		for (auto& entry : a_batch.floats) {
+			const FloatSetting* setting = findFloat(entry.first);
+			*setting->value = entry.second;
+			if (setting->apply) {
+				hooks.push_back(setting->apply);
+			}
+		}
+
+		for (auto& entry : a_batch.bools) {
+			const BoolSetting* setting = findBool(entry.first);
+			*setting->value = entry.second;
+			if (setting->apply) {
+				hooks.push_back(setting->apply);
+			}
+		}
+
+		for (auto hand = 0; hand < 2; hand++) {
+			if (a_batch.hasFingers[hand]) {
+				float* f = a_batch.fingers[hand];
+				setFingerPositionScalar(nullptr, hand == 1, f[0], f[1], f[2], f[3], f[4]);
+			}
+		}
+
+		for (auto hook : hooks) {
+			hook();
+		}
+	}
+
+	void ConfigTransactions::applyPending() {
+		std::vector<ConfigBatch> ready;
+
+		{
+			std::lock_guard<std::mutex> lock(_lock);
+			if (_ready.empty()) {
+				return;
+			}
+			ready.swap(_ready);
+		}
+
+		bool persist = false;
+
+		for (auto& batch : ready) {
+			apply(batch);
+			persist |= batch.persist;
+		}
+
+		if (persist) {
+			saveSettings();
+		}
+
+		_MESSAGE("applied %d config batches", (int)ready.size());
+	}
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include "F4VRBody.h"
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace F4VRBody {
+
+	// Settings staged by one BeginConfig ... CommitConfig sequence
+	struct ConfigBatch {
+		std::map<std::string, float> floats;
+		std::map<std::string, bool> bools;
+		bool hasFingers[2] = { false, false };
+		float fingers[2][5];
+		bool persist = false;
+	};
+
+	// Lets MCM style scripts change a whole page of settings with a handful of native calls.   Values are staged per batch,
+	// validated together on commit (one bad key or value rejects the whole batch) and then applied all at once at the start
+	// of the next frame so update() never sees half a configuration.   The ini is written at most once per batch.
+	// Natives can come in on any papyrus thread, applyPending() runs on the main thread.
+	class ConfigTransactions {
+	public:
+		UInt32 begin();
+		bool setFloats(UInt32 a_batch, std::vector<std::string>& a_keys, std::vector<float>& a_values);
+		bool setBools(UInt32 a_batch, std::vector<std::string>& a_keys, std::vector<bool>& a_values);
+		bool setFingers(UInt32 a_batch, bool a_isLeft, std::vector<float>& a_values);
+		bool commit(UInt32 a_batch, bool a_persist);
+		void abort(UInt32 a_batch);
+
+		// called from update() before anything else reads the settings
+		void applyPending();
+
+	private:
+		bool validate(ConfigBatch& a_batch);
+		void apply(ConfigBatch& a_batch);
+
+		std::mutex _lock;
+		std::map<UInt32, ConfigBatch> _open;
+		std::vector<ConfigBatch> _ready;
+		UInt32 _next = 1;
+	};
+
+	extern ConfigTransactions* g_configTransactions;
+
+	inline void InitConfigTransactions() {
+		g_configTransactions = new ConfigTransactions();
+	}
+}
@@ -7,6 +7,24 @@
 #include "BSFlattenedBoneTree.h"
 #include "GunReload.h"
 #include "VR.h"
+#include "FrameGovernor.h"
+#include "WorkCounters.h"
+#include "Telemetry.h"
+#include "PoseBuffer.h"
+#include "BoneQuery.h"
+#include "ConfigBatch.h"
+#include "BetterScopesChannel.h"
+#include "Haptics.h"
+#include "Gait.h"
+#include "HeightField.h"
+#include "TrackedBody.h"
+#include "FingerTracking.h"
+#include "ActorIK.h"
+#include "HookStats.h"
+#include "SkeletonSnapshot.h"
+#include "WeaponFeatures.h"
+#include "IKStats.h"
+#include "f4se/GameAPI.h"
 
 #include "api/PapyrusVRAPI.h"
 #include "api/VRManagerAPI.h"
@@ -81,6 +99,7 @@ namespace F4VRBody {
 	bool c_hideSkin = false;
 	float c_pipBoyLookAtGate = 0.7;
 	float c_gripLetGoThreshold = 15.0f;
+	float c_gripLetGoSpeed = 225.0f;
 	bool c_isLookingThroughScope = false;
 	bool c_pipBoyButtonMode = false;
 	bool c_pipBoyAllowMovementNotLooking = true;
@@ -101,6 +120,32 @@ namespace F4VRBody {
 	bool c_dampenHands = true;
 	float c_dampenHandsRotation = 0.7;
 	float c_dampenHandsTranslation = 0.7;
+	bool c_enableSolveCache = true;
+	float c_solveCachePositionTolerance = 0.05;
+	float c_solveCacheAngleTolerance = 0.1;
+	int c_solveCacheRefreshFrames = 30;
+	bool c_parallelIK = false;
+	bool c_enableFrameGovernor = false;
+	float c_frameBudgetMs = 2.0;
+	bool c_logWorkCounters = false;
+	bool c_snapshotReloads = false;
+	bool c_enableTelemetry = false;
+	int c_scopeMessageIntervalMs = 0;
+	bool c_terrainFootPlacement = false;
+	float c_terrainFootRange = 40.0f;
+	bool c_enableBodyTrackers = false;
+	std::string c_waistTracker;
+	std::string c_leftFootTracker;
+	std::string c_rightFootTracker;
+	bool c_fingerTracking = false;
+	std::string c_fingerTrackingActionManifest;
+	std::string c_fingerTrackingActionSet;
+	std::string c_leftHandSkeletonAction;
+	std::string c_rightHandSkeletonAction;
+	float c_actorIKBudgetMs = 1.0f;
+	int c_actorIKMaxActors = 8;
+	float c_actorIKFarDistance = 2000.0f;
+	int c_actorIKFarInterval = 4;
 
 	float c_scopeAdjustDistance = 15.0f;
 
@@ -131,6 +176,33 @@ namespace F4VRBody {
 	std::vector<std::string> skinGeometry;
 	bool bDumpArray = false;
 
+	// comma separated list of floats, leaves the table alone if the key isn't there
+	static void readTable(CSimpleIniA& ini, const char* section, const char* key, std::vector<float>& table) {
+		const char* value = ini.GetValue(section, key, nullptr);
+		if (!value) {
+			return;
+		}
+
+		std::vector<float> read;
+		char* end = nullptr;
+		for (const char* p = value; *p; p = end) {
+			float f = strtof(p, &end);
+			if (end == p) {
+				break;
+			}
+			read.push_back(f);
+			while (*end == ',' || *end == ' ') {
+				end++;
+			}
+		}
+
+		if (read.size() < 2) {
+			_MESSAGE("ERROR: %s needs at least two values", key);
+			return;
+		}
+		table = read;
+	}
+
 	bool loadConfig() {
 		CSimpleIniA ini;
 		SI_Error rc = ini.LoadFile(".\\Data\\F4SE\\plugins\\FRIK.ini");
@@ -165,6 +237,8 @@ namespace F4VRBody {
 		c_pipBoyLookAtGate = ini.GetDoubleValue("Fallout4VRBody", "PipBoyLookAtThreshold", 0.7);
 		c_pipBoyOffDelay = (int)ini.GetLongValue("Fallout4VRBody", "PipBoyOffDelay", 5000);
 		c_gripLetGoThreshold = ini.GetDoubleValue("Fallout4VRBody", "GripLetGoThreshold", 15.0f);
+		// the old threshold was per frame, ini files that only have it get it converted at 90 fps
+		c_gripLetGoSpeed = ini.GetDoubleValue("Fallout4VRBody", "GripLetGoSpeed", c_gripLetGoThreshold * 90.0f);
 		c_pipBoyButtonMode =             ini.GetBoolValue("Fallout4VRBody", "OperatePipboyWithButton", false);
 		c_pipBoyAllowMovementNotLooking = ini.GetBoolValue("Fallout4VRBody", "AllowMovementWhenNotLookingAtPipboy", true);
 		c_pipBoyButtonArm = (int)ini.GetLongValue("Fallout4VRBody", "OperatePipboyWithButtonArm", 0);
@@ -179,6 +253,33 @@ namespace F4VRBody {
 		c_dampenHands = ini.GetBoolValue("Fallout4VRBody", "DampenHands", true);
 		c_dampenHandsRotation = ini.GetDoubleValue("Fallout4VRBody", "DampenHandsRotation", 0.7);
 		c_dampenHandsTranslation = ini.GetDoubleValue("Fallout4VRBody", "DampenHandsTranslation", 0.7);
+		c_enableSolveCache = ini.GetBoolValue("Fallout4VRBody", "EnableSolveCache", true);
+		c_solveCachePositionTolerance = ini.GetDoubleValue("Fallout4VRBody", "SolveCachePositionTolerance", 0.05);
+		c_solveCacheAngleTolerance = ini.GetDoubleValue("Fallout4VRBody", "SolveCacheAngleTolerance", 0.1);
+		c_solveCacheRefreshFrames = (int)ini.GetLongValue("Fallout4VRBody", "SolveCacheRefreshFrames", 30);
+		SolveCache::settings = { c_enableSolveCache, c_solveCachePositionTolerance, degrees_to_rads(c_solveCacheAngleTolerance), c_solveCacheRefreshFrames };
+		c_parallelIK = ini.GetBoolValue("Fallout4VRBody", "ParallelIK", false);
+		c_enableFrameGovernor = ini.GetBoolValue("Fallout4VRBody", "EnableFrameGovernor", false);
+		c_frameBudgetMs = ini.GetDoubleValue("Fallout4VRBody", "FrameBudgetMs", 2.0);
+		c_logWorkCounters = ini.GetBoolValue("Fallout4VRBody", "LogWorkCounters", false);
+		c_snapshotReloads = ini.GetBoolValue("Fallout4VRBody", "SnapshotReloads", false);
+		c_enableTelemetry = ini.GetBoolValue("Fallout4VRBody", "EnableTelemetry", false);
+		c_scopeMessageIntervalMs = ini.GetLongValue("Fallout4VRBody", "ScopeMessageIntervalMs", 0);
+		c_terrainFootPlacement = ini.GetBoolValue("Fallout4VRBody", "TerrainFootPlacement", false);
+		c_terrainFootRange = ini.GetDoubleValue("Fallout4VRBody", "TerrainFootRange", 40.0);
+		c_enableBodyTrackers = ini.GetBoolValue("Fallout4VRBody", "EnableBodyTrackers", false);
+		c_waistTracker = ini.GetValue("Fallout4VRBody", "WaistTracker", "");
+		c_leftFootTracker = ini.GetValue("Fallout4VRBody", "LeftFootTracker", "");
+		c_rightFootTracker = ini.GetValue("Fallout4VRBody", "RightFootTracker", "");
+		c_fingerTracking = ini.GetBoolValue("Fallout4VRBody", "EnableFingerTracking", false);
+		c_fingerTrackingActionManifest = ini.GetValue("Fallout4VRBody", "FingerTrackingActionManifest", "FRIK_actions.json");
+		c_fingerTrackingActionSet = ini.GetValue("Fallout4VRBody", "FingerTrackingActionSet", "/actions/frik");
+		c_leftHandSkeletonAction = ini.GetValue("Fallout4VRBody", "LeftHandSkeletonAction", "/actions/frik/in/lefthand_skeleton");
+		c_rightHandSkeletonAction = ini.GetValue("Fallout4VRBody", "RightHandSkeletonAction", "/actions/frik/in/righthand_skeleton");
+		c_actorIKBudgetMs = ini.GetDoubleValue("Fallout4VRBody", "ActorIKBudgetMs", 1.0);
+		c_actorIKMaxActors = ini.GetLongValue("Fallout4VRBody", "ActorIKMaxActors", 8);
+		c_actorIKFarDistance = ini.GetDoubleValue("Fallout4VRBody", "ActorIKFarDistance", 2000.0);
+		c_actorIKFarInterval = ini.GetLongValue("Fallout4VRBody", "ActorIKFarInterval", 4);
 
 
 		//Smooth Movement
@@ -192,15 +293,36 @@ namespace F4VRBody {
 		disableInteriorSmoothing           = ini.GetBoolValue("SmoothMovementVR", "DisableInteriorSmoothing", 1);
 		disableInteriorSmoothingHorizontal = ini.GetBoolValue("SmoothMovementVR", "DisableInteriorSmoothingHorizontal", 1);
 
+		//Gait
+		GaitTables& gait = g_gaitTables;
+		readTable(ini, "Gait", "StepTime", gait.stepTime);
+		readTable(ini, "Gait", "SwingCurve", gait.swing);
+		gait.maxSpeed           = (float) ini.GetDoubleValue("Gait", "MaxSpeed", gait.maxSpeed);
+		gait.startSpeed         = (float) ini.GetDoubleValue("Gait", "StartSpeed", gait.startSpeed);
+		gait.stopSpeed          = (float) ini.GetDoubleValue("Gait", "StopSpeed", gait.stopSpeed);
+		gait.strideScale        = (float) ini.GetDoubleValue("Gait", "StrideScale", gait.strideScale);
+		gait.maxStride          = (float) ini.GetDoubleValue("Gait", "MaxStride", gait.maxStride);
+		gait.stepHeightDistance = (float) ini.GetDoubleValue("Gait", "StepHeightDistance", gait.stepHeightDistance);
+		gait.maxStepHeight      = (float) ini.GetDoubleValue("Gait", "MaxStepHeight", gait.maxStepHeight);
+		gait.minStepHeight      = (float) ini.GetDoubleValue("Gait", "MinStepHeight", gait.minStepHeight);
+		gait.spineSway          = (float) ini.GetDoubleValue("Gait", "SpineSway", gait.spineSway);
+		gait.seed               = (UInt32) ini.GetLongValue("Gait", "Seed", gait.seed);
+		if (gait.maxSpeed <= 0.0f) {
+			gait.maxSpeed = 350.0f;
+		}
+
 		// weaponPositioning
 		c_repositionMasterMode = ini.GetBoolValue("Fallout4VRBody", "EnableRepositionMode", false);
 		c_holdDelay = (int)ini.GetLongValue("Fallout4VRBody", "HoldDelay", 1000);
 		c_repositionButtonID = (int)ini.GetLongValue("Fallout4VRBody", "RepositionButtonID", vr::EVRButtonId::k_EButton_SteamVR_Trigger); // 33
 		c_offHandActivateButtonID = (int)ini.GetLongValue("Fallout4VRBody", "OffHandActivateButtonID", vr::EVRButtonId::k_EButton_A); // 7
 		c_scopeAdjustDistance = ini.GetDoubleValue("Fallout4VRBody", "ScopeAdjustDistance", 15.f);
-		// now load weapon offset JSON
-		readOffsetJson();
 
+		return true;
+	}
+
+	// face and skin meshes to hide.   runs on a startup loader thread, nothing reads them before the game has loaded
+	void loadCullLists() {
 		std::ifstream cullList;
 
 		cullList.open(".\\Data\\F4SE\\plugins\\FRIK_Mesh_Hide\\face.ini");
@@ -226,8 +348,6 @@ namespace F4VRBody {
 		}
 
 		cullList.close();
-
-		return true;
 	}
 
 
@@ -286,6 +406,11 @@ namespace F4VRBody {
 
 	// Bone sphere detection
 
+	static void sendBoneSphereEvent(const EventRegistration<NullParameters>& reg, SInt32 evt, UInt32 handle, UInt32 device) {
+		g_workCounters.add(kWork_PapyrusEvents);
+		SendPapyrusEvent3<SInt32, UInt32, UInt32>(reg.handle, reg.scriptName, boneSphereEventName, evt, handle, device);
+	}
+
 	void detectBoneSphere() {
 
 		if ((*g_player)->firstPersonSkeleton == nullptr) {
@@ -329,7 +454,7 @@ namespace F4VRBody {
 					if (g_boneSphereEventRegs.m_data.size() > 0) {
 						g_boneSphereEventRegs.ForEach(
 							[&evt, &handle, &device](const EventRegistration<NullParameters>& reg) {
-							SendPapyrusEvent3<SInt32, UInt32, UInt32>(reg.handle, reg.scriptName, boneSphereEventName, evt, handle, device);
+							sendBoneSphereEvent(reg, evt, handle, device);
 						}
 						);
 					}
@@ -347,7 +472,7 @@ namespace F4VRBody {
 					if (g_boneSphereEventRegs.m_data.size() > 0) {
 						g_boneSphereEventRegs.ForEach(
 							[&evt, &handle, &device](const EventRegistration<NullParameters>& reg) {
-							SendPapyrusEvent3<SInt32, UInt32, UInt32>(reg.handle, reg.scriptName, boneSphereEventName, evt, handle, device);
+							sendBoneSphereEvent(reg, evt, handle, device);
 						}
 						);
 					}
@@ -368,7 +493,7 @@ namespace F4VRBody {
 					if (g_boneSphereEventRegs.m_data.size() > 0) {
 						g_boneSphereEventRegs.ForEach(
 							[&evt, &handle, &device](const EventRegistration<NullParameters>& reg) {
-							SendPapyrusEvent3<SInt32, UInt32, UInt32>(reg.handle, reg.scriptName, boneSphereEventName, evt, handle, device);
+							sendBoneSphereEvent(reg, evt, handle, device);
 						}
 						);
 					}
@@ -386,7 +511,7 @@ namespace F4VRBody {
 					if (g_boneSphereEventRegs.m_data.size() > 0) {
 						g_boneSphereEventRegs.ForEach(
 							[&evt, &handle, &device](const EventRegistration<NullParameters>& reg) {
-							SendPapyrusEvent3<SInt32, UInt32, UInt32>(reg.handle, reg.scriptName, boneSphereEventName, evt, handle, device);
+							sendBoneSphereEvent(reg, evt, handle, device);
 						}
 						);
 					}
@@ -451,10 +576,10 @@ namespace F4VRBody {
 			static BSFixedString rfarm("RArm_ForeArm2");
 			static BSFixedString pipboyName("PipboyBone");
 
-			NiNode* hand = pn->GetObjectByName(&lHand)->GetAsNiNode();
-			NiNode* arm = pn->GetObjectByName(&lArm)->GetAsNiNode();
-			NiNode* forearm = pn->GetObjectByName(&lfarm)->GetAsNiNode();
-			NiNode* pipboy = (NiNode*)pn->m_children.m_data[0]->GetObjectByName(&pipboyName);
+			NiNode* hand = getObjectByName(pn, lHand)->GetAsNiNode();
+			NiNode* arm = getObjectByName(pn, lArm)->GetAsNiNode();
+			NiNode* forearm = getObjectByName(pn, lfarm)->GetAsNiNode();
+			NiNode* pipboy = (NiNode*)getObjectByName(pn->m_children.m_data[0], pipboyName);
 
 			Skeleton sk;
 			bool inPA = sk.detectInPowerArmor();
@@ -466,7 +591,7 @@ namespace F4VRBody {
 						pipboy->m_parent->RemoveChild(pipboy);
 					}
 					else {
-						pipboy = (NiNode*)pn->GetObjectByName(&pipboyName);
+						pipboy = (NiNode*)getObjectByName(pn, pipboyName);
 					}
 					forearm->m_parent->RemoveChild(forearm);
 					arm->AttachChild(forearm, true);
@@ -476,9 +601,9 @@ namespace F4VRBody {
 					}
 				}
 
-				hand = pn->GetObjectByName(&rHand)->GetAsNiNode();
-				arm = pn->GetObjectByName(&rArm)->GetAsNiNode();
-				forearm = pn->GetObjectByName(&rfarm)->GetAsNiNode();
+				hand = getObjectByName(pn, rHand)->GetAsNiNode();
+				arm = getObjectByName(pn, rArm)->GetAsNiNode();
+				forearm = getObjectByName(pn, rfarm)->GetAsNiNode();
 
 				if (arm->m_children.m_data[0] == hand) {
 					arm->RemoveChildAt(0);
@@ -512,8 +637,7 @@ namespace F4VRBody {
 
 
 		if (retNode && wand) {
-			BSFixedString screenName("Screen:0");
-			NiAVObject* newScreen = retNode->GetObjectByName(&screenName)->m_parent;
+			NiAVObject* newScreen = getObjectByName(retNode, "Screen:0")->m_parent;
 
 			if (!newScreen) {
 				meshesReplaced = false;
@@ -538,13 +662,12 @@ namespace F4VRBody {
 		NiNode* screenNode = pn->ScreenNode;
 
 		if (screenNode) {
-			BSFixedString screenName("Screen:0");
-			NiAVObject* newScreen = screenNode->GetObjectByName(&screenName);
+			NiAVObject* newScreen = getObjectByName(screenNode, "Screen:0");
 
 			if (!newScreen) {
 				pn->ScreenNode->RemoveChildAt(0);
 
-				newScreen = pn->PipboyRoot_nif_only_node->GetObjectByName(&screenName)->m_parent;
+				newScreen = getObjectByName(pn->PipboyRoot_nif_only_node, "Screen:0")->m_parent;
 				NiNode* rn = Offsets::addNode((uint64_t)&pn->ScreenNode, newScreen);
 			}
 		}
@@ -554,8 +677,7 @@ namespace F4VRBody {
 		static NiPoint3 origLoc(0, 0, 0);
 
 		NiNode* wand = pn->primaryUIAttachNode;
-		BSFixedString bname = "BackOfHand";
-		NiNode* node = (NiNode*)wand->GetObjectByName(&bname);
+		NiNode* node = (NiNode*)getObjectByName(wand, "BackOfHand");
 
 		if (!node) {
 			return;
@@ -690,6 +812,28 @@ namespace F4VRBody {
 
 	}
 
+	void publishTelemetry() {
+		UInt32 flags = 0;
+
+		flags |= playerSkelly->inPowerArmor() ? FRIK_FLAG_POWER_ARMOR : 0;
+		flags |= c_armsOnly ? FRIK_FLAG_ARMS_ONLY : 0;
+		flags |= c_repositionMasterMode ? FRIK_FLAG_REPOSITION : 0;
+		flags |= c_isLookingThroughScope ? FRIK_FLAG_SCOPE : 0;
+		flags |= c_leftHandedMode ? FRIK_FLAG_LEFT_HANDED : 0;
+		flags |= c_selfieMode ? FRIK_FLAG_SELFIE : 0;
+
+		g_telemetry->endFrame(flags);
+	}
+
+	// measured against the final pose, after everything that moves the hands once the ik is done
+	void collectIKStats() {
+		for (auto i = 0; i < FRIK_LIMB_COUNT; i++) {
+			FRIKTelemetryLimb limb = (FRIKTelemetryLimb)i;
+			g_ikStats.setLimb(limb, playerSkelly->getIKResidual(limb), playerSkelly->getIKRotationResidual(limb), playerSkelly->getIKFlags(limb));
+		}
+		g_ikStats.setPosture(playerSkelly->getPostureResidual());
+	}
+
 	void update() {
 		static bool inPowerArmorSticky = false;
 
@@ -772,6 +916,14 @@ namespace F4VRBody {
 
 		if (c_verbose) { _MESSAGE("Start of Frame"); }
 
+		// settings committed through the config batch natives land here so the whole frame sees the same values
+		g_configTransactions->applyPending();
+
+		g_frameGovernor->beginFrame();
+		if (g_telemetry) {
+			g_telemetry->beginFrame();
+		}
+
 		c_leftHandedMode = *Offsets::iniLeftHandedMode;
 
 		if (!meshesReplaced) {
@@ -791,10 +943,10 @@ namespace F4VRBody {
 
 	//	fixSkeleton();
 
-		NiPoint3 position = (*g_player)->pos;
-		float groundHeight = 0.0f;
-
-		uint64_t ret = Offsets::TESObjectCell_GetLandHeight((*g_player)->parentCell, &position, &groundHeight);
+		// the feet read land heights from the cached grid, interiors don't have any
+		TESObjectCELL* cell = (*g_player)->parentCell;
+		bool exterior = cell && !((cell->flags & TESObjectCELL::kFlag_IsInterior) == TESObjectCELL::kFlag_IsInterior);
+		setLandRegion(exterior ? cell : nullptr, (*g_player)->pos);
 
 		// first restore locals to a default state to wipe out any local transform changes the game might have made since last update
 		if (c_verbose) { _MESSAGE("restore locals of skeleton"); }
@@ -809,37 +961,42 @@ namespace F4VRBody {
 
 		//// set up the body underneath the headset in a proper scale and orientation
 		if (c_verbose) { _MESSAGE("Set body under HMD"); }
-		playerSkelly->setUnderHMD(groundHeight);
+		playerSkelly->setUnderHMD();
 		playerSkelly->updateDown(playerSkelly->getRoot(), true);  // Do world update now so that IK calculations have proper world reference
 
 		// Now Set up body Posture and hook up the legs
 		if (c_verbose) { _MESSAGE("Set body posture"); }
-		playerSkelly->setBodyPosture();
+		g_trackedBody->update(playerSkelly->getPlayerNodes()->roomnode);
+		if (!playerSkelly->setTrackedPosture()) {
+			playerSkelly->setBodyPosture();
+		}
 		playerSkelly->updateDown(playerSkelly->getRoot(), true);  // Do world update now so that IK calculations have proper world reference
 
+		if (g_telemetry) { g_telemetry->mark(FRIK_STAGE_BODY); }
 		if (c_verbose) { _MESSAGE("Set Knee Posture"); }
 		playerSkelly->setKneePos();
 		if (c_verbose) { _MESSAGE("Set Walk"); }
 
-		if (!c_armsOnly) {
+		if (!c_armsOnly && !playerSkelly->setTrackedFeet()) {
 			playerSkelly->walk();
 		}
 		//playerSkelly->setLegs();
 		if (c_verbose) { _MESSAGE("Set Legs"); }
-		playerSkelly->setSingleLeg(false);
-		playerSkelly->setSingleLeg(true);
+		playerSkelly->setBothLegs();
 
 		// Do another update before setting arms
 		playerSkelly->updateDown(playerSkelly->getRoot(), true);  // Do world update now so that IK calculations have proper world reference
+		playerSkelly->calibrateTrackers();
 
+		if (g_telemetry) { g_telemetry->mark(FRIK_STAGE_LEGS); }
 		// do arm IK - Right then Left
 		if (c_verbose) { _MESSAGE("Set Arms"); }
 		playerSkelly->handleWeaponNodes();
-		playerSkelly->setArms(false);
-		playerSkelly->setArms(true);
+		playerSkelly->setBothArms();
 		playerSkelly->leftHandedModePipboy();
 		playerSkelly->updateDown(playerSkelly->getRoot(), true);  // Do world update now so that IK calculations have proper world reference
 
+		if (g_telemetry) { g_telemetry->mark(FRIK_STAGE_ARMS); }
 		// Misc stuff to showahide things and also setup the wrist pipboy
 		if (c_verbose) { _MESSAGE("Pipboy and Weapons"); }
 		playerSkelly->hideWeapon();
@@ -849,13 +1006,16 @@ namespace F4VRBody {
 		playerSkelly->hideFistHelpers();
 		playerSkelly->showHidePAHUD();
 
-		cullGeometry();
+		if (g_frameGovernor->shouldRun(kStage_CullGeometry)) {
+			cullGeometry();
+		}
 
 		// project body out in front of the camera for debug purposes
 		if (c_verbose) { _MESSAGE("Selfie Time"); }
 		playerSkelly->selfieSkelly(120.0f);
 		playerSkelly->updateDown(playerSkelly->getRoot(), true);  
 
+		if (g_telemetry) { g_telemetry->mark(FRIK_STAGE_ATTACHMENTS); }
 		if (c_verbose) { _MESSAGE("fix the missing screen"); }
 		fixMissingScreen(playerSkelly->getPlayerNodes());
 
@@ -865,31 +1025,36 @@ namespace F4VRBody {
 			playerSkelly->showOnlyArms();
 		}
 
+		g_fingerTracking->update();
+		g_weaponFeatures->update();
 		playerSkelly->setHandPose();
 		if (c_verbose) { _MESSAGE("Operate Pipboy"); }
 		playerSkelly->operatePipBoy();
 		if (c_verbose) { _MESSAGE("bone sphere stuff"); }
-		detectBoneSphere();
-		handleDebugBoneSpheres();
+		if (g_frameGovernor->shouldRun(kStage_BoneSpheres)) {
+			detectBoneSphere();
+		}
+		if (g_frameGovernor->shouldRun(kStage_DebugSpheres)) {
+			handleDebugBoneSpheres();
+		}
+		if (g_telemetry) { g_telemetry->mark(FRIK_STAGE_HANDS); }
 		g_gunReloadSystem->Update();
 
 
 		playerSkelly->offHandToBarrel();
 		playerSkelly->offHandToScope();
+		g_scopesChannel->flush();
+		g_haptics->submit();
+		playerSkelly->applyVisibility();
 
+		if (g_telemetry) { g_telemetry->mark(FRIK_STAGE_WEAPON); }
 		Offsets::BSFadeNode_MergeWorldBounds((*g_player)->unkF0->rootNode->GetAsNiNode());
 		BSFlattenedBoneTree_UpdateBoneArray((*g_player)->unkF0->rootNode->m_children.m_data[0]); // just in case any transforms missed because they are not in the tree do a full flat bone array update
 		Offsets::BSFadeNode_UpdateGeomArray((*g_player)->unkF0->rootNode, 1);
 
-		if ((*g_player)->middleProcess->unk08->equipData && (*g_player)->middleProcess->unk08->equipData->equippedData) {
-			auto obj = (*g_player)->middleProcess->unk08->equipData->equippedData;
-			uint64_t* vfunc = (uint64_t*)obj;
-			if ((*vfunc & 0xFFFF) == (Offsets::EquippedWeaponData_vfunc & 0xFFFF)) {
-				MuzzleFlash* muzzle = reinterpret_cast<MuzzleFlash*>((*g_player)->middleProcess->unk08->equipData->equippedData->unk28);
-				if (muzzle && muzzle->fireNode && muzzle->projectileNode) {
-					muzzle->fireNode->m_localTransform = muzzle->projectileNode->m_worldTransform;
-				}
-			}
+		MuzzleFlash* muzzle = g_weaponFeatures->getMuzzleFlash();
+		if (muzzle && muzzle->fireNode && muzzle->projectileNode) {
+			muzzle->fireNode->m_localTransform = muzzle->projectileNode->m_worldTransform;
 		}
 
 		if (isInScopeMenu()) {
@@ -903,6 +1068,23 @@ namespace F4VRBody {
 
 		playerSkelly->debug();
 
+		// hand the final pose to other plugins
+		g_poseBuffer->publish(playerSkelly);
+
+		// other actors with ik targets, whatever fits in what is left of the budget
+		g_actorIK->run((*g_player)->pos);
+
+		g_hookStats.endFrame();
+		collectIKStats();
+
+		if (g_telemetry) {
+			g_telemetry->mark(FRIK_STAGE_FINISH);
+			publishTelemetry();
+		}
+
+		g_frameGovernor->endFrame();
+		g_workCounters.endFrame();
+		g_ikStats.endFrame();
 	}
 
 
@@ -920,6 +1102,10 @@ namespace F4VRBody {
 	// Papyrus Native Funcs
 
 	void saveStates(StaticFunctionTag* base) {
+		saveSettings();
+	}
+
+	void saveSettings() {
 		CSimpleIniA ini;
 		SI_Error rc = ini.LoadFile(".\\Data\\F4SE\\plugins\\FRIK.ini");
 
@@ -1072,6 +1258,7 @@ namespace F4VRBody {
 		PlayerNodes* pn = (PlayerNodes*)((char*)(*g_player) + 0x6E0);
 
 		c_playerHeight = pn->UprightHmdNode->m_localTransform.pos.z;
+		g_trackedBody->resetCalibration();
 
 		_MESSAGE("Calibrated Height: %f  arm length: %f %f", c_playerHeight, c_armLength);
 	}
@@ -1130,8 +1317,7 @@ namespace F4VRBody {
 
 		c_staticGripping = !c_staticGripping;
 
-		bool gripConfig = !F4VRBody::c_staticGripping;
-		g_messaging->Dispatch(g_pluginHandle, 15, (void*)gripConfig, sizeof(bool), "FO4VRBETTERSCOPES");
+		g_scopesChannel->sendGripConfig(!c_staticGripping);
 	}
 
 	bool isLeftHandedMode(StaticFunctionTag* base) {
@@ -1346,6 +1532,124 @@ namespace F4VRBody {
 		}
 	}
 
+	// transactional settings for mcm style scripts.   BeginConfig, any number of Set calls, then CommitConfig
+	UInt32 BeginConfig(StaticFunctionTag* base) {
+		return g_configTransactions->begin();
+	}
+
+	bool SetConfigFloats(StaticFunctionTag* base, UInt32 batch, VMArray<BSFixedString> keys, VMArray<float> values) {
+		std::vector<std::string> keyList;
+		std::vector<float> valueList;
+
+		for (UInt32 i = 0; i < keys.Length(); i++) {
+			BSFixedString key;
+			keys.Get(&key, i);
+			keyList.push_back(key.c_str());
+		}
+		for (UInt32 i = 0; i < values.Length(); i++) {
+			float value;
+			values.Get(&value, i);
+			valueList.push_back(value);
+		}
+
+		return g_configTransactions->setFloats(batch, keyList, valueList);
+	}
+
+	bool SetConfigBools(StaticFunctionTag* base, UInt32 batch, VMArray<BSFixedString> keys, VMArray<bool> values) {
+		std::vector<std::string> keyList;
+		std::vector<bool> valueList;
+
+		for (UInt32 i = 0; i < keys.Length(); i++) {
+			BSFixedString key;
+			keys.Get(&key, i);
+			keyList.push_back(key.c_str());
+		}
+		for (UInt32 i = 0; i < values.Length(); i++) {
+			bool value;
+			values.Get(&value, i);
+			valueList.push_back(value);
+		}
+
+		return g_configTransactions->setBools(batch, keyList, valueList);
+	}
+
+	// thumb, index, middle, ring, pinky
+	bool SetConfigFingers(StaticFunctionTag* base, UInt32 batch, bool isLeft, VMArray<float> values) {
+		std::vector<float> valueList;
+
+		for (UInt32 i = 0; i < values.Length(); i++) {
+			float value;
+			values.Get(&value, i);
+			valueList.push_back(value);
+		}
+
+		return g_configTransactions->setFingers(batch, isLeft, valueList);
+	}
+
+	bool CommitConfig(StaticFunctionTag* base, UInt32 batch, bool persist) {
+		return g_configTransactions->commit(batch, persist);
+	}
+
+	void AbortConfig(StaticFunctionTag* base, UInt32 batch) {
+		g_configTransactions->abort(batch);
+	}
+
+	// batched bone lookups so scripts don't need a native call per bone per frame
+	UInt32 RegisterBoneQuery(StaticFunctionTag* base, VMArray<BSFixedString> bones) {
+		if (bones.Length() == 0) {
+			return 0;
+		}
+
+		std::vector<BSFixedString> names;
+		for (UInt32 i = 0; i < bones.Length(); i++) {
+			BSFixedString name;
+			bones.Get(&name, i);
+			names.push_back(name);
+		}
+
+		UInt32 handle = nextBoneQueryHandle++;
+		boneQueries[handle] = std::make_unique<BoneQuery>(names);
+
+		return handle;
+	}
+
+	void DestroyBoneQuery(StaticFunctionTag* base, UInt32 handle) {
+		boneQueries.erase(handle);
+	}
+
+	VMArray<float> GetBoneQueryPositions(StaticFunctionTag* base, UInt32 handle) {
+		VMArray<float> result;
+
+		auto found = boneQueries.find(handle);
+		if (playerSkelly && found != boneQueries.end()) {
+			found->second->getPositions((BSFlattenedBoneTree*)playerSkelly->getRoot(), result);
+		}
+
+		return result;
+	}
+
+	VMArray<float> GetBoneQueryTransforms(StaticFunctionTag* base, UInt32 handle) {
+		VMArray<float> result;
+
+		auto found = boneQueries.find(handle);
+		if (playerSkelly && found != boneQueries.end()) {
+			found->second->getTransforms((BSFlattenedBoneTree*)playerSkelly->getRoot(), result);
+		}
+
+		return result;
+	}
+
+	// right thumb to pinky then left, x y z each
+	VMArray<float> GetFingertipPositions(StaticFunctionTag* base) {
+		VMArray<float> result;
+
+		if (playerSkelly) {
+			getFingertipQuery()->getPositions((BSFlattenedBoneTree*)playerSkelly->getRoot(), result);
+		}
+
+		return result;
+	}
+
 	void RegisterForBoneSphereEvents(StaticFunctionTag* base, VMObject* thisObject) {
 		_MESSAGE("RegisterForBoneSphereEvents");
 		if (!thisObject) {
@@ -1440,6 +1744,77 @@ namespace F4VRBody {
 		bDumpArray = true;
 	}
 
+	// cgf "FRIK:FRIK.getWorkCounters" from the console
+	BSFixedString getWorkCounters(StaticFunctionTag* base) {
+		std::string summary = g_workCounters.getSummary();
+		Console_Print("%s", summary.c_str());
+		return BSFixedString(summary.c_str());
+	}
+
+	// cgf "FRIK:FRIK.getHookStats" from the console
+	BSFixedString getHookStats(StaticFunctionTag* base) {
+		std::string summary = g_hookStats.getSummary();
+		Console_Print("%s", summary.c_str());
+		return BSFixedString(summary.c_str());
+	}
+
+	// cgf "FRIK:FRIK.getIKStats" from the console
+	BSFixedString getIKStats(StaticFunctionTag* base) {
+		std::string summary = g_ikStats.getSummary();
+		Console_Print("%s", summary.c_str());
+		return BSFixedString(summary.c_str());
+	}
+
+	// cgf "FRIK:FRIK.captureSkeleton" "label" from the console, writes the body and first person skeletons to FRIK_Snapshots.frks
+	UInt32 captureSkeleton(StaticFunctionTag* base, BSFixedString label) {
+		if (!*g_player || !(*g_player)->unkF0) {
+			return 0;
+		}
+
+		std::string name = label.c_str() ? label.c_str() : "";
+		int nodes = g_skeletonSnapshots->capture((*g_player)->unkF0->rootNode, (name + " body").c_str());
+		nodes += g_skeletonSnapshots->capture((*g_player)->firstPersonSkeleton, (name + " 1st").c_str());
+
+		Console_Print("captured %d nodes", nodes);
+		return nodes;
+	}
+
+	float getWorkCounter(StaticFunctionTag* base, UInt32 counter) {
+		if (counter >= kWork_Count) {
+			return 0.0f;
+		}
+		return g_workCounters.getPerFrame((WorkCounter)counter);
+	}
+
+
+	bool AddIKActor(StaticFunctionTag* base, Actor* actor) {
+		if (!actor) {
+			return false;
+		}
+		return g_actorIK->add(actor->formID);
+	}
+
+	void RemoveIKActor(StaticFunctionTag* base, Actor* actor) {
+		if (actor) {
+			g_actorIK->remove(actor->formID);
+		}
+	}
+
+	// limb is 0 right arm, 1 left arm, 2 right leg, 3 left leg
+	bool SetIKActorTarget(StaticFunctionTag* base, Actor* actor, UInt32 limb, float x, float y, float z) {
+		if (!actor || limb >= FRIK_LIMB_COUNT) {
+			return false;
+		}
+		return g_actorIK->setTarget(actor->formID, (FRIKTelemetryLimb)limb, true, NiPoint3(x, y, z));
+	}
+
+	bool ClearIKActorTarget(StaticFunctionTag* base, Actor* actor, UInt32 limb) {
+		if (!actor || limb >= FRIK_LIMB_COUNT) {
+			return false;
+		}
+		return g_actorIK->setTarget(actor->formID, (FRIKTelemetryLimb)limb, false, NiPoint3(0, 0, 0));
+	}
+
 
 	bool RegisterFuncs(VirtualMachine* vm) {
 
@@ -1484,6 +1859,26 @@ namespace F4VRBody {
 		vm->RegisterFunction(new NativeFunction6<StaticFunctionTag, void, bool, float, float, float, float, float>("setFingerPositionScalar", "FRIK:FRIK", F4VRBody::setFingerPositionScalar, vm));
 		vm->RegisterFunction(new NativeFunction1<StaticFunctionTag, void, bool>("restoreFingerPoseControl", "FRIK:FRIK", F4VRBody::restoreFingerPoseControl, vm));
 		vm->RegisterFunction(new NativeFunction0<StaticFunctionTag, void>("dumpGeometryArray", "FRIK:FRIK", F4VRBody::dumpGeometryArray, vm));
+		vm->RegisterFunction(new NativeFunction0<StaticFunctionTag, UInt32>("BeginConfig", "FRIK:FRIK", F4VRBody::BeginConfig, vm));
+		vm->RegisterFunction(new NativeFunction3<StaticFunctionTag, bool, UInt32, VMArray<BSFixedString>, VMArray<float> >("SetConfigFloats", "FRIK:FRIK", F4VRBody::SetConfigFloats, vm));
+		vm->RegisterFunction(new NativeFunction3<StaticFunctionTag, bool, UInt32, VMArray<BSFixedString>, VMArray<bool> >("SetConfigBools", "FRIK:FRIK", F4VRBody::SetConfigBools, vm));
+		vm->RegisterFunction(new NativeFunction3<StaticFunctionTag, bool, UInt32, bool, VMArray<float> >("SetConfigFingers", "FRIK:FRIK", F4VRBody::SetConfigFingers, vm));
+		vm->RegisterFunction(new NativeFunction2<StaticFunctionTag, bool, UInt32, bool>("CommitConfig", "FRIK:FRIK", F4VRBody::CommitConfig, vm));
+		vm->RegisterFunction(new NativeFunction1<StaticFunctionTag, void, UInt32>("AbortConfig", "FRIK:FRIK", F4VRBody::AbortConfig, vm));
+		vm->RegisterFunction(new NativeFunction1<StaticFunctionTag, UInt32, VMArray<BSFixedString> >("RegisterBoneQuery", "FRIK:FRIK", F4VRBody::RegisterBoneQuery, vm));
+		vm->RegisterFunction(new NativeFunction1<StaticFunctionTag, void, UInt32>("DestroyBoneQuery", "FRIK:FRIK", F4VRBody::DestroyBoneQuery, vm));
+		vm->RegisterFunction(new NativeFunction1<StaticFunctionTag, VMArray<float>, UInt32>("GetBoneQueryPositions", "FRIK:FRIK", F4VRBody::GetBoneQueryPositions, vm));
+		vm->RegisterFunction(new NativeFunction1<StaticFunctionTag, VMArray<float>, UInt32>("GetBoneQueryTransforms", "FRIK:FRIK", F4VRBody::GetBoneQueryTransforms, vm));
+		vm->RegisterFunction(new NativeFunction0<StaticFunctionTag, VMArray<float> >("GetFingertipPositions", "FRIK:FRIK", F4VRBody::GetFingertipPositions, vm));
+		vm->RegisterFunction(new NativeFunction0<StaticFunctionTag, BSFixedString>("getWorkCounters", "FRIK:FRIK", F4VRBody::getWorkCounters, vm));
+		vm->RegisterFunction(new NativeFunction1<StaticFunctionTag, float, UInt32>("getWorkCounter", "FRIK:FRIK", F4VRBody::getWorkCounter, vm));
+		vm->RegisterFunction(new NativeFunction0<StaticFunctionTag, BSFixedString>("getHookStats", "FRIK:FRIK", F4VRBody::getHookStats, vm));
+		vm->RegisterFunction(new NativeFunction0<StaticFunctionTag, BSFixedString>("getIKStats", "FRIK:FRIK", F4VRBody::getIKStats, vm));
+		vm->RegisterFunction(new NativeFunction1<StaticFunctionTag, UInt32, BSFixedString>("captureSkeleton", "FRIK:FRIK", F4VRBody::captureSkeleton, vm));
+		vm->RegisterFunction(new NativeFunction1<StaticFunctionTag, bool, Actor*>("AddIKActor", "FRIK:FRIK", F4VRBody::AddIKActor, vm));
+		vm->RegisterFunction(new NativeFunction1<StaticFunctionTag, void, Actor*>("RemoveIKActor", "FRIK:FRIK", F4VRBody::RemoveIKActor, vm));
+		vm->RegisterFunction(new NativeFunction5<StaticFunctionTag, bool, Actor*, UInt32, float, float, float>("SetIKActorTarget", "FRIK:FRIK", F4VRBody::SetIKActorTarget, vm));
+		vm->RegisterFunction(new NativeFunction2<StaticFunctionTag, bool, Actor*, UInt32>("ClearIKActorTarget", "FRIK:FRIK", F4VRBody::ClearIKActorTarget, vm));
 
 		return true;
 	}
@@ -33,6 +33,10 @@ namespace F4VRBody {
 	extern float c_fVrScale;
 	extern float c_armLength;
 	extern float c_cameraHeight;
+	extern float c_handUI_X;
+	extern float c_handUI_Y;
+	extern float c_handUI_Z;
+	extern bool  c_hideHead;
 	extern bool  c_showPAHUD;
 	extern bool  c_hidePipboy;
 	extern bool  c_selfieMode;
@@ -48,6 +52,7 @@ namespace F4VRBody {
 	extern bool  c_staticGripping;
 	extern float c_pipBoyLookAtGate;
 	extern float c_gripLetGoThreshold;
+	extern float c_gripLetGoSpeed;
 	extern bool c_isLookingThroughScope;
 	extern bool c_pipBoyButtonMode;
 	extern bool c_pipBoyAllowMovementNotLooking;
@@ -69,6 +74,32 @@ namespace F4VRBody {
 	extern bool c_dampenHands;
 	extern float c_dampenHandsRotation;
 	extern float c_dampenHandsTranslation;
+	extern bool c_enableSolveCache;
+	extern float c_solveCachePositionTolerance;
+	extern float c_solveCacheAngleTolerance;
+	extern int c_solveCacheRefreshFrames;
+	extern bool c_parallelIK;
+	extern bool c_enableFrameGovernor;
+	extern float c_frameBudgetMs;
+	extern bool c_logWorkCounters;
+	extern bool c_snapshotReloads;
+	extern bool c_enableTelemetry;
+	extern int c_scopeMessageIntervalMs;
+	extern bool c_terrainFootPlacement;
+	extern float c_terrainFootRange;
+	extern bool c_enableBodyTrackers;
+	extern std::string c_waistTracker;
+	extern std::string c_leftFootTracker;
+	extern std::string c_rightFootTracker;
+	extern bool c_fingerTracking;
+	extern std::string c_fingerTrackingActionManifest;
+	extern std::string c_fingerTrackingActionSet;
+	extern std::string c_leftHandSkeletonAction;
+	extern std::string c_rightHandSkeletonAction;
+	extern float c_actorIKBudgetMs;
+	extern int c_actorIKMaxActors;
+	extern float c_actorIKFarDistance;
+	extern int c_actorIKFarInterval;
 
 	class BoneSphere {
 	public:
@@ -110,6 +141,7 @@ namespace F4VRBody {
 	NiNode* loadNifFromFile(char* path);
 
 	bool loadConfig();
+	void loadCullLists();
 
 	void smoothMovement();
 	void update();
@@ -117,7 +149,9 @@ namespace F4VRBody {
 
 	// Native funcs to expose to papyrus
 
+	void saveSettings();
 	void saveStates(StaticFunctionTag* base);
+	void setFingerPositionScalar(StaticFunctionTag* base, bool isLeft, float thumb, float index, float middle, float ring, float pinky);
 	void calibrate(StaticFunctionTag* base);
 	void togglePipboyVis(StaticFunctionTag* base);
 	void toggleSelfieMode(StaticFunctionTag* base);
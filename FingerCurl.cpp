@@ -0,0 +1,88 @@
+#include "FingerCurl.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string.h>
+
+namespace F4VRBody {
+
+	// OpenVR hand skeleton bone for each FRIK slot.   thumb, index, middle, ring, pinky and 3 joints each, the metacarpals
+	// of the other 4 fingers and the tips have no FRIK bone
+	static const int openVRBones[FingerCurl::kBonesPerHand] = {
+		2, 3, 4,
+		7, 8, 9,
+		12, 13, 14,
+		17, 18, 19,
+		22, 23, 24
+	};
+
+	static float angleBetween(Quaternion a_q1, Quaternion a_q2) {
+		return 2.0f * acosf(std::clamp((float)fabs(a_q1.dot(a_q2)), 0.0f, 1.0f));
+	}
+
+	FingerCurl::FingerCurl() {
+		_haveReference[0] = false;
+		_haveReference[1] = false;
+
+		for (auto slot = 0; slot < 2 * kBonesPerHand; slot++) {
+			_curl[slot] = 0.0f;
+			_range[slot] = 0.0f;
+			_poseRange[slot] = 0.0f;
+		}
+	}
+
+	int FingerCurl::getSlot(const char* a_boneName) {
+		if (strlen(a_boneName) != 13 || _strnicmp(a_boneName + 1, "Arm_Finger", 10)) {
+			return -1;
+		}
+
+		int hand = (a_boneName[0] == 'L' || a_boneName[0] == 'l') ? 1 : 0;
+		int finger = a_boneName[11] - '1';
+		int joint = a_boneName[12] - '1';
+		if (finger < 0 || finger > 4 || joint < 0 || joint > 2) {
+			return -1;
+		}
+
+		return hand * kBonesPerHand + finger * 3 + joint;
+	}
+
+	void FingerCurl::setReference(int a_hand, const Quaternion* a_open, const Quaternion* a_fist) {
+		for (auto i = 0; i < kBonesPerHand; i++) {
+			int slot = a_hand * kBonesPerHand + i;
+			_reference[slot] = a_open[openVRBones[i]];
+			_range[slot] = angleBetween(_reference[slot], a_fist[openVRBones[i]]);
+		}
+
+		_haveReference[a_hand] = true;
+	}
+
+	void FingerCurl::setBones(int a_hand, const Quaternion* a_bones) {
+		for (auto i = 0; i < kBonesPerHand; i++) {
+			int slot = a_hand * kBonesPerHand + i;
+			float angle = angleBetween(_reference[slot], a_bones[openVRBones[i]]);
+			_curl[slot] = _range[slot] > 0.0001f ? std::clamp(angle / _range[slot], 0.0f, 1.0f) : 0.0f;
+		}
+	}
+
+	void FingerCurl::setPose(int a_slot, const NiMatrix43& a_open, const NiMatrix43& a_closed) {
+		_open[a_slot].fromRot(a_open);
+		_closed[a_slot].fromRot(a_closed);
+		_poseRange[a_slot] = angleBetween(_open[a_slot], _closed[a_slot]);
+	}
+
+	Quaternion FingerCurl::getTarget(int a_slot) {
+		Quaternion q = _closed[a_slot];
+		q.slerp(1.0f - _curl[a_slot], _open[a_slot]);
+		return q;
+	}
+
+	float FingerCurl::getPoseCurl(int a_slot, const NiMatrix43& a_rot) {
+		if (_poseRange[a_slot] < 0.0001f) {
+			return 0.0f;
+		}
+
+		Quaternion q;
+		q.fromRot(a_rot);
+		return std::clamp(angleBetween(_open[a_slot], q) / _poseRange[a_slot], 0.0f, 1.0f);
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include "F4VRBody.h"
+#include "Quaternion.h"
+
+namespace F4VRBody {
+
+	// The math FingerTracking does on the SteamVR hand skeleton, without OpenVR.   A slot is one FRIK finger bone
+	// (hand * 15 + finger * 3 + joint).   The skeletal bone rotations come in as quaternions in parent space, indexed like
+	// OpenVR's 31 bone hand, and are turned into a curl per slot, 0 at SteamVR's open hand reference and 1 at its fist.
+	// The curl then picks a rotation between FRIK's own open and closed pose for that bone.
+	class FingerCurl {
+	public:
+		static const int kBonesPerHand = 15;
+		static const int kOpenVRBoneCount = 31;
+
+		FingerCurl();
+
+		// LArm_Finger11 ... RArm_Finger53 to its slot, -1 for anything else
+		static int getSlot(const char* a_boneName);
+
+		// the open hand and fist reference poses of one hand's controller
+		void setReference(int a_hand, const Quaternion* a_open, const Quaternion* a_fist);
+
+		bool hasReference(int a_hand) {
+			return _haveReference[a_hand];
+		}
+
+		// one frame of skeletal bone data, needs the reference first
+		void setBones(int a_hand, const Quaternion* a_bones);
+
+		// FRIK's open and closed pose for the bone in that slot
+		void setPose(int a_slot, const NiMatrix43& a_open, const NiMatrix43& a_closed);
+
+		float getCurl(int a_slot) {
+			return _curl[a_slot];
+		}
+
+		Quaternion getTarget(int a_slot);
+
+		// 0 = FRIK's open pose, 1 = its closed pose, for whatever rotation the bone in that slot ended up with
+		float getPoseCurl(int a_slot, const NiMatrix43& a_rot);
+
+	private:
+		bool _haveReference[2];
+
+		float _curl[2 * kBonesPerHand];
+		float _range[2 * kBonesPerHand];        // radians from the open hand to the fist, per joint
+		Quaternion _reference[2 * kBonesPerHand];   // SteamVR open hand
+		Quaternion _open[2 * kBonesPerHand];
+		Quaternion _closed[2 * kBonesPerHand];
+		float _poseRange[2 * kBonesPerHand];    // radians from FRIK's open pose to its closed one
+	};
+}
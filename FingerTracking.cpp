@@ -0,0 +1,136 @@
+#include "FingerTracking.h"
+#include "HandPose.h"
+
+namespace F4VRBody {
+
+	FingerTracking* g_fingerTracking = nullptr;
+
+	static const int kOpenVRBoneCount = FingerCurl::kOpenVRBoneCount;
+
+	static void toQuaternions(const vr::VRBoneTransform_t* a_bones, Quaternion* a_out) {
+		for (auto i = 0; i < kOpenVRBoneCount; i++) {
+			const vr::HmdQuaternionf_t& q = a_bones[i].orientation;
+			a_out[i] = Quaternion(q.x, q.y, q.z, q.w);
+		}
+	}
+
+	bool FingerTracking::init() {
+		_initDone = true;
+
+		vr::IVRInput* input = vr::VRInput();
+		if (!input) {
+			_MESSAGE("finger tracking: no IVRInput");
+			return false;
+		}
+
+		// has to be set before the first handle lookup, the path has to be absolute
+		if (!c_fingerTrackingActionManifest.empty()) {
+			char manifestPath[MAX_PATH];
+			std::string relative = ".\\Data\\F4SE\\plugins\\" + c_fingerTrackingActionManifest;
+			if (!GetFullPathNameA(relative.c_str(), MAX_PATH, manifestPath, nullptr)) {
+				_MESSAGE("finger tracking: bad action manifest path %s", relative.c_str());
+				return false;
+			}
+
+			vr::EVRInputError error = input->SetActionManifestPath(manifestPath);
+			if (error != vr::VRInputError_None) {
+				_MESSAGE("finger tracking: SteamVR did not take action manifest %s (error %d)", manifestPath, (int)error);
+				return false;
+			}
+			_MESSAGE("finger tracking: registered action manifest %s", manifestPath);
+		}
+
+		if (input->GetActionSetHandle(c_fingerTrackingActionSet.c_str(), &_actionSet) != vr::VRInputError_None ||
+			input->GetActionHandle(c_rightHandSkeletonAction.c_str(), &_actions[0]) != vr::VRInputError_None ||
+			input->GetActionHandle(c_leftHandSkeletonAction.c_str(), &_actions[1]) != vr::VRInputError_None) {
+			_MESSAGE("finger tracking: skeleton actions not found in the action manifest");
+			return false;
+		}
+
+		_MESSAGE("finger tracking: using %s and %s", c_rightHandSkeletonAction.c_str(), c_leftHandSkeletonAction.c_str());
+		return true;
+	}
+
+	void FingerTracking::update() {
+		_tracking[0] = false;
+		_tracking[1] = false;
+
+		if (!c_fingerTracking) {
+			return;
+		}
+
+		if (!_initDone) {
+			_available = init();
+		}
+		if (!_available) {
+			return;
+		}
+
+		vr::VRActiveActionSet_t active = {};
+		active.ulActionSet = _actionSet;
+		if (vr::VRInput()->UpdateActionState(&active, sizeof(vr::VRActiveActionSet_t), 1) != vr::VRInputError_None) {
+			return;
+		}
+
+		for (auto hand = 0; hand < 2; hand++) {
+			_tracking[hand] = readHand(hand);
+		}
+	}
+
+	// the open hand and fist poses don't change for a controller so they are only asked for once
+	bool FingerTracking::readReference(int a_hand) {
+		vr::VRBoneTransform_t open[kOpenVRBoneCount];
+		vr::VRBoneTransform_t fist[kOpenVRBoneCount];
+
+		vr::IVRInput* input = vr::VRInput();
+		if (input->GetSkeletalReferenceTransforms(_actions[a_hand], vr::VRSkeletalTransformSpace_Parent, vr::VRSkeletalReferencePose_OpenHand, open, kOpenVRBoneCount) != vr::VRInputError_None ||
+			input->GetSkeletalReferenceTransforms(_actions[a_hand], vr::VRSkeletalTransformSpace_Parent, vr::VRSkeletalReferencePose_Fist, fist, kOpenVRBoneCount) != vr::VRInputError_None) {
+			return false;
+		}
+
+		Quaternion openRot[kOpenVRBoneCount];
+		Quaternion fistRot[kOpenVRBoneCount];
+		toQuaternions(open, openRot);
+		toQuaternions(fist, fistRot);
+		_curl.setReference(a_hand, openRot, fistRot);
+		return true;
+	}
+
+	bool FingerTracking::readHand(int a_hand) {
+		vr::InputSkeletalActionData_t data;
+		if (vr::VRInput()->GetSkeletalActionData(_actions[a_hand], &data, sizeof(vr::InputSkeletalActionData_t)) != vr::VRInputError_None || !data.bActive) {
+			return false;
+		}
+
+		if (!_curl.hasReference(a_hand) && !readReference(a_hand)) {
+			return false;
+		}
+
+		vr::VRBoneTransform_t bones[kOpenVRBoneCount];
+		if (vr::VRInput()->GetSkeletalBoneData(_actions[a_hand], vr::VRSkeletalTransformSpace_Parent, vr::VRSkeletalMotionRange_WithoutController, bones, kOpenVRBoneCount) != vr::VRInputError_None) {
+			return false;
+		}
+
+		Quaternion rot[kOpenVRBoneCount];
+		toQuaternions(bones, rot);
+		_curl.setBones(a_hand, rot);
+
+		return true;
+	}
+
+	void FingerTracking::remap(BSFlattenedBoneTree* a_tree) {
+		_slots.assign(a_tree->numTransforms, -1);
+
+		for (auto pos = 0; pos < a_tree->numTransforms; pos++) {
+			const char* name = a_tree->transforms[pos].name.c_str();
+
+			int slot = FingerCurl::getSlot(name);
+			if (slot < 0) {
+				continue;
+			}
+
+			_slots[pos] = slot;
+			_curl.setPose(slot, handOpen[name].rot, handClosed[name].rot);
+		}
+	}
+}
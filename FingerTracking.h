@@ -0,0 +1,68 @@
+#pragma once
+#include "F4VRBody.h"
+#include "BSFlattenedBoneTree.h"
+#include "FingerCurl.h"
+
+#include "api/VRHookAPI.h"
+
+#include <vector>
+
+namespace F4VRBody {
+
+	// Finger poses from SteamVR skeletal input (Index controllers) instead of guessing them from button touches.
+	// Each FRIK finger bone has a slot (hand * 15 + finger * 3 + joint) and the flattened bone tree index -> slot table is
+	// built once per skeleton, so setHandPose doesn't need the string maps to find the finger bones.   Every frame the
+	// skeletal bone rotations are turned into a curl per joint (how far from SteamVR's open hand towards its fist) which
+	// picks the rotation between FRIK's own open and closed hand poses.   That keeps the result independent of the bone
+	// axes of the OpenVR hand, and controllers without skeletal input just keep the button based poses.   The curl math
+	// is FingerCurl's, this only reads SteamVR.
+	class FingerTracking {
+	public:
+		static const int kBonesPerHand = FingerCurl::kBonesPerHand;
+
+		// once a frame before setHandPose
+		void update();
+
+		bool isTracking(bool a_isLeft) {
+			return _tracking[a_isLeft ? 1 : 0];
+		}
+
+		// called from setNodes, open and closed poses are taken from the hand pose maps at that time
+		void remap(BSFlattenedBoneTree* a_tree);
+
+		// -1 if that bone isn't a finger
+		int getSlot(int a_treeIndex) {
+			return a_treeIndex < (int)_slots.size() ? _slots[a_treeIndex] : -1;
+		}
+
+		Quaternion getTarget(int a_slot) {
+			return _curl.getTarget(a_slot);
+		}
+
+		// 0 = FRIK's open pose, 1 = its closed pose, for whatever rotation the bone in that slot ended up with
+		float getPoseCurl(int a_slot, const NiMatrix43& a_rot) {
+			return _curl.getPoseCurl(a_slot, a_rot);
+		}
+
+	private:
+		bool init();
+		bool readHand(int a_hand);
+		bool readReference(int a_hand);
+
+		bool _initDone = false;
+		bool _available = false;
+		vr::VRActionSetHandle_t _actionSet = vr::k_ulInvalidActionSetHandle;
+		vr::VRActionHandle_t _actions[2] = { vr::k_ulInvalidActionHandle, vr::k_ulInvalidActionHandle };
+
+		bool _tracking[2] = { false, false };
+
+		FingerCurl _curl;
+		std::vector<int> _slots;
+	};
+
+	extern FingerTracking* g_fingerTracking;
+
+	inline void InitFingerTracking() {
+		g_fingerTracking = new FingerTracking();
+	}
+}
@@ -0,0 +1,76 @@
+#include "FrameGovernor.h"
+
+namespace F4VRBody {
+
+	FrameGovernor* g_frameGovernor = nullptr;
+
+	struct GovernorStep {
+		GovernedStage stage;
+		int interval;
+	};
+
+	// applied in order as the level goes up.  debug stuff goes first, finger poses last.   nothing is ever turned off,
+	// whatever the user asked to see still shows, just updated less often
+	static const GovernorStep governorSteps[] = {
+		{ kStage_DebugSpheres, 4 },
+		{ kStage_CullGeometry, 2 },
+		{ kStage_BoneSpheres, 2 },
+		{ kStage_FingerPose, 2 },
+		{ kStage_CullGeometry, 4 },
+		{ kStage_BoneSpheres, 4 },
+		{ kStage_FingerPose, 3 },
+	};
+
+	static const int maxGovernorLevel = sizeof(governorSteps) / sizeof(GovernorStep);
+
+	void FrameGovernor::beginFrame() {
+		QueryPerformanceCounter(&_start);
+		_frame++;
+	}
+
+	void FrameGovernor::endFrame() {
+		LARGE_INTEGER end;
+		QueryPerformanceCounter(&end);
+
+		double ms = (double)(end.QuadPart - _start.QuadPart) * 1000.0 / _freq.QuadPart;
+		_avgMs += (ms - _avgMs) * 0.05;
+
+		if (!c_enableFrameGovernor) {
+			if (_level > 0) {
+				setLevel(0);
+			}
+			return;
+		}
+
+		_framesAtLevel++;
+
+		if ((_avgMs > c_frameBudgetMs) && (_level < maxGovernorLevel) && (_framesAtLevel >= 30)) {
+			setLevel(_level + 1);
+		}
+		else if ((_avgMs < c_frameBudgetMs * 0.7) && (_level > 0) && (_framesAtLevel >= 90)) {
+			setLevel(_level - 1);
+		}
+	}
+
+	void FrameGovernor::setLevel(int a_level) {
+		_level = a_level;
+		_framesAtLevel = 0;
+
+		for (auto i = 0; i < kStage_Count; i++) {
+			_interval[i] = 1;
+		}
+
+		for (auto i = 0; i < _level; i++) {
+			_interval[governorSteps[i].stage] = governorSteps[i].interval;
+		}
+
+		_MESSAGE("frame governor level %d (avg %f ms budget %f ms)", _level, _avgMs, c_frameBudgetMs);
+	}
+
+	bool FrameGovernor::shouldRun(GovernedStage a_stage) {
+		int interval = _interval[a_stage];
+
+		// offset by stage so decimated stages don't all land on the same frame
+		return ((_frame + a_stage) % interval) == 0;
+	}
+}
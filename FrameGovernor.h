@@ -0,0 +1,64 @@
+#pragma once
+#include "F4VRBody.h"
+
+namespace F4VRBody {
+
+	// optional work in update() that can be run less often when FRIK runs over its frame budget.   modes the user turns
+	// on (selfie, arms only ...) are never governed
+	enum GovernedStage {
+		kStage_DebugSpheres = 0,
+		kStage_CullGeometry,
+		kStage_BoneSpheres,
+		kStage_FingerPose,
+		kStage_Count
+	};
+
+	// Keeps a moving average of how long update() takes.   When the average goes over c_frameBudgetMs the optional stages
+	// are degraded one step at a time (run every other frame or every few frames, never switched off) and when it drops well
+	// under the budget they are brought back one step at a time.   Each step has to hold for a while before the next
+	// change so the level doesn't bounce around.
+	class FrameGovernor {
+	public:
+		FrameGovernor() {
+			QueryPerformanceFrequency(&_freq);
+			_start.QuadPart = 0;
+			_avgMs = 0.0;
+			_level = 0;
+			_framesAtLevel = 0;
+			_frame = 0;
+			for (auto i = 0; i < kStage_Count; i++) {
+				_interval[i] = 1;
+			}
+		}
+
+		void beginFrame();
+		void endFrame();
+
+		bool shouldRun(GovernedStage a_stage);
+
+		double getAverageMs() {
+			return _avgMs;
+		}
+
+		int getLevel() {
+			return _level;
+		}
+
+	private:
+		void setLevel(int a_level);
+
+		LARGE_INTEGER _freq;
+		LARGE_INTEGER _start;
+		double _avgMs;
+		int _level;
+		int _framesAtLevel;
+		uint64_t _frame;
+		int _interval[kStage_Count];   // 1 = every frame
+	};
+
+	extern FrameGovernor* g_frameGovernor;
+
+	inline void InitFrameGovernor() {
+		g_frameGovernor = new FrameGovernor();
+	}
+}
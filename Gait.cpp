@@ -0,0 +1,223 @@
+#include "Gait.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace F4VRBody {
+
+	GaitTables g_gaitTables;
+
+	// same results as vec3_len / vec3_dot / vec3_norm in matrix.cpp
+	static float gaitLen(const GaitVec& a_v) {
+		return sqrt(a_v.x * a_v.x + a_v.y * a_v.y + a_v.z * a_v.z);
+	}
+
+	static float gaitDot(const GaitVec& a_v1, const GaitVec& a_v2) {
+		return a_v1.x * a_v2.x + a_v1.y * a_v2.y + a_v1.z * a_v2.z;
+	}
+
+	static GaitVec gaitNorm(GaitVec a_v) {
+		double mag = gaitLen(a_v);
+
+		if (mag < 0.000001) {
+			float maxX = fabs(a_v.x);
+			float maxY = fabs(a_v.y);
+			float maxZ = fabs(a_v.z);
+
+			if (maxX >= maxY && maxX >= maxZ) {
+				return a_v.x >= 0 ? GaitVec(1, 0, 0) : GaitVec(-1, 0, 0);
+			}
+			else if (maxY > maxZ) {
+				return a_v.y >= 0 ? GaitVec(0, 1, 0) : GaitVec(0, -1, 0);
+			}
+			return a_v.z >= 0 ? GaitVec(0, 0, 1) : GaitVec(0, 0, -1);
+		}
+
+		a_v.x /= mag;
+		a_v.y /= mag;
+		a_v.z /= mag;
+		return a_v;
+	}
+
+	GaitTables::GaitTables() {
+		// clamp(cos(speed / 140), 0.28, 0.5) every 25 cm/s
+		stepTime = { 0.50f, 0.50f, 0.50f, 0.50f, 0.50f, 0.50f, 0.479f, 0.315f, 0.28f, 0.28f, 0.28f, 0.28f, 0.28f, 0.28f, 0.28f };
+		// sin(pi * t)
+		swing = { 0.0f, 0.195f, 0.383f, 0.556f, 0.707f, 0.831f, 0.924f, 0.981f, 1.0f, 0.981f, 0.924f, 0.831f, 0.707f, 0.556f, 0.383f, 0.195f, 0.0f };
+	}
+
+	float sampleTable(const std::vector<float>& a_table, float a_x) {
+		if (a_table.empty()) {
+			return 0.0f;
+		}
+		if (a_table.size() == 1) {
+			return a_table[0];
+		}
+
+		float pos = std::clamp(a_x, 0.0f, 1.0f) * (a_table.size() - 1);
+		uint32_t i = (std::min)((uint32_t)pos, (uint32_t)a_table.size() - 2);
+		float frac = pos - i;
+
+		return a_table[i] + (a_table[i + 1] - a_table[i]) * frac;
+	}
+
+	void GaitEngine::reset(uint32_t a_seed) {
+		_state = kGait_Standing;
+		_stepping = kFoot_None;
+		_rng = a_seed ? a_seed : 1;
+		_prevSpeed = 0.0;
+		_stepTime = 0.0;
+		_timeInStep = 0.0;
+		_turnDelay = 0;
+		_stepDir = GaitVec(0, 0, 0);
+	}
+
+	// xorshift32
+	uint32_t GaitEngine::nextRandom() {
+		_rng ^= _rng << 13;
+		_rng ^= _rng >> 17;
+		_rng ^= _rng << 5;
+		return _rng;
+	}
+
+	void GaitEngine::update(const GaitTables& a_tables, const GaitInput& a_in, GaitOutput& a_out) {
+		GaitVec dir = a_in.moved;
+		dir.z = 0;
+
+		double curSpeed = 0.0;
+		if (a_in.frameTime > 0.0) {
+			curSpeed = std::clamp(gaitLen(dir) / a_in.frameTime, 0.0, (double)a_tables.maxSpeed);
+		}
+		if (_prevSpeed > a_tables.stopSpeed) {
+			curSpeed = (curSpeed + _prevSpeed) / 2;
+		}
+		_prevSpeed = curSpeed;
+
+		double stepTime = sampleTable(a_tables.stepTime, (float)(curSpeed / a_tables.maxSpeed));
+		double stride = curSpeed * stepTime * a_tables.strideScale;
+		dir = gaitNorm(dir);
+
+		a_out.walking = false;
+		a_out.spineAngle = 0.0f;
+
+		// setup current walking state based on velocity and previous state
+		if (a_in.jumping) {
+			_state = kGait_Standing;
+		}
+		else if (_state == kGait_Standing) {
+			if (curSpeed >= a_tables.startSpeed) {
+				_state = kGait_Walking;
+				_stepping = (nextRandom() & 1) ? kFoot_Left : kFoot_Right;   // pick a random foot to take a step
+				_stepDir = dir;
+				_stepTime = stepTime;
+				_timeInStep = stepTime / 2;
+				_turnDelay = a_tables.turnDelayFrames;
+
+				_leftStart = a_in.leftFoot;
+				_rightStart = a_in.rightFoot;
+				_leftTarget = a_in.leftFoot;
+				_rightTarget = a_in.rightFoot;
+				_leftPos = _leftStart;
+				_rightPos = _rightStart;
+
+				if (_stepping == kFoot_Right) {
+					_rightTarget += _stepDir * stride;
+				}
+				else {
+					_leftTarget += _stepDir * stride;
+				}
+			}
+			else {
+				_timeInStep = 0.0;
+				_stepping = kFoot_None;
+			}
+		}
+		else if (_state == kGait_Walking) {
+			if (curSpeed < a_tables.stopSpeed) {
+				_state = kGait_Stopping;         // begin process to stop walking
+				_timeInStep = 0.0;
+			}
+		}
+		else if (_state == kGait_Stopping) {
+			if (curSpeed >= a_tables.stopSpeed) {
+				_state = kGait_Walking;          // resume walking
+				_timeInStep = 0.0;
+			}
+		}
+
+		if (_state == kGait_Standing) {
+			// we're standing still so just set foot positions accordingly.
+			a_out.leftFoot = a_in.leftFoot;
+			a_out.rightFoot = a_in.rightFoot;
+			a_out.leftFoot.z = a_in.groundZ;
+			a_out.rightFoot.z = a_in.groundZ;
+			return;
+		}
+
+		if (_state == kGait_Stopping) {
+			a_out.leftFoot = a_in.leftFoot;
+			a_out.rightFoot = a_in.rightFoot;
+			_state = kGait_Standing;
+			return;
+		}
+
+		float dot = gaitDot(dir, _stepDir);
+		double scale = (std::min)(stride, (double)a_tables.maxStride);
+		GaitVec dirOffset = (dir - _stepDir) * scale;
+
+		_timeInStep += a_in.frameTime;
+		float interp = _stepTime > 0.0 ? (float)std::clamp(_timeInStep / _stepTime, 0.0, 1.0) : 1.0f;
+		float lift = sampleTable(a_tables.swing, interp);
+
+		bool right = _stepping == kFoot_Right;
+		GaitVec& start = right ? _rightStart : _leftStart;
+		GaitVec& target = right ? _rightTarget : _leftTarget;
+		GaitVec& pos = right ? _rightPos : _leftPos;
+
+		// heading changed, move the swinging foot over after a couple frames
+		if (dot < a_tables.turnDot) {
+			if (!_turnDelay) {
+				target += dirOffset;
+				_stepDir = dir;
+				_turnDelay = a_tables.turnDelayFrames;
+			}
+			else {
+				_turnDelay--;
+			}
+		}
+		else if (_turnDelay < a_tables.turnDelayFrames) {
+			_turnDelay++;
+		}
+
+		target.z = a_in.groundZ;
+		start.z = a_in.groundZ;
+		pos = start + ((target - start) * interp);
+
+		float stepAmount = std::clamp(gaitLen(target - start) / a_tables.stepHeightDistance, 0.0f, 1.0f);
+		float stepHeight = (std::max)(stepAmount * a_tables.maxStepHeight, a_tables.minStepHeight);
+		pos.z += lift * stepHeight;
+
+		a_out.walking = true;
+		a_out.spineAngle = (right ? -1.0f : 1.0f) * lift * a_tables.spineSway;
+		a_out.leftFoot = _leftPos;
+		a_out.rightFoot = _rightPos;
+
+		// step done, plant it and swing the other foot
+		if (_timeInStep > stepTime) {
+			_timeInStep = 0.0;
+			_stepDir = dir;
+			_stepTime = stepTime;
+
+			if (right) {
+				_stepping = kFoot_Left;
+				_leftTarget = a_in.leftFoot + _stepDir * scale;
+				_leftStart = _leftPos;
+			}
+			else {
+				_stepping = kFoot_Right;
+				_rightTarget = a_in.rightFoot + _stepDir * scale;
+				_rightStart = _rightPos;
+			}
+		}
+	}
+}
@@ -0,0 +1,110 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace F4VRBody {
+
+	// The gait only needs a plain vector so it builds and replays without f4se.   Skeleton converts at the call.
+	struct GaitVec {
+		float x = 0.0f;
+		float y = 0.0f;
+		float z = 0.0f;
+
+		GaitVec() {}
+		GaitVec(float a_x, float a_y, float a_z) : x(a_x), y(a_y), z(a_z) {}
+
+		GaitVec operator+(const GaitVec& a_v) const { return GaitVec(x + a_v.x, y + a_v.y, z + a_v.z); }
+		GaitVec operator-(const GaitVec& a_v) const { return GaitVec(x - a_v.x, y - a_v.y, z - a_v.z); }
+		GaitVec operator*(float a_s) const { return GaitVec(x * a_s, y * a_s, z * a_s); }
+		GaitVec& operator+=(const GaitVec& a_v) { x += a_v.x; y += a_v.y; z += a_v.z; return *this; }
+	};
+
+	// Everything that shapes a step.   The curves are sampled by lookup, the defaults match the old walk() math.
+	struct GaitTables {
+		std::vector<float> stepTime;   // seconds per step, evenly spaced from 0 to maxSpeed
+		std::vector<float> swing;      // foot lift over one step, evenly spaced from 0 to 1
+		float maxSpeed = 350.0f;       // cm/s
+		float startSpeed = 35.0f;      // start walking above this
+		float stopSpeed = 20.0f;       // stop walking below this
+		float strideScale = 1.5f;      // stride = speed * step time * strideScale
+		float maxStride = 140.0f;
+		float stepHeightDistance = 150.0f;   // a step this long gets the full height
+		float maxStepHeight = 9.0f;
+		float minStepHeight = 1.0f;
+		float spineSway = 3.0f;        // degrees
+		float turnDot = 0.9f;          // retarget the swinging foot when the heading changes more than this
+		int turnDelayFrames = 2;
+		uint32_t seed = 1;
+
+		GaitTables();
+	};
+
+	extern GaitTables g_gaitTables;
+
+	// one frame of input.   positions are world space, feet are where the animation put them
+	struct GaitInput {
+		GaitVec moved;         // how far the body moved this frame, only x and y are used
+		double frameTime;
+		bool jumping;
+		float groundZ;
+		GaitVec leftFoot;
+		GaitVec rightFoot;
+	};
+
+	struct GaitOutput {
+		bool walking;          // spineAngle only applies while walking
+		GaitVec leftFoot;
+		GaitVec rightFoot;
+		float spineAngle;
+	};
+
+	// The foot placement state machine that used to live in Skeleton::walk().   All of its state is in here, the first
+	// foot comes from a seeded generator and the step curves come from GaitTables, so the same input stream always gives
+	// the same foot targets.   It never touches the scene graph.
+	class GaitEngine {
+	public:
+		enum State {
+			kGait_Standing = 0,
+			kGait_Walking,
+			kGait_Stopping
+		};
+
+		enum Foot {
+			kFoot_None = 0,
+			kFoot_Right,
+			kFoot_Left
+		};
+
+		GaitEngine() {
+			reset(g_gaitTables.seed);
+		}
+
+		void reset(uint32_t a_seed);
+		void update(const GaitTables& a_tables, const GaitInput& a_in, GaitOutput& a_out);
+
+		State getState() {
+			return _state;
+		}
+
+	private:
+		uint32_t nextRandom();
+
+		State _state;
+		Foot _stepping;
+		uint32_t _rng;
+		double _prevSpeed;
+		double _stepTime;         // length of the step in progress
+		double _timeInStep;
+		int _turnDelay;
+		GaitVec _stepDir;
+		GaitVec _leftPos;
+		GaitVec _rightPos;
+		GaitVec _leftStart;
+		GaitVec _rightStart;
+		GaitVec _leftTarget;
+		GaitVec _rightTarget;
+	};
+
+	// linear lookup into an evenly spaced table, a_x is 0 - 1
+	float sampleTable(const std::vector<float>& a_table, float a_x);
+}
@@ -3,6 +3,7 @@
 #include "VR.h"
 #include "Offsets.h"
 #include "MiscStructs.h"
+#include "SkeletonSnapshot.h"
 
 namespace F4VRBody {
 	GunReload* g_gunReloadSystem = nullptr;
@@ -10,50 +11,58 @@ namespace F4VRBody {
 	float g_animDeltaTime = -1.0f;
 
 
-	void printNodes(NiNode* nde, long long curTime) {
-		_MESSAGE("%d %s : children = %d %d: local %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f", curTime, nde->m_name.c_str(), nde->m_children.m_emptyRunStart, (nde->flags & 0x1),
-			nde->m_localTransform.rot.arr[0],
-			nde->m_localTransform.rot.arr[1],
-			nde->m_localTransform.rot.arr[2],
-			nde->m_localTransform.rot.arr[3],
-			nde->m_localTransform.rot.arr[4],
-			nde->m_localTransform.rot.arr[5],
-			nde->m_localTransform.rot.arr[6],
-			nde->m_localTransform.rot.arr[7],
-			nde->m_localTransform.rot.arr[8],
-			nde->m_localTransform.rot.arr[9],
-			nde->m_localTransform.rot.arr[10],
-			nde->m_localTransform.rot.arr[11],
-			nde->m_localTransform.pos.x, nde->m_localTransform.pos.y, nde->m_localTransform.pos.z);
-
-
-		if (nde->GetAsNiNode()) {
-			for (auto i = 0; i < nde->m_children.m_emptyRunStart; ++i) {
-				auto nextNode = nde->m_children.m_data[i] ? nde->m_children.m_data[i]->GetAsNiNode() : nullptr;
-				if (nextNode) {
-					printNodes((NiNode*)nextNode, curTime);
-				}
-			}
+	// MagazinePool's engine calls
+	static TESObjectCELL* magazineCell() {
+		return (*g_player)->parentCell;
+	}
+
+	static void createMagazine(TESBoundObject* a_object, NiPoint3 a_location, NiPoint3 a_direction, UInt64* a_handle) {
+		// one request struct for every reference rather than a new one each time, made on first use since its vtable comes
+		// from a relocated address
+		static NEW_REFR_DATA magazineRequest;
+
+		magazineRequest.location = a_location;
+		magazineRequest.direction = a_direction;
+		magazineRequest.object = a_object;
+		magazineRequest.interior = (*g_player)->parentCell;
+		magazineRequest.world = Offsets::TESObjectREFR_GetWorldSpace(*g_player);
+
+		Offsets::TESDataHandler_CreateReferenceAtLocation(*g_dataHandler, a_handle, &magazineRequest);
+	}
+
+	static TESObjectREFR* resolveMagazine(UInt64* a_handle) {
+		std::uintptr_t refr = 0x0;
+		Offsets::BSPointerHandleManagerInterface_GetSmartPointer(a_handle, &refr);
+		return (TESObjectREFR*)refr;
+	}
+
+	static void moveMagazine(TESObjectREFR* a_refr, NiPoint3 a_location, NiPoint3 a_direction) {
+		// through the engine so the reference's cell, havok body and 3D all end up at the new spot together
+		UInt32 nullHandle = *g_invalidRefHandle;
+		MoveRefrToPosition(a_refr, &nullHandle, (*g_player)->parentCell, Offsets::TESObjectREFR_GetWorldSpace(*g_player), &a_location, &a_direction);
+	}
+
+	static void retireMagazine(TESObjectREFR* a_refr) {
+		// nothing here deletes a reference, hide it and leave it for the cell to clean up
+		NiNode* root = a_refr->unkF0 ? a_refr->unkF0->rootNode : nullptr;
+		if (root) {
+			root->flags |= 0x1;
 		}
 	}
 
+	MagazineCalls getGameMagazineCalls() {
+		return { magazineCell, createMagazine, resolveMagazine, moveMagazine, retireMagazine };
+	}
+
 	void GunReload::DoAnimationCapture() {
 		if (!startAnimCap) {
-			g_animDeltaTime = -1.0f;
 			return;
 		}
 
-		auto elapsed = since(startCapTime).count();
-		if (elapsed > 300) {
-			if (elapsed > 2000) {
-				g_animDeltaTime = -1.0f;
-				Offsets::TESObjectREFR_UpdateAnimation(*g_player, 0.08f);
-			}
-			g_animDeltaTime = 0.0f;
+		// once per reload, not every frame of it
+		if (c_snapshotReloads && !snapshotTaken && since(startCapTime).count() > 300) {
+			snapshotTaken = g_skeletonSnapshots->capture(getChildNode("Weapon", (*g_player)->firstPersonSkeleton), "reload") > 0;
 		}
-
-		NiNode* weap = getChildNode("Weapon", (*g_player)->firstPersonSkeleton);
-	//	printNodes(weap, elapsed);
 	}
 
 	bool GunReload::StartReloading() {
@@ -74,32 +83,18 @@ namespace F4VRBody {
 
 		if ((!reloadButtonPressed) && (handInput & vr::ButtonMaskFromId(vr::EVRButtonId::k_EButton_Grip))) {
 
-			if (currentRefr) {
-
-			}
-
 			reloadButtonPressed = true;
-			NEW_REFR_DATA* refrData = new NEW_REFR_DATA();
-			refrData->location = weapNode->m_worldTransform.pos;
-			refrData->direction = (*g_player)->rot;
-			refrData->interior = (*g_player)->parentCell;
-			refrData->world = Offsets::TESObjectREFR_GetWorldSpace(*g_player);
 
-			BGSObjectInstance* instance = new BGSObjectInstance(nullptr, nullptr);
+			BGSObjectInstance instance(nullptr, nullptr);
 			BGSEquipIndex idx;
-			Offsets::Actor_GetWeaponEquipIndex(*g_player, &idx, instance);
+			Offsets::Actor_GetWeaponEquipIndex(*g_player, &idx, &instance);
 			currentAmmo = Offsets::Actor_GetCurrentAmmo(*g_player, idx);
 
-			refrData->object = currentAmmo;
-			void* ammoDrop = new std::size_t;
-
-			void* newHandle = Offsets::TESDataHandler_CreateReferenceAtLocation(*g_dataHandler, ammoDrop, refrData);
-
-			std::uintptr_t newRefr = 0x0;
-			Offsets::BSPointerHandleManagerInterface_GetSmartPointer(newHandle, &newRefr);
+			currentRefr = magazines.acquire(currentAmmo, weapNode->m_worldTransform.pos, (*g_player)->rot);
+			if (!currentRefr) {
+				return false;
+			}
 
-			currentRefr = (TESObjectREFR*)newRefr;
-			
 			weapNode->flags |= 0x1;
 			return true;
 		}
@@ -111,6 +106,11 @@ namespace F4VRBody {
 	}
 
 	bool GunReload::SetAmmoMesh() {
+		// a recycled magazine still has its mesh from last time
+		if (magazines.getMesh()) {
+			return true;
+		}
+
 		if (currentRefr->unkF0 && currentRefr->unkF0->rootNode) {
 			for (auto i = 0; i < currentRefr->unkF0->rootNode->m_children.m_emptyRunStart; ++i) {
 			//	currentRefr->unkF0->rootNode->RemoveChildAt(i);
@@ -134,6 +134,7 @@ namespace F4VRBody {
 			//Offsets::TESObjectREFR_AttachAllChildRef3D(currentRefr);
 			//Offsets::TESObjectCell_AttachReference3D((*g_player)->parentCell, currentRefr, false, false);
 			currentRefr->unkF0->rootNode->AttachChild(newMesh, true);
+			magazines.setMesh(newMesh);
 			//Offsets::bhkWorld_RemoveObject(currentRefr->unkF0->rootNode, true, false);
 			//Offsets::bhkUtilFunctions_MoveFirstCollisionObjectToRoot(currentRefr->unkF0->rootNode, newMesh);
 			//Offsets::bhkWorld_SetMotion(currentRefr->unkF0->rootNode, hknpMotionPropertiesId::Preset::DYNAMIC, true, true, true);
@@ -147,6 +148,7 @@ namespace F4VRBody {
 	}
 
 	void GunReload::Update() {
+		DoAnimationCapture();
 
 		switch (state) {
 		case idle: 
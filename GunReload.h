@@ -2,6 +2,7 @@
 
 #include <chrono>
 #include "utils.h"
+#include "MagazinePool.h"
 
 namespace F4VRBody {
 
@@ -16,7 +17,7 @@ namespace F4VRBody {
 
 	class GunReload {
 	public:
-		GunReload() {
+		GunReload() : magazines(getGameMagazineCalls()) {
 			startAnimCap = false;
 			state = idle;
 			reloadButtonPressed = false;
@@ -25,6 +26,7 @@ namespace F4VRBody {
 		inline void startAnimationCapture() {
 			startAnimCap = !startAnimCap;     // hook gets called twice once at the start of reload and once after animation is done
 			startCapTime = std::chrono::high_resolution_clock::now();
+			snapshotTaken = false;
 		}
 
 		void DoAnimationCapture();
@@ -41,9 +43,11 @@ namespace F4VRBody {
 		bool startAnimCap;
 		ReloadState state;
 		bool reloadButtonPressed;
+		bool snapshotTaken{ false };
 		TESAmmo* currentAmmo{ nullptr };
 		NiNode* magMesh{ nullptr };
 		TESObjectREFR* currentRefr{ nullptr };
+		MagazinePool magazines;
 	};
 
 	extern GunReload* g_gunReloadSystem;
@@ -0,0 +1,53 @@
+#include "HandVelocity.h"
+
+namespace F4VRBody {
+
+	void HandVelocity::reset() {
+		_hasLast = false;
+		_head = 0;
+		_count = 0;
+		_sumTime = 0.0;
+		_sumDistance = 0.0;
+	}
+
+	void HandVelocity::addSample(double a_time, NiPoint3 a_hand, NiPoint3 a_body) {
+		if (!_hasLast || a_time <= _lastTime) {
+			_hasLast = true;
+			_lastTime = a_time;
+			_lastHand = a_hand;
+			_lastBody = a_body;
+			return;
+		}
+
+		// hand movement that the body didn't do
+		NiPoint3 moved = (a_hand - _lastHand) - (a_body - _lastBody);
+
+		Segment seg;
+		seg.time = a_time - _lastTime;
+		seg.distance = vec3_len(moved);
+
+		_lastTime = a_time;
+		_lastHand = a_hand;
+		_lastBody = a_body;
+
+		if (_count == kCapacity) {
+			_sumTime -= _ring[_head].time;
+			_sumDistance -= _ring[_head].distance;
+			_head = (_head + 1) % kCapacity;
+			_count--;
+		}
+
+		_ring[(_head + _count) % kCapacity] = seg;
+		_count++;
+		_sumTime += seg.time;
+		_sumDistance += seg.distance;
+
+		// keep the newest segments that still cover the window
+		while (_count > 1 && (_sumTime - _ring[_head].time) >= _window) {
+			_sumTime -= _ring[_head].time;
+			_sumDistance -= _ring[_head].distance;
+			_head = (_head + 1) % kCapacity;
+			_count--;
+		}
+	}
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include "f4se/NiNodes.h"
+
+#include "utils.h"
+
+namespace F4VRBody {
+
+	// How fast a hand is moving relative to the body, for letting go of the two handed grip.   Every sample carries its own
+	// timestamp so the speed comes out in game units per second whatever the frame rate.   The camera movement between
+	// samples is taken out of the hand movement before anything is averaged, and the average is over a time window rather
+	// than a frame count.
+	class HandVelocity {
+	public:
+		static const int kCapacity = 32;
+
+		HandVelocity(double a_window = 0.035) : _window(a_window) {
+			reset();
+		}
+
+		// forget everything, the next sample starts a new window
+		void reset();
+
+		void addSample(double a_time, NiPoint3 a_hand, NiPoint3 a_body);
+
+		// average speed over the window, 0 until there are two samples
+		float getSpeed() {
+			return _sumTime > 0.0 ? (float)(_sumDistance / _sumTime) : 0.0f;
+		}
+
+	private:
+		struct Segment {
+			double time;
+			double distance;
+		};
+
+		double _window;
+		bool _hasLast;
+		double _lastTime;
+		NiPoint3 _lastHand;
+		NiPoint3 _lastBody;
+
+		Segment _ring[kCapacity];
+		int _head;                // oldest segment
+		int _count;
+		double _sumTime;
+		double _sumDistance;
+	};
+}
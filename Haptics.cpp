@@ -0,0 +1,121 @@
+#include "Haptics.h"
+#include "api/PapyrusVRAPI.h"
+
+#include <cstdio>
+
+extern OpenVRHookManagerAPI* vrhook;
+
+namespace F4VRBody {
+
+	HapticScheduler* g_haptics = nullptr;
+
+	// name, duration, intensity, priority
+	static const HapticPattern defaultPatterns[] = {
+		{ "tick",       0.05f, 0.3f, 1 },   // finger touching the pipboy
+		{ "scopeZoom",  0.1f,  0.3f, 2 },   // scope zoom step
+		{ "confirm",    0.1f,  0.3f, 2 },   // reticle reset, entering reposition mode
+		{ "reposition", 0.1f,  0.3f, 3 },   // reposition mode switch, scaled by the mode
+	};
+
+	HapticScheduler::HapticScheduler() {
+		for (auto& pattern : defaultPatterns) {
+			_patterns.push_back(pattern);
+		}
+	}
+
+	void HapticScheduler::loadPatterns(CSimpleIniA& a_ini) {
+		CSimpleIniA::TNamesDepend keys;
+		a_ini.GetAllKeys("Haptics", keys);
+
+		for (auto& key : keys) {
+			HapticPattern pattern;
+			pattern.name = key.pItem;
+
+			const char* value = a_ini.GetValue("Haptics", key.pItem, "");
+			if (sscanf_s(value, "%f , %f , %d", &pattern.duration, &pattern.intensity, &pattern.priority) != 3) {
+				_MESSAGE("haptics: cannot read pattern %s = %s", key.pItem, value);
+				continue;
+			}
+
+			HapticPattern* existing = find(key.pItem);
+			if (existing) {
+				*existing = pattern;
+			}
+			else {
+				_patterns.push_back(pattern);
+			}
+		}
+
+		_MESSAGE("haptics: %d patterns", (int)_patterns.size());
+	}
+
+	HapticPattern* HapticScheduler::find(const char* a_name) {
+		for (auto& pattern : _patterns) {
+			if (!_stricmp(pattern.name.c_str(), a_name)) {
+				return &pattern;
+			}
+		}
+		return nullptr;
+	}
+
+	void HapticScheduler::play(const char* a_pattern, HapticController a_controller, float a_scale) {
+		const HapticPattern* pattern = find(a_pattern);
+
+		if (!pattern) {
+			_MESSAGE("haptics: unknown pattern %s", a_pattern);
+			return;
+		}
+
+		// both is just a request on each hand, so each one still goes through that hand's priority check
+		if (a_controller == kHaptic_Both) {
+			request(pattern, kHaptic_Left, a_scale);
+			request(pattern, kHaptic_Right, a_scale);
+		}
+		else {
+			request(pattern, a_controller, a_scale);
+		}
+	}
+
+	void HapticScheduler::request(const HapticPattern* a_pattern, HapticController a_controller, float a_scale) {
+		Request& req = _requests[a_controller];
+
+		if (req.pending) {
+			_merged++;
+			if (a_pattern->priority < req.priority) {
+				return;
+			}
+		}
+
+		req.pending = true;
+		req.duration = a_pattern->duration * a_scale;
+		req.intensity = a_pattern->intensity;
+		req.priority = a_pattern->priority;
+	}
+
+	void HapticScheduler::submit() {
+		ULONGLONG now = GetTickCount64();
+
+		for (auto i = 0; i < kHaptic_Hands; i++) {
+			Request& req = _requests[i];
+
+			if (!req.pending) {
+				continue;
+			}
+			req.pending = false;
+
+			// don't stomp on a stronger pulse that is still going
+			if (now < _active[i].endTime && req.priority < _active[i].priority) {
+				_merged++;
+				continue;
+			}
+
+			_active[i].endTime = now + (ULONGLONG)(req.duration * 1000.0f);
+			_active[i].priority = req.priority;
+			_submitted++;
+
+			if (vrhook) {
+				vrhook->StartHaptics(i, req.duration, req.intensity);
+			}
+		}
+	}
+}
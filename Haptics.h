@@ -0,0 +1,88 @@
+#pragma once
+#include "F4VRBody.h"
+
+#include <string>
+#include <vector>
+
+namespace F4VRBody {
+
+	// controller ids as FO4VRTools takes them
+	enum HapticController {
+		kHaptic_Left = 0,
+		kHaptic_Right,
+		kHaptic_Both,
+
+		kHaptic_Hands = kHaptic_Both   // only the two real controllers get a request slot
+	};
+
+	struct HapticPattern {
+		std::string name;
+		float duration;
+		float intensity;
+		int priority;
+	};
+
+	// Everything that wants to buzz a controller asks for a named pattern here instead of calling StartHaptics directly.
+	// Requests made during a frame are merged per controller, the highest priority one wins, and submit() sends at most one
+	// pulse per controller per frame.   A pulse that is still playing can only be cut off by something of the same or
+	// higher priority.   Patterns come from the [Haptics] section of FRIK.ini as "duration, intensity, priority" and fall
+	// back to the built in ones.
+	class HapticScheduler {
+	public:
+		HapticScheduler();
+
+		void loadPatterns(CSimpleIniA& a_ini);
+
+		// a_scale stretches the duration, reposition mode uses it to tell the modes apart
+		void play(const char* a_pattern, HapticController a_controller, float a_scale = 1.0f);
+
+		// end of frame, sends what won
+		void submit();
+
+		UInt32 getSubmitted() {
+			return _submitted;
+		}
+
+		UInt32 getMerged() {
+			return _merged;
+		}
+
+	private:
+		struct Request {
+			bool pending = false;
+			float duration = 0.0f;
+			float intensity = 0.0f;
+			int priority = 0;
+		};
+
+		struct Active {
+			ULONGLONG endTime = 0;
+			int priority = 0;
+		};
+
+		HapticPattern* find(const char* a_name);
+		void request(const HapticPattern* a_pattern, HapticController a_controller, float a_scale);
+
+		std::vector<HapticPattern> _patterns;
+		Request _requests[kHaptic_Hands];
+		Active _active[kHaptic_Hands];
+		UInt32 _submitted = 0;
+		UInt32 _merged = 0;
+	};
+
+	extern HapticScheduler* g_haptics;
+
+	// the offhand controller, same one the old calls used
+	inline HapticController offHandController() {
+		return c_leftHandedMode ? kHaptic_Left : kHaptic_Right;
+	}
+
+	inline void InitHaptics() {
+		g_haptics = new HapticScheduler();
+
+		CSimpleIniA ini;
+		if (ini.LoadFile(".\\Data\\F4SE\\plugins\\FRIK.ini") >= 0) {
+			g_haptics->loadPatterns(ini);
+		}
+	}
+}
@@ -0,0 +1,110 @@
+#include "HeightField.h"
+#include "Offsets.h"
+
+#include <string.h>
+
+namespace F4VRBody {
+
+	HeightField* g_heightField = nullptr;
+
+	// exterior cells are 4096 units square, counted from the world origin.   GetLandHeight only knows the land of the
+	// cell it's given, so every grid point is checked against the cell it falls in.   There is no cell for the ones over
+	// the border (only the player's is at hand), those count as no land and the feet keep the animation's height there.
+	static const float kCellSize = 4096.0f;
+
+	static int landCellX = 0;
+	static int landCellY = 0;
+
+	static bool sampleLandHeight(void* a_context, float a_x, float a_y, float* a_height) {
+		*a_height = 0.0f;
+
+		if ((int)floorf(a_x / kCellSize) != landCellX || (int)floorf(a_y / kCellSize) != landCellY) {
+			return false;
+		}
+
+		NiPoint3 pos(a_x, a_y, 0);
+		return Offsets::TESObjectCell_GetLandHeight((TESObjectCELL*)a_context, &pos, a_height) != 0;
+	}
+
+	void InitHeightField() {
+		g_heightField = new HeightField(sampleLandHeight);
+	}
+
+	void setLandRegion(TESObjectCELL* a_cell, NiPoint3 a_position) {
+		if (a_cell) {
+			landCellX = (int)floorf(a_position.x / kCellSize);
+			landCellY = (int)floorf(a_position.y / kCellSize);
+		}
+
+		g_heightField->setRegion(a_cell, a_position);
+	}
+
+	void HeightField::clear() {
+		memset(_state, 0, sizeof(_state));
+	}
+
+	void HeightField::recenter(NiPoint3 a_center) {
+		float half = _spacing * kSize / 2;
+
+		_originX = floorf((a_center.x - half) / _spacing) * _spacing;
+		_originY = floorf((a_center.y - half) / _spacing) * _spacing;
+		clear();
+	}
+
+	void HeightField::setRegion(void* a_context, NiPoint3 a_center) {
+		if (a_context != _context) {
+			_context = a_context;
+			recenter(a_center);
+			return;
+		}
+
+		// keep a quarter of the grid as margin on every side so both feet stay inside
+		float half = _spacing * kSize / 2;
+		float dx = a_center.x - (_originX + half);
+		float dy = a_center.y - (_originY + half);
+
+		if (fabsf(dx) > half / 2 || fabsf(dy) > half / 2) {
+			recenter(a_center);
+		}
+	}
+
+	bool HeightField::getSample(int a_x, int a_y, float* a_height) {
+		signed char& state = _state[a_x][a_y];
+
+		if (!state) {
+			_queries++;
+			state = _sampler(_context, _originX + a_x * _spacing, _originY + a_y * _spacing, &_heights[a_x][a_y]) ? 1 : -1;
+		}
+
+		*a_height = _heights[a_x][a_y];
+		return state > 0;
+	}
+
+	bool HeightField::getHeight(float a_x, float a_y, float* a_height) {
+		if (!_context) {
+			return false;
+		}
+
+		float gx = (a_x - _originX) / _spacing;
+		float gy = (a_y - _originY) / _spacing;
+		int x = (int)floorf(gx);
+		int y = (int)floorf(gy);
+
+		if (x < 0 || y < 0 || x >= kSize - 1 || y >= kSize - 1) {
+			return false;
+		}
+
+		float h00, h10, h01, h11;
+		if (!getSample(x, y, &h00) || !getSample(x + 1, y, &h10) || !getSample(x, y + 1, &h01) || !getSample(x + 1, y + 1, &h11)) {
+			return false;
+		}
+
+		float fx = gx - x;
+		float fy = gy - y;
+		float bottom = h00 + (h10 - h00) * fx;
+		float top = h01 + (h11 - h01) * fx;
+
+		*a_height = bottom + (top - bottom) * fy;
+		return true;
+	}
+}
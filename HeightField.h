@@ -0,0 +1,61 @@
+#pragma once
+#include "f4se/NiNodes.h"
+
+#include <cmath>
+
+class TESObjectCELL;
+
+namespace F4VRBody {
+
+	// Small grid of land heights around the player.   Each grid point is asked for through the sampler the first time a
+	// lookup needs it and kept until the player changes cell or walks far enough from the middle of the grid that it has
+	// to be moved.   Lookups in between are bilinear so the feet can follow slopes without an engine call per foot per frame.
+	class HeightField {
+	public:
+		// returns false if there is no land at that point
+		typedef bool (*Sampler)(void* a_context, float a_x, float a_y, float* a_height);
+
+		static const int kSize = 16;
+
+		HeightField(Sampler a_sampler, float a_spacing = 24.0f) : _sampler(a_sampler), _spacing(a_spacing) {
+			_context = nullptr;
+			_originX = 0.0f;
+			_originY = 0.0f;
+			_queries = 0;
+			clear();
+		}
+
+		// once a frame.   a_context goes to the sampler, nullptr turns lookups off (interiors)
+		void setRegion(void* a_context, NiPoint3 a_center);
+
+		bool getHeight(float a_x, float a_y, float* a_height);
+
+		void clear();
+
+		// sampler calls since startup
+		UInt32 getQueries() {
+			return _queries;
+		}
+
+	private:
+		bool getSample(int a_x, int a_y, float* a_height);
+		void recenter(NiPoint3 a_center);
+
+		Sampler _sampler;
+		float _spacing;
+		void* _context;
+		float _originX;     // world position of grid point 0,0
+		float _originY;
+		UInt32 _queries;
+
+		float _heights[kSize][kSize];
+		signed char _state[kSize][kSize];   // 0 not asked yet, 1 land, -1 no land
+	};
+
+	extern HeightField* g_heightField;
+
+	void InitHeightField();
+
+	// once a frame with the player's exterior cell, nullptr indoors
+	void setLandRegion(TESObjectCELL* a_cell, NiPoint3 a_position);
+}
@@ -0,0 +1,106 @@
+#include "HookStats.h"
+
+namespace F4VRBody {
+
+	HookStats g_hookStats;
+
+	static_assert((int)kHook_Count == (int)FRIK_HOOK_COUNT, "hook ids and telemetry hooks are out of sync");
+
+	static const char* hookNames[kHook_Count] = {
+		"bodyUpdate",
+		"mainUpdatePlayer",
+		"smoothMovement",
+		"reEquipAll",
+		"setMultiBoundRef",
+		"gunReloadInit",
+		"animationUpdate",
+		"patchInventory",
+		"patchLockForRead",
+		"patchPipeGunScope",
+	};
+
+	HookStats::HookStats() {
+		QueryPerformanceFrequency(&_freq);
+		QueryPerformanceCounter(&_windowStart);
+		_windowTsc = __rdtsc();
+
+		for (auto i = 0; i < kHook_Count; i++) {
+			_counters[i].calls = 0;
+			_counters[i].cycles = 0;
+			_seenCalls[i] = 0;
+			_seenCycles[i] = 0;
+			_lastFrameCalls[i] = 0;
+			_lastFrameCycles[i] = 0;
+			_windowCalls[i] = 0;
+			_windowCycles[i] = 0;
+			_callsPerFrame[i] = 0.0f;
+			_microsPerCall[i] = 0.0f;
+		}
+		_windowFrames = 0;
+		_lastFrames = 0;
+		_cyclesPerMicro = 3000.0;   // until the first second is measured
+	}
+
+	// the body update hook is still running when this is called from update(), its time shows up a frame late
+	void HookStats::endFrame() {
+		for (auto i = 0; i < kHook_Count; i++) {
+			UInt64 calls = _counters[i].calls.load(std::memory_order_relaxed);
+			UInt64 cycles = _counters[i].cycles.load(std::memory_order_relaxed);
+
+			_lastFrameCalls[i] = (UInt32)(calls - _seenCalls[i]);
+			_lastFrameCycles[i] = cycles - _seenCycles[i];
+			_seenCalls[i] = calls;
+			_seenCycles[i] = cycles;
+
+			_windowCalls[i] += _lastFrameCalls[i];
+			_windowCycles[i] += _lastFrameCycles[i];
+		}
+		_windowFrames++;
+
+		LARGE_INTEGER now;
+		QueryPerformanceCounter(&now);
+
+		if ((now.QuadPart - _windowStart.QuadPart) < _freq.QuadPart) {
+			return;
+		}
+
+		UInt64 tsc = __rdtsc();
+		double micros = (double)(now.QuadPart - _windowStart.QuadPart) * 1000000.0 / _freq.QuadPart;
+		_cyclesPerMicro = (double)(tsc - _windowTsc) / micros;
+
+		for (auto i = 0; i < kHook_Count; i++) {
+			_callsPerFrame[i] = (float)_windowCalls[i] / _windowFrames;
+			_microsPerCall[i] = _windowCalls[i] ? (float)(_windowCycles[i] / _cyclesPerMicro / _windowCalls[i]) : 0.0f;
+			_windowCalls[i] = 0;
+			_windowCycles[i] = 0;
+		}
+		_lastFrames = _windowFrames;
+		_windowFrames = 0;
+		_windowStart = now;
+		_windowTsc = tsc;
+
+		if (c_logWorkCounters) {
+			_MESSAGE("%s", getSummary().c_str());
+		}
+	}
+
+	std::string HookStats::getSummary() {
+		char buf[128];
+		std::string summary;
+
+		sprintf_s(buf, "hooks over %d frames (calls/frame, us/call):", _lastFrames);
+		summary = buf;
+
+		for (auto i = 0; i < kHook_Count; i++) {
+			if (i >= kHook_PatchInventory) {
+				sprintf_s(buf, " %s %.1f", hookNames[i], _callsPerFrame[i]);
+			}
+			else {
+				sprintf_s(buf, " %s %.1f %.2f", hookNames[i], _callsPerFrame[i], _microsPerCall[i]);
+			}
+			summary += buf;
+		}
+
+		return summary;
+	}
+}
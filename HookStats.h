@@ -0,0 +1,105 @@
+#pragma once
+#include "F4VRBody.h"
+#include "api/FRIKTelemetry.h"
+
+#include <atomic>
+#include <intrin.h>
+#include <string>
+
+namespace F4VRBody {
+
+	enum HookId {
+		kHook_BodyUpdate = 0,       // hook5, runs update()
+		kHook_MainUpdatePlayer,     // hook_main_update_player
+		kHook_SmoothMovement,       // hookSmoothMovement
+		kHook_ReEquipAll,           // fixPA3D
+		kHook_SetMultiBoundRef,     // fixPA3DEnter
+		kHook_GunReloadInit,        // gunReloadInit
+		kHook_AnimationUpdate,      // updatePlayerAnimationHook
+		kHook_PatchInventory,       // the xbyak patches only count calls
+		kHook_PatchLockForRead,
+		kHook_PatchPipeGunScope,
+		kHook_Count
+	};
+
+	struct HookCounter {
+		std::atomic<UInt64> calls;
+		std::atomic<UInt64> cycles;
+	};
+
+	// Call counts and time spent for every detour FRIK installs.   The detours add to their counter from whatever thread
+	// the game calls them on, endFrame() on the main thread turns the running totals into per frame numbers and once a
+	// second into averages like the work counters.   Time is in rdtsc cycles, converted with the rate measured against
+	// QueryPerformanceCounter over the same second.
+	class HookStats {
+	public:
+		HookStats();
+
+		inline void record(HookId a_hook, UInt64 a_cycles) {
+			_counters[a_hook].calls.fetch_add(1, std::memory_order_relaxed);
+			_counters[a_hook].cycles.fetch_add(a_cycles, std::memory_order_relaxed);
+		}
+
+		// for generated code that bumps the count itself
+		UInt64* getCallCounter(HookId a_hook) {
+			return reinterpret_cast<UInt64*>(&_counters[a_hook].calls);
+		}
+
+		void endFrame();
+
+		UInt32 getCallsLastFrame(HookId a_hook) {
+			return _lastFrameCalls[a_hook];
+		}
+
+		float getMicrosLastFrame(HookId a_hook) {
+			return (float)(_lastFrameCycles[a_hook] / _cyclesPerMicro);
+		}
+
+		std::string getSummary();
+
+	private:
+		HookCounter _counters[kHook_Count];
+		UInt64 _seenCalls[kHook_Count];
+		UInt64 _seenCycles[kHook_Count];
+		UInt32 _lastFrameCalls[kHook_Count];
+		UInt64 _lastFrameCycles[kHook_Count];
+
+		UInt64 _windowCalls[kHook_Count];
+		UInt64 _windowCycles[kHook_Count];
+		float _callsPerFrame[kHook_Count];
+		float _microsPerCall[kHook_Count];
+		UInt32 _windowFrames;
+		UInt32 _lastFrames;
+
+		LARGE_INTEGER _freq;
+		LARGE_INTEGER _windowStart;
+		UInt64 _windowTsc;
+		double _cyclesPerMicro;
+	};
+
+	// plain object so hooks that fire before plugin init is done still have somewhere to count
+	extern HookStats g_hookStats;
+
+	struct HookTimer {
+		HookTimer(HookId a_hook) : hook(a_hook), start(__rdtsc()) {}
+
+		~HookTimer() {
+			g_hookStats.record(hook, __rdtsc() - start);
+		}
+
+		HookId hook;
+		UInt64 start;
+	};
+
+	// HookThunk<kHook_X, &detour>::call has the same signature as the detour and is what gets written into the game code
+	template <HookId Hook, auto Fn>
+	struct HookThunk;
+
+	template <HookId Hook, typename R, typename... Args, R (*Fn)(Args...)>
+	struct HookThunk<Hook, Fn> {
+		static R call(Args... args) {
+			HookTimer timer(Hook);
+			return Fn(args...);
+		}
+	};
+}
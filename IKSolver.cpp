@@ -0,0 +1,388 @@
+#include "IKSolver.h"
+
+#include <algorithm>
+#include <math.h>
+
+namespace F4VRBody {
+
+	// adapted solver from VRIK.  Thanks prog!
+	void solveLegIK(const LegIKInput& in, LegIKOutput& out) {
+		Matrix44 rotMat;
+		out.flags = 0;
+
+		NiPoint3 footPos = in.footPos;
+		NiPoint3 hipPos = in.hipWorld.pos;
+
+		NiPoint3 footToHip = hipPos - footPos;
+
+		NiPoint3 rotV = NiPoint3(0, 1, 0);
+		if (in.inPowerArmor) {
+			rotV.y = 0;
+			rotV.z = in.isLeft ? 1 : -1;
+		}
+		NiPoint3 hipDir = in.hipWorld.rot * rotV;
+		NiPoint3 xDir = vec3_norm(footToHip);
+		NiPoint3 yDir = vec3_norm(hipDir - xDir * vec3_dot(hipDir, xDir));
+
+		float thighLenOrig = vec3_len(in.kneeLocal.pos);
+		float calfLenOrig = vec3_len(in.footLocalPos);
+		float thighLen = thighLenOrig;
+		float calfLen = calfLenOrig;
+
+		float ftLen = vec3_len(footToHip);
+		if (ftLen < 0.1) {
+			ftLen = 0.1;
+			out.flags |= FRIK_IK_DEGENERATE;
+		}
+
+		if (ftLen > thighLen + calfLen) {
+			out.flags |= FRIK_IK_STRETCHED;
+			float diff = ftLen - thighLen - calfLen;
+			float ratio = calfLen / (calfLen + thighLen);
+			calfLen += ratio * diff + 0.1;
+			thighLen += (1.0 - ratio) * diff + 0.1;
+		}
+
+		// Use the law of cosines to calculate the angle the calf must bend to reach the knee position
+		// In cases where this is impossible (foot too close to thigh), then set calfLen = thighLen so
+		// there is always a solution
+		float footAngle = acosf((calfLen * calfLen + ftLen * ftLen - thighLen * thighLen) / (2 * calfLen * ftLen));
+		if (isnan(footAngle) || isinf(footAngle)) {
+			out.flags |= FRIK_IK_ACOS_CLAMPED;
+			calfLen = thighLen = (thighLenOrig + calfLenOrig) / 2.0;
+			footAngle = acosf((calfLen * calfLen + ftLen * ftLen - thighLen * thighLen) / (2 * calfLen * ftLen));
+		}
+
+		// Get the desired world coordinate of the knee
+		float xDist = cosf(footAngle) * calfLen;
+		float yDist = sinf(footAngle) * calfLen;
+		NiPoint3 kneePos = footPos + xDir * xDist + yDir * yDist;
+
+		NiPoint3 pos = kneePos - hipPos;
+		NiPoint3 uLocalDir = in.hipWorld.rot.Transpose() * vec3_norm(pos) / in.hipWorld.scale;
+		rotMat.rotateVectoVec(uLocalDir, in.kneeLocal.pos);
+		out.hipLocalRot = rotMat.multiply43Left(in.hipLocalRot);
+
+		NiMatrix43 hipWR;
+		rotMat.makeTransformMatrix(out.hipLocalRot, NiPoint3(0, 0, 0));
+		hipWR = rotMat.multiply43Left(in.hipParentRot);
+
+		NiMatrix43 calfWR;
+		rotMat.makeTransformMatrix(in.kneeLocal.rot, NiPoint3(0, 0, 0));
+		calfWR = rotMat.multiply43Left(hipWR);
+
+		uLocalDir = calfWR.Transpose() * vec3_norm(footPos - kneePos) / in.kneeWorldScale;
+		rotMat.rotateVectoVec(uLocalDir, in.footLocalPos);
+		out.kneeLocalRot = rotMat.multiply43Left(in.kneeLocal.rot);
+
+		rotMat.makeTransformMatrix(out.kneeLocalRot, NiPoint3(0, 0, 0));
+		calfWR = rotMat.multiply43Left(hipWR);
+
+		// Calculate Clp:  Cwp = Twp + Twr * (Clp * Tws) = kneePos   ===>   Clp = Twr' * (kneePos - Twp) / Tws
+		out.kneeLocalPos = hipWR.Transpose() * (kneePos - hipPos) / in.hipWorld.scale;
+
+		// Calculate Flp:  Fwp = Cwp + Cwr * (Flp * Cws) = footPos   ===>   Flp = Cwr' * (footPos - Cwp) / Cws
+		out.footLocalPos = calfWR.Transpose() * (footPos - kneePos) / in.kneeWorldScale;
+	}
+
+	// This is the main arm IK solver function - Algo credit to prog from SkyrimVR VRIK mod - what a beast!
+	void solveArmIK(const ArmIKInput& in, ArmIKOutput& out) {
+		NiPoint3 handPos = in.handPos;
+		NiMatrix43 handRot = in.handRot;
+
+		out.shoulderOnly = true;
+		out.twistAngle = in.prevTwistAngle;
+		out.flags = FRIK_IK_OUT_OF_REACH;
+		out.upperLocalRot = in.upperLocal.rot;
+		out.forearm1Local = in.forearm1Local;
+		out.forearm2Local = in.forearm2Local;
+		out.forearm3Local = in.forearm3Local;
+		out.handLocal = in.handLocal;
+
+		double adjustedArmLength = in.armLength / 36.74;
+
+		// Shoulder IK is done in a very simple way
+
+		NiPoint3 shoulderToHand = handPos - in.upperWorldPos;
+		float armLength = in.armLength;
+		float adjustAmount = (std::clamp)(vec3_len(shoulderToHand) - armLength * 0.5f, 0.0f, armLength * 0.85f) / (armLength * 0.85f);
+		NiPoint3 shoulderOffset = vec3_norm(shoulderToHand) * (adjustAmount * armLength * 0.08f);
+
+		NiPoint3 clavicalToNewShoulder = in.upperWorldPos + shoulderOffset - in.shoulderWorld.pos;
+
+		NiPoint3 sLocalDir = (in.shoulderWorld.rot.Transpose() * clavicalToNewShoulder) / in.shoulderWorld.scale;
+
+		Matrix44 rotatedM;
+		rotatedM = 0.0;
+		rotatedM.rotateVectoVec(sLocalDir, NiPoint3(1, 0, 0));
+
+		out.shoulderLocalRot = rotatedM.multiply43Left(in.shoulderLocalRot);
+
+		// world rotation of the clavicle and upper arm once the shoulder has moved.   the serial version got these from an updateDown
+		rotatedM.makeTransformMatrix(out.shoulderLocalRot, NiPoint3(0, 0, 0));
+		NiMatrix43 Cwr = rotatedM.multiply43Left(in.shoulderParentRot);
+		rotatedM.makeTransformMatrix(in.upperLocal.rot, NiPoint3(0, 0, 0));
+		NiMatrix43 baseUwr = rotatedM.multiply43Left(Cwr);
+
+		/* The bend of the arm depends on its distance to the body.  Its distance as well as the lengths of
+		   the upper arm and forearm define the sides of a triangle:
+		                   ^
+		                  /|\         Let a,b be the arm lengths, c be the distance from hand-to-shoulder
+		                 /^| \        Let A be the total angle at which the wrist must bend
+		                / ||  \       Let x be the width of the right triangle
+		              a/  y|   \  b   Let y be the height of the right triangle
+		              /   ||    \
+	                 /    v|<-x->\
+	       Shoulder /______|_____A\ Hand
+		                  c
+		   Law of cosines: Wrist angle A = acos( (b^2 + c^2 - a^2) / (2*b*c) )
+		   The wrist angle is used to calculate x and y, which are used to position the elbow */
+
+
+		float negLeft = in.isLeft ? -1 : 1;
+
+		float originalUpperLen = vec3_len(in.forearm1Local.pos);
+		float originalForearmLen;
+
+		if (in.inPowerArmor) {
+			originalForearmLen = vec3_len(in.handLocal.pos);
+		}
+		else {
+			originalForearmLen = vec3_len(in.handLocal.pos) + vec3_len(in.forearm2Local.pos) + vec3_len(in.forearm3Local.pos);
+		}
+		float upperLen = originalUpperLen * adjustedArmLength;
+		float forearmLen = originalForearmLen * adjustedArmLength;
+
+		NiPoint3 Uwp = in.shoulderWorld.pos + Cwr * (in.upperLocal.pos * in.shoulderWorld.scale);
+		NiPoint3 handToShoulder = Uwp - handPos;
+		float hsLen = (std::max)(vec3_len(handToShoulder), 0.1f);
+
+		if (hsLen > (upperLen + forearmLen) * 2.25) {
+			return;
+		}
+		out.flags = hsLen <= 0.1f ? FRIK_IK_DEGENERATE : 0;
+
+		// Stretch the upper arm and forearm proportionally when the hand distance exceeds the arm length
+		if (hsLen > upperLen + forearmLen) {
+			out.flags |= FRIK_IK_STRETCHED;
+			float diff = hsLen - upperLen - forearmLen;
+			float ratio = forearmLen / (forearmLen + upperLen);
+			forearmLen += ratio * diff + 0.1;
+			upperLen += (1.0 - ratio) * diff + 0.1;
+		}
+
+		NiPoint3 forwardDir = vec3_norm(in.forwardDir);
+		NiPoint3 sidewaysDir = vec3_norm(in.sidewaysRDir * negLeft);
+
+		// The primary twist angle comes from the direction the wrist is pointing into the forearm
+		NiPoint3 handBack = handRot * NiPoint3(-1, 0, 0);
+		float twistAngle = asinf((std::clamp)(handBack.z, -0.999f, 0.999f));
+
+		// The second twist angle comes from a side vector pointing "outward" from the side of the wrist
+		NiPoint3 handSide = handRot * NiPoint3(0, -1, 0);
+		NiPoint3 handinSide = handSide * negLeft;
+		float twistAngle2 = -1 * asinf((std::clamp)(handSide.z, -0.599f, 0.999f));
+
+		// Blend the two twist angles together, using the primary angle more when the wrist is pointing downward
+		float interpTwist = (std::clamp)((handBack.z + 0.866f) * 1.155f, 0.45f, 0.8f); // 0 to 1 as hand points 60 degrees down to horizontal
+		twistAngle = twistAngle + interpTwist * (twistAngle2 - twistAngle);
+
+		// Smooth out sudden changes in the twist angle over time to reduce elbow shake
+		twistAngle = in.prevTwistAngle + (twistAngle - in.prevTwistAngle) * 0.25f;
+		out.twistAngle = twistAngle;
+
+		// Calculate the hand's distance behind the body - It will increase the minimum elbow rotation angle
+		float size = 1.0;
+		float behindD = -(forwardDir.x * in.shoulderWorld.pos.x + forwardDir.y * in.shoulderWorld.pos.y) - 10.0f;
+		float handBehindDist = -(handPos.x * forwardDir.x + handPos.y * forwardDir.y + behindD);
+		float behindAmount = (std::clamp)(handBehindDist / (40.0f * size), 0.0f, 1.0f);
+
+		// Holding hands in front of chest increases the minimum elbow rotation angle (elbows lift) and decreases the maximum angle
+		NiPoint3 planeDir = rotateXY(forwardDir, negLeft * degrees_to_rads(135));
+		float planeD = -(planeDir.x * in.shoulderWorld.pos.x + planeDir.y * in.shoulderWorld.pos.y) + 16.0f * size;
+		float armCrossAmount = (std::clamp)((handPos.x * planeDir.x + handPos.y * planeDir.y + planeD) / (20.0f * size), 0.0f, 1.0f);
+
+		// The arm lift limits how much the crossing amount can influence minimum elbow rotation
+		// The maximum rotation is also decreased as hands lift higher (elbows point further downward)
+		float armLiftLimitZ = in.chestZ * size;
+		float armLiftThreshold = 60.0f * size;
+		float armLiftLimit = (std::clamp)((armLiftLimitZ + armLiftThreshold - handPos.z) / armLiftThreshold, 0.0f, 1.0f); // 1 at bottom, 0 at top
+		float upLimit = (std::clamp)((1.0f - armLiftLimit) * 1.4f, 0.0f, 1.0f); // 0 at bottom, 1 at a much lower top
+
+		// Determine overall amount the elbows minimum rotation will be limited
+		float adjustMinAmount = (std::max)(behindAmount, (std::min)(armCrossAmount, armLiftLimit));
+		if (adjustMinAmount > 0.0f) {
+			out.flags |= behindAmount >= adjustMinAmount ? FRIK_IK_ELBOW_BEHIND : FRIK_IK_ELBOW_CROSSED;
+		}
+
+		// Get the minimum and maximum angles at which the elbow is allowed to twist
+		float twistMinAngle = degrees_to_rads(-85.0) + degrees_to_rads(50) * adjustMinAmount;
+		float twistMaxAngle = degrees_to_rads(55.0) - (std::max)(degrees_to_rads(90) * armCrossAmount, degrees_to_rads(70) * upLimit);
+
+		// Twist angle ranges from -PI/2 to +PI/2; map that range to go from the minimum to the maximum instead
+		float twistLimitAngle = twistMinAngle + ((twistAngle + PI / 2.0f) / PI) * (twistMaxAngle - twistMinAngle);
+
+		// The bendDownDir vector points in the direction the player faces, and bends up/down with the final elbow angle
+		NiMatrix43 rot = getRotationAxisAngle(sidewaysDir * negLeft, twistLimitAngle);
+		NiPoint3 bendDownDir = rot * forwardDir;
+
+		// Get the "X" direction vectors pointing to the shoulder
+		NiPoint3 xDir = vec3_norm(handToShoulder);
+
+		// Get the final "Y" vector, perpendicular to "X", and pointing in elbow direction (as in the diagram above)
+		float sideD = -(sidewaysDir.x * in.shoulderWorld.pos.x + sidewaysDir.y * in.shoulderWorld.pos.y) - 1.0 * 8.0f;
+		float acrossAmount = -(handPos.x * sidewaysDir.x + handPos.y * sidewaysDir.y + sideD) / (16.0f * 1.0);
+		float handSideTwistOutward = vec3_dot(handSide, vec3_norm(sidewaysDir + (forwardDir * 0.5f)));
+		float armTwist = (std::clamp)(handSideTwistOutward - (std::max)(0.0f, acrossAmount + 0.25f), 0.0f, 1.0f);
+
+		if (acrossAmount < 0) {
+			acrossAmount *= 0.2f;
+		}
+
+		float handBehindHead = (std::clamp)((handBehindDist + 0.0f * size) / (15.0f * size), 0.0f, 1.0f) * (std::clamp)(upLimit * 1.2f, 0.0f, 1.0f);
+		float elbowsTwistForward = (std::max)(acrossAmount * degrees_to_rads(90), handBehindHead * degrees_to_rads(120));
+		if (handBehindHead > 0.0f && handBehindHead * 120.0f > acrossAmount * 90.0f) {
+			out.flags |= FRIK_IK_ELBOW_BEHIND_HEAD;
+		}
+		NiPoint3 elbowDir = rotateXY(bendDownDir, -negLeft * (degrees_to_rads(150) - armTwist * degrees_to_rads(25) - elbowsTwistForward));
+		NiPoint3 yDir = elbowDir - xDir * vec3_dot(elbowDir, xDir);
+		yDir = vec3_norm(yDir);
+
+		// Get the angle wrist must bend to reach elbow position
+		// In cases where this is impossible (hand too close to shoulder), then set forearmLen = upperLen so there is always a solution
+		float wristAngle = acosf((forearmLen * forearmLen + hsLen * hsLen - upperLen * upperLen) / (2 * forearmLen * hsLen));
+		if (isnan(wristAngle) || isinf(wristAngle)) {
+			out.flags |= FRIK_IK_ACOS_CLAMPED;
+			forearmLen = upperLen = (originalUpperLen + originalForearmLen) / 2.0 * adjustedArmLength;
+			wristAngle = acosf((forearmLen * forearmLen + hsLen * hsLen - upperLen * upperLen) / (2 * forearmLen * hsLen));
+		}
+
+		// Get the desired world coordinate of the elbow
+		float xDist = cosf(wristAngle) * forearmLen;
+		float yDist = sinf(wristAngle) * forearmLen;
+		NiPoint3 elbowWorld = handPos + xDir * xDist + yDir * yDist;
+
+		// This code below rotates and positions the upper arm, forearm, and hand bones
+		// Notation: C=Clavicle, U=Upper arm, F=Forearm, H=hand   w=world, l=local   p=position, r=rotation, s=scale
+		//    Rules: World position = Parent world pos + Parent world rot * (Local pos * Parent World scale)
+		//           World Rotation = Parent world rotation * Local Rotation
+		// ---------------------------------------------------------------------------------------------------------
+
+		// The upper arm bone must be rotated from its forward vector to its shoulder-to-elbow vector in its local space
+		// Calculate Ulr:  baseUwr * rotTowardElbow = Cwr * Ulr   ===>   Ulr = Cwr' * baseUwr * rotTowardElbow
+		NiMatrix43 Uwr = baseUwr;
+		NiPoint3 pos = elbowWorld - Uwp;
+		NiPoint3 uLocalDir = Uwr.Transpose() * vec3_norm(pos) / in.upperWorldScale;
+
+		NiMatrix43 upperLocalRot;
+		rotatedM.rotateVectoVec(uLocalDir, in.forearm1Local.pos);
+		upperLocalRot = rotatedM.multiply43Left(in.upperLocal.rot);
+
+		rotatedM.makeTransformMatrix(upperLocalRot, in.upperLocal.pos);
+
+		Uwr = rotatedM.multiply43Left(Cwr);
+
+		// Find the angle of the forearm twisted around the upper arm and twist the upper arm to align it
+		//    Uwr * twist = Cwr * Ulr   ===>   Ulr = Cwr' * Uwr * twist
+		pos = handPos - elbowWorld;
+		NiPoint3 uLocalTwist = Uwr.Transpose() * vec3_norm(pos);
+		uLocalTwist.x = 0;
+		NiPoint3 upperSide = baseUwr * NiPoint3(0, 1, 0);
+		NiPoint3 uloc = Cwr.Transpose() * upperSide;
+		uloc.x = 0;
+		// rounding can push the dot of two unit vectors just past 1, which used to turn the whole arm into NaN
+		float upperCos = vec3_dot(vec3_norm(uLocalTwist), vec3_norm(uloc));
+		if (upperCos > 1.0f || upperCos < -1.0f) {
+			out.flags |= FRIK_IK_ACOS_CLAMPED;
+			upperCos = (std::clamp)(upperCos, -1.0f, 1.0f);
+		}
+		float upperAngle = acosf(upperCos) * (uLocalTwist.z > 0 ? 1 : -1);
+
+		Matrix44 twist;
+		twist.setEulerAngles(-upperAngle, 0, 0);
+		upperLocalRot = twist.multiply43Left(upperLocalRot);
+
+		rotatedM.makeTransformMatrix(upperLocalRot, in.upperLocal.pos);
+		Uwr = rotatedM.multiply43Left(Cwr);
+
+		NiTransform forearm1 = in.forearm1Local;
+		NiTransform forearm2 = in.forearm2Local;
+		NiTransform forearm3 = in.forearm3Local;
+		NiTransform hand = in.handLocal;
+
+		twist.setEulerAngles(-upperAngle, 0, 0);
+		forearm1.rot = twist.multiply43Left(forearm1.rot);
+
+		// The forearm arm bone must be rotated from its forward vector to its elbow-to-hand vector in its local space
+		// Calculate Flr:  Fwr * rotTowardHand = Uwr * Flr   ===>   Flr = Uwr' * Fwr * rotTowardHand
+		rotatedM.makeTransformMatrix(forearm1.rot, forearm1.pos);
+		NiMatrix43 Fwr = rotatedM.multiply43Left(Uwr);
+		NiPoint3 elbowHand = handPos - elbowWorld;
+		NiPoint3 fLocalDir = Fwr.Transpose() * vec3_norm(elbowHand);
+
+		rotatedM.rotateVectoVec(fLocalDir, NiPoint3(1, 0, 0));
+		forearm1.rot = rotatedM.multiply43Left(forearm1.rot);
+		rotatedM.makeTransformMatrix(forearm1.rot, forearm1.pos);
+		Fwr = rotatedM.multiply43Left(Uwr);
+
+		NiMatrix43 Fwr2 = Fwr;
+		NiMatrix43 Fwr3 = Fwr;
+
+		if (!in.inPowerArmor && in.hasForearmTwist) {
+			rotatedM.makeTransformMatrix(forearm2.rot, forearm2.pos);
+			Fwr2 = rotatedM.multiply43Left(Fwr);
+			rotatedM.makeTransformMatrix(forearm3.rot, forearm3.pos);
+			Fwr3 = rotatedM.multiply43Left(Fwr2);
+
+			// Find the angle the wrist is pointing and twist forearm3 appropriately
+			//    Fwr * twist = Uwr * Flr   ===>   Flr = (Uwr' * Fwr) * twist = (Flr) * twist
+
+			NiPoint3 wLocalDir = Fwr3.Transpose() * vec3_norm(handinSide);
+			wLocalDir.x = 0;
+			NiPoint3 forearm3Side = Fwr3 * NiPoint3(0, 0, -1);   // forearm is rotated 90 degrees already from hand so need this vector instead of 0,-1,0
+			NiPoint3 floc = Fwr2.Transpose() * vec3_norm(forearm3Side);
+			floc.x = 0;
+			float fcos = vec3_dot(vec3_norm(wLocalDir), vec3_norm(floc));
+			float fsin = vec3_det(vec3_norm(wLocalDir), vec3_norm(floc), NiPoint3(-1, 0, 0));
+			float forearmAngle = -1 * negLeft * atan2f(fsin, fcos);
+
+			twist.setEulerAngles(negLeft * forearmAngle / 2, 0, 0);
+			forearm2.rot = twist.multiply43Left(forearm2.rot);
+
+			twist.setEulerAngles(negLeft * forearmAngle / 2, 0, 0);
+			forearm3.rot = twist.multiply43Left(forearm3.rot);
+
+			rotatedM.makeTransformMatrix(forearm2.rot, forearm2.pos);
+			Fwr2 = rotatedM.multiply43Left(Fwr);
+			rotatedM.makeTransformMatrix(forearm3.rot, forearm3.pos);
+			Fwr3 = rotatedM.multiply43Left(Fwr2);
+		}
+
+		// Calculate Hlr:  Fwr * Hlr = handRot   ===>   Hlr = Fwr' * handRot
+		rotatedM.makeTransformMatrix(handRot, handPos);
+		if (!in.inPowerArmor) {
+			hand.rot = rotatedM.multiply43Left(Fwr3.Transpose());
+		}
+		else {
+			hand.rot = rotatedM.multiply43Left(Fwr.Transpose());
+		}
+
+		// Calculate Flp:  Fwp = Uwp + Uwr * (Flp * Uws) = elbowWorld   ===>   Flp = Uwr' * (elbowWorld - Uwp) / Uws
+		forearm1.pos = Uwr.Transpose() * ((elbowWorld - Uwp) / in.upperWorldScale);
+
+		float forearmRatio = (forearmLen / in.handToForearmLen) * in.rootScale;
+
+		if (in.hasForearmTwist && !in.inPowerArmor) {
+			forearm2.pos *= forearmRatio;
+			forearm3.pos *= forearmRatio;
+		}
+		hand.pos *= forearmRatio;
+
+		out.shoulderOnly = false;
+		out.upperLocalRot = upperLocalRot;
+		out.forearm1Local = forearm1;
+		out.forearm2Local = forearm2;
+		out.forearm3Local = forearm3;
+		out.handLocal = hand;
+	}
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include "f4se/NiNodes.h"
+#include "f4se/NiObjects.h"
+
+#include "utils.h"
+#include "matrix.h"
+#include "api/FRIKTelemetry.h"
+
+namespace F4VRBody {
+
+	// The limb solvers are split in two.   Skeleton gathers a snapshot of everything the solve needs from the scene graph,
+	// the solve below only does math on that snapshot, and Skeleton then writes the results back into m_localTransform.
+	// Keeping the solve off the scene graph is what lets the arms and legs run at the same time on the IK workers.
+
+	struct LegIKInput {
+		bool isLeft;
+		bool inPowerArmor;
+		NiPoint3 footPos;
+		NiTransform hipWorld;
+		NiMatrix43 hipParentRot;
+		NiMatrix43 hipLocalRot;
+		NiTransform kneeLocal;
+		NiPoint3 footLocalPos;
+		float kneeWorldScale;
+	};
+
+	struct LegIKOutput {
+		NiMatrix43 hipLocalRot;
+		NiMatrix43 kneeLocalRot;
+		NiPoint3 kneeLocalPos;
+		NiPoint3 footLocalPos;
+		uint32_t flags;         // FRIK_IK_* that happened during the solve
+	};
+
+	struct ArmIKInput {
+		bool isLeft;
+		bool inPowerArmor;
+		bool hasForearmTwist;   // forearm2 and forearm3 exist
+		NiPoint3 handPos;
+		NiMatrix43 handRot;
+		NiTransform shoulderWorld;
+		NiMatrix43 shoulderLocalRot;
+		NiMatrix43 shoulderParentRot;
+		NiPoint3 upperWorldPos;
+		float upperWorldScale;
+		NiTransform upperLocal;
+		NiTransform forearm1Local;
+		NiTransform forearm2Local;
+		NiTransform forearm3Local;
+		NiTransform handLocal;
+		float handToForearmLen;
+		NiPoint3 forwardDir;
+		NiPoint3 sidewaysRDir;
+		float chestZ;
+		float rootScale;
+		float armLength;
+		float prevTwistAngle;
+	};
+
+	struct ArmIKOutput {
+		bool shoulderOnly;      // hand too far away, only the shoulder was adjusted
+		NiMatrix43 shoulderLocalRot;
+		NiMatrix43 upperLocalRot;
+		NiTransform forearm1Local;
+		NiTransform forearm2Local;
+		NiTransform forearm3Local;
+		NiTransform handLocal;
+		float twistAngle;
+		uint32_t flags;         // FRIK_IK_* that happened during the solve
+	};
+
+	void solveLegIK(const LegIKInput& in, LegIKOutput& out);
+	void solveArmIK(const ArmIKInput& in, ArmIKOutput& out);
+}
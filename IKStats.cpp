@@ -0,0 +1,98 @@
+#include "IKStats.h"
+
+namespace F4VRBody {
+
+	IKStats g_ikStats;
+
+	static const char* limbNames[FRIK_LIMB_COUNT] = { "rightArm", "leftArm", "rightLeg", "leftLeg" };
+
+	// FRIK_IK_* bit order, SOLVED is reported as the solve count
+	static const char* flagNames[] = { "solved", "outOfReach", "stretched", "acosClamped", "degenerate", "elbowBehind", "elbowCrossed", "elbowBehindHead" };
+
+	IKStats::IKStats() {
+		QueryPerformanceFrequency(&_freq);
+		QueryPerformanceCounter(&_windowStart);
+
+		memset(_frame, 0, sizeof(_frame));
+		memset(_window, 0, sizeof(_window));
+		memset(_last, 0, sizeof(_last));
+		_framePosture = 0.0f;
+		_windowPosture = 0.0;
+		_windowPeakPosture = 0.0f;
+		_windowFrames = 0;
+		_lastPosture = 0.0;
+		_lastPeakPosture = 0.0f;
+		_lastFrames = 0;
+	}
+
+	void IKStats::endFrame() {
+		for (auto i = 0; i < FRIK_LIMB_COUNT; i++) {
+			Window& w = _window[i];
+			const Limb& l = _frame[i];
+
+			w.position += l.position;
+			w.rotation += l.rotation;
+			w.peakPosition = l.position > w.peakPosition ? l.position : w.peakPosition;
+			w.peakRotation = l.rotation > w.peakRotation ? l.rotation : w.peakRotation;
+
+			for (auto bit = 0; bit < kFlagBits; bit++) {
+				w.flagCounts[bit] += (l.flags >> bit) & 1;
+			}
+		}
+		_windowPosture += _framePosture;
+		_windowPeakPosture = _framePosture > _windowPeakPosture ? _framePosture : _windowPeakPosture;
+		_windowFrames++;
+
+		LARGE_INTEGER now;
+		QueryPerformanceCounter(&now);
+
+		if ((now.QuadPart - _windowStart.QuadPart) < _freq.QuadPart) {
+			return;
+		}
+
+		memcpy(_last, _window, sizeof(_window));
+		memset(_window, 0, sizeof(_window));
+		_lastPosture = _windowPosture;
+		_lastPeakPosture = _windowPeakPosture;
+		_windowPosture = 0.0;
+		_windowPeakPosture = 0.0f;
+		_lastFrames = _windowFrames;
+		_windowFrames = 0;
+		_windowStart = now;
+
+		if (c_logWorkCounters) {
+			_MESSAGE("%s", getSummary().c_str());
+		}
+	}
+
+	std::string IKStats::getSummary() {
+		char buf[160];
+		std::string summary;
+
+		UInt32 frames = _lastFrames ? _lastFrames : 1;
+
+		sprintf_s(buf, "ik over %d frames: posture %.2f (peak %.2f)", _lastFrames, _lastPosture / frames, _lastPeakPosture);
+		summary = buf;
+
+		for (auto i = 0; i < FRIK_LIMB_COUNT; i++) {
+			const Window& w = _last[i];
+
+			sprintf_s(buf, " | %s pos %.2f (peak %.2f)", limbNames[i], w.position / frames, w.peakPosition);
+			summary += buf;
+
+			if (i <= FRIK_LIMB_LEFT_ARM) {
+				sprintf_s(buf, " rot %.1f (peak %.1f)", w.rotation / frames, w.peakRotation);
+				summary += buf;
+			}
+
+			for (auto bit = 0; bit < kFlagBits; bit++) {
+				if (w.flagCounts[bit]) {
+					sprintf_s(buf, " %s %d", flagNames[bit], w.flagCounts[bit]);
+					summary += buf;
+				}
+			}
+		}
+
+		return summary;
+	}
+}
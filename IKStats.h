@@ -0,0 +1,75 @@
+#pragma once
+#include "F4VRBody.h"
+#include "api/FRIKTelemetry.h"
+
+#include <string>
+
+namespace F4VRBody {
+
+	// How well the ik met its targets.   Every frame each limb hands in its position and rotation residual and the
+	// FRIK_IK_* flags from its solve, the posture solve its neck residual.   They go into a fixed block for the frame (what
+	// telemetry publishes) and are rolled up once a second into averages, peaks and how often each clamp or elbow
+	// heuristic kicked in, for the console and the log.   Main thread only.
+	class IKStats {
+	public:
+		IKStats();
+
+		struct Limb {
+			float position;         // cm
+			float rotation;         // degrees
+			UInt32 flags;           // FRIK_IK_*
+		};
+
+		inline void setLimb(FRIKTelemetryLimb a_limb, float a_position, float a_rotation, UInt32 a_flags) {
+			_frame[a_limb].position = a_position;
+			_frame[a_limb].rotation = a_rotation;
+			_frame[a_limb].flags = a_flags;
+		}
+
+		inline void setPosture(float a_residual) {
+			_framePosture = a_residual;
+		}
+
+		const Limb& getThisFrame(FRIKTelemetryLimb a_limb) {
+			return _frame[a_limb];
+		}
+
+		float getPostureThisFrame() {
+			return _framePosture;
+		}
+
+		void endFrame();
+
+		std::string getSummary();
+
+	private:
+		static const int kFlagBits = 8;
+
+		struct Window {
+			double position;
+			double rotation;
+			float peakPosition;
+			float peakRotation;
+			UInt32 solves;
+			UInt32 flagCounts[kFlagBits];
+		};
+
+		LARGE_INTEGER _freq;
+		LARGE_INTEGER _windowStart;
+
+		Limb _frame[FRIK_LIMB_COUNT];
+		float _framePosture;
+
+		Window _window[FRIK_LIMB_COUNT];
+		double _windowPosture;
+		float _windowPeakPosture;
+		UInt32 _windowFrames;
+
+		Window _last[FRIK_LIMB_COUNT];
+		double _lastPosture;
+		float _lastPeakPosture;
+		UInt32 _lastFrames;
+	};
+
+	extern IKStats g_ikStats;
+}
@@ -0,0 +1,167 @@
+#include "LimbIK.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace F4VRBody {
+
+	bool LimbIK::prepareLeg(LegJob& job) {
+		LegIKInput& in = job.in;
+		in.hipWorld = job.hip->m_worldTransform;
+		in.hipParentRot = job.hip->m_parent->m_worldTransform.rot;
+		in.hipLocalRot = job.hip->m_localTransform.rot;
+		in.kneeLocal = job.knee->m_localTransform;
+		in.footLocalPos = job.foot->m_localTransform.pos;
+		in.kneeWorldScale = job.knee->m_worldTransform.scale;
+
+		SolveCache& cache = _cache[in.isLeft ? FRIK_LIMB_LEFT_LEG : FRIK_LIMB_RIGHT_LEG];
+		cache.beginInputs();
+		cache.addInput(in.footPos);
+		cache.addInput(in.hipWorld);
+		cache.addInput(in.hipParentRot);
+		// the animation rewrites these every frame and the solve is built on them, a new pose under still targets has to
+		// solve again rather than get the old one put back
+		cache.addInput(in.hipLocalRot);
+		cache.addInput(in.kneeLocal);
+		cache.addInput(in.footLocalPos);
+		cache.addInput(in.inPowerArmor ? 1.0f : 0.0f);
+
+		return !cache.tryReuse();
+	}
+
+	void LimbIK::applyLeg(LegJob& job) {
+		int limb = job.in.isLeft ? FRIK_LIMB_LEFT_LEG : FRIK_LIMB_RIGHT_LEG;
+		_target[limb] = job.in.footPos;
+		_effector[limb] = job.foot;
+		_flags[limb] = job.out.flags | FRIK_IK_SOLVED;
+
+		job.hip->m_localTransform.rot = job.out.hipLocalRot;
+		job.knee->m_localTransform.rot = job.out.kneeLocalRot;
+		job.knee->m_localTransform.pos = job.out.kneeLocalPos;
+		job.foot->m_localTransform.pos = job.out.footLocalPos;
+
+		SolveCache& cache = _cache[limb];
+		cache.beginOutputs();
+		cache.addOutput(job.hip);
+		cache.addOutput(job.knee);
+		cache.addOutput(job.foot);
+		cache.commit();
+	}
+
+	bool LimbIK::prepareArm(ArmJob& job) {
+		ArmNodes& arm = job.arm;
+		int limb = job.in.isLeft ? FRIK_LIMB_LEFT_ARM : FRIK_LIMB_RIGHT_ARM;
+
+		ArmIKInput& in = job.in;
+		in.hasForearmTwist = (arm.forearm2 != nullptr) && (arm.forearm3 != nullptr);
+		in.shoulderWorld = arm.shoulder->m_worldTransform;
+		in.shoulderLocalRot = arm.shoulder->m_localTransform.rot;
+		in.shoulderParentRot = arm.shoulder->m_parent->m_worldTransform.rot;
+		in.upperWorldPos = arm.upper->m_worldTransform.pos;
+		in.upperWorldScale = arm.upper->m_worldTransform.scale;
+		in.upperLocal = arm.upper->m_localTransform;
+		in.forearm1Local = arm.forearm1->m_localTransform;
+		in.forearm2Local = in.hasForearmTwist ? arm.forearm2->m_localTransform : arm.forearm1->m_localTransform;
+		in.forearm3Local = in.hasForearmTwist ? arm.forearm3->m_localTransform : arm.forearm1->m_localTransform;
+		in.handLocal = arm.hand->m_localTransform;
+		in.handToForearmLen = vec3_len(arm.hand->m_worldTransform.pos - arm.forearm1->m_worldTransform.pos);
+		in.prevTwistAngle = _prevTwistAngle[limb];
+
+		SolveCache& cache = _cache[limb];
+		cache.beginInputs();
+		cache.addInput(in.handPos);
+		cache.addInput(in.handRot);
+		cache.addInput(in.shoulderWorld);
+		cache.addInput(arm.upper->m_worldTransform);
+		cache.addDirection(in.forwardDir);
+		cache.addInput(in.chestZ);
+		cache.addScale(in.rootScale);
+		cache.addAngle(in.prevTwistAngle);
+		cache.addInput(in.armLength);
+		// the animated locals the solve composes against, same as the legs
+		cache.addInput(in.shoulderLocalRot);
+		cache.addInput(in.upperLocal);
+		cache.addInput(in.forearm1Local);
+		cache.addInput(in.forearm2Local);
+		cache.addInput(in.forearm3Local);
+		cache.addInput(in.handLocal);
+		cache.addInput(in.inPowerArmor ? 1.0f : 0.0f);
+
+		return !cache.tryReuse();
+	}
+
+	void LimbIK::applyArm(ArmJob& job) {
+		ArmNodes& arm = job.arm;
+		ArmIKOutput& out = job.out;
+
+		int limb = job.in.isLeft ? FRIK_LIMB_LEFT_ARM : FRIK_LIMB_RIGHT_ARM;
+		_target[limb] = job.in.handPos;
+		_targetRot[limb] = job.in.handRot;
+		_effector[limb] = arm.hand;
+		_flags[limb] = out.flags | FRIK_IK_SOLVED;
+
+		arm.shoulder->m_localTransform.rot = out.shoulderLocalRot;
+
+		if (out.shoulderOnly) {
+			return;
+		}
+
+		arm.upper->m_localTransform.rot = out.upperLocalRot;
+		arm.forearm1->m_localTransform = out.forearm1Local;
+		if (job.in.hasForearmTwist) {
+			arm.forearm2->m_localTransform = out.forearm2Local;
+			arm.forearm3->m_localTransform = out.forearm3Local;
+		}
+		arm.hand->m_localTransform = out.handLocal;
+		_prevTwistAngle[limb] = out.twistAngle;
+
+		SolveCache& cache = _cache[limb];
+		cache.beginOutputs();
+		cache.addOutput(arm.shoulder);
+		cache.addOutput(arm.upper);
+		cache.addOutput(arm.forearm1);
+		cache.addOutput(arm.forearm2);
+		cache.addOutput(arm.forearm3);
+		cache.addOutput(arm.hand);
+		cache.commit();
+	}
+
+	void LimbIK::beginFrame() {
+		for (auto i = 0; i < FRIK_LIMB_COUNT; i++) {
+			_flags[i] = 0;
+		}
+	}
+
+	void LimbIK::invalidate() {
+		for (auto i = 0; i < FRIK_LIMB_COUNT; i++) {
+			_cache[i].invalidate();
+			_effector[i] = nullptr;
+		}
+	}
+
+	float LimbIK::getResidual(FRIKTelemetryLimb a_limb) {
+		if (!_effector[a_limb]) {
+			return 0.0f;
+		}
+
+		return vec3_len(_effector[a_limb]->m_worldTransform.pos - _target[a_limb]);
+	}
+
+	float LimbIK::getRotationResidual(FRIKTelemetryLimb a_limb) {
+		if (a_limb > FRIK_LIMB_LEFT_ARM || !_effector[a_limb]) {
+			return 0.0f;
+		}
+
+		// trace(A' * B) without building the product, the angle of the rotation between them is acos((trace - 1) / 2)
+		NiMatrix43& hand = _effector[a_limb]->m_worldTransform.rot;
+		NiMatrix43& target = _targetRot[a_limb];
+		float trace = 0.0f;
+		for (auto i = 0; i < 3; i++) {
+			for (auto j = 0; j < 3; j++) {
+				trace += hand.data[i][j] * target.data[i][j];
+			}
+		}
+
+		return rads_to_degrees(acosf(std::clamp((trace - 1.0f) * 0.5f, -1.0f, 1.0f)));
+	}
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include "f4se/NiNodes.h"
+#include "f4se/NiObjects.h"
+
+#include "IKSolver.h"
+#include "SolveCache.h"
+#include "api/FRIKTelemetry.h"
+
+namespace F4VRBody {
+
+	struct ArmNodes {
+		NiAVObject* shoulder;
+		NiAVObject* upper;
+		NiAVObject* upperT1;
+		NiAVObject* forearm1;
+		NiAVObject* forearm2;
+		NiAVObject* forearm3;
+		NiAVObject* hand;
+	};
+
+	// one limb solve - the nodes to write back into plus the snapshot and result for IKSolver
+	struct LegJob {
+		NiNode* hip;
+		NiNode* knee;
+		NiNode* foot;
+		LegIKInput in;
+		LegIKOutput out;
+	};
+
+	struct ArmJob {
+		ArmNodes arm;
+		ArmIKInput in;
+		ArmIKOutput out;
+	};
+
+	// WorkerJob entry points
+	inline void runLegJob(void* a_job) {
+		LegJob* job = (LegJob*)a_job;
+		solveLegIK(job->in, job->out);
+	}
+
+	inline void runArmJob(void* a_job) {
+		ArmJob* job = (ArmJob*)a_job;
+		solveArmIK(job->in, job->out);
+	}
+
+	// The part of a body's ik that only needs the limb nodes, one per body (the player's Skeleton and each ActorBody).
+	// The body fills in what it wants from a limb - the nodes, the target and the body directions - and this reads the rest
+	// off the nodes, checks the limb's SolveCache, writes the result back and keeps the residuals and flags the telemetry
+	// reports.   World transforms are left to the body since the player and the actors update them differently.
+	class LimbIK {
+	public:
+		// job.hip / knee / foot plus in.isLeft, inPowerArmor and footPos are set.   false if last frame's solve was reused
+		bool prepareLeg(LegJob& job);
+		void applyLeg(LegJob& job);
+
+		// job.arm plus in.isLeft, inPowerArmor, handPos, handRot, forwardDir, sidewaysRDir, chestZ, rootScale and armLength
+		// are set
+		bool prepareArm(ArmJob& job);
+		void applyArm(ArmJob& job);
+
+		// a frame the body doesn't solve the limb, the last solve's locals go back over the animated pose.   false if the
+		// limb has no solve to put back
+		bool reapply(FRIKTelemetryLimb a_limb) {
+			return _cache[a_limb].reapply();
+		}
+
+		// once a frame before the solves, flags only say what happened this frame
+		void beginFrame();
+
+		// after teleports or new 3D
+		void invalidate();
+
+		// how far the hand or foot ended up from its ik target.   only meaningful after the world update that follows the solve
+		float getResidual(FRIKTelemetryLimb a_limb);
+
+		// degrees between the hand and the rotation its solve was given, 0 for the feet
+		float getRotationResidual(FRIKTelemetryLimb a_limb);
+
+		// FRIK_IK_* from this frame's solve, 0 if the limb wasn't solved this frame
+		uint32_t getFlags(FRIKTelemetryLimb a_limb) {
+			return _flags[a_limb];
+		}
+
+	private:
+		SolveCache _cache[FRIK_LIMB_COUNT];
+		float _prevTwistAngle[2] = { 0, 0 };
+
+		// where the last solve was asked to put each hand and foot
+		NiPoint3 _target[FRIK_LIMB_COUNT];
+		NiAVObject* _effector[FRIK_LIMB_COUNT] = { nullptr, nullptr, nullptr, nullptr };
+		NiMatrix43 _targetRot[2];
+		uint32_t _flags[FRIK_LIMB_COUNT] = { 0, 0, 0, 0 };
+	};
+}
@@ -0,0 +1,76 @@
+#include "MagazinePool.h"
+
+namespace F4VRBody {
+
+	TESObjectREFR* MagazinePool::resolve(Slot& a_slot) {
+		if (!a_slot.handle) {
+			return nullptr;
+		}
+
+		return _calls.resolve(&a_slot.handle);
+	}
+
+	TESObjectREFR* MagazinePool::create(Slot& a_slot, TESBoundObject* a_object, NiPoint3 a_location, NiPoint3 a_direction) {
+		a_slot = Slot();
+		_calls.create(a_object, a_location, a_direction, &a_slot.handle);
+		a_slot.object = a_object;
+		_created++;
+
+		return resolve(a_slot);
+	}
+
+	void MagazinePool::clear() {
+		for (auto& slot : _slots) {
+			slot = Slot();
+		}
+		_last = -1;
+	}
+
+	TESObjectREFR* MagazinePool::acquire(TESBoundObject* a_object, NiPoint3 a_location, NiPoint3 a_direction) {
+		TESObjectCELL* cell = _calls.getCell();
+		if (cell != _cell) {
+			_cell = cell;
+			clear();
+		}
+
+		int oldest = -1;
+		int oldestMatch = -1;
+		TESObjectREFR* refrs[kCapacity];
+
+		for (auto i = 0; i < kCapacity; i++) {
+			refrs[i] = resolve(_slots[i]);
+			if (!refrs[i]) {
+				// free or unloaded by the game, make a new one here
+				_last = i;
+				TESObjectREFR* refr = create(_slots[i], a_object, a_location, a_direction);
+				_slots[i].lastUsed = ++_uses;
+				if (c_verbose) { _MESSAGE("magazine pool: new reference in slot %d, %d made so far", i, _created); }
+				return refr;
+			}
+
+			if (oldest < 0 || _slots[i].lastUsed < _slots[oldest].lastUsed) {
+				oldest = i;
+			}
+			if (_slots[i].object == a_object && (oldestMatch < 0 || _slots[i].lastUsed < _slots[oldestMatch].lastUsed)) {
+				oldestMatch = i;
+			}
+		}
+
+		// full, take back the magazine of this weapon that has been lying around longest
+		if (oldestMatch >= 0) {
+			_last = oldestMatch;
+			_slots[oldestMatch].lastUsed = ++_uses;
+			_calls.move(refrs[oldestMatch], a_location, a_direction);
+			if (c_verbose) { _MESSAGE("magazine pool: reusing slot %d", oldestMatch); }
+			return refrs[oldestMatch];
+		}
+
+		// none of them is this magazine, the oldest slot gets a new reference instead of the wrong model
+		_calls.retire(refrs[oldest]);
+		_last = oldest;
+		TESObjectREFR* refr = create(_slots[oldest], a_object, a_location, a_direction);
+		_slots[oldest].lastUsed = ++_uses;
+		if (c_verbose) { _MESSAGE("magazine pool: replacing slot %d with another magazine, %d made so far", oldest, _created); }
+		return refr;
+	}
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include "F4VRBody.h"
+
+class TESBoundObject;
+class TESObjectCELL;
+class TESObjectREFR;
+
+namespace F4VRBody {
+
+	// The engine calls MagazinePool makes, the game's come from getGameMagazineCalls() in GunReload.cpp
+	struct MagazineCalls {
+		// the cell the player is in, the pool forgets its slots when it changes
+		TESObjectCELL* (*getCell)();
+
+		// places a new reference and writes its handle
+		void (*create)(TESBoundObject* a_object, NiPoint3 a_location, NiPoint3 a_direction, UInt64* a_handle);
+
+		// nullptr once the game has let go of the reference
+		TESObjectREFR* (*resolve)(UInt64* a_handle);
+
+		void (*move)(TESObjectREFR* a_refr, NiPoint3 a_location, NiPoint3 a_direction);
+
+		// a reference whose slot goes to another magazine
+		void (*retire)(TESObjectREFR* a_refr);
+	};
+
+	MagazineCalls getGameMagazineCalls();
+
+	// The magazine references the reload system drops into the world.   Every reload used to create a new reference and
+	// leak its request structs, now there are at most kCapacity of them: empty or dead slots get a new reference, once
+	// they are all taken the oldest one of the same magazine is moved to the new spot, or if there is none the oldest
+	// slot is hidden and gets a new reference for this magazine.   Slots keep the reference handle rather than the pointer
+	// so references the game has unloaded are noticed, and everything is forgotten when the player changes cell since the
+	// cell takes its temporary references with it.
+	class MagazinePool {
+	public:
+		static const int kCapacity = 4;
+
+		explicit MagazinePool(const MagazineCalls& a_calls) : _calls(a_calls) {}
+
+		// a magazine reference of a_object at a_location facing a_direction, nullptr if the game wouldn't make one
+		TESObjectREFR* acquire(TESBoundObject* a_object, NiPoint3 a_location, NiPoint3 a_direction);
+
+		// the mesh attached to the reference acquire() last returned, nullptr until one has been set
+		NiNode* getMesh() {
+			return _last >= 0 ? _slots[_last].mesh : nullptr;
+		}
+
+		void setMesh(NiNode* a_mesh) {
+			if (_last >= 0) {
+				_slots[_last].mesh = a_mesh;
+			}
+		}
+
+		// slot the reference acquire() last returned is kept in, -1 before the first
+		int getLastSlot() {
+			return _last;
+		}
+
+		// references created this session, for the log
+		UInt32 getCreated() {
+			return _created;
+		}
+
+	private:
+		struct Slot {
+			UInt64 handle = 0;            // written by the create call
+			TESBoundObject* object = nullptr;
+			NiNode* mesh = nullptr;
+			UInt64 lastUsed = 0;
+		};
+
+		TESObjectREFR* resolve(Slot& a_slot);
+		TESObjectREFR* create(Slot& a_slot, TESBoundObject* a_object, NiPoint3 a_location, NiPoint3 a_direction);
+		void clear();
+
+		MagazineCalls _calls;
+		Slot _slots[kCapacity];
+		TESObjectCELL* _cell = nullptr;
+		UInt64 _uses = 0;
+		UInt32 _created = 0;
+		int _last = -1;
+	};
+}
@@ -0,0 +1,86 @@
+#include "PipboyInteraction.h"
+#include "utils.h"
+#include "WorkCounters.h"
+
+namespace F4VRBody {
+
+	NiPoint3 toLocalSpace(NiAVObject* a_node, const NiPoint3& a_world) {
+		NiTransform& world = a_node->m_worldTransform;
+		return world.rot.Transpose() * ((a_world - world.pos) / world.scale);
+	}
+
+	void PipboyInteraction::invalidate() {
+		_bound = false;
+	}
+
+	bool PipboyInteraction::bind(const PipboyAttach& a_attach, float a_touchRange) {
+		bool complete = _touchRoot && _wandPipboy && _screen && _pipboyBone && _fingerBone >= 0;
+
+		// parts of the pipboy can show up a little after the rest, look again every so often until they are all there
+		if (_bound && _attach == a_attach && _touchRange == a_touchRange && (complete || ++_retryFrames < kRetryFrames)) {
+			return _touchRoot != nullptr && _fingerBone >= 0;
+		}
+
+		_bound = true;
+		_retryFrames = 0;
+		_attach = a_attach;
+		_touchRange = a_touchRange;
+		_touchRoot = nullptr;
+		_wandPipboy = nullptr;
+		_screen = nullptr;
+		_pipboyBone = nullptr;
+		_fingerBone = -1;
+
+		// the finger on the other hand does the pointing
+		auto finger = countedFind(boneTreeMap, a_attach.leftHanded ? "LArm_Finger23" : "RArm_Finger23");
+		if (finger != boneTreeMap.end()) {
+			_fingerBone = finger->second;
+		}
+
+		NiNode* shoulder = a_attach.shoulder ? a_attach.shoulder->GetAsNiNode() : nullptr;
+		if (shoulder) {
+			_touchRoot = getChildNode("PipboyRoot", shoulder);
+		}
+
+		if (a_attach.wand) {
+			_wandPipboy = getObjectByName(a_attach.wand, "PipboyRoot_NIF_ONLY");
+		}
+		if (_wandPipboy) {
+			_screen = getObjectByName(_wandPipboy, "Screen:0");
+		}
+
+		NiAVObject* forearm = a_attach.forearm3 ? a_attach.forearm3 : a_attach.forearm1;
+		if (forearm) {
+			_pipboyBone = getObjectByName(forearm, "PipboyBone");
+		}
+
+		// the touch range is a radius in world units, the sphere lives in the root's local space
+		if (_touchRoot) {
+			_touchRegion.center = NiPoint3(0, 0, 0);
+			_touchRegion.radius = a_touchRange / _touchRoot->m_worldTransform.scale;
+		}
+
+		_screenOut = NiPoint3(0, -1, 0);
+
+		if (c_verbose) { _MESSAGE("pipboy bound: root %016I64X screen %016I64X bone %016I64X finger %d", _touchRoot, _screen, _pipboyBone, _fingerBone); }
+		return _touchRoot != nullptr && _fingerBone >= 0;
+	}
+
+	bool PipboyInteraction::isTouching(const NiPoint3& a_fingerWorld) {
+		if (!_touchRoot) {
+			return false;
+		}
+
+		return _touchRegion.contains(toLocalSpace(_touchRoot, a_fingerWorld));
+	}
+
+	bool PipboyInteraction::isLookedAt(const NiPoint3& a_lookDirWorld, float a_gate) {
+		if (!_screen) {
+			return false;
+		}
+
+		// looking at it means looking against the way the screen faces
+		NiPoint3 look = _screen->m_worldTransform.rot.Transpose() * vec3_norm(a_lookDirWorld);
+		return vec3_dot(look, _screenOut) < -a_gate;
+	}
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include "f4se/NiNodes.h"
+#include "f4se/NiObjects.h"
+#include "F4VRBody.h"
+
+#include <map>
+#include <string>
+
+namespace F4VRBody {
+
+	// sphere in a node's local space, same test as the old distance check without the sqrt
+	struct PipboyRegion {
+		NiPoint3 center;
+		float radius = 0.0f;
+
+		bool contains(const NiPoint3& a_local) const {
+			NiPoint3 d = a_local - center;
+			return d.x * d.x + d.y * d.y + d.z * d.z <= radius * radius;
+		}
+	};
+
+	// what the pipboy nodes hang off of.   when any of these change the pipboy 3D was swapped and the nodes are looked up again
+	struct PipboyAttach {
+		NiAVObject* wand = nullptr;          // SecondaryWandNode
+		NiAVObject* wandPipboy = nullptr;    // PlayerNodes::PipboyRoot_nif_only_node
+		NiAVObject* shoulder = nullptr;      // arm the pipboy is on
+		NiAVObject* forearm1 = nullptr;
+		NiAVObject* forearm3 = nullptr;
+		bool leftHanded = false;             // c_leftHandedPipBoy, pipboy on the right arm
+
+		bool operator==(const PipboyAttach& a_other) const {
+			return wand == a_other.wand && wandPipboy == a_other.wandPipboy && shoulder == a_other.shoulder &&
+				   forearm1 == a_other.forearm1 && forearm3 == a_other.forearm3 && leftHanded == a_other.leftHanded;
+		}
+	};
+
+	// Looks up the pipboy nodes once per pipboy 3D instead of every frame and answers the two questions operatePipBoy
+	// asks, is the finger on the pipboy and is the player looking at the screen.   Both are one move into the node's local
+	// space followed by a box or axis check.
+	class PipboyInteraction {
+	public:
+		// cheap when nothing changed
+		bool bind(const PipboyAttach& a_attach, float a_touchRange);
+		void invalidate();
+
+		bool isTouching(const NiPoint3& a_fingerWorld);
+		bool isLookedAt(const NiPoint3& a_lookDirWorld, float a_gate);
+
+		NiAVObject* getTouchRoot() { return _touchRoot; }      // PipboyRoot on the arm
+		NiAVObject* getWandPipboy() { return _wandPipboy; }    // PipboyRoot_NIF_ONLY on the wand
+		NiAVObject* getScreen() { return _screen; }
+		NiAVObject* getPipboyBone() { return _pipboyBone; }
+		int getFingerBone() { return _fingerBone; }        // flattened bone tree index of the pointing fingertip
+
+	private:
+		static const int kRetryFrames = 90;
+
+		bool _bound = false;
+		int _retryFrames = 0;
+		PipboyAttach _attach;
+
+		NiAVObject* _touchRoot = nullptr;
+		NiAVObject* _wandPipboy = nullptr;
+		NiAVObject* _screen = nullptr;
+		NiAVObject* _pipboyBone = nullptr;
+		int _fingerBone = -1;
+
+		float _touchRange = 0.0f;
+		PipboyRegion _touchRegion;    // touchRoot local space
+		NiPoint3 _screenOut;          // screen local space, the way the screen faces
+	};
+
+	extern std::map<std::string, int> boneTreeMap;
+
+	// world point into a node's local space
+	NiPoint3 toLocalSpace(NiAVObject* a_node, const NiPoint3& a_world);
+}
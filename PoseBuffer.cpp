@@ -0,0 +1,109 @@
+#include "PoseBuffer.h"
+
+namespace F4VRBody {
+
+	PoseBuffer* g_poseBuffer = nullptr;
+
+	static const char* poseBoneNames[FRIK_BONE_COUNT] = {
+		nullptr,    // root is the skeleton root itself
+		"COM",
+		"Pelvis",
+		"SPINE1",
+		"SPINE2",
+		"Chest",
+		"Neck",
+		"Head",
+		nullptr,    // arms come from the skeleton's arm nodes
+		nullptr,
+		nullptr,
+		nullptr,
+		nullptr,
+		nullptr,
+		nullptr,
+		nullptr,
+		"RLeg_Thigh",
+		"RLeg_Calf",
+		"RLeg_Foot",
+		"LLeg_Thigh",
+		"LLeg_Calf",
+		"LLeg_Foot",
+	};
+
+	static_assert(sizeof(FRIKPoseTransform) == sizeof(NiTransform), "FRIKPoseTransform has to match NiTransform");
+
+	static void copyTransform(FRIKPoseTransform& a_dst, NiAVObject* a_node) {
+		if (a_node) {
+			memcpy(&a_dst, &a_node->m_worldTransform, sizeof(FRIKPoseTransform));
+		}
+	}
+
+	PoseBuffer::PoseBuffer() {
+		_boundRoot = nullptr;
+		_boundFirstPerson = nullptr;
+		_weapon = nullptr;
+		for (auto i = 0; i < FRIK_BONE_COUNT; i++) {
+			_bones[i] = nullptr;
+		}
+	}
+
+	void PoseBuffer::announce(const char* a_receiver) {
+		g_messaging->Dispatch(g_pluginHandle, FRIK_MESSAGE_POSE_BUFFER, (void*)getBuffer(), sizeof(FRIKPoseBuffer*), a_receiver);
+	}
+
+	void PoseBuffer::bind(Skeleton* a_skelly) {
+		_boundRoot = a_skelly->getRoot();
+
+		for (auto i = 0; i < FRIK_BONE_COUNT; i++) {
+			_bones[i] = poseBoneNames[i] ? a_skelly->getNode(poseBoneNames[i], _boundRoot) : nullptr;
+		}
+		_bones[FRIK_BONE_ROOT] = _boundRoot;
+
+		ArmNodes rightArm = a_skelly->getArm(false);
+		ArmNodes leftArm = a_skelly->getArm(true);
+
+		_bones[FRIK_BONE_RIGHT_CLAVICLE] = rightArm.shoulder;
+		_bones[FRIK_BONE_RIGHT_UPPERARM] = rightArm.upper;
+		_bones[FRIK_BONE_RIGHT_FOREARM] = rightArm.forearm1;
+		_bones[FRIK_BONE_RIGHT_HAND] = rightArm.hand;
+		_bones[FRIK_BONE_LEFT_CLAVICLE] = leftArm.shoulder;
+		_bones[FRIK_BONE_LEFT_UPPERARM] = leftArm.upper;
+		_bones[FRIK_BONE_LEFT_FOREARM] = leftArm.forearm1;
+		_bones[FRIK_BONE_LEFT_HAND] = leftArm.hand;
+
+		_MESSAGE("pose buffer bound to new skeleton");
+	}
+
+	void PoseBuffer::publish(Skeleton* a_skelly) {
+		if (a_skelly->getRoot() != _boundRoot) {
+			bind(a_skelly);
+		}
+
+		NiNode* firstPerson = (*g_player)->firstPersonSkeleton ? (*g_player)->firstPersonSkeleton->GetAsNiNode() : nullptr;
+		if (firstPerson != _boundFirstPerson) {
+			_boundFirstPerson = firstPerson;
+			_weapon = firstPerson ? a_skelly->getNode("Weapon", firstPerson) : nullptr;
+		}
+
+		FRIKPoseFrame& frame = _slots.begin();
+
+		frame.flags = FRIK_POSE_VALID;
+		frame.flags |= a_skelly->inPowerArmor() ? FRIK_POSE_POWER_ARMOR : 0;
+		frame.flags |= c_leftHandedMode ? FRIK_POSE_LEFT_HANDED : 0;
+
+		for (auto i = 0; i < FRIK_BONE_COUNT; i++) {
+			copyTransform(frame.bones[i], _bones[i]);
+		}
+
+		for (auto i = 0; i < FRIK_FINGER_COUNT; i++) {
+			frame.fingerCurl[0][i] = a_skelly->getFingerCurl(false, i);
+			frame.fingerCurl[1][i] = a_skelly->getFingerCurl(true, i);
+		}
+
+		if (_weapon && (*g_player)->actorState.IsWeaponDrawn()) {
+			copyTransform(frame.weaponGrip, _weapon);
+			frame.flags |= FRIK_POSE_HAS_WEAPON;
+		}
+
+		_slots.commit();
+	}
+}
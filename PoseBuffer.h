@@ -0,0 +1,39 @@
+#pragma once
+#include "F4VRBody.h"
+#include "Skeleton.h"
+#include "PoseSlots.h"
+
+namespace F4VRBody {
+
+	// Fills the FRIKPoseBuffer other plugins get through F4SE messaging (layout and reading rules in api/FRIKPoseBuffer.h).
+	// The bone nodes are looked up once per skeleton so publishing is just copying transforms.
+	class PoseBuffer {
+	public:
+		PoseBuffer();
+
+		FRIKPoseBuffer* getBuffer() {
+			return _slots.getBuffer();
+		}
+
+		// send the buffer pointer to anyone listening to F4VRBody, or just to a_receiver when it asked for it
+		void announce(const char* a_receiver = nullptr);
+
+		void publish(Skeleton* a_skelly);
+
+	private:
+		void bind(Skeleton* a_skelly);
+
+		PoseSlots _slots;
+
+		BSFadeNode* _boundRoot;
+		NiAVObject* _bones[FRIK_BONE_COUNT];
+		NiNode* _boundFirstPerson;
+		NiAVObject* _weapon;
+	};
+
+	extern PoseBuffer* g_poseBuffer;
+
+	inline void InitPoseBuffer() {
+		g_poseBuffer = new PoseBuffer();
+	}
+}
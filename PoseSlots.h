@@ -0,0 +1,49 @@
+#pragma once
+#include "F4VRBody.h"
+#include "api/FRIKPoseBuffer.h"
+
+#include <atomic>
+#include <cstring>
+
+namespace F4VRBody {
+
+	// The writing half of FRIKPoseBuffer's double buffering (reading rules in api/FRIKPoseBuffer.h).   begin() hands out
+	// the slot readers weren't pointed at with its frame number zeroed, commit() numbers it and makes it the latest.
+	// Only meant to be written from the main thread.
+	class PoseSlots {
+	public:
+		PoseSlots() {
+			memset(&_buffer, 0, sizeof(FRIKPoseBuffer));
+			_buffer.version = FRIK_POSE_BUFFER_VERSION;
+			_buffer.size = sizeof(FRIKPoseBuffer);
+			_frame = 0;
+			_writing = 0;
+		}
+
+		FRIKPoseBuffer* getBuffer() {
+			return &_buffer;
+		}
+
+		FRIKPoseFrame& begin() {
+			_writing = _buffer.latest ^ 1;
+			FRIKPoseFrame& frame = _buffer.frames[_writing];
+
+			// zero the frame number first so readers off the main thread can tell this slot is being rewritten
+			frame.frameNumber = 0;
+			std::atomic_thread_fence(std::memory_order_release);
+			return frame;
+		}
+
+		void commit() {
+			std::atomic_thread_fence(std::memory_order_release);
+			_buffer.frames[_writing].frameNumber = ++_frame;
+			std::atomic_thread_fence(std::memory_order_release);
+			_buffer.latest = _writing;
+		}
+
+	private:
+		FRIKPoseBuffer _buffer;
+		UInt64 _frame;
+		UInt32 _writing;
+	};
+}
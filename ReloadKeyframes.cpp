@@ -0,0 +1,213 @@
+#include "ReloadKeyframes.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace F4VRBody {
+
+	static const char* reloadBoneNames[kReloadBone_Count] = { "WeaponMagazine", "LArm_Hand", "RArm_Hand" };
+
+	// how far a dropped key may be from what its neighbours interpolate to
+	static const float maxPosError = 0.1f;       // cm
+	static const float minRotDot = 0.99996f;     // ~1 degree
+
+	static Quaternion keyRot(const ReloadKey& a_key) {
+		return Quaternion(a_key.rot[0] / 32767.0f, a_key.rot[1] / 32767.0f, a_key.rot[2] / 32767.0f, a_key.rot[3] / 32767.0f);
+	}
+
+	static void interpolate(const ReloadKey& a_from, const ReloadKey& a_to, float a_time, NiPoint3& a_pos, Quaternion& a_rot) {
+		float span = a_to.time - a_from.time;
+		float t = span > 0.0f ? std::clamp((a_time - a_from.time) / span, 0.0f, 1.0f) : 0.0f;
+
+		a_pos.x = a_from.pos[0] + (a_to.pos[0] - a_from.pos[0]) * t;
+		a_pos.y = a_from.pos[1] + (a_to.pos[1] - a_from.pos[1]) * t;
+		a_pos.z = a_from.pos[2] + (a_to.pos[2] - a_from.pos[2]) * t;
+
+		a_rot = keyRot(a_from);
+		a_rot.slerp(t, keyRot(a_to));
+	}
+
+	static void hashNames(NiAVObject* a_node, UInt32& a_hash) {
+		// FNV-1a over every name, a separator so "ab" + "c" isn't "a" + "bc"
+		for (const char* c = a_node->m_name.c_str(); c && *c; c++) {
+			a_hash = (a_hash ^ (UInt8)*c) * 16777619u;
+		}
+		a_hash = (a_hash ^ '/') * 16777619u;
+
+		NiNode* node = a_node->GetAsNiNode();
+		if (node) {
+			for (auto i = 0; i < node->m_children.m_emptyRunStart; i++) {
+				if (node->m_children.m_data[i]) {
+					hashNames(node->m_children.m_data[i], a_hash);
+				}
+			}
+		}
+	}
+
+	UInt64 ReloadKeyframes::weaponKey(UInt32 a_formId, NiAVObject* a_model) {
+		UInt32 hash = 2166136261u;
+		if (a_model) {
+			hashNames(a_model, hash);
+		}
+		return ((UInt64)a_formId << 32) | hash;
+	}
+
+	bool ReloadKeyframes::bind(UInt32 a_formId, NiNode* a_firstPerson) {
+		if (a_firstPerson != _boundFirstPerson) {
+			_boundFirstPerson = a_firstPerson;
+			_weapon = a_firstPerson ? getChildNode("Weapon", a_firstPerson) : nullptr;
+			_model = nullptr;
+		}
+
+		NiAVObject* model = (_weapon && _weapon->m_children.m_emptyRunStart > 0) ? _weapon->m_children.m_data[0] : nullptr;
+		if (a_formId != _form || model != _model) {
+			_form = a_formId;
+			_model = model;
+			_key = (a_formId && model) ? weaponKey(a_formId, model) : 0;
+
+			// the magazine lives under the model, so the bones are looked up again along with it
+			for (auto i = 0; i < kReloadBone_Count; i++) {
+				_bones[i] = _boundFirstPerson ? getChildNode(reloadBoneNames[i], _boundFirstPerson) : nullptr;
+			}
+
+			if (_capturing && _key != _recordingKey) {
+				if (c_verbose) { _MESSAGE("reload of %08X (parts %08X) not captured, the weapon changed", (UInt32)(_recordingKey >> 32), (UInt32)_recordingKey); }
+				endCapture(false);
+			}
+		}
+
+		return _key != 0;
+	}
+
+	void ReloadKeyframes::beginCapture() {
+		if (!_key || has()) {
+			_capturing = false;
+			return;
+		}
+
+		_recording = ReloadTrack();
+		for (auto& keys : _recording.keys) {
+			keys.reserve(256);
+		}
+		_recordingKey = _key;
+		_capturing = true;
+	}
+
+	void ReloadKeyframes::addFrame(float a_time) {
+		if (!_capturing || !_weapon) {
+			return;
+		}
+
+		NiMatrix43 toWeapon = _weapon->m_worldTransform.rot.Transpose();
+
+		for (auto i = 0; i < kReloadBone_Count; i++) {
+			if (!_bones[i]) {
+				continue;
+			}
+
+			NiPoint3 pos = toWeapon * (_bones[i]->m_worldTransform.pos - _weapon->m_worldTransform.pos) / _weapon->m_worldTransform.scale;
+
+			Matrix44 rot;
+			rot.makeTransformMatrix(_bones[i]->m_worldTransform.rot, NiPoint3(0, 0, 0));
+			Quaternion q;
+			q.fromRot(rot.multiply43Left(toWeapon));
+			q.normalize();
+
+			ReloadKey key;
+			key.time = a_time;
+			key.pos[0] = pos.x;
+			key.pos[1] = pos.y;
+			key.pos[2] = pos.z;
+			key.rot[0] = (int16_t)(std::clamp(q.x, -1.0f, 1.0f) * 32767.0f);
+			key.rot[1] = (int16_t)(std::clamp(q.y, -1.0f, 1.0f) * 32767.0f);
+			key.rot[2] = (int16_t)(std::clamp(q.z, -1.0f, 1.0f) * 32767.0f);
+			key.rot[3] = (int16_t)(std::clamp(q.w, -1.0f, 1.0f) * 32767.0f);
+			_recording.keys[i].push_back(key);
+		}
+
+		_recording.length = (std::max)(_recording.length, a_time);
+	}
+
+	void ReloadKeyframes::endCapture(bool a_complete) {
+		if (!_capturing) {
+			return;
+		}
+		_capturing = false;
+
+		if (!a_complete) {
+			_recording = ReloadTrack();
+			return;
+		}
+
+		size_t raw = 0;
+		size_t kept = 0;
+		for (auto& keys : _recording.keys) {
+			raw += keys.size();
+			compress(keys);
+			keys.shrink_to_fit();
+			kept += keys.size();
+		}
+
+		if (!kept) {
+			return;
+		}
+
+		_MESSAGE("reload of %08X (parts %08X) captured: %.2f s, %d of %d keys kept", (UInt32)(_recordingKey >> 32), (UInt32)_recordingKey,
+			_recording.length, (int)kept, (int)raw);
+		_tracks[_recordingKey] = std::move(_recording);
+	}
+
+	// greedy: from the last kept key, reach as far forward as the straight interpolation stays within tolerance
+	void ReloadKeyframes::compress(std::vector<ReloadKey>& a_keys) {
+		if (a_keys.size() < 3) {
+			return;
+		}
+
+		std::vector<ReloadKey> out;
+		out.push_back(a_keys[0]);
+
+		size_t anchor = 0;
+		for (size_t end = 2; end < a_keys.size(); end++) {
+			bool fits = true;
+			for (size_t k = anchor + 1; k < end && fits; k++) {
+				NiPoint3 pos;
+				Quaternion rot;
+				interpolate(a_keys[anchor], a_keys[end], a_keys[k].time, pos, rot);
+
+				NiPoint3 actual(a_keys[k].pos[0], a_keys[k].pos[1], a_keys[k].pos[2]);
+				fits = vec3_len(pos - actual) <= maxPosError && fabs(rot.dot(keyRot(a_keys[k]))) >= minRotDot;
+			}
+
+			if (!fits) {
+				anchor = end - 1;
+				out.push_back(a_keys[anchor]);
+			}
+		}
+
+		out.push_back(a_keys.back());
+		a_keys.swap(out);
+	}
+
+	bool ReloadKeyframes::sample(ReloadBone a_bone, float a_time, NiTransform& a_out) {
+		auto found = _key ? _tracks.find(_key) : _tracks.end();
+		if (found == _tracks.end() || found->second.keys[a_bone].empty()) {
+			return false;
+		}
+
+		auto& keys = found->second.keys[a_bone];
+		auto next = std::upper_bound(keys.begin(), keys.end(), a_time, [](float t, const ReloadKey& key) { return t < key.time; });
+
+		const ReloadKey& to = next == keys.end() ? keys.back() : *next;
+		const ReloadKey& from = next == keys.begin() ? keys.front() : *(next - 1);
+
+		NiPoint3 pos;
+		Quaternion rot;
+		interpolate(from, to, a_time, pos, rot);
+
+		a_out.pos = pos;
+		a_out.rot = rot.getRot().make43();
+		a_out.scale = 1.0f;
+		return true;
+	}
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include "F4VRBody.h"
+#include "Quaternion.h"
+
+#include <unordered_map>
+#include <vector>
+
+namespace F4VRBody {
+
+	// the bones a reload moves that anything showing the reload cares about
+	enum ReloadBone {
+		kReloadBone_Magazine = 0,
+		kReloadBone_LeftHand,
+		kReloadBone_RightHand,
+		kReloadBone_Count
+	};
+
+	struct ReloadKey {
+		float time;            // seconds since the reload started
+		float pos[3];
+		int16_t rot[4];        // quaternion x y z w / 32767
+	};
+
+	// One weapon's reload, each bone relative to the Weapon node so it plays back wherever the weapon is held.
+	// Keys that the neighbours already interpolate to within tolerance are dropped when the capture ends.
+	struct ReloadTrack {
+		float length = 0.0f;
+		std::vector<ReloadKey> keys[kReloadBone_Count];
+	};
+
+	// Reload animations captured the first time a weapon reloads.   Tracks are keyed by the weapon form and the parts
+	// modded onto it, since a different receiver or magazine reloads differently.   Nothing in the reload path records or
+	// plays these back yet, the capture needs the animation graph held through g_animDeltaTime and that only comes back
+	// together with something that samples the tracks.
+	class ReloadKeyframes {
+	public:
+		// once a frame before anything else.   Finds the Weapon node and the bones again whenever the first person skeleton,
+		// the equipped form or the model under Weapon changes, and drops a recording that was for the weapon before.
+		// false if there is no weapon to key a track to
+		bool bind(UInt32 a_formId, NiNode* a_firstPerson);
+
+		// the bound weapon has a track
+		bool has() {
+			return _key && _tracks.find(_key) != _tracks.end();
+		}
+
+		// starts recording the bound weapon unless it already has a track
+		void beginCapture();
+
+		// one frame of the live animation, a_time is seconds since the reload started
+		void addFrame(float a_time);
+
+		// a_complete when the reload played to its end, then the recording is compressed and kept.   Anything else is
+		// thrown away, a track missing its end would be played back as the whole reload
+		void endCapture(bool a_complete);
+
+		bool isCapturing() {
+			return _capturing;
+		}
+
+		// a_bone of the bound weapon's track at a_time relative to the Weapon node, false if it has no track
+		bool sample(ReloadBone a_bone, float a_time, NiTransform& a_out);
+
+		// form id in the high half, hash of the node names under the model in the low half
+		static UInt64 weaponKey(UInt32 a_formId, NiAVObject* a_model);
+
+	private:
+		static void compress(std::vector<ReloadKey>& a_keys);
+
+		std::unordered_map<UInt64, ReloadTrack> _tracks;
+		ReloadTrack _recording;
+		UInt64 _recordingKey = 0;
+		bool _capturing = false;
+
+		NiNode* _boundFirstPerson = nullptr;
+		UInt32 _form = 0;
+		NiAVObject* _model = nullptr;
+		UInt64 _key = 0;
+		NiNode* _weapon = nullptr;
+		NiNode* _bones[kReloadBone_Count] = {};
+	};
+}
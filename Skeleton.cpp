@@ -4,13 +4,22 @@
 #include "weaponOffset.h"
 #include "f4se/GameForms.h"
 #include "VR.h"
+#include "TrackedBody.h"
+#include "FingerTracking.h"
+#include "FrameGovernor.h"
+#include "WorkCounters.h"
+#include "BetterScopesChannel.h"
+#include "Haptics.h"
+#include "HeightField.h"
+#include "PipboyInteraction.h"
+#include "Visibility.h"
+#include "WeaponFeatures.h"
 
 #include <chrono>
 #include <time.h>
 #include <string.h>
 
 extern PapyrusVRAPI* g_papyrusvr;
-extern OpenVRHookManagerAPI* vrhook;
 
 using namespace std::chrono;
 namespace F4VRBody
@@ -85,48 +94,6 @@ namespace F4VRBody
 
 
 
-	void Skeleton::printChildren(NiNode* child, std::string padding) {
-		padding += "....";
-		_MESSAGE("%s%s : children = %d %d: %2f %2f %2f %2f %2f %2f", padding.c_str(), child->m_name.c_str(), child->m_children.m_emptyRunStart, (child->flags & 0x1),
-			child->m_localTransform.pos.x,
-			child->m_localTransform.pos.y,
-			child->m_localTransform.pos.z,
-			child->m_worldTransform.pos.x,
-			child->m_worldTransform.pos.y,
-			child->m_worldTransform.pos.z);
-
-		//_MESSAGE("%s%s : children = %d : worldbound %f %f %f %f", padding.c_str(), child->m_name.c_str(), child->m_children.m_emptyRunStart,
-		//	child->m_worldBound.m_kCenter.x, child->m_worldBound.m_kCenter.y, child->m_worldBound.m_kCenter.z, child->m_worldBound.m_fRadius);
-
-		if (child->GetAsNiNode())
-		{
-			for (auto i = 0; i < child->m_children.m_emptyRunStart; ++i) {
-				//auto nextNode = child->m_children.m_data[i] ? child->m_children.m_data[i]->GetAsNiNode() : nullptr;
-				auto nextNode = child->m_children.m_data[i];
-				if (nextNode) {
-					this->printChildren((NiNode*)nextNode, padding);
-				}
-			}
-		}
-	}
-
-
-	void Skeleton::printNodes(NiNode* nde) {
-		// print root node info first
-		_MESSAGE("%s : children = %d %d: local %f %f %f", nde->m_name.c_str(), nde->m_children.m_emptyRunStart, (nde->flags & 0x1),
-			nde->m_localTransform.pos.x,nde->m_localTransform.pos.y,nde->m_localTransform.pos.z);
-
-		std::string padding = "";
-
-		for (auto i = 0; i < nde->m_children.m_emptyRunStart; ++i) {
-		//	auto nextNode = nde->m_children.m_data[i] ? nde->m_children.m_data[i]->GetAsNiNode() : nullptr;
-			auto nextNode = nde->m_children.m_data[i];
-			if (nextNode) {
-				this->printChildren((NiNode*)nextNode, padding);
-			}
-		}
-	}
-
 	void Skeleton::rotateWorld(NiNode *nde) {
 		Matrix44* result = new Matrix44();
 		Matrix44 mat;
@@ -179,14 +146,12 @@ namespace F4VRBody
 	}
 
 	void Skeleton::updateDown(NiNode* nde, bool updateSelf) {
-		NiAVObject::NiUpdateData* ud = nullptr;
-
 		if (!nde) {
 			return;
 		}
 
 		if (updateSelf) {
-			nde->UpdateWorldData(ud);
+			updateWorldData(nde);
 //			updateTransforms(nde);
 		}
 
@@ -198,7 +163,7 @@ namespace F4VRBody
 			auto triNode = nde->m_children.m_data[i] ? nde->m_children.m_data[i]->GetAsBSGeometry() : nullptr;
 			if (triNode) {
 				//updateTransforms((NiNode*)triNode);
-				triNode->UpdateWorldData(ud);
+				updateWorldData(triNode);
 			}
 		}
 	}
@@ -209,10 +174,8 @@ namespace F4VRBody
 			return;
 		}
 
-		NiAVObject::NiUpdateData* ud = nullptr;
-
 		if (updateSelf) {
-			fromNode->UpdateWorldData(ud);
+			updateWorldData(fromNode);
 		}
 
 		if (!_stricmp(toNode->m_name.c_str(), fromNode->m_name.c_str())) {
@@ -233,17 +196,14 @@ namespace F4VRBody
 			return;
 		}
 
-		NiAVObject::NiUpdateData* ud = nullptr;
-
-
 		if (!_stricmp(toNode->m_name.c_str(), fromNode->m_name.c_str())) {
 			if (updateTarget) {
-				fromNode->UpdateWorldData(ud);
+				updateWorldData(fromNode);
 			}
 			return;
 		}
 
-		fromNode->UpdateWorldData(ud);
+		updateWorldData(fromNode);
 		NiNode* parent = fromNode->m_parent ? fromNode->m_parent->GetAsNiNode() : 0;
 		if (!parent) {
 			return;
@@ -260,6 +220,22 @@ namespace F4VRBody
 
 		//also save last position at this time for anyone doing speed calcs
 		_lastPos = _curPos;
+
+		// teleports and cell changes make the saved IK solves useless
+		NiPoint3 camPos = (*g_playerCamera)->cameraNode->m_worldTransform.pos;
+		if (((*g_player)->parentCell != _lastCell) || (vec3_len(camPos - _lastPos) > 200.0f)) {
+			_lastCell = (*g_player)->parentCell;
+			invalidateSolveCaches();
+		}
+
+		_limbs.beginFrame();
+	}
+
+	void Skeleton::invalidateSolveCaches() {
+		_underHMDCache.invalidate();
+		_postureCache.invalidate();
+		_limbs.invalidate();
+		_postureEffector = nullptr;
 	}
 
 	void Skeleton::selfieSkelly(float offsetOutFront) {    // Projects the 3rd person body out in front of the player by offset amount
@@ -289,11 +265,18 @@ namespace F4VRBody
 	}
 
 	NiNode* Skeleton::getNode(const char* nodeName, NiNode* nde) {
+		g_workCounters.add(kWork_NodeLookups);
+		return this->findNode(nodeName, nde);
+	}
+
+	NiNode* Skeleton::findNode(const char* nodeName, NiNode* nde) {
 
 		if (!nde || !nde->m_name) {
 			return nullptr;
 		}
 
+		g_workCounters.add(kWork_NodesVisited);
+
 		if (!_stricmp(nodeName, nde->m_name.c_str())) {
 			return nde;
 		}
@@ -303,7 +286,7 @@ namespace F4VRBody
 		for (auto i = 0; i < nde->m_children.m_emptyRunStart; ++i) {
 			auto nextNode = nde->m_children.m_data[i] ? nde->m_children.m_data[i]->GetAsNiNode() : nullptr;
 			if (nextNode) {
-				ret = this->getNode(nodeName, nextNode);
+				ret = this->findNode(nodeName, nextNode);
 				if (ret) {
 					return ret;
 				}
@@ -354,9 +337,7 @@ namespace F4VRBody
 //		}
 
 
-		NiAVObject::NiUpdateData* ud = nullptr;
-
-		headNode->UpdateWorldData(ud);
+		updateWorldData(headNode);
 	}
 
 	void Skeleton::insertSaveState(std::string name, NiNode* node) {
@@ -522,12 +503,17 @@ namespace F4VRBody
 		QueryPerformanceFrequency(&freqCounter);
 		QueryPerformanceCounter(&timer);
 
-		std::srand(time(NULL));
-
 		_offHandGripping = false;
 		_hasLetGoGripButton = false;
 
-		_prevSpeed = 0.0;
+		_gait.reset(g_gaitTables.seed);
+		_pipboy.invalidate();
+		_visibility.invalidate();
+		_leftFootNode = getNode("LLeg_Foot", _root);
+		_rightFootNode = getNode("RLeg_Foot", _root);
+
+		// new 3d so anything saved off from the old nodes is stale
+		invalidateSolveCaches();
 
 		_playerNodes = (PlayerNodes*)((char*)(*g_player) + 0x6E0);
 
@@ -564,38 +550,23 @@ namespace F4VRBody
 		_weaponEquipped = false;
 
 		// Setup Arms
-		BSFixedString rCollar("RArm_Collarbone");
-		BSFixedString rUpper("RArm_UpperArm");
-		BSFixedString rUpper1("RArm_UpperTwist1");
-		BSFixedString rForearm1("RArm_ForeArm1");
-		BSFixedString rForearm2("RArm_ForeArm2");
-		BSFixedString rForearm3("RArm_ForeArm3");
-		BSFixedString rHand("RArm_Hand");
-		BSFixedString lCollar("LArm_Collarbone");
-		BSFixedString lUpper("LArm_UpperArm");
-		BSFixedString lUpper1("LArm_UpperTwist1");
-		BSFixedString lForearm1("LArm_ForeArm1");
-		BSFixedString lForearm2("LArm_ForeArm2");
-		BSFixedString lForearm3("LArm_ForeArm3");
-		BSFixedString lHand("LArm_Hand");
-
 		_MESSAGE("set arm nodes");
 
-		rightArm.shoulder  = _common->GetObjectByName(&rCollar);
-		rightArm.upper     = _common->GetObjectByName(&rUpper);
-		rightArm.upperT1   = _common->GetObjectByName(&rUpper1);
-		rightArm.forearm1  = _common->GetObjectByName(&rForearm1);
-		rightArm.forearm2  = _common->GetObjectByName(&rForearm2);
-		rightArm.forearm3  = _common->GetObjectByName(&rForearm3);
-		rightArm.hand      = _common->GetObjectByName(&rHand);
-
-		leftArm.shoulder   = _common->GetObjectByName(&lCollar);
-		leftArm.upper      = _common->GetObjectByName(&lUpper);
-		leftArm.upperT1    = _common->GetObjectByName(&lUpper1);
-		leftArm.forearm1   = _common->GetObjectByName(&lForearm1);
-		leftArm.forearm2   = _common->GetObjectByName(&lForearm2);
-		leftArm.forearm3   = _common->GetObjectByName(&lForearm3);
-		leftArm.hand       = _common->GetObjectByName(&lHand);
+		rightArm.shoulder  = getObjectByName(_common, "RArm_Collarbone");
+		rightArm.upper     = getObjectByName(_common, "RArm_UpperArm");
+		rightArm.upperT1   = getObjectByName(_common, "RArm_UpperTwist1");
+		rightArm.forearm1  = getObjectByName(_common, "RArm_ForeArm1");
+		rightArm.forearm2  = getObjectByName(_common, "RArm_ForeArm2");
+		rightArm.forearm3  = getObjectByName(_common, "RArm_ForeArm3");
+		rightArm.hand      = getObjectByName(_common, "RArm_Hand");
+
+		leftArm.shoulder   = getObjectByName(_common, "LArm_Collarbone");
+		leftArm.upper      = getObjectByName(_common, "LArm_UpperArm");
+		leftArm.upperT1    = getObjectByName(_common, "LArm_UpperTwist1");
+		leftArm.forearm1   = getObjectByName(_common, "LArm_ForeArm1");
+		leftArm.forearm2   = getObjectByName(_common, "LArm_ForeArm2");
+		leftArm.forearm3   = getObjectByName(_common, "LArm_ForeArm3");
+		leftArm.hand       = getObjectByName(_common, "LArm_Hand");
 
 		_MESSAGE("finished set arm nodes");
 
@@ -619,6 +590,7 @@ namespace F4VRBody
 		//}
 
 		_handBones = handOpen;
+		memset(_fingerCurl, 0, sizeof(_fingerCurl));
 
 		// setup hand bones to openvr button mapping
 		_handBonesButton["LArm_Finger11"] = vr::k_EButton_SteamVR_Touchpad;
@@ -657,6 +629,7 @@ namespace F4VRBody
 		_MESSAGE("finished saving tree");
 
 		initBoneTreeMap(_root);
+		g_fingerTracking->remap((BSFlattenedBoneTree*)_root);
 		return true;
 	}
 
@@ -769,7 +742,7 @@ namespace F4VRBody
 		return degrees_to_rads(angle);
 	}
 
-	void Skeleton::setUnderHMD(float groundHeight) {
+	void Skeleton::setUnderHMD() {
 
 		detectInPowerArmor();
 
@@ -790,6 +763,22 @@ namespace F4VRBody
 		float neckYaw   = getNeckYaw();
 		float neckPitch   = getNeckPitch();
 
+		NiNode* body = _root->m_parent->GetAsNiNode();
+
+		_underHMDCache.beginInputs();
+		_underHMDCache.addInput(_playerNodes->HmdNode->m_localTransform.rot);
+		_underHMDCache.addAngle(neckYaw);
+		_underHMDCache.addAngle(neckPitch);
+		_underHMDCache.addInput(body->m_worldTransform);
+		_underHMDCache.addInput(getPosition());
+		_underHMDCache.addInput(_playerNodes->playerworldnode->m_localTransform.pos.z);
+		_underHMDCache.addInput(z);
+		_underHMDCache.addInput(c_playerHeight);
+
+		if (_underHMDCache.tryReuse()) {
+			return;
+		}
+
 		Quaternion qa;
 		qa.setAngleAxis(-neckPitch, NiPoint3(-1, 0, 0));
 
@@ -799,7 +788,6 @@ namespace F4VRBody
 		_forwardDir = rotateXY(NiPoint3(newRot.data[1][0], newRot.data[1][1], 0), neckYaw * 0.7);
 		_sidewaysRDir = NiPoint3(_forwardDir.y, -_forwardDir.x, 0);
 
-		NiNode* body = _root->m_parent->GetAsNiNode();
 		body->m_localTransform.pos *= 0.0f;
 		body->m_worldTransform.pos.x = this->getPosition().x;
 		body->m_worldTransform.pos.y = this->getPosition().y;
@@ -815,6 +803,13 @@ namespace F4VRBody
 		//_root->m_localTransform.pos *= 0.0f;
 		//_root->m_localTransform.pos.y = c_playerOffset_forward - 6.0f;
 		_root->m_localTransform.scale = c_playerHeight / defaultCameraHeight;    // set scale based off specified user height
+
+		_underHMDCache.beginOutputs();
+		_underHMDCache.addOutput(body, true);
+		_underHMDCache.addOutput(_root);
+		_underHMDCache.addOutput(&_forwardDir);
+		_underHMDCache.addOutput(&_sidewaysRDir);
+		_underHMDCache.commit();
 	}
 
 	void Skeleton::setBodyPosture() {
@@ -829,6 +824,28 @@ namespace F4VRBody
 		_leftKneePos = getNode("LLeg_Calf", com)->m_worldTransform.pos;
 		_rightKneePos = getNode("RLeg_Calf", com)->m_worldTransform.pos;
 
+		_postureCache.beginInputs();
+		_postureCache.addInput(camera->m_worldTransform.pos);
+		_postureCache.addAngle(neckPitch);
+		_postureCache.addAngle(bodyPitch);
+		_postureCache.addDirection(_forwardDir);
+		_postureCache.addInput(com->m_worldTransform);
+		_postureCache.addInput(neck->m_worldTransform.pos);
+		_postureCache.addInput(spine->m_worldTransform.rot);
+		_postureCache.addInput(spine->m_parent->m_worldTransform.rot);
+		_postureCache.addInput(_root->m_worldTransform.rot);
+		_postureCache.addScale(_root->m_localTransform.scale);
+		_postureCache.addInput(c_playerOffset_up);
+		_postureCache.addInput(c_playerOffset_forward);
+		_postureCache.addInput(c_powerArmor_forward);
+		_postureCache.addInput(c_powerArmor_up);
+		_postureCache.addInput(c_PACameraHeight);
+		_postureCache.addInput(_inPowerArmor ? 1.0f : 0.0f);
+
+		if (_postureCache.tryReuse()) {
+			return;
+		}
+
 		float comZ = com->m_localTransform.pos.z;
 		com->m_localTransform.pos.x = 0.0;
 		com->m_localTransform.pos.y = 0.0;
@@ -836,6 +853,8 @@ namespace F4VRBody
 		float z_adjust = c_playerOffset_up - cosf(neckPitch) * (5.0 * _root->m_localTransform.scale);
 		NiPoint3 neckAdjust = NiPoint3(-_forwardDir.x * c_playerOffset_forward / 2, -_forwardDir.y * c_playerOffset_forward / 2, z_adjust);
 		NiPoint3 neckPos = camera->m_worldTransform.pos + neckAdjust;
+		_postureTarget = neckPos;
+		_postureEffector = neck;
 
 		_torsoLen = vec3_len(neck->m_worldTransform.pos - com->m_worldTransform.pos);
 
@@ -862,9 +881,56 @@ namespace F4VRBody
 		rot.makeTransformMatrix(mat, NiPoint3(0, 0, 0));
 		spine->m_localTransform.rot = rot.multiply43Right(spine->m_worldTransform.rot);
 
+		_postureCache.beginOutputs();
+		_postureCache.addOutput(com);
+		_postureCache.addOutput(spine);
+		_postureCache.addOutput(&_torsoLen);
+		_postureCache.commit();
 	}
 
 
+	// hips follow the waist tracker, the spine is still bent to meet the neck under the hmd
+	bool Skeleton::setTrackedPosture() {
+		if (!g_trackedBody->isActive(kTracked_Waist)) {
+			return false;
+		}
+
+		float neckPitch = getNeckPitch();
+
+		NiNode* camera = (*g_playerCamera)->cameraNode;
+		NiNode* com = getNode("COM", _root);
+		NiNode* neck = getNode("Neck", _root);
+		NiNode* spine = getNode("SPINE1", _root);
+
+		_leftKneePos = getNode("LLeg_Calf", com)->m_worldTransform.pos;
+		_rightKneePos = getNode("RLeg_Calf", com)->m_worldTransform.pos;
+
+		// the heuristic posture has to solve again once the tracker drops out
+		_postureCache.invalidate();
+
+		float z_adjust = c_playerOffset_up - cosf(neckPitch) * (5.0 * _root->m_localTransform.scale);
+		NiPoint3 neckAdjust = NiPoint3(-_forwardDir.x * c_playerOffset_forward / 2, -_forwardDir.y * c_playerOffset_forward / 2, z_adjust);
+		NiPoint3 neckPos = camera->m_worldTransform.pos + neckAdjust;
+		_postureTarget = neckPos;
+		_postureEffector = neck;
+
+		_torsoLen = vec3_len(neck->m_worldTransform.pos - com->m_worldTransform.pos);
+
+		NiPoint3 hipPos = g_trackedBody->getTarget(kTracked_Waist);
+		NiPoint3 hmdToHip = neckPos - com->m_worldTransform.pos;
+
+		NiNode* comParent = com->m_parent->GetAsNiNode();
+		com->m_localTransform.pos += comParent->m_worldTransform.rot.Transpose() * ((hipPos - com->m_worldTransform.pos) / comParent->m_worldTransform.scale);
+
+		Matrix44 rot;
+		rot.rotateVectoVec(neckPos - hipPos, hmdToHip);
+		NiMatrix43 mat = rot.multiply43Left(spine->m_parent->m_worldTransform.rot.Transpose());
+		rot.makeTransformMatrix(mat, NiPoint3(0, 0, 0));
+		spine->m_localTransform.rot = rot.multiply43Right(spine->m_worldTransform.rot);
+
+		return true;
+	}
+
 	//void Skeleton::setBodyPosture() {
 	//	float neckPitch = getNeckPitch();
 	//	float bodyPitch = (std::min)(getBodyPitch(), 0.6f);
@@ -987,208 +1053,99 @@ namespace F4VRBody
 		}
 	}
 
-	void Skeleton::walk() {
-
-		NiNode* lHip = getNode("LLeg_Thigh", _root);
-		NiNode* rHip = getNode("RLeg_Thigh", _root);
+	// shift a foot target by how much higher or lower the land under it is than the land under the body, keeps any step lift
+	void Skeleton::projectOnTerrain(NiPoint3& foot, float landZ) {
+		float height;
 
-		if (!lHip || !rHip) {
+		if (!g_heightField->getHeight(foot.x, foot.y, &height)) {
 			return;
 		}
 
-		NiNode* lKnee = getNode("LLeg_Calf", lHip);
-		NiNode* rKnee = getNode("RLeg_Calf", rHip);
-		NiNode* lFoot = getNode("LLeg_Foot", lHip);
-		NiNode* rFoot = getNode("RLeg_Foot", rHip);
-
-		if (!lKnee || !rKnee || !lFoot || !rFoot) {
-			return;
+		float offset = height - landZ;
+		if (fabs(offset) < c_terrainFootRange) {
+			foot.z += offset;
 		}
+	}
 
-		// move feet closer togther
-		NiPoint3 leftToRight = _inPowerArmor ?  (rFoot->m_worldTransform.pos - lFoot->m_worldTransform.pos) * -0.15 : (rFoot->m_worldTransform.pos - lFoot->m_worldTransform.pos) * 0.3;
-		lFoot->m_worldTransform.pos += leftToRight;
-		rFoot->m_worldTransform.pos -= leftToRight;
+	static GaitVec toGait(const NiPoint3& a_pos) {
+		return GaitVec(a_pos.x, a_pos.y, a_pos.z);
+	}
 
-		// want to calculate direction vector first.     Will only concern with x-y vector to start.
-		NiPoint3 lastPos = _lastPos;
-		NiPoint3 curPos = _curPos;
-		curPos.z = 0;
-		lastPos.z = 0;
-
-		NiPoint3 dir = curPos - lastPos;
-
-		double curSpeed;
-
-		curSpeed = std::clamp((abs(vec3_len(dir)) / _frameTime), 0.0, 350.0);
-		if (_prevSpeed > 20.0) {
-			curSpeed = (curSpeed + _prevSpeed) / 2;
-		}
-		_prevSpeed = curSpeed;
-
-		double stepTime = std::clamp(cos(curSpeed / 140.0), 0.28, 0.50);
-		dir = vec3_norm(dir);
-
-		static float spineAngle = 0.0;
-
-		// setup current walking state based on velocity and previous state
-		if (!c_jumping) {
-			switch (_walkingState) {
-			case 0: {
-				if (curSpeed >= 35.0) {
-					_walkingState = 1;          // start walking
-					_footStepping = std::rand() % 2 + 1;    // pick a random foot to take a step
-					_stepDir = dir;
-					_stepTimeinStep = stepTime;
-					delayFrame = 2;
-
-					if (_footStepping == 1) {
-						_rightFootTarget = rFoot->m_worldTransform.pos + _stepDir * (curSpeed * stepTime * 1.5);
-						_rightFootStart = rFoot->m_worldTransform.pos;
-						_leftFootTarget = lFoot->m_worldTransform.pos;
-						_leftFootStart = lFoot->m_worldTransform.pos;
-						_leftFootPos = _leftFootStart;
-						_rightFootPos = _rightFootStart;
-					}
-					else {
-						_rightFootTarget = rFoot->m_worldTransform.pos;
-						_rightFootStart = rFoot->m_worldTransform.pos;
-						_leftFootTarget = lFoot->m_worldTransform.pos + _stepDir * (curSpeed * stepTime * 1.5);
-						_leftFootStart = lFoot->m_worldTransform.pos;
-						_leftFootPos = _leftFootStart;
-						_rightFootPos = _rightFootStart;
-					}
-					_currentStepTime = stepTime / 2;
-					break;
-				}
-				_currentStepTime = 0.0;
-				_footStepping = 0;
-				spineAngle = 0.0;
-				break;
-			}
-			case 1: {
-				if (curSpeed < 20.0) {
-					_walkingState = 2;          // begin process to stop walking
-					_currentStepTime = 0.0;
-				}
-				break;
-			}
-			case 2: {
-				if (curSpeed >= 20.0) {
-					_walkingState = 1;         // resume walking
-					_currentStepTime = 0.0;
-				}
-				break;
-			}
-			default: {
-				_walkingState = 0;
-				break;
-			}
+	static NiPoint3 fromGait(const GaitVec& a_pos) {
+		return NiPoint3(a_pos.x, a_pos.y, a_pos.z);
+	}
+
+	void Skeleton::walk() {
+
+		if (!_leftFootNode || !_rightFootNode) {
+			_leftFootNode = getNode("LLeg_Foot", _root);
+			_rightFootNode = getNode("RLeg_Foot", _root);
+
+			if (!_leftFootNode || !_rightFootNode) {
+				return;
 			}
 		}
-		else {
-			_walkingState = 0;
-		}
 
-		if (_walkingState == 0) {
-			// we're standing still so just set foot positions accordingly.
-			_leftFootPos = lFoot->m_worldTransform.pos;
-			_rightFootPos = rFoot->m_worldTransform.pos;
-			_leftFootPos.z = _root->m_worldTransform.pos.z;
-			_rightFootPos.z = _root->m_worldTransform.pos.z;
+		NiNode* lFoot = _leftFootNode;
+		NiNode* rFoot = _rightFootNode;
 
-			return;
-		}
-		else if (_walkingState == 1) {
-			NiPoint3 dirOffset = dir - _stepDir;
-			float dot = vec3_dot(dir, _stepDir);
-			double scale = (std::min)(curSpeed * stepTime * 1.5, 140.0);
-			dirOffset = dirOffset * scale;
+		// move feet closer togther
+		NiPoint3 leftToRight = _inPowerArmor ?  (rFoot->m_worldTransform.pos - lFoot->m_worldTransform.pos) * -0.15 : (rFoot->m_worldTransform.pos - lFoot->m_worldTransform.pos) * 0.3;
+		lFoot->m_worldTransform.pos += leftToRight;
+		rFoot->m_worldTransform.pos -= leftToRight;
 
-			int sign = 1;
+		GaitInput in;
+		in.moved = toGait(_curPos - _lastPos);
+		in.frameTime = _frameTime;
+		in.jumping = c_jumping;
+		in.groundZ = _root->m_worldTransform.pos.z;
+		in.leftFoot = toGait(lFoot->m_worldTransform.pos);
+		in.rightFoot = toGait(rFoot->m_worldTransform.pos);
 
-			_currentStepTime += _frameTime;
+		GaitOutput out;
+		_gait.update(g_gaitTables, in, out);
 
-			double frameStep = _frameTime / (_stepTimeinStep);
-			double interp = std::clamp(frameStep * (_currentStepTime / _frameTime), 0.0, 1.0);
+		_leftFootPos = fromGait(out.leftFoot);
+		_rightFootPos = fromGait(out.rightFoot);
 
-			if (_footStepping == 1) {
-				sign = -1;
-				if (dot < 0.9) {
-					if (!delayFrame) {
-						_rightFootTarget += dirOffset;
-						_stepDir = dir;
-						delayFrame = 2;
-					}
-					else {
-						delayFrame--;
-					}
-				}
-				else {
-					delayFrame = delayFrame == 2 ? delayFrame : delayFrame + 1;
-				}
-				_rightFootTarget.z = _root->m_worldTransform.pos.z;
-				_rightFootStart.z = _root->m_worldTransform.pos.z;
-				_rightFootPos = _rightFootStart + ((_rightFootTarget - _rightFootStart) * interp);
-				double stepAmount = std::clamp(vec3_len(_rightFootTarget - _rightFootStart) / 150.0, 0.0, 1.0);
-				double stepHeight = (std::max)(stepAmount * 9.0, 1.0);
-				float up = sinf(interp * PI) * stepHeight;
-				_rightFootPos.z += up;
-			}
-			else {
-				if (dot < 0.9) {
-					if (!delayFrame) {
-						_leftFootTarget += dirOffset;
-						_stepDir = dir;
-						delayFrame = 2;
-					}
-					else {
-						delayFrame--;
-					}
-				}
-				else {
-					delayFrame = delayFrame == 2 ? delayFrame : delayFrame + 1;
-				}
-				_leftFootTarget.z = _root->m_worldTransform.pos.z;
-				_leftFootStart.z = _root->m_worldTransform.pos.z;
-				_leftFootPos = _leftFootStart + ((_leftFootTarget - _leftFootStart) * interp);
-				double stepAmount = std::clamp(vec3_len(_leftFootTarget - _leftFootStart) / 150.0, 0.0, 1.0);
-				double stepHeight = (std::max)(stepAmount * 9.0, 1.0);
-				float up = sinf(interp * PI) * stepHeight;
-				_leftFootPos.z += up;
-			}
+		// only when standing on the land itself, not on a building or rock above it
+		float landZ;
+		NiPoint3 rootPos = _root->m_worldTransform.pos;
+		if (c_terrainFootPlacement && g_heightField->getHeight(rootPos.x, rootPos.y, &landZ) && fabs(landZ - in.groundZ) < c_terrainFootRange) {
+			projectOnTerrain(_leftFootPos, landZ);
+			projectOnTerrain(_rightFootPos, landZ);
+		}
 
-			spineAngle = sign * sinf(interp * PI) * 3.0;
+		if (out.walking) {
 			Matrix44 rot;
 
-			rot.setEulerAngles(degrees_to_rads(spineAngle), 0.0, 0.0);
+			rot.setEulerAngles(degrees_to_rads(out.spineAngle), 0.0, 0.0);
 			_spine->m_localTransform.rot = rot.multiply43Left(_spine->m_localTransform.rot);
+		}
+	}
 
-			if (_currentStepTime > stepTime) {
-				_currentStepTime = 0.0;
-				_stepDir = dir;
-				_stepTimeinStep = stepTime;
-				//_MESSAGE("%2f %2f", curSpeed, stepTime);
 
-				if (_footStepping == 1) {
-					_footStepping = 2;
-					_leftFootTarget = lFoot->m_worldTransform.pos + _stepDir * scale;
-					_leftFootStart = _leftFootPos;
-				}
-				else {
-					_footStepping = 1;
-					_rightFootTarget = rFoot->m_worldTransform.pos + _stepDir * scale;
-					_rightFootStart = _rightFootPos;
-				}
-			}
-			return;
+	// both feet tracked, no stepping at all.   with only one foot tracked the gait keeps both so they stay in step
+	bool Skeleton::setTrackedFeet() {
+		if (!g_trackedBody->isActive(kTracked_LeftFoot) || !g_trackedBody->isActive(kTracked_RightFoot)) {
+			return false;
 		}
-		else if (_walkingState == 2) {
-			_leftFootPos = lFoot->m_worldTransform.pos;
-			_rightFootPos = rFoot->m_worldTransform.pos;
-			_walkingState = 0;
-			return;
 
+		_leftFootPos = g_trackedBody->getTarget(kTracked_LeftFoot);
+		_rightFootPos = g_trackedBody->getTarget(kTracked_RightFoot);
+		return true;
+	}
+
+	// after the legs are solved.   a tracker seen for the first time (or after Calibrate) takes its offset to the bone it drives
+	void Skeleton::calibrateTrackers() {
+		if (g_trackedBody->needsCalibration(kTracked_Waist)) {
+			g_trackedBody->calibrate(kTracked_Waist, getNode("COM", _root)->m_worldTransform.pos);
+		}
+		if (g_trackedBody->needsCalibration(kTracked_LeftFoot)) {
+			g_trackedBody->calibrate(kTracked_LeftFoot, getNode("LLeg_Foot", _root)->m_worldTransform.pos);
+		}
+		if (g_trackedBody->needsCalibration(kTracked_RightFoot)) {
+			g_trackedBody->calibrate(kTracked_RightFoot, getNode("RLeg_Foot", _root)->m_worldTransform.pos);
 		}
 	}
 
@@ -1229,111 +1186,56 @@ namespace F4VRBody
 		rKnee->m_localTransform.rot = rotatedM.multiply43Left(rKnee->m_localTransform.rot);
 	}
 
-	// adapted solver from VRIK.  Thanks prog!
-	void Skeleton::setSingleLeg(bool isLeft) {
-		Matrix44 rotMat;
-
-		NiNode* footNode = isLeft ? getNode("LLeg_Foot", _root) : getNode("RLeg_Foot", _root);
-		NiNode* kneeNode = isLeft ? getNode("LLeg_Calf", _root) : getNode("RLeg_Calf", _root);
-		NiNode* hipNode  = isLeft ? getNode("LLeg_Thigh", _root) : getNode("RLeg_Thigh", _root);
-
-		NiPoint3 footPos = isLeft ? _leftFootPos : _rightFootPos;
-		NiPoint3 kneePos = isLeft ? _leftKneePos : _rightKneePos;
-		NiPoint3 hipPos = hipNode->m_worldTransform.pos;
-
+	// snapshot of everything the leg solver needs.   returns false if the saved solve from last frame was reused instead
+	bool Skeleton::prepareLeg(bool isLeft, LegJob& job) {
+		job.foot = isLeft ? getNode("LLeg_Foot", _root) : getNode("RLeg_Foot", _root);
+		job.knee = isLeft ? getNode("LLeg_Calf", _root) : getNode("RLeg_Calf", _root);
+		job.hip  = isLeft ? getNode("LLeg_Thigh", _root) : getNode("RLeg_Thigh", _root);
 
-		NiPoint3 footToHip = hipNode->m_worldTransform.pos - footPos;
-
-		NiPoint3 rotV = NiPoint3(0, 1, 0);
-		if (_inPowerArmor) {
-			rotV.y = 0;
-			rotV.z = isLeft ? 1 : -1;
-		}
-		NiPoint3 hipDir = hipNode->m_worldTransform.rot * rotV;
-		NiPoint3 xDir = vec3_norm(footToHip);
-		NiPoint3 yDir = vec3_norm(hipDir - xDir * vec3_dot(hipDir, xDir));
-
-		float thighLenOrig = vec3_len(kneeNode->m_localTransform.pos);
-		float calfLenOrig = vec3_len(footNode->m_localTransform.pos);
-		float thighLen = thighLenOrig;
-		float calfLen = calfLenOrig;
-
-		float ftLen = vec3_len(footToHip);
-		if (ftLen < 0.1) {
-			ftLen = 0.1;
-		}
-
-		if (ftLen > thighLen + calfLen) {
-			float diff = ftLen - thighLen - calfLen;
-			float ratio = calfLen / (calfLen + thighLen);
-			calfLen += ratio * diff + 0.1;
-			thighLen += (1.0 - ratio) * diff + 0.1;
-		}
-
-		// Use the law of cosines to calculate the angle the calf must bend to reach the knee position
-		// In cases where this is impossible (foot too close to thigh), then set calfLen = thighLen so
-		// there is always a solution
-		float footAngle = acosf((calfLen * calfLen + ftLen * ftLen - thighLen * thighLen) / (2 * calfLen * ftLen));
-		if (isnan(footAngle) || isinf(footAngle)) {
-			calfLen = thighLen = (thighLenOrig + calfLenOrig) / 2.0;
-			footAngle = acosf((calfLen * calfLen + ftLen * ftLen - thighLen * thighLen) / (2 * calfLen * ftLen));
-		}
-
-		// Get the desired world coordinate of the knee
-		float xDist = cosf(footAngle) * calfLen;
-		float yDist = sinf(footAngle) * calfLen;
-		kneePos = footPos + xDir * xDist + yDir * yDist;
-
-		NiPoint3 pos = kneePos - hipNode->m_worldTransform.pos;
-		NiPoint3 uLocalDir = hipNode->m_worldTransform.rot.Transpose() * vec3_norm(pos) / hipNode->m_worldTransform.scale;
-		rotMat.rotateVectoVec(uLocalDir, kneeNode->m_localTransform.pos);
-		hipNode->m_localTransform.rot = rotMat.multiply43Left(hipNode->m_localTransform.rot);
-
-		//if (_inPowerArmor) {
-		//	//power armor for some reason twists the legs.  twist them back!
-		//	Matrix44 twist;
-		//	float angle = isLeft ? 90.0f : -90.0f;
-		//	twist.setEulerAngles(degrees_to_rads(angle), 0, 0);
-		//	hipNode->m_localTransform.rot = twist.multiply43Left(hipNode->m_localTransform.rot);
-		//}
+		if (!job.foot || !job.knee || !job.hip) {
+			return false;
+		}
 
-		NiMatrix43 hipWR;
-		rotMat.makeTransformMatrix(hipNode->m_localTransform.rot, NiPoint3(0, 0, 0));
-		hipWR = rotMat.multiply43Left(hipNode->m_parent->m_worldTransform.rot);
+		LegIKInput& in = job.in;
+		in.isLeft = isLeft;
+		in.inPowerArmor = _inPowerArmor;
+		in.footPos = isLeft ? _leftFootPos : _rightFootPos;
 
-		NiMatrix43 calfWR;
-		rotMat.makeTransformMatrix(kneeNode->m_localTransform.rot, NiPoint3(0, 0, 0));
-		calfWR = rotMat.multiply43Left(hipWR);
+		return _limbs.prepareLeg(job);
+	}
 
-		uLocalDir = calfWR.Transpose() * vec3_norm(footPos - kneePos) / kneeNode->m_worldTransform.scale;
-		rotMat.rotateVectoVec(uLocalDir, footNode->m_localTransform.pos);
-		kneeNode->m_localTransform.rot = rotMat.multiply43Left(kneeNode->m_localTransform.rot);
+	void Skeleton::setSingleLeg(bool isLeft) {
+		LegJob job;
 
-		rotMat.makeTransformMatrix(kneeNode->m_localTransform.rot, NiPoint3(0, 0, 0));
-		calfWR = rotMat.multiply43Left(hipWR);
+		if (!prepareLeg(isLeft, job)) {
+			return;
+		}
 
-		// Calculate Flr:  Cwr * Flr = footRot   ===>   Flr = Cwr' * footRot
-		//LROT(nodeFoot) = Cwr.Transpose() * footRot;
+		solveLegIK(job.in, job.out);
+		_limbs.applyLeg(job);
+	}
 
-		// Calculate Clp:  Cwp = Twp + Twr * (Clp * Tws) = kneePos   ===>   Clp = Twr' * (kneePos - Twp) / Tws
-		//LPOS(nodeCalf) = Twr.Transpose() * (kneePos - thighPos) / WSCL(nodeThigh);
-		kneeNode->m_localTransform.pos = hipWR.Transpose() * (kneePos - hipPos) / hipNode->m_worldTransform.scale;
+	// both legs are independent once the body is placed so solve them together on the ik workers
+	void Skeleton::setBothLegs() {
+		LegJob legs[2];
+		bool solve[2];
+		WorkerJob jobs[2];
+		int count = 0;
 
-		// Calculate Flp:  Fwp = Cwp + Cwr * (Flp * Cws) = footPos   ===>   Flp = Cwr' * (footPos - Cwp) / Cws
-		//LPOS(nodeFoot) = Cwr.Transpose() * (footPos - kneePos) / WSCL(nodeCalf);
-		footNode->m_localTransform.pos = calfWR.Transpose() * (footPos - kneePos) / kneeNode->m_worldTransform.scale;
+		for (auto i = 0; i < 2; i++) {
+			solve[i] = prepareLeg(i == 1, legs[i]);
+			if (solve[i]) {
+				jobs[count++] = { runLegJob, &legs[i] };
+			}
+		}
 
-		//if (_inPowerArmor) {
-		//	footNode->m_localTransform.pos *= 1.5;
-		//	//power armor for some reason twists the legs.  twist them back!
-		//	Matrix44 twist;
+		g_ikWorkers->run(jobs, count);
 
-		//	float angle = isLeft ? 90.0f : -90.0f;
-		//	float angle2 = isLeft ? -45.0f : 45.0f;
-		//	float angle3 = isLeft ? 30.0f : -30.0f;
-		//	twist.setEulerAngles(degrees_to_rads(angle2), degrees_to_rads(angle), degrees_to_rads(angle3));
-		//	footNode->m_localTransform.rot = twist.multiply43Left(footNode->m_localTransform.rot);
-		//}
+		for (auto i = 0; i < 2; i++) {
+			if (solve[i]) {
+				_limbs.applyLeg(legs[i]);
+			}
+		}
 	}
 
 	void Skeleton::rotateLeg(uint32_t pos, float angle) {
@@ -1395,44 +1297,40 @@ namespace F4VRBody
 	}
 
 	void Skeleton::hideWeapon() {
-
-		static BSFixedString nodeName("Weapon");
-
-		NiAVObject* weapon = rightArm.hand->GetObjectByName(&nodeName);
-
-		if (weapon != nullptr) {
-			weapon->flags |= 0x1;
-			weapon->m_localTransform.scale = 0.0;
-			for (auto i = 0; i < weapon->GetAsNiNode()->m_children.m_emptyRunStart; ++i) {
-				auto nextNode = weapon->GetAsNiNode()->m_children.m_data[i]->GetAsNiNode();
-				nextNode->flags |= 0x1;
-				nextNode->m_localTransform.scale = 0.0;
-			}
-		}
-
+		_visibility.setVisible(kVis_Weapon, false);
 	}
 
 	void Skeleton::swapPipboy() {
 		_pipboyStatus = false;
 		_pipTimer = 0;
+		_pipboy.invalidate();
+	}
+
+	// pipboy nodes only get looked up again when the pipboy 3D or the arm it is on changes
+	bool Skeleton::bindPipboy() {
+		ArmNodes& arm = c_leftHandedPipBoy ? rightArm : leftArm;
+		PipboyAttach attach;
+
+		attach.wand = _playerNodes->SecondaryWandNode;
+		attach.wandPipboy = _playerNodes->PipboyRoot_nif_only_node;
+		attach.shoulder = arm.shoulder;
+		attach.forearm1 = arm.forearm1;
+		attach.forearm3 = arm.forearm3;
+		attach.leftHanded = c_leftHandedPipBoy;
+
+		return _pipboy.bind(attach, c_pipboyDetectionRange);
 	}
 
 	void Skeleton::positionPipboy() {
-		static BSFixedString wandPipName("PipboyRoot_NIF_ONLY");
-		NiAVObject* wandPip = _playerNodes->SecondaryWandNode->GetObjectByName(&wandPipName);
+		bindPipboy();
+
+		NiAVObject* wandPip = _pipboy.getWandPipboy();
 
 		if (wandPip == nullptr) {
 			return;
 		}
 
-		static BSFixedString nodeName("PipboyBone");
-		NiAVObject* pipboyBone;
-		if (c_leftHandedPipBoy) {
-			pipboyBone = rightArm.forearm1->GetObjectByName(&nodeName);
-		}
-		else {
-			pipboyBone = leftArm.forearm1->GetObjectByName(&nodeName);
-		}
+		NiAVObject* pipboyBone = _pipboy.getPipboyBone();
 
 		if (pipboyBone == nullptr) {
 			return;
@@ -1607,47 +1505,14 @@ namespace F4VRBody
 	}
 
 	void Skeleton::setWandsVisibility(bool a_show, wandMode a_mode) {
-		int i;
 		auto rightHand = a_mode == both || (a_mode == mainhandWand && !c_leftHandedMode) || (a_mode == offhandWand && c_leftHandedMode);
 		auto leftHand = a_mode == both || (a_mode == mainhandWand && c_leftHandedMode) || (a_mode == offhandWand && !c_leftHandedMode);
 		if (rightHand) {
-			for (i = 0; i < _playerNodes->primaryWandNode->m_children.m_emptyRunStart; i++) {
-				if (_playerNodes->primaryWandNode->m_children.m_data[i]) {
-					NiNode* n = (NiNode*)(_playerNodes->primaryWandNode->m_children.m_data[i]);
-					auto right = _playerNodes->primaryWandNode->m_children.m_data[i]->GetAsBSTriShape();
-					if (right) {
-						NiAVObject* n1 = (NiAVObject*)right;
-						setVisibility(n1, a_show);
-						break;
-					}
-					else if (!_stricmp(n->m_name.c_str(), "")) {
-						setVisibility(n, a_show);
-						NiAVObject* n1 = (NiAVObject*)n->m_children.m_data[0];
-						setVisibility(n1, a_show);
-						break;
-					}
-				}
-			}
+			_visibility.setVisible(kVis_RightWand, a_show);
 		}
 
 		if (leftHand) {
-			for (i = 0; i < _playerNodes->SecondaryWandNode->m_children.m_emptyRunStart; i++) {
-				if (_playerNodes->SecondaryWandNode->m_children.m_data[i]) {
-					NiNode* n = (NiNode*)(_playerNodes->SecondaryWandNode->m_children.m_data[i]);
-					auto left = _playerNodes->SecondaryWandNode->m_children.m_data[i]->GetAsBSTriShape();
-					if (left) {
-						NiAVObject* n2 = (NiAVObject*)left;
-						setVisibility(n2, a_show);
-						break;
-					}
-					else if (!_stricmp(n->m_name.c_str(), "")) {
-						setVisibility(n, a_show);
-						NiAVObject* n2 = (NiAVObject*)n->m_children.m_data[0];
-						setVisibility(n2, a_show);
-						break;
-					}
-				}
-			}
+			_visibility.setVisible(kVis_LeftWand, a_show);
 		}
 	}
 
@@ -1660,135 +1525,38 @@ namespace F4VRBody
 	}
 
 	void Skeleton::hideFistHelpers() {
-		if (!c_leftHandedMode) {
-			NiAVObject* node = getNode("fist_M_Right_HELPER", _playerNodes->primaryWandNode);
-			if (node != nullptr) {
-				node->flags |= 0x1;   // first bit sets the cull flag so it will be hidden;
-			}
-
-			node = getNode("fist_F_Right_HELPER", _playerNodes->primaryWandNode);
-			if (node != nullptr) {
-				node->flags |= 0x1;
-			}
-
-			node = getNode("PA_fist_R_HELPER", _playerNodes->primaryWandNode);
-			if (node != nullptr) {
-				node->flags |= 0x1;
-			}
-
-			node = getNode("fist_M_Left_HELPER", _playerNodes->SecondaryWandNode);
-			if (node != nullptr) {
-				node->flags |= 0x1;   // first bit sets the cull flag so it will be hidden;
-			}
-
-			node = getNode("fist_F_Left_HELPER", _playerNodes->SecondaryWandNode);
-			if (node != nullptr) {
-				node->flags |= 0x1;
-			}
-
-			node = getNode("PA_fist_L_HELPER", _playerNodes->SecondaryWandNode);
-			if (node != nullptr) {
-				node->flags |= 0x1;
-			}
-
-		}
-		else {
-			NiAVObject* node = getNode("fist_M_Right_HELPER", _playerNodes->SecondaryWandNode);
-			if (node != nullptr) {
-				node->flags |= 0x1;   // first bit sets the cull flag so it will be hidden;
-			}
-
-			node = getNode("fist_F_Right_HELPER", _playerNodes->SecondaryWandNode);
-			if (node != nullptr) {
-				node->flags |= 0x1;
-			}
-
-			node = getNode("PA_fist_R_HELPER", _playerNodes->SecondaryWandNode);
-			if (node != nullptr) {
-				node->flags |= 0x1;
-			}
-
-			node = getNode("fist_M_Left_HELPER", _playerNodes->primaryWandNode);
-			if (node != nullptr) {
-				node->flags |= 0x1;   // first bit sets the cull flag so it will be hidden;
-			}
-
-			node = getNode("fist_F_Left_HELPER", _playerNodes->primaryWandNode);
-			if (node != nullptr) {
-				node->flags |= 0x1;
-			}
+		_visibility.setVisible(kVis_FistHelpers, false);
+		_visibility.setVisible(kVis_WandUIPoint, false);
+	}
 
-			node = getNode("PA_fist_L_HELPER", _playerNodes->primaryWandNode);
-			if (node != nullptr) {
-				node->flags |= 0x1;
-			}
-		}
+	// everything that was asked to be shown or hidden this frame gets written out here, only what actually changed
+	void Skeleton::applyVisibility() {
+		VisibilityAttach attach;
 
-		NiAVObject* uiNode = getNode("Point002", _playerNodes->SecondaryWandNode);
+		attach.primaryWand = _playerNodes->primaryWandNode;
+		attach.secondaryWand = _playerNodes->SecondaryWandNode;
+		attach.roomNode = _playerNodes->roomnode;
+		attach.uiAttach = _playerNodes->primaryUIAttachNode;
+		attach.rightHand = rightArm.hand;
+		attach.pipboyBone = _pipboy.getPipboyBone();
+		attach.leftHanded = c_leftHandedMode;
+		attach.inPowerArmor = _inPowerArmor;
 
-		if (uiNode) {
-			uiNode->m_localTransform.scale = 0.0;
-		}
+		_visibility.apply(attach);
 	}
 
 	bool Skeleton::isLookingAtPipBoy() {
-		BSFixedString wandPipName("PipboyRoot_NIF_ONLY");
-		NiAVObject* pipboy = _playerNodes->SecondaryWandNode->GetObjectByName(&wandPipName);
-
-		if (pipboy == nullptr) {
-			return false;
-		}
+		bindPipboy();
 
-		BSFixedString screenName("Screen:0");
-		NiAVObject* screen = pipboy->GetObjectByName(&screenName);
-
-		NiPoint3 pipBoyOut = screen->m_worldTransform.rot * NiPoint3(0, -1, 0);
 		NiPoint3 lookDir = (*g_playerCamera)->cameraNode->m_worldTransform.rot * NiPoint3(0, 1, 0);
 
-		float dot = vec3_dot(vec3_norm(pipBoyOut), vec3_norm(lookDir));
-
-		return (dot < -(c_pipBoyLookAtGate) ? true : false);
-
+		return _pipboy.isLookedAt(lookDir, c_pipBoyLookAtGate);
 	}
 
 	void Skeleton::hidePipboy() {
-		BSFixedString pipName("PipboyBone");
-		NiAVObject* pipboy = nullptr;
-
-		if (!c_leftHandedPipBoy) {
-			if (leftArm.forearm3) {
-				pipboy = leftArm.forearm3->GetObjectByName(&pipName);
-			}
-		}
-		else {
-			pipboy = rightArm.forearm3->GetObjectByName(&pipName);
-
-		}
-
-		if (!pipboy) {
-	//		_MESSAGE("can't find pipboyroot in hidePipBoy function");
-			return;
-		}
-
-		if (!c_hidePipboy) {
-			if (pipboy->m_localTransform.scale = 1.0) {
-				return;
-			}
-			else {
-				pipboy->m_localTransform.scale = 1.0;
-				toggleVis(pipboy->GetAsNiNode(), false, true);
-			}
-		}
-		else {
-			if (pipboy->m_localTransform.scale = 0.0) {
-				return;
-			}
-			else {
-				pipboy->m_localTransform.scale = 0.0;
-				toggleVis(pipboy->GetAsNiNode(), true, true);
-			}
+		bindPipboy();
 
-		}
+		_visibility.setVisible(kVis_Pipboy, !c_hidePipboy);
 	}
 
 	void Skeleton::operatePipBoy() {
@@ -1799,25 +1567,12 @@ namespace F4VRBody
 
 		BSFlattenedBoneTree* rt = (BSFlattenedBoneTree*)_root;
 
-		NiPoint3 finger;
-		NiAVObject* pipboy = nullptr;
-
-		if (!c_leftHandedPipBoy) {
-			finger = rt->transforms[boneTreeMap["RArm_Finger23"]].world.pos;
-
-			pipboy = getNode("PipboyRoot", leftArm.shoulder->GetAsNiNode());
-		}
-		else {
-			finger = rt->transforms[boneTreeMap["LArm_Finger23"]].world.pos;
-
-			pipboy = getNode("PipboyRoot", rightArm.shoulder->GetAsNiNode());
-
-		}
-
-		if (pipboy == nullptr) {
+		if (!bindPipboy()) {
 			return;
 		}
 
+		NiPoint3 finger = rt->transforms[_pipboy.getFingerBone()].world.pos;
+
 		const auto pipOnButtonPressed = (c_pipBoyButtonArm ? VRHook::g_vrHook->getControllerState(VRHook::VRSystem::TrackerType::Right).ulButtonPressed : 
 			VRHook::g_vrHook->getControllerState(VRHook::VRSystem::TrackerType::Left).ulButtonPressed) & vr::ButtonMaskFromId((vr::EVRButtonId)c_pipBoyButtonID);
 		const auto pipOffButtonPressed = (c_pipBoyButtonOffArm ? VRHook::g_vrHook->getControllerState(VRHook::VRSystem::TrackerType::Right).ulButtonPressed : 
@@ -1853,7 +1608,7 @@ namespace F4VRBody
 
 		if (!isLookingAtPipBoy()) {
 			vr::VRControllerAxis_t axis_state = (c_pipBoyButtonArm > 0) ? VRHook::g_vrHook->getControllerState(VRHook::VRSystem::TrackerType::Right).rAxis[0] : VRHook::g_vrHook->getControllerState(VRHook::VRSystem::TrackerType::Left).rAxis[0];
-			const auto timeElapsed = duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count() - _lastLookingAtPip;
+			const auto timeElapsed = GetTickCount64() - _lastLookingAtPip;
 			if (_pipboyStatus && timeElapsed > c_pipBoyOffDelay) {
 				_pipboyStatus = false;
 				turnPipBoyOff();
@@ -1870,24 +1625,20 @@ namespace F4VRBody
 		}
 		else if (_pipboyStatus)
 		{
-			_lastLookingAtPip = duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+			_lastLookingAtPip = GetTickCount64();
 		}
 
 		if (c_pipBoyButtonMode) // If c_pipBoyButtonMode, don't check touch
 			return;
 
-		float distance = vec3_len(finger - pipboy->m_worldTransform.pos);
-
-		if (distance > c_pipboyDetectionRange) {
+		if (!_pipboy.isTouching(finger)) {
 			_pipTimer = 0;
 			_stickypip = false;
 			return;
 		}
 		else {
 			if (!_stickypip) {
-				if (vrhook != nullptr) {
-					vrhook->StartHaptics(2, 0.05, 0.3);
-				}
+				g_haptics->play("tick", kHaptic_Both);
 			}
 			else {
 				return;
@@ -1923,10 +1674,7 @@ namespace F4VRBody
 	}
 
 	void Skeleton::showHidePAHUD() {
-		NiNode* wand = this->getPlayerNodes()->primaryUIAttachNode;
-
-		BSFixedString bname = "BackOfHand";
-		NiNode* node = (NiNode*)wand->GetObjectByName(&bname);
+		NiNode* node = _visibility.getBackOfHand();
 
 		if (node && _inPowerArmor) {
 			node->m_worldTransform.pos += NiPoint3(-5.0, -7.0, 2.0);
@@ -1936,12 +1684,7 @@ namespace F4VRBody
 
 
 
-		NiNode* hud = getNode("PowerArmorHelmetRoot", _playerNodes->roomnode);
-
-		if (hud) {
-			hud->m_localTransform.scale = c_showPAHUD ? 1.0 : 0.0;
-			return;
-		}
+		_visibility.setVisible(kVis_PAHud, c_showPAHUD);
 	}
 
 	void Skeleton::setLeftHandedSticky() {
@@ -1984,11 +1727,13 @@ namespace F4VRBody
 		}
 	}
 
-	// This is the main arm IK solver function - Algo credit to prog from SkyrimVR VRIK mod - what a beast!
-	void Skeleton::setArms(bool isLeft) {
+	// Sets up the first person hand the arm will reach for and takes a snapshot for the arm solver in IKSolver.cpp
+	// returns false if there is nothing to solve (bad tracking or last frame's solve was reused)
+	bool Skeleton::prepareArm(bool isLeft, ArmJob& job) {
 		ArmNodes arm;
 
 		arm = isLeft ? leftArm : rightArm;
+		job.arm = arm;
 
 		// This first part is to handle the game calculating the first person hand based off two offset nodes
 		// PrimaryWeaponOffset and PrimaryMeleeoffset
@@ -1999,7 +1744,7 @@ namespace F4VRBody
 		// matches my real life hand pose with an index controller very well.   I use this as the baseline for everything
 
 		if ((*g_player)->firstPersonSkeleton == nullptr) {
-			return;
+			return false;
 		}
 
 		NiNode* rightWeapon = getNode("Weapon", (*g_player)->firstPersonSkeleton->GetAsNiNode());
@@ -2095,290 +1840,69 @@ namespace F4VRBody
 			isinf(handPos.x) || isinf(handPos.y) || isinf(handPos.z) ||
 			vec3_len(arm.upper->m_worldTransform.pos - handPos) > 200.0)
 		{
-			return;
+			return false;
 		}
 
+		ArmIKInput& in = job.in;
+		in.isLeft = isLeft;
+		in.inPowerArmor = _inPowerArmor;
+		in.handPos = handPos;
+		in.handRot = handRot;
+		in.forwardDir = _forwardDir;
+		in.sidewaysRDir = _sidewaysRDir;
+		in.chestZ = _chest->m_worldTransform.pos.z;
+		in.rootScale = _root->m_localTransform.scale;
+		in.armLength = c_armLength;
 
-		double adjustedArmLength = c_armLength / 36.74;
-
-		// Shoulder IK is done in a very simple way
-
-		NiPoint3 shoulderToHand = handPos - arm.upper->m_worldTransform.pos;
-		float armLength = c_armLength;
-		float adjustAmount = (std::clamp)(vec3_len(shoulderToHand) - armLength * 0.5f, 0.0f, armLength * 0.85f) / (armLength * 0.85f);
-		NiPoint3 shoulderOffset = vec3_norm(shoulderToHand) * (adjustAmount * armLength * 0.08f);
-
-		NiPoint3 clavicalToNewShoulder = arm.upper->m_worldTransform.pos + shoulderOffset - arm.shoulder->m_worldTransform.pos;
-
-		NiPoint3 sLocalDir = (arm.shoulder->m_worldTransform.rot.Transpose() * clavicalToNewShoulder) / arm.shoulder->m_worldTransform.scale;
-
-		Matrix44 rotatedM;
-		rotatedM = 0.0;
-		rotatedM.rotateVectoVec(sLocalDir, NiPoint3(1,0,0));
-
-		NiMatrix43 result = rotatedM.multiply43Left(arm.shoulder->m_localTransform.rot);
-		arm.shoulder->m_localTransform.rot = result;
-
-		updateDown(arm.shoulder->GetAsNiNode(), true);
-
-		// The bend of the arm depends on its distance to the body.  Its distance as well as the lengths of
-		// the upper arm and forearm define the sides of a triangle:
-		//                 ^
-		//                /|\         Let a,b be the arm lengths, c be the distance from hand-to-shoulder
-		//               /^| \        Let A be the total angle at which the wrist must bend
-		//              / ||  \       Let x be the width of the right triangle
-		//            a/  y|   \  b   Let y be the height of the right triangle
-		//            /   ||    \
-	    //           /    v|<-x->\
-	    // Shoulder /______|_____A\ Hand
-		//                c
-		// Law of cosines: Wrist angle A = acos( (b^2 + c^2 - a^2) / (2*b*c) )
-		// The wrist angle is used to calculate x and y, which are used to position the elbow
-
-
-		float negLeft = isLeft ? -1 : 1;
-
-		float originalUpperLen = vec3_len(arm.forearm1->m_localTransform.pos);
-		float originalForearmLen;
+		return _limbs.prepareArm(job);
+	}
 
-		if (_inPowerArmor) {
-			originalForearmLen = vec3_len(arm.hand->m_localTransform.pos);
-		}
-		else {
-			originalForearmLen = vec3_len(arm.hand->m_localTransform.pos) + vec3_len(arm.forearm2->m_localTransform.pos) + vec3_len(arm.forearm3->m_localTransform.pos);
-		}
-		float upperLen = originalUpperLen * adjustedArmLength;
-		float forearmLen = originalForearmLen * adjustedArmLength;
+	void Skeleton::applyArm(ArmJob& job) {
+		_limbs.applyArm(job);
+		updateDown(job.arm.shoulder->GetAsNiNode(), true);
+	}
 
-		NiPoint3 Uwp = arm.upper->m_worldTransform.pos;
-		NiPoint3 handToShoulder = Uwp - handPos;
-		float hsLen = (std::max)(vec3_len(handToShoulder), 0.1f);
+	void Skeleton::setArms(bool isLeft) {
+		ArmJob job;
 
-		if (hsLen > (upperLen + forearmLen) * 2.25) {
+		if (!prepareArm(isLeft, job)) {
 			return;
 		}
 
+		solveArmIK(job.in, job.out);
+		applyArm(job);
+	}
 
-		// Stretch the upper arm and forearm proportionally when the hand distance exceeds the arm length
-		if (hsLen > upperLen + forearmLen) {
-			float diff = hsLen - upperLen - forearmLen;
-			float ratio = forearmLen / (forearmLen + upperLen);
-			forearmLen += ratio * diff + 0.1;
-			upperLen += (1.0 - ratio) * diff + 0.1;
-		}
-
-		NiPoint3 forwardDir = vec3_norm(_forwardDir);
-		NiPoint3 sidewaysDir = vec3_norm(_sidewaysRDir * negLeft);
-
-		// The primary twist angle comes from the direction the wrist is pointing into the forearm
-		NiPoint3 handBack = handRot * NiPoint3(-1, 0, 0);
-		float twistAngle = asinf((std::clamp)(handBack.z, -0.999f, 0.999f));
-
-		// The second twist angle comes from a side vector pointing "outward" from the side of the wrist
-		NiPoint3 handSide = handRot * NiPoint3(0, -1, 0);
-		NiPoint3 handinSide = handSide * negLeft;
-		float twistAngle2 = -1 * asinf((std::clamp)(handSide.z, -0.599f, 0.999f));
-
-		// Blend the two twist angles together, using the primary angle more when the wrist is pointing downward
-		//float interpTwist = (std::clamp)((handBack.z + 0.866f) * 1.155f, 0.25f, 0.8f); // 0 to 1 as hand points 60 degrees down to horizontal
-		float interpTwist = (std::clamp)((handBack.z + 0.866f) * 1.155f, 0.45f, 0.8f); // 0 to 1 as hand points 60 degrees down to horizontal
-//		_MESSAGE("%2f %2f %2f", rads_to_degrees(twistAngle), rads_to_degrees(twistAngle2), interpTwist);
-		twistAngle = twistAngle + interpTwist * (twistAngle2 - twistAngle);
-		// Wonkiness is bad.  Interpolate twist angle towards zero to correct it when the angles are pointed a certain way.
-	/*	float fixWonkiness1 = (std::clamp)(vec3_dot(handSide, vec3_norm(-sidewaysDir - forwardDir * 0.25f + NiPoint3(0, 0, -0.25))), 0.0f, 1.0f);
-		float fixWonkiness2 = 1.0f - (std::clamp)(vec3_dot(handBack, vec3_norm(forwardDir + sidewaysDir)), 0.0f, 1.0f);
-		twistAngle = twistAngle + fixWonkiness1 * fixWonkiness2 * (-PI / 2.0f - twistAngle);*/
-
-//		_MESSAGE("final angle %2f", rads_to_degrees(twistAngle));
-
-		// Smooth out sudden changes in the twist angle over time to reduce elbow shake
-		static std::array<float, 2> prevAngle = { 0, 0 };
-		twistAngle = prevAngle[isLeft ? 0 : 1] + (twistAngle - prevAngle[isLeft ? 0 : 1]) * 0.25f;
-		prevAngle[isLeft ? 0 : 1] = twistAngle;
-
-		// Calculate the hand's distance behind the body - It will increase the minimum elbow rotation angle
-		float size = 1.0;
-		float behindD = -(forwardDir.x * arm.shoulder->m_worldTransform.pos.x + forwardDir.y * arm.shoulder->m_worldTransform.pos.y) - 10.0f;
-		float handBehindDist = -(handPos.x * forwardDir.x + handPos.y * forwardDir.y + behindD);
-		float behindAmount = (std::clamp)(handBehindDist / (40.0f * size), 0.0f, 1.0f);
-
-		// Holding hands in front of chest increases the minimum elbow rotation angle (elbows lift) and decreases the maximum angle
-		NiPoint3 planeDir = rotateXY(forwardDir, negLeft * degrees_to_rads(135));
-		float planeD = -(planeDir.x * arm.shoulder->m_worldTransform.pos.x + planeDir.y * arm.shoulder->m_worldTransform.pos.y) + 16.0f * size;
-		float armCrossAmount = (std::clamp)((handPos.x * planeDir.x + handPos.y * planeDir.y + planeD) / (20.0f * size), 0.0f, 1.0f);
-
-		// The arm lift limits how much the crossing amount can influence minimum elbow rotation
-		// The maximum rotation is also decreased as hands lift higher (elbows point further downward)
-		float armLiftLimitZ = _chest->m_worldTransform.pos.z * size;
-		float armLiftThreshold = 60.0f * size;
-		float armLiftLimit = (std::clamp)((armLiftLimitZ + armLiftThreshold - handPos.z) / armLiftThreshold, 0.0f, 1.0f); // 1 at bottom, 0 at top
-		float upLimit = (std::clamp)((1.0f - armLiftLimit) * 1.4f, 0.0f, 1.0f); // 0 at bottom, 1 at a much lower top
-
-			// Determine overall amount the elbows minimum rotation will be limited
-		float adjustMinAmount = (std::max)(behindAmount, (std::min)(armCrossAmount, armLiftLimit));
-
-		// Get the minimum and maximum angles at which the elbow is allowed to twist
-		float twistMinAngle = degrees_to_rads(-85.0) + degrees_to_rads(50) * adjustMinAmount;
-		float twistMaxAngle = degrees_to_rads(55.0) - (std::max)(degrees_to_rads(90) * armCrossAmount, degrees_to_rads(70) * upLimit);
-
-		// Twist angle ranges from -PI/2 to +PI/2; map that range to go from the minimum to the maximum instead
-		float twistLimitAngle = twistMinAngle + ((twistAngle + PI / 2.0f) / PI) * (twistMaxAngle - twistMinAngle);
-
-		//_MESSAGE("%f %f %f %f", rads_to_degrees(twistAngle), rads_to_degrees(twistAngle2), rads_to_degrees(twistAngle), rads_to_degrees(twistLimitAngle));
-		// The bendDownDir vector points in the direction the player faces, and bends up/down with the final elbow angle
-		NiMatrix43 rot = getRotationAxisAngle(sidewaysDir * negLeft, twistLimitAngle);
-		NiPoint3 bendDownDir = rot * forwardDir;
-
-		// Get the "X" direction vectors pointing to the shoulder
-		NiPoint3 xDir = vec3_norm(handToShoulder);
-
-		// Get the final "Y" vector, perpendicular to "X", and pointing in elbow direction (as in the diagram above)
-		float sideD = -(sidewaysDir.x * arm.shoulder->m_worldTransform.pos.x + sidewaysDir.y * arm.shoulder->m_worldTransform.pos.y) - 1.0 * 8.0f;
-		float acrossAmount = -(handPos.x * sidewaysDir.x + handPos.y * sidewaysDir.y + sideD) / (16.0f * 1.0);
-		float handSideTwistOutward = vec3_dot(handSide, vec3_norm(sidewaysDir + (forwardDir * 0.5f)));
-		float armTwist = (std::clamp)(handSideTwistOutward - (std::max)(0.0f, acrossAmount + 0.25f), 0.0f, 1.0f);
-
-		if (acrossAmount < 0) {
-			acrossAmount *= 0.2f;
-		}
-
-		float handBehindHead = (std::clamp)((handBehindDist + 0.0f * size) / (15.0f * size), 0.0f, 1.0f) * (std::clamp)(upLimit * 1.2f, 0.0f, 1.0f);
-		float elbowsTwistForward = (std::max)(acrossAmount * degrees_to_rads(90), handBehindHead * degrees_to_rads(120));
-		NiPoint3 elbowDir = rotateXY(bendDownDir, -negLeft * (degrees_to_rads(150) - armTwist * degrees_to_rads(25) - elbowsTwistForward));
-		NiPoint3 yDir = elbowDir - xDir * vec3_dot(elbowDir, xDir);
-		yDir = vec3_norm(yDir);
+	// the two arm solves only share the torso, which is already placed, so they can run at the same time
+	void Skeleton::setBothArms() {
+		ArmJob arms[2];
+		bool solve[2];
+		WorkerJob jobs[2];
+		int count = 0;
 
-		// Get the angle wrist must bend to reach elbow position
-		// In cases where this is impossible (hand too close to shoulder), then set forearmLen = upperLen so there is always a solution
-		float wristAngle = acosf((forearmLen * forearmLen + hsLen * hsLen - upperLen * upperLen) / (2 * forearmLen * hsLen));
-		if (isnan(wristAngle) || isinf(wristAngle)) {
-			forearmLen = upperLen = (originalUpperLen + originalForearmLen) / 2.0 * adjustedArmLength;
-			wristAngle = acosf((forearmLen * forearmLen + hsLen * hsLen - upperLen * upperLen) / (2 * forearmLen * hsLen));
+		// right then left like the serial version.   the first person hand setup has to stay on this thread
+		for (auto i = 0; i < 2; i++) {
+			solve[i] = prepareArm(i == 1, arms[i]);
+			if (solve[i]) {
+				jobs[count++] = { runArmJob, &arms[i] };
+			}
 		}
 
-		// Get the desired world coordinate of the elbow
-		float xDist = cosf(wristAngle) * forearmLen;
-		float yDist = sinf(wristAngle) * forearmLen;
-		NiPoint3 elbowWorld = handPos + xDir * xDist + yDir * yDist;
-
-		// This code below rotates and positions the upper arm, forearm, and hand bones
-		// Notation: C=Clavicle, U=Upper arm, F=Forearm, H=hand   w=world, l=local   p=position, r=rotation, s=scale
-		//    Rules: World position = Parent world pos + Parent world rot * (Local pos * Parent World scale)
-		//           World Rotation = Parent world rotation * Local Rotation
-		// ---------------------------------------------------------------------------------------------------------
-
-		// The upper arm bone must be rotated from its forward vector to its shoulder-to-elbow vector in its local space
-		// Calculate Ulr:  baseUwr * rotTowardElbow = Cwr * Ulr   ===>   Ulr = Cwr' * baseUwr * rotTowardElbow
-		NiMatrix43 Uwr = arm.upper->m_worldTransform.rot;
-		NiPoint3 pos = elbowWorld - Uwp;
-		NiPoint3 uLocalDir = Uwr.Transpose() * vec3_norm(pos) / arm.upper->m_worldTransform.scale;
-
-		rotatedM.rotateVectoVec(uLocalDir, arm.forearm1->m_localTransform.pos);
-		arm.upper->m_localTransform.rot = rotatedM.multiply43Left(arm.upper->m_localTransform.rot);
-
-		rotatedM.makeTransformMatrix(arm.upper->m_localTransform.rot, arm.upper->m_localTransform.pos);
-
-		Uwr = rotatedM.multiply43Left(arm.shoulder->m_worldTransform.rot);
-
-		// Find the angle of the forearm twisted around the upper arm and twist the upper arm to align it
-		//    Uwr * twist = Cwr * Ulr   ===>   Ulr = Cwr' * Uwr * twist
-		pos = handPos - elbowWorld;
-		NiPoint3 uLocalTwist = Uwr.Transpose() * vec3_norm(pos);
-		uLocalTwist.x = 0;
-		NiPoint3 upperSide = arm.upper->m_worldTransform.rot * NiPoint3(0, 1, 0);
-		NiPoint3 uloc = arm.shoulder->m_worldTransform.rot.Transpose() * upperSide;
-		uloc.x = 0;
-		float upperAngle = acosf(vec3_dot(vec3_norm(uLocalTwist), vec3_norm(uloc))) * (uLocalTwist.z > 0 ? 1 : -1);
-
-		Matrix44 twist;
-		twist.setEulerAngles(-upperAngle, 0, 0);
-		arm.upper->m_localTransform.rot = twist.multiply43Left(arm.upper->m_localTransform.rot);
-
-		rotatedM.makeTransformMatrix(arm.upper->m_localTransform.rot, arm.upper->m_localTransform.pos);
-		Uwr = rotatedM.multiply43Left(arm.shoulder->m_worldTransform.rot);
-
-		twist.setEulerAngles(-upperAngle, 0, 0);
-		arm.forearm1->m_localTransform.rot = twist.multiply43Left(arm.forearm1->m_localTransform.rot);
-
-		// The forearm arm bone must be rotated from its forward vector to its elbow-to-hand vector in its local space
-		// Calculate Flr:  Fwr * rotTowardHand = Uwr * Flr   ===>   Flr = Uwr' * Fwr * rotTowardHand
-		rotatedM.makeTransformMatrix(arm.forearm1->m_localTransform.rot, arm.forearm1->m_localTransform.pos);
-		NiMatrix43 Fwr = rotatedM.multiply43Left(Uwr);
-		NiPoint3 elbowHand = handPos - elbowWorld;
-		NiPoint3 fLocalDir = Fwr.Transpose() * vec3_norm(elbowHand);
-
-		rotatedM.rotateVectoVec(fLocalDir, NiPoint3(1, 0, 0));
-		arm.forearm1->m_localTransform.rot = rotatedM.multiply43Left(arm.forearm1->m_localTransform.rot);
-		rotatedM.makeTransformMatrix(arm.forearm1->m_localTransform.rot, arm.forearm1->m_localTransform.pos);
-		Fwr = rotatedM.multiply43Left(Uwr);
-
-		NiMatrix43 Fwr2, Fwr3;
-
-		if (!_inPowerArmor && (arm.forearm2 != nullptr) && (arm.forearm3 != nullptr)) {
-			rotatedM.makeTransformMatrix(arm.forearm2->m_localTransform.rot, arm.forearm2->m_localTransform.pos);
-			Fwr2 = rotatedM.multiply43Left(Fwr);
-			rotatedM.makeTransformMatrix(arm.forearm3->m_localTransform.rot, arm.forearm3->m_localTransform.pos);
-			Fwr3 = rotatedM.multiply43Left(Fwr2);
-
-
-
+		g_ikWorkers->run(jobs, count);
 
-			// Find the angle the wrist is pointing and twist forearm3 appropriately
-			//    Fwr * twist = Uwr * Flr   ===>   Flr = (Uwr' * Fwr) * twist = (Flr) * twist
-
-			NiPoint3 wLocalDir = Fwr3.Transpose() * vec3_norm(handinSide);
-			wLocalDir.x = 0;
-			NiPoint3 forearm3Side = Fwr3 * NiPoint3(0, 0, -1);   // forearm is rotated 90 degrees already from hand so need this vector instead of 0,-1,0
-			NiPoint3 floc = Fwr2.Transpose() * vec3_norm(forearm3Side);
-			floc.x = 0;
-			float fcos = vec3_dot(vec3_norm(wLocalDir), vec3_norm(floc));
-			float fsin = vec3_det(vec3_norm(wLocalDir), vec3_norm(floc), NiPoint3(-1, 0, 0));
-			float forearmAngle = -1 * negLeft * atan2f(fsin, fcos);
-
-			// old way of doing this
-			//NiPoint3 cross = vec3_cross(vec3_norm(floc), vec3_norm(wLocalDir));
-
-			//float forearmAngle = acosf(fcos) - degrees_to_rads(90.0f);
-
-			//if (cross.x < 0) {
-			//	float d = forearmAngle >= 0 ? degrees_to_rads(180.0f) : -1 * degrees_to_rads(180.0f);
-			//	forearmAngle = d - forearmAngle;
-			//}
-
-			twist.setEulerAngles(negLeft * forearmAngle / 2, 0, 0);
-			arm.forearm2->m_localTransform.rot = twist.multiply43Left(arm.forearm2->m_localTransform.rot);
-
-			twist.setEulerAngles(negLeft * forearmAngle / 2, 0, 0);
-			arm.forearm3->m_localTransform.rot = twist.multiply43Left(arm.forearm3->m_localTransform.rot);
-
-			rotatedM.makeTransformMatrix(arm.forearm2->m_localTransform.rot, arm.forearm2->m_localTransform.pos);
-			Fwr2 = rotatedM.multiply43Left(Fwr);
-			rotatedM.makeTransformMatrix(arm.forearm3->m_localTransform.rot, arm.forearm3->m_localTransform.pos);
-			Fwr3 = rotatedM.multiply43Left(Fwr2);
-		}
-
-		// Calculate Hlr:  Fwr * Hlr = handRot   ===>   Hlr = Fwr' * handRot
-		rotatedM.makeTransformMatrix(handRot, handPos);
-		if (!_inPowerArmor) {
-			arm.hand->m_localTransform.rot = rotatedM.multiply43Left(Fwr3.Transpose());
-		}
-		else {
-			arm.hand->m_localTransform.rot = rotatedM.multiply43Left(Fwr.Transpose());
+		for (auto i = 0; i < 2; i++) {
+			if (solve[i]) {
+				applyArm(arms[i]);
+			}
 		}
+	}
 
-		// Calculate Flp:  Fwp = Uwp + Uwr * (Flp * Uws) = elbowWorld   ===>   Flp = Uwr' * (elbowWorld - Uwp) / Uws
-		arm.forearm1->m_localTransform.pos = Uwr.Transpose() * ((elbowWorld - Uwp) / arm.upper->m_worldTransform.scale);
-
-		float origEHLen = vec3_len(arm.hand->m_worldTransform.pos - arm.forearm1->m_worldTransform.pos);
-		float forearmRatio = (forearmLen / origEHLen) * _root->m_localTransform.scale;
-
-		if (arm.forearm2 && !_inPowerArmor) {
-			arm.forearm2->m_localTransform.pos *= forearmRatio;
-			arm.forearm3->m_localTransform.pos *= forearmRatio;
+	float Skeleton::getPostureResidual() {
+		if (!_postureEffector) {
+			return 0.0f;
 		}
-		arm.hand->m_localTransform.pos     *= forearmRatio;
 
-		return;
+		return vec3_len(_postureEffector->m_worldTransform.pos - _postureTarget);
 	}
 
 	void Skeleton::showOnlyArms() {
@@ -2475,6 +1999,23 @@ namespace F4VRBody
 		_handBones[bone].rot = rot.make43();
 	}
 
+	// same blend as calculateHandPose but towards the pose from skeletal input
+	void Skeleton::trackedHandPose(const std::string& bone, int slot) {
+		Quaternion qc;
+		Quaternion qt = g_fingerTracking->getTarget(slot);
+
+		qc.fromRot(_handBones[bone].rot);
+
+		float blend = std::clamp(_frameTime*7, 0.0, 1.0);
+
+		qc.slerp(blend, qt);
+
+		Matrix44 rot;
+		rot = qc.getRot();
+
+		_handBones[bone].rot = rot.make43();
+	}
+
 	void Skeleton::copy1stPerson(std::string bone) {
 		BSFlattenedBoneTree* fpTree = (BSFlattenedBoneTree*)(*g_player)->firstPersonSkeleton->m_children.m_data[0]->GetAsNiNode();
 
@@ -2527,11 +2068,18 @@ namespace F4VRBody
 		}
 	}
 
+	float Skeleton::getFingerCurl(bool isLeft, int finger) {
+		return _fingerCurl[isLeft ? 1 : 0][finger];
+	}
+
 	void Skeleton::setHandPose() {
 
 		BSFlattenedBoneTree* rt = (BSFlattenedBoneTree*)_root;
 		bool isLeft = false;
 
+		// when over budget the finger poses are only recalculated some frames.   the last pose still gets written every frame
+		bool updateFingers = g_frameGovernor->shouldRun(kStage_FingerPose);
+
 	//	fixBoneTree();
 
 		//if (rt->numTransforms > 145) {
@@ -2540,26 +2088,38 @@ namespace F4VRBody
 
 		for (auto pos = 0; pos < rt->numTransforms; pos++) {
 
-			std::string name = boneTreeVec[pos];
-			auto found = fingerRelations.find(name.c_str());
-			if (found != fingerRelations.end()) {
-				isLeft = name[0] == 'L';
-				uint64_t reg = isLeft ? VRHook::g_vrHook->getControllerState(VRHook::VRSystem::TrackerType::Left).ulButtonTouched : VRHook::g_vrHook->getControllerState(VRHook::VRSystem::TrackerType::Right).ulButtonTouched;
-				float gripProx = isLeft ? VRHook::g_vrHook->getControllerState(VRHook::VRSystem::TrackerType::Left).rAxis[2].x : VRHook::g_vrHook->getControllerState(VRHook::VRSystem::TrackerType::Right).rAxis[2].x;
-				bool thumbUp = (reg & vr::ButtonMaskFromId(vr::k_EButton_Grip)) && (reg & vr::ButtonMaskFromId(vr::k_EButton_SteamVR_Trigger)) && (!(reg & vr::ButtonMaskFromId(vr::k_EButton_SteamVR_Touchpad)));
-				_closedHand[name] = reg & vr::ButtonMaskFromId(_handBonesButton[name]);
-
-				if ((*g_player)->actorState.IsWeaponDrawn() && !(isLeft ^ c_leftHandedMode)) {
-					this->copy1stPerson(name);
+			// finger bones come from the slot table built in setNodes
+			int slot = g_fingerTracking->getSlot(pos);
+			if (slot >= 0) {
+				const std::string& name = boneTreeVec[pos];
+				if (updateFingers) {
+					isLeft = name[0] == 'L';
+					uint64_t reg = isLeft ? VRHook::g_vrHook->getControllerState(VRHook::VRSystem::TrackerType::Left).ulButtonTouched : VRHook::g_vrHook->getControllerState(VRHook::VRSystem::TrackerType::Right).ulButtonTouched;
+					float gripProx = isLeft ? VRHook::g_vrHook->getControllerState(VRHook::VRSystem::TrackerType::Left).rAxis[2].x : VRHook::g_vrHook->getControllerState(VRHook::VRSystem::TrackerType::Right).rAxis[2].x;
+					bool thumbUp = (reg & vr::ButtonMaskFromId(vr::k_EButton_Grip)) && (reg & vr::ButtonMaskFromId(vr::k_EButton_SteamVR_Trigger)) && (!(reg & vr::ButtonMaskFromId(vr::k_EButton_SteamVR_Touchpad)));
+					countedLookup(_closedHand, name) = reg & vr::ButtonMaskFromId(countedLookup(_handBonesButton, name));
+
+					if ((*g_player)->actorState.IsWeaponDrawn() && !(isLeft ^ c_leftHandedMode)) {
+						this->copy1stPerson(name);
+					}
+					else if (g_fingerTracking->isTracking(isLeft) && !countedLookup(handPapyrusHasControl, name)) {
+						this->trackedHandPose(name, slot);
+					}
+					else {
+						this->calculateHandPose(name, gripProx, thumbUp, isLeft);
+					}
 				}
-				else {
-					this->calculateHandPose(name, gripProx, thumbUp, isLeft);
+
+				NiTransform trans = countedLookup(_handBones, name);
+
+				// base joint of each finger, read by the pose buffer
+				if (slot % 3 == 0) {
+					int hand = slot / FingerTracking::kBonesPerHand;
+					_fingerCurl[hand][(slot % FingerTracking::kBonesPerHand) / 3] = g_fingerTracking->getPoseCurl(slot, trans.rot);
 				}
-				
-				NiTransform trans = _handBones[name];
 
 				rt->transforms[pos].local.rot = trans.rot;
-				rt->transforms[pos].local.pos = handOpen[name.c_str()].pos;
+				rt->transforms[pos].local.pos = countedLookup(handOpen, name).pos;
 
 				if (rt->transforms[pos].refNode) {
 					rt->transforms[pos].refNode->m_localTransform = rt->transforms[pos].local;
@@ -2585,7 +2145,7 @@ namespace F4VRBody
 		}
 
 		if ((*g_player)->actorState.IsWeaponDrawn()) {
-			NiNode* weap = getNode("Weapon", (*g_player)->firstPersonSkeleton);
+			NiNode* weap = g_weaponFeatures->getWeaponNode();
 
 			std::string weapname("");
 			if ((*g_player)->middleProcess->unk08->equipData) {
@@ -2679,32 +2239,16 @@ namespace F4VRBody
 
 				// handle offhand gripping
 
-				static NiPoint3 _offhandFingerBonePos = NiPoint3(0, 0, 0);
-				static NiPoint3 bodyPos = NiPoint3(0, 0, 0);
-				static float avgHandV[3] = { 0.0f, 0.0f, 0.0f };
-				static int fc = 0;
 				float handV = 0.0f;
+				double now = (double)timer.QuadPart / freqCounter.QuadPart;
 
 				auto offHandBone = c_leftHandedMode ? "RArm_Finger31" : "LArm_Finger31";
 				auto onHandBone = !c_leftHandedMode ? "RArm_Finger31" : "LArm_Finger31";
 				if (_offHandGripping && c_enableOffHandGripping) {
 
-					float handFrameMovement;
-
-					handFrameMovement = vec3_len(rt->transforms[boneTreeMap[offHandBone]].world.pos - _offhandFingerBonePos);
-
-					float bodyFrameMovement = vec3_len(_curPos - bodyPos);
-					avgHandV[fc] = abs(handFrameMovement - bodyFrameMovement);
-
-					fc = fc == 2 ? 0 : fc + 1;
-
-					float sum = 0;
-
-					for (int i = 0; i < 3; i++) {
-						sum += avgHandV[i];
-					}
-
-					handV = sum / 3;
+					// game units per second with the body's own movement taken out
+					_offhandVelocity.addSample(now, rt->transforms[boneTreeMap[offHandBone]].world.pos, _curPos);
+					handV = _offhandVelocity.getSpeed();
 
 					uint64_t reg = c_leftHandedMode ? VRHook::g_vrHook->getControllerState(VRHook::VRSystem::TrackerType::Right).ulButtonPressed : VRHook::g_vrHook->getControllerState(VRHook::VRSystem::TrackerType::Left).ulButtonPressed;
 					if (c_onePressGripButton && _hasLetGoGripButton) {
@@ -2716,7 +2260,7 @@ namespace F4VRBody
 							_hasLetGoGripButton = false;
 						}
 					}
-					else if ((handV > c_gripLetGoThreshold) && !c_isLookingThroughScope) {
+					else if ((handV > c_gripLetGoSpeed) && !c_isLookingThroughScope) {
 						_offHandGripping = false;
 					}
 					uint64_t _pressLength = 0;
@@ -2733,8 +2277,7 @@ namespace F4VRBody
 					else {
 						if (!_repositionModeSwitched && reg & vr::ButtonMaskFromId((vr::EVRButtonId)c_offHandActivateButtonID)) {
 							_repositionMode = static_cast<repositionMode>((_repositionMode + 1) % (repositionMode::total + 1));
-							if (vrhook)
-								vrhook->StartHaptics(c_leftHandedMode ? 0 : 1, 0.1 * (_repositionMode + 1), 0.3);
+							g_haptics->play("reposition", offHandController(), (float)(_repositionMode + 1));
 							_repositionModeSwitched = true;
 							_MESSAGE("Reposition Mode Switch: weapon %s %d ms mode: %d", weapname, _pressLength, _repositionMode);
 						}
@@ -2743,8 +2286,8 @@ namespace F4VRBody
 						}
 						_pressLength = duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count() - _repositionButtonHoldStart;
 						if (!_inRepositionMode && reg & vr::ButtonMaskFromId((vr::EVRButtonId)c_repositionButtonID) && _pressLength > c_holdDelay) {
-							if (vrhook && c_repositionMasterMode)
-								vrhook->StartHaptics(c_leftHandedMode ? 0 : 1, 0.1 * (_repositionMode + 1), 0.3);
+							if (c_repositionMasterMode)
+								g_haptics->play("reposition", offHandController(), (float)(_repositionMode + 1));
 							_inRepositionMode = c_repositionMasterMode;
 						}
 						else if (!(reg & vr::ButtonMaskFromId((vr::EVRButtonId)c_repositionButtonID))) {
@@ -2773,7 +2316,7 @@ namespace F4VRBody
 						}							
 						oH2Bar.z += 3.5f;
 
-						NiPoint3 barrelVec = NiPoint3(0, 1, 0);
+						NiPoint3 barrelVec = g_weaponFeatures->get().barrelAxis;
 
 						NiPoint3 scopeVecLoc = oH2Bar;
 						oH2Bar = weap->m_worldTransform.rot.Transpose() * vec3_norm(oH2Bar) / weap->m_worldTransform.scale;
@@ -2797,9 +2340,7 @@ namespace F4VRBody
 						_playerNodes->primaryWeaponScopeCamera->m_localTransform.rot = rot.multiply43Left(_playerNodes->primaryWeaponScopeCamera->m_localTransform.rot);
 						//updateTransforms(dynamic_cast<NiNode*>(_playerNodes->primaryWeaponScopeCamera));
 
-						_offhandFingerBonePos = rt->transforms[boneTreeMap[offHandBone]].world.pos;
-						_offhandPos = _offhandFingerBonePos;
-						bodyPos = _curPos;
+						_offhandPos = rt->transforms[boneTreeMap[offHandBone]].world.pos;
 						vr::VRControllerAxis_t axis_state = !(c_pipBoyButtonArm > 0) ? VRHook::g_vrHook->getControllerState(VRHook::VRSystem::TrackerType::Right).rAxis[0] : VRHook::g_vrHook->getControllerState(VRHook::VRSystem::TrackerType::Left).rAxis[0];
 						if (_repositionButtonHolding && c_repositionMasterMode) {
 							// this is for a preview of the move. The preview happens one frame before we detect the release so must be processed separately.
@@ -2872,17 +2413,11 @@ namespace F4VRBody
 					}
 				}
 				else {
-					_offhandFingerBonePos = rt->transforms[boneTreeMap[offHandBone]].world.pos;
-					_offhandPos = _offhandFingerBonePos;
-					bodyPos = _curPos;
-
-					if (fc != 0) {
-						for (int i = 0; i < 3; i++) {
-							avgHandV[i] = 0.0f;
-						}
-					}
-					fc = 0;
+					_offhandPos = rt->transforms[boneTreeMap[offHandBone]].world.pos;
 
+					// start a fresh window so the first gripping frame has something to measure from
+					_offhandVelocity.reset();
+					_offhandVelocity.addSample(now, _offhandPos, _curPos);
 				}
 
 
@@ -2893,27 +2428,20 @@ namespace F4VRBody
 	}
 
 	void Skeleton::offHandToBarrel() {
-		NiNode* weap = getNode("Weapon", (*g_player)->firstPersonSkeleton);
+		NiNode* weap = g_weaponFeatures->getWeaponNode();
 
 		BSFlattenedBoneTree* rt = (BSFlattenedBoneTree*)_root;
 
 		if (weap && (*g_player)->actorState.IsWeaponDrawn()) {
-			NiPoint3 barrelVec = NiPoint3(0, 1, 0);
-
-			NiPoint3 oH2Bar = c_leftHandedMode ? rt->transforms[boneTreeMap["RArm_Finger31"]].world.pos - weap->m_worldTransform.pos : rt->transforms[boneTreeMap["LArm_Finger31"]].world.pos - weap->m_worldTransform.pos;
-
-			float len = vec3_len(oH2Bar);
-
-			oH2Bar = weap->m_worldTransform.rot.Transpose() * vec3_norm(oH2Bar) / weap->m_worldTransform.scale;
+			bool nearBarrel = g_weaponFeatures->inForegrip(rt->transforms[countedLookup(boneTreeMap, c_leftHandedMode ? "RArm_Finger31" : "LArm_Finger31")].world.pos);
 
-			float dotP = vec3_dot(vec3_norm(oH2Bar), barrelVec);
 			uint64_t reg = c_leftHandedMode ? VRHook::g_vrHook->getControllerState(VRHook::VRSystem::TrackerType::Right).ulButtonPressed : VRHook::g_vrHook->getControllerState(VRHook::VRSystem::TrackerType::Left).ulButtonPressed;
 
 			if (!(reg & vr::ButtonMaskFromId((vr::EVRButtonId)c_gripButtonID))) {
 				_hasLetGoGripButton = true;
 			}
 
-			if ((dotP > 0.955) && (len > 10.0)) {
+			if (nearBarrel) {
 
 				if (!c_enableGripButtonToGrap) {
 					_offHandGripping = true;
@@ -2934,12 +2462,11 @@ namespace F4VRBody
 
 	/* Handle off-hand scope*/
 	void Skeleton::offHandToScope() {
-		NiNode* weap = getNode("Weapon", (*g_player)->firstPersonSkeleton);
-		if (weap && (*g_player)->actorState.IsWeaponDrawn() && c_isLookingThroughScope) {
-			static BSFixedString reticleNodeName = "ReticleNode";
-			NiAVObject* scopeRet = weap->GetObjectByName(&reticleNodeName);
+		NiNode* weap = g_weaponFeatures->getWeaponNode();
+		NiAVObject* scopeRet = g_weaponFeatures->get().reticle;
+		if (weap && scopeRet && (*g_player)->actorState.IsWeaponDrawn() && c_isLookingThroughScope) {
 			const std::string scopeName = scopeRet->m_name;
-			auto reticlePos = scopeRet->GetAsNiNode()->m_worldTransform.pos;
+			auto reticlePos = scopeRet->m_worldTransform.pos;
 			auto offset = vec3_len(reticlePos - _offhandPos);
 			uint64_t handInput = c_leftHandedMode ? VRHook::g_vrHook->getControllerState(VRHook::VRSystem::TrackerType::Right).ulButtonPressed : VRHook::g_vrHook->getControllerState(VRHook::VRSystem::TrackerType::Left).ulButtonPressed;
 			uint64_t _pressLength = 0;
@@ -2954,9 +2481,8 @@ namespace F4VRBody
 				else if (_zoomModeButtonHeld && !(handInput & vr::ButtonMaskFromId((vr::EVRButtonId)c_offHandActivateButtonID))) {
 					_zoomModeButtonHeld = false;
 					_MESSAGE("Zoom Toggle pressed; sending message to switch zoom state");
-					g_messaging->Dispatch(g_pluginHandle, 16, nullptr, 0, "FO4VRBETTERSCOPES");
-					if (vrhook)
-						vrhook->StartHaptics(c_leftHandedMode ? 0 : 1, 0.1, 0.3);
+					g_scopesChannel->sendZoomToggle();
+					g_haptics->play("scopeZoom", offHandController());
 				}
 
 			if (c_repositionMasterMode) {
@@ -2972,30 +2498,23 @@ namespace F4VRBody
 					_repositionButtonHolding = false;
 					_hasLetGoRepositionButton = true;
 					_inRepositionMode = false;
-					msgData.x = 0.f;
-					msgData.y = 1; // pass save command
-					msgData.z = 0.f;
-					g_messaging->Dispatch(g_pluginHandle, 17, (void*)&msgData, sizeof(NiPoint3*), "FO4VRBETTERSCOPES");
+					g_scopesChannel->sendReticleSave();
 					_MESSAGE("Reposition Button Hold stop: scope %s %d ms", scopeName, _pressLength);
 				}
 				_pressLength = duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count() - _repositionButtonHoldStart;
 				// repositioning does not require hand near scope
 				if (!_inRepositionMode && handInput & vr::ButtonMaskFromId((vr::EVRButtonId)c_repositionButtonID) && _pressLength > c_holdDelay) {
 					// enter reposition mode
-					if (vrhook && c_repositionMasterMode)
-						vrhook->StartHaptics(c_leftHandedMode ? 0 : 1, 0.1, 0.3);
+					if (c_repositionMasterMode)
+						g_haptics->play("confirm", offHandController());
 					_inRepositionMode = c_repositionMasterMode;
 				}
 				else if (_inRepositionMode) { // in reposition mode for better scopes
 					vr::VRControllerAxis_t axis_state = !(c_pipBoyButtonArm > 0) ? VRHook::g_vrHook->getControllerState(VRHook::VRSystem::TrackerType::Right).rAxis[0] : VRHook::g_vrHook->getControllerState(VRHook::VRSystem::TrackerType::Left).rAxis[0];
 					if (!_repositionModeSwitched && handInput & vr::ButtonMaskFromId((vr::EVRButtonId)c_offHandActivateButtonID)) {
-						if (vrhook)
-							vrhook->StartHaptics(c_leftHandedMode ? 0 : 1, 0.1, 0.3);
+						g_haptics->play("confirm", offHandController());
 						_repositionModeSwitched = true;
-						msgData.x = 0.f;
-						msgData.y = 0.f;
-						msgData.z = 0.f;
-						g_messaging->Dispatch(g_pluginHandle, 17, (void*)&msgData, sizeof(NiPoint3*), "FO4VRBETTERSCOPES");
+						g_scopesChannel->sendReticleReset();
 						_MESSAGE("Reposition Mode Reset: scope %s %d ms", scopeName, _pressLength);
 					}
 					else if (_repositionModeSwitched && !(handInput & vr::ButtonMaskFromId((vr::EVRButtonId)c_offHandActivateButtonID))) {
@@ -3003,11 +2522,9 @@ namespace F4VRBody
 					}
 					// get axis from non-movement joystick
 					else if (axis_state.x != 0 || axis_state.y != 0) { // axis_state y is up and down, which corresponds to reticle z axis
-						msgData.x = axis_state.x;
-						msgData.y = 0.f;
-						msgData.z = axis_state.y;
-						g_messaging->Dispatch(g_pluginHandle, 17, (void*)&msgData, sizeof(NiPoint3*), "FO4VRBETTERSCOPES");
-						_MESSAGE("Moving scope reticle. input: (%f, %f)", axis_state.x, axis_state.y);
+						// coalesced, at most one move goes out per frame
+						g_scopesChannel->moveReticle(axis_state.x, axis_state.y);
+						if (c_verbose) { _MESSAGE("Moving scope reticle. input: (%f, %f)", axis_state.x, axis_state.y); }
 					}
 				}
 			}
@@ -16,6 +16,15 @@
 #include "matrix.h"
 #include "Quaternion.h"
 #include "BSFlattenedBoneTree.h"
+#include "SolveCache.h"
+#include "IKSolver.h"
+#include "LimbIK.h"
+#include "Gait.h"
+#include "HandVelocity.h"
+#include "PipboyInteraction.h"
+#include "Visibility.h"
+#include "WorkerPool.h"
+#include "api/FRIKTelemetry.h"
 
 
 #define DEFAULT_HEIGHT 56.0;
@@ -90,16 +99,6 @@ namespace F4VRBody
 
 	};
 
-	struct ArmNodes {
-		NiAVObject* shoulder;
-		NiAVObject* upper;
-		NiAVObject* upperT1;
-		NiAVObject* forearm1;
-		NiAVObject* forearm2;
-		NiAVObject* forearm3;
-		NiAVObject* hand;
-	};
-
 	struct HandMeshBoneTransforms {
 		NiTransform* LArm_ForeArm1_skin;
 		NiTransform* LArm_ForeArm2_skin;
@@ -153,13 +152,11 @@ namespace F4VRBody
 		Skeleton() : _root(nullptr)
 		{
 			_curPos = NiPoint3(0, 0, 0);
-			_walkingState = 0;
 		}
 
 		Skeleton(BSFadeNode* a_node) : _root(a_node)
 		{
 			_curPos = NiPoint3(0, 0, 0);
-			_walkingState = 0;
 		}
 
 		void setDirection() {
@@ -184,13 +181,15 @@ namespace F4VRBody
 			return _playerNodes;
 		}
 
+		bool inPowerArmor() {
+			return _inPowerArmor;
+		}
+
 		void setCommonNode() {
 			_common = this->getNode("COM", _root);
 		}
 
 		// info stuff
-		void printChildren(NiNode* child, std::string padding);
-		void printNodes(NiNode* nde);
 		void positionDiff();
 
 		// reposition stuff
@@ -200,11 +199,14 @@ namespace F4VRBody
 		void setupHead(NiNode* headNode, bool hideHead);
 		void saveStatesTree(NiNode* node);
 		void restoreLocals(NiNode* node);
-		void setUnderHMD(float groundHeight);
+		void setUnderHMD();
 		void setBodyPosture();
+		bool setTrackedPosture();
 		void setLegs();
 		void setSingleLeg(bool isLeft);
+		void setBothLegs();
 		void setArms(bool isLeft);
+		void setBothArms();
 		void setArms_wp(bool isLeft);
 		void setHandPose();
 		NiPoint3 getPosition();
@@ -216,6 +218,9 @@ namespace F4VRBody
 
 		// movement
 		void walk();
+		void projectOnTerrain(NiPoint3& foot, float landZ);
+		bool setTrackedFeet();
+		void calibrateTrackers();
 
 		enum wandMode {
 			both = 0,
@@ -228,10 +233,12 @@ namespace F4VRBody
 		void hideWands(wandMode a_mode = both);
 		void hideWeapon();
 		void swapPipboy();
+		bool bindPipboy();
 		void leftHandedModePipboy();
 		void positionPipboy();
 		void fixMelee();
 		void hideFistHelpers();
+		void applyVisibility();
 		void fixPAArmor();
 		void dampenHand(NiNode* node, bool isLeft);
 
@@ -244,6 +251,7 @@ namespace F4VRBody
 
 		// utility
 		NiNode* getNode(const char* nodeName, NiNode* nde);
+		NiNode* findNode(const char* nodeName, NiNode* nde);
 		void setVisibility(NiAVObject* nde, bool a_show = true); // Change flags to show or hide a node
 		void updateDown(NiNode* nde, bool updateSelf);
 		void updateDownTo(NiNode* toNode, NiNode* fromNode, bool updateSelf);
@@ -258,9 +266,13 @@ namespace F4VRBody
 		void handleWeaponNodes();
 		void setLeftHandedSticky();
 		void calculateHandPose(std::string bone, float gripProx, bool thumbUp, bool isLeft);
+		void trackedHandPose(const std::string& bone, int slot);
 		void copy1stPerson(std::string bone);
 		void insertSaveState(std::string name, NiNode* node);
 		void rotateLeg(uint32_t pos, float angle);
+		bool prepareLeg(bool isLeft, LegJob& job);
+		bool prepareArm(bool isLeft, ArmJob& job);
+		void applyArm(ArmJob& job);
 		void offHandToScope();
 		void moveBack();
 		void debug();
@@ -268,6 +280,28 @@ namespace F4VRBody
 		void fixBoneTree();
 
 		void setTime();
+		void invalidateSolveCaches();
+
+		// 0 = open, 1 = closed for the base joint of a finger (0 thumb .. 4 pinky)
+		float getFingerCurl(bool isLeft, int finger);
+
+		// how far the hand or foot ended up from its ik target.   only meaningful after the world update that follows the solve
+		float getIKResidual(FRIKTelemetryLimb a_limb) {
+			return _limbs.getResidual(a_limb);
+		}
+
+		// degrees between the hand and the rotation its solve was given, 0 for the feet
+		float getIKRotationResidual(FRIKTelemetryLimb a_limb) {
+			return _limbs.getRotationResidual(a_limb);
+		}
+
+		// FRIK_IK_* from this frame's solve, 0 if the limb wasn't solved this frame
+		UInt32 getIKFlags(FRIKTelemetryLimb a_limb) {
+			return _limbs.getFlags(a_limb);
+		}
+
+		// how far the neck ended up from where the posture solve aimed it
+		float getPostureResidual();
 
 		// Body Positioning
 		float getNeckYaw();
@@ -319,23 +353,16 @@ namespace F4VRBody
 		LARGE_INTEGER prevTime;
 		double _frameTime;
 
-		int _walkingState;
-		double _currentStepTime;
+		GaitEngine _gait;
+		HandVelocity _offhandVelocity;
+		NiNode* _leftFootNode = nullptr;
+		NiNode* _rightFootNode = nullptr;
 		NiPoint3 _leftFootPos;
 		NiPoint3 _rightFootPos;
-		NiPoint3 _rightFootTarget;
-		NiPoint3 _leftFootTarget;
-		NiPoint3 _rightFootStart;
-		NiPoint3 _leftFootStart;
 		NiPoint3 _leftKneePosture;
 		NiPoint3 _rightKneePosture;
 		NiPoint3 _leftKneePos;
 		NiPoint3 _rightKneePos;
-		int _footStepping;
-		NiPoint3 _stepDir;
-		double _prevSpeed;
-		double _stepTimeinStep;
-		int delayFrame;
 
 		HandMeshBoneTransforms* _boneTransforms;
 
@@ -343,6 +370,7 @@ namespace F4VRBody
 		std::map<std::string, NiTransform, CaseInsensitiveComparator> _handBones;
 		std::map<std::string, bool, CaseInsensitiveComparator> _closedHand;
 		std::map<std::string, vr::EVRButtonId, CaseInsensitiveComparator> _handBonesButton;
+		float _fingerCurl[2][5] = {};
 
 		bool _weaponEquipped;
 		NiTransform _weapSave;
@@ -366,13 +394,23 @@ namespace F4VRBody
 		std::string _lastWeapon = "";
 		Quaternion _aimAdjust;
 		uint64_t _lastLookingAtPip = 0;
+		PipboyInteraction _pipboy;
+		VisibilityManager _visibility;
 
 		NiMatrix43 _originalWeaponRot;
 		NiPoint3 _offhandPos {0, 0, 0};
 		NiTransform _offhandOffset; // Saving as NiTransform in case we need rotation in future
-		NiPoint3 msgData{ 0, 0, 0 }; // used for msg passing
 
 		NiTransform _rightHandPrevFrame;
 		NiTransform _leftHandPrevFrame;
+
+		// saved solver results for frames where nothing moved
+		SolveCache _underHMDCache;
+		SolveCache _postureCache;
+		LimbIK _limbs;
+		TESObjectCell* _lastCell = nullptr;
+
+		NiPoint3 _postureTarget;
+		NiAVObject* _postureEffector = nullptr;
 	};
 }
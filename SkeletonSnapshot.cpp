@@ -0,0 +1,181 @@
+#include "SkeletonSnapshot.h"
+#include "Quaternion.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace F4VRBody {
+
+	SkeletonSnapshots* g_skeletonSnapshots = nullptr;
+
+	// records the writer hasn't gotten to yet, captures are skipped past this instead of piling up memory
+	static const size_t maxPending = 64;
+
+	static void quantizeRot(NiMatrix43& a_rot, int16_t* a_out) {
+		Quaternion q;
+		q.fromRot(a_rot);
+		q.normalize();
+
+		float comps[4] = { q.x, q.y, q.z, q.w };
+		for (auto i = 0; i < 4; i++) {
+			float c = (std::max)(-1.0f, (std::min)(1.0f, comps[i]));
+			a_out[i] = (int16_t)(c < 0 ? c * 32767.0f - 0.5f : c * 32767.0f + 0.5f);
+		}
+	}
+
+	static void append(std::vector<char>& a_buf, const void* a_data, size_t a_size) {
+		auto at = a_buf.size();
+		a_buf.resize(at + a_size);
+		memcpy(&a_buf[at], a_data, a_size);
+	}
+
+	SkeletonSnapshots::SkeletonSnapshots() {
+		QueryPerformanceFrequency(&_freq);
+		QueryPerformanceCounter(&_start);
+		_nodes.reserve(512);
+		_stack.reserve(64);
+	}
+
+	uint32_t SkeletonSnapshots::intern(const char* a_name) {
+		if (!a_name) {
+			a_name = "";
+		}
+
+		auto found = _names.find(a_name);
+		if (found != _names.end()) {
+			return found->second;
+		}
+
+		_names[a_name] = _nameCount;
+		_newNames.insert(_newNames.end(), a_name, a_name + strlen(a_name) + 1);
+		return _nameCount++;
+	}
+
+	int SkeletonSnapshots::capture(NiAVObject* a_root, const char* a_label) {
+		if (!a_root) {
+			return 0;
+		}
+
+		// console captures come from a papyrus thread, the reload capture from the main thread
+		std::lock_guard<std::mutex> captureLock(_captureLock);
+
+		{
+			std::lock_guard<std::mutex> lock(_lock);
+			if (_pending.size() >= maxPending) {
+				if (_dropped++ == 0) {
+					_MESSAGE("snapshot writer is behind, skipping captures");
+				}
+				return 0;
+			}
+		}
+
+		_nodes.clear();
+		_stack.clear();
+		_newNames.clear();
+		_firstNewName = _nameCount;
+
+		// depth first with our own stack, children pushed backwards so they come out in the same order the old dumps had
+		_stack.push_back({ a_root, -1 });
+		while (!_stack.empty()) {
+			auto top = _stack.back();
+			_stack.pop_back();
+
+			NiAVObject* obj = top.first;
+			FRIKSnapshotNode node;
+			node.name = intern(obj->m_name.c_str());
+			node.parent = top.second;
+			node.flags = (uint32_t)(obj->flags & 0xffffffff);
+			quantizeRot(obj->m_localTransform.rot, node.localRot);
+			node.localPos[0] = obj->m_localTransform.pos.x;
+			node.localPos[1] = obj->m_localTransform.pos.y;
+			node.localPos[2] = obj->m_localTransform.pos.z;
+			node.localScale = obj->m_localTransform.scale;
+			quantizeRot(obj->m_worldTransform.rot, node.worldRot);
+			node.worldPos[0] = obj->m_worldTransform.pos.x;
+			node.worldPos[1] = obj->m_worldTransform.pos.y;
+			node.worldPos[2] = obj->m_worldTransform.pos.z;
+			node.worldScale = obj->m_worldTransform.scale;
+
+			int32_t index = (int32_t)_nodes.size();
+			_nodes.push_back(node);
+
+			NiNode* asNode = obj->GetAsNiNode();
+			if (asNode) {
+				for (int i = asNode->m_children.m_emptyRunStart - 1; i >= 0; --i) {
+					if (asNode->m_children.m_data[i]) {
+						_stack.push_back({ asNode->m_children.m_data[i], index });
+					}
+				}
+			}
+		}
+
+		std::vector<char> record;
+		record.reserve(_newNames.size() + _nodes.size() * sizeof(FRIKSnapshotNode) + 128);
+
+		if (_nameCount != _firstNewName) {
+			uint32_t count = _nameCount - _firstNewName;
+			FRIKSnapshotChunk chunk = { FRIK_SNAPSHOT_NAMES, (uint32_t)(8 + _newNames.size()) };
+			append(record, &chunk, sizeof(chunk));
+			append(record, &_firstNewName, sizeof(uint32_t));
+			append(record, &count, sizeof(uint32_t));
+			append(record, _newNames.data(), _newNames.size());
+		}
+
+		LARGE_INTEGER now;
+		QueryPerformanceCounter(&now);
+
+		FRIKSnapshotPose pose;
+		memset(&pose, 0, sizeof(pose));
+		pose.sequence = _sequence++;
+		pose.time = (double)(now.QuadPart - _start.QuadPart) / (double)_freq.QuadPart;
+		strncpy_s(pose.label, a_label ? a_label : "", _TRUNCATE);
+		pose.nodeCount = (uint32_t)_nodes.size();
+
+		FRIKSnapshotChunk chunk = { FRIK_SNAPSHOT_POSE, (uint32_t)(sizeof(pose) + _nodes.size() * sizeof(FRIKSnapshotNode)) };
+		append(record, &chunk, sizeof(chunk));
+		append(record, &pose, sizeof(pose));
+		append(record, _nodes.data(), _nodes.size() * sizeof(FRIKSnapshotNode));
+
+		queue(record);
+		return (int)_nodes.size();
+	}
+
+	void SkeletonSnapshots::queue(std::vector<char>& a_record) {
+		std::lock_guard<std::mutex> lock(_lock);
+		_pending.push_back(std::move(a_record));
+
+		// nothing to write most sessions so the thread only starts with the first capture
+		if (!_writerStarted) {
+			std::thread(&SkeletonSnapshots::writerLoop, this).detach();
+			_writerStarted = true;
+		}
+		_wake.notify_one();
+	}
+
+	void SkeletonSnapshots::writerLoop() {
+		FILE* file = nullptr;
+		if (fopen_s(&file, ".\\Data\\F4SE\\plugins\\FRIK_Snapshots.frks", "wb") != 0 || !file) {
+			_MESSAGE("could not open FRIK_Snapshots.frks, snapshots will not be saved");
+			file = nullptr;
+		}
+		else {
+			FRIKSnapshotFileHeader header = { FRIK_SNAPSHOT_MAGIC, FRIK_SNAPSHOT_VERSION };
+			fwrite(&header, sizeof(header), 1, file);
+		}
+
+		while (true) {
+			std::vector<char> record;
+			{
+				std::unique_lock<std::mutex> lock(_lock);
+				_wake.wait(lock, [this] { return !_pending.empty(); });
+				record = std::move(_pending.front());
+				_pending.pop_front();
+			}
+
+			if (file) {
+				fwrite(record.data(), 1, record.size(), file);
+				fflush(file);
+			}
+		}
+	}
+}
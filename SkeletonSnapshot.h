@@ -0,0 +1,52 @@
+#pragma once
+#include "F4VRBody.h"
+#include "api/FRIKSnapshot.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace F4VRBody {
+
+	// Binary replacement for the old printNodes log dumps.   capture() walks the subtree once and copies names, parents and
+	// both transforms into a record (layout in api/FRIKSnapshot.h), the file write happens on a thread of its own so the
+	// frame only pays for the copy.   Node names are BSFixedStrings so the string pointer is enough to intern them.
+	class SkeletonSnapshots {
+	public:
+		SkeletonSnapshots();
+
+		// returns how many nodes went into the snapshot, 0 if there was nothing to capture
+		int capture(NiAVObject* a_root, const char* a_label);
+
+	private:
+		uint32_t intern(const char* a_name);
+		void queue(std::vector<char>& a_record);
+		void writerLoop();
+
+		std::mutex _captureLock;
+		std::unordered_map<const char*, uint32_t> _names;
+		uint32_t _nameCount = 0;
+		uint32_t _firstNewName = 0;
+		std::vector<char> _newNames;
+		std::vector<FRIKSnapshotNode> _nodes;
+		std::vector<std::pair<NiAVObject*, int32_t>> _stack;
+		uint64_t _sequence = 0;
+		LARGE_INTEGER _freq;
+		LARGE_INTEGER _start;
+
+		std::mutex _lock;
+		std::condition_variable _wake;
+		std::deque<std::vector<char>> _pending;
+		bool _writerStarted = false;
+		int _dropped = 0;
+	};
+
+	extern SkeletonSnapshots* g_skeletonSnapshots;
+
+	inline void InitSkeletonSnapshots() {
+		g_skeletonSnapshots = new SkeletonSnapshots();
+	}
+}
@@ -0,0 +1,143 @@
+#include "SolveCache.h"
+
+#include <cmath>
+
+namespace F4VRBody {
+
+	SolveCacheSettings SolveCache::settings;
+
+	static bool withinTolerance(const std::vector<float>& a_now, const std::vector<float>& a_solved, float a_tolerance) {
+		if (a_now.size() != a_solved.size()) {
+			return false;
+		}
+
+		for (size_t i = 0; i < a_now.size(); i++) {
+			// nan never compares so it always forces a solve
+			if (!(fabs(a_now[i] - a_solved[i]) <= a_tolerance)) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	void SolveCache::beginInputs() {
+		_inputs.clear();
+		_angles.clear();
+	}
+
+	void SolveCache::addInput(float a_val) {
+		_inputs.push_back(a_val);
+	}
+
+	void SolveCache::addInput(const NiPoint3& a_val) {
+		_inputs.push_back(a_val.x);
+		_inputs.push_back(a_val.y);
+		_inputs.push_back(a_val.z);
+	}
+
+	void SolveCache::addInput(const NiMatrix43& a_val) {
+		for (auto i = 0; i < 3; i++) {
+			for (auto j = 0; j < 3; j++) {
+				_angles.push_back(a_val.data[i][j]);
+			}
+		}
+	}
+
+	void SolveCache::addInput(const NiTransform& a_val) {
+		addInput(a_val.rot);
+		addInput(a_val.pos);
+		addScale(a_val.scale);
+	}
+
+	void SolveCache::addAngle(float a_val) {
+		_angles.push_back(a_val);
+	}
+
+	void SolveCache::addScale(float a_val) {
+		_angles.push_back(a_val);
+	}
+
+	void SolveCache::addDirection(const NiPoint3& a_val) {
+		_angles.push_back(a_val.x);
+		_angles.push_back(a_val.y);
+		_angles.push_back(a_val.z);
+	}
+
+	bool SolveCache::tryReuse() {
+
+		if (!settings.enabled || !_valid) {
+			misses++;
+			return false;
+		}
+
+		if (++_framesSinceSolve >= settings.refreshFrames) {
+			misses++;
+			return false;
+		}
+
+		if (!withinTolerance(_inputs, _solvedInputs, settings.positionTolerance) || !withinTolerance(_angles, _solvedAngles, settings.angleTolerance)) {
+			misses++;
+			return false;
+		}
+
+		restore();
+		hits++;
+		return true;
+	}
+
+	bool SolveCache::reapply() {
+		if (!_valid) {
+			return false;
+		}
+
+		restore();
+		return true;
+	}
+
+	void SolveCache::restore() {
+		for (auto& out : _nodes) {
+			out.node->m_localTransform = out.local;
+			if (out.saveWorld) {
+				out.node->m_worldTransform = out.world;
+			}
+		}
+
+		for (auto& out : _points) {
+			*out.first = out.second;
+		}
+
+		for (auto& out : _floats) {
+			*out.first = out.second;
+		}
+	}
+
+	void SolveCache::beginOutputs() {
+		_nodes.clear();
+		_points.clear();
+		_floats.clear();
+	}
+
+	void SolveCache::addOutput(NiAVObject* a_node, bool a_saveWorld) {
+		if (!a_node) {
+			return;
+		}
+
+		_nodes.push_back({ a_node, a_node->m_localTransform, a_node->m_worldTransform, a_saveWorld });
+	}
+
+	void SolveCache::addOutput(NiPoint3* a_val) {
+		_points.push_back({ a_val, *a_val });
+	}
+
+	void SolveCache::addOutput(float* a_val) {
+		_floats.push_back({ a_val, *a_val });
+	}
+
+	void SolveCache::commit() {
+		_solvedInputs = _inputs;
+		_solvedAngles = _angles;
+		_framesSinceSolve = 0;
+		_valid = true;
+	}
+}
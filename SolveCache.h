@@ -0,0 +1,79 @@
+#pragma once
+#include "f4se/NiNodes.h"
+#include "f4se/NiObjects.h"
+
+#include <vector>
+
+namespace F4VRBody {
+
+	// copied from the c_ settings in loadConfig so the cache itself needs nothing from the game
+	struct SolveCacheSettings {
+		bool enabled = true;
+		float positionTolerance = 0.05f;     // game units
+		float angleTolerance = 0.0017f;      // radians, also used for rotation matrix entries, unit directions and scales
+		int refreshFrames = 30;
+	};
+
+	// Remembers the inputs and the resulting transforms of one IK solve so that frames where nothing moved
+	// (standing still with the controllers resting) can skip the math and just reapply the last result.
+	// Inputs are compared against the ones from the last real solve, not the last frame, so slow drift still
+	// triggers a new solve.   A solve is also forced every refreshFrames frames.
+	// Distances and angles are compared against their own tolerance, a rotation matrix entry moves by about the angle in
+	// radians so a tolerance that is fine for positions would let the rotations drift by more than half a degree.
+	class SolveCache {
+	public:
+		SolveCache() : hits(0), misses(0), _valid(false), _framesSinceSolve(0) {}
+
+		static SolveCacheSettings settings;
+
+		void beginInputs();
+		void addInput(float a_val);                  // a distance
+		void addInput(const NiPoint3& a_val);        // a position
+		void addInput(const NiMatrix43& a_val);
+		void addInput(const NiTransform& a_val);
+		void addAngle(float a_val);                  // radians
+		void addScale(float a_val);
+		void addDirection(const NiPoint3& a_val);    // unit vector
+
+		// returns true if the inputs are within tolerance and the saved outputs were reapplied
+		bool tryReuse();
+
+		// puts the saved outputs back without looking at the inputs, for frames the solve is skipped.   false if nothing
+		// was saved yet
+		bool reapply();
+
+		// call after a full solve to save off the results
+		void beginOutputs();
+		void addOutput(NiAVObject* a_node, bool a_saveWorld = false);
+		void addOutput(NiPoint3* a_val);
+		void addOutput(float* a_val);
+		void commit();
+
+		void invalidate() {
+			_valid = false;
+		}
+
+		uint64_t hits;
+		uint64_t misses;
+
+	private:
+		void restore();
+
+		struct NodeOutput {
+			NiAVObject* node;
+			NiTransform local;
+			NiTransform world;
+			bool saveWorld;
+		};
+
+		std::vector<float> _inputs;
+		std::vector<float> _solvedInputs;
+		std::vector<float> _angles;
+		std::vector<float> _solvedAngles;
+		std::vector<NodeOutput> _nodes;
+		std::vector<std::pair<NiPoint3*, NiPoint3>> _points;
+		std::vector<std::pair<float*, float>> _floats;
+		bool _valid;
+		int _framesSinceSolve;
+	};
+}
@@ -0,0 +1,96 @@
+#include "Startup.h"
+
+#include <cstdarg>
+
+namespace F4VRBody {
+
+	StartupGraph* g_startup = nullptr;
+
+	// set while a spawned loader runs
+	static thread_local std::vector<std::string>* loaderLog = nullptr;
+
+	void startupLog(const char* a_fmt, ...) {
+		char line[1024];
+		va_list args;
+		va_start(args, a_fmt);
+		vsnprintf(line, sizeof(line), a_fmt, args);
+		va_end(args);
+
+		if (loaderLog) {
+			loaderLog->push_back(line);
+		}
+		else {
+			_MESSAGE("%s", line);
+		}
+	}
+
+	double StartupGraph::msSince(LARGE_INTEGER a_start) {
+		LARGE_INTEGER now;
+		QueryPerformanceCounter(&now);
+		return (double)(now.QuadPart - a_start.QuadPart) * 1000.0 / (double)_freq.QuadPart;
+	}
+
+	void StartupGraph::addPhase(const char* a_name, double a_ms, bool a_async, std::vector<std::string> a_log) {
+		std::lock_guard<std::mutex> lock(_lock);
+		_phases.push_back({ a_name, a_ms, a_async, std::move(a_log) });
+	}
+
+	void StartupGraph::spawn(const char* a_name, std::function<void()> a_task) {
+		_threads.push_back(std::thread([this, a_name, a_task]() {
+			std::vector<std::string> log;
+			loaderLog = &log;
+
+			LARGE_INTEGER start;
+			QueryPerformanceCounter(&start);
+			a_task();
+			double ms = msSince(start);
+
+			loaderLog = nullptr;
+			addPhase(a_name, ms, true, std::move(log));
+		}));
+	}
+
+	bool StartupGraph::run(const char* a_name, std::function<bool()> a_task) {
+		LARGE_INTEGER start;
+		QueryPerformanceCounter(&start);
+		bool result = a_task();
+		addPhase(a_name, msSince(start), false);
+		return result;
+	}
+
+	void StartupGraph::join() {
+		if (_joined) {
+			return;
+		}
+		_joined = true;
+
+		LARGE_INTEGER start;
+		QueryPerformanceCounter(&start);
+		for (auto& thread : _threads) {
+			thread.join();
+		}
+		_threads.clear();
+		double waited = msSince(start);
+
+		std::lock_guard<std::mutex> lock(_lock);
+		for (auto& phase : _phases) {
+			_MESSAGE("startup: %-24s %8.2f ms%s", phase.name, phase.ms, phase.async ? "  (loader thread)" : "");
+			for (auto& line : phase.log) {
+				_MESSAGE("    %s", line.c_str());
+			}
+		}
+		_MESSAGE("startup: waited %.2f ms for loaders, %.2f ms since plugin load", waited, msSince(_start));
+	}
+
+	void waitForDebugger() {
+		CSimpleIniA ini;
+		if (ini.LoadFile(".\\Data\\F4SE\\plugins\\FRIK.ini") < 0 || !ini.GetBoolValue("Fallout4VRBody", "WaitForDebugger", false)) {
+			return;
+		}
+
+		_MESSAGE("waiting 5 seconds for a debugger");
+		for (auto i = 0; i < 50 && !IsDebuggerPresent(); i++) {
+			Sleep(100);
+		}
+	}
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include "F4VRBody.h"
+
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace F4VRBody {
+
+	// Plugin load in phases.   Things that only read files and don't touch the game (weapon offsets, cull lists) are
+	// spawned on their own threads while the hooks and patches are put in on the loader thread.   join() is called when
+	// the game has loaded, before the first update() can run, or on the way out of a failed load.   It logs how long every
+	// phase took along with whatever the spawned loaders logged, so nothing is written to the log from two threads.
+	class StartupGraph {
+	public:
+		StartupGraph() {
+			QueryPerformanceFrequency(&_freq);
+			QueryPerformanceCounter(&_start);
+		}
+
+		// runs on a new thread right away
+		void spawn(const char* a_name, std::function<void()> a_task);
+
+		// runs on the calling thread, returns what the phase returned
+		bool run(const char* a_name, std::function<bool()> a_task);
+
+		// waits for the spawned loaders.   only the first call does anything
+		void join();
+
+	private:
+		struct Phase {
+			const char* name;
+			double ms;
+			bool async;
+			std::vector<std::string> log;
+		};
+
+		double msSince(LARGE_INTEGER a_start);
+		void addPhase(const char* a_name, double a_ms, bool a_async, std::vector<std::string> a_log = {});
+
+		LARGE_INTEGER _freq;
+		LARGE_INTEGER _start;
+		std::mutex _lock;
+		std::vector<Phase> _phases;
+		std::vector<std::thread> _threads;
+		bool _joined = false;
+	};
+
+	extern StartupGraph* g_startup;
+
+	inline void InitStartup() {
+		g_startup = new StartupGraph();
+	}
+
+	// use instead of _MESSAGE in anything spawned at startup.   on a loader thread the line is kept for join(), anywhere
+	// else it goes straight to the log
+	void startupLog(const char* a_fmt, ...);
+
+	// the old fixed 5 second sleep in F4SEPlugin_Query, now only with WaitForDebugger in the ini.   returns as soon as a
+	// debugger is attached
+	void waitForDebugger();
+}
@@ -0,0 +1,124 @@
+#include "Telemetry.h"
+#include "FrameGovernor.h"
+#include "WorkCounters.h"
+#include "HookStats.h"
+#include "IKStats.h"
+
+#include <atomic>
+
+namespace F4VRBody {
+
+	Telemetry* g_telemetry = nullptr;
+
+	static_assert((int)kWork_Count == (int)FRIK_COUNTER_COUNT, "work counters and telemetry counters are out of sync");
+
+	Telemetry::Telemetry() {
+		QueryPerformanceFrequency(&_freq);
+		_frameStart.QuadPart = 0;
+		_last.QuadPart = 0;
+		memset(&_pending, 0, sizeof(FRIKTelemetry));
+
+		_block = nullptr;
+		_mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, sizeof(FRIKTelemetry), FRIK_TELEMETRY_NAME);
+
+		if (!_mapping) {
+			_MESSAGE("telemetry: could not create %s (%d)", FRIK_TELEMETRY_NAME, GetLastError());
+			return;
+		}
+
+		_block = (FRIKTelemetry*)MapViewOfFile(_mapping, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(FRIKTelemetry));
+
+		if (!_block) {
+			_MESSAGE("telemetry: could not map %s (%d)", FRIK_TELEMETRY_NAME, GetLastError());
+			CloseHandle(_mapping);
+			_mapping = nullptr;
+			return;
+		}
+
+		memset(_block, 0, sizeof(FRIKTelemetry));
+		_block->version = FRIK_TELEMETRY_VERSION;
+		_block->size = sizeof(FRIKTelemetry);
+
+		_MESSAGE("telemetry: publishing to %s", FRIK_TELEMETRY_NAME);
+	}
+
+	Telemetry::~Telemetry() {
+		if (_block) {
+			UnmapViewOfFile(_block);
+		}
+		if (_mapping) {
+			CloseHandle(_mapping);
+		}
+	}
+
+	void Telemetry::beginFrame() {
+		QueryPerformanceCounter(&_frameStart);
+		_last = _frameStart;
+
+		for (auto i = 0; i < FRIK_STAGE_COUNT; i++) {
+			_pending.stageMs[i] = 0.0f;
+		}
+	}
+
+	void Telemetry::mark(FRIKTelemetryStage a_stage) {
+		LARGE_INTEGER now;
+		QueryPerformanceCounter(&now);
+
+		_pending.stageMs[a_stage] += (float)((double)(now.QuadPart - _last.QuadPart) * 1000.0 / _freq.QuadPart);
+		_last = now;
+	}
+
+	void Telemetry::endFrame(UInt32 a_flags) {
+		if (!_block) {
+			return;
+		}
+
+		LARGE_INTEGER now;
+		QueryPerformanceCounter(&now);
+
+		_pending.flags = a_flags;
+		_pending.frame++;
+		_pending.frameMs = (float)((double)(now.QuadPart - _frameStart.QuadPart) * 1000.0 / _freq.QuadPart);
+		_pending.averageMs = (float)g_frameGovernor->getAverageMs();
+		_pending.governorLevel = g_frameGovernor->getLevel();
+
+		for (auto i = 0; i < FRIK_COUNTER_COUNT; i++) {
+			_pending.counters[i] = (uint32_t)g_workCounters.getThisFrame((WorkCounter)i);
+		}
+
+		for (auto i = 0; i < FRIK_HOOK_COUNT; i++) {
+			_pending.hookCalls[i] = g_hookStats.getCallsLastFrame((HookId)i);
+			_pending.hookUs[i] = g_hookStats.getMicrosLastFrame((HookId)i);
+		}
+
+		for (auto i = 0; i < FRIK_LIMB_COUNT; i++) {
+			const IKStats::Limb& limb = g_ikStats.getThisFrame((FRIKTelemetryLimb)i);
+			_pending.ikResidual[i] = limb.position;
+			_pending.ikRotResidual[i] = limb.rotation;
+			_pending.ikFlags[i] = limb.flags;
+		}
+		_pending.postureResidual = g_ikStats.getPostureThisFrame();
+
+		// seqlock write.   odd sequence tells readers the block is in flux
+		uint32_t seq = _block->sequence;
+		_block->sequence = seq + 1;
+		std::atomic_thread_fence(std::memory_order_release);
+
+		_block->flags = _pending.flags;
+		_block->frame = _pending.frame;
+		_block->frameMs = _pending.frameMs;
+		_block->averageMs = _pending.averageMs;
+		_block->governorLevel = _pending.governorLevel;
+		memcpy(_block->stageMs, _pending.stageMs, sizeof(_pending.stageMs));
+		memcpy(_block->counters, _pending.counters, sizeof(_pending.counters));
+		memcpy(_block->ikResidual, _pending.ikResidual, sizeof(_pending.ikResidual));
+		memcpy(_block->hookCalls, _pending.hookCalls, sizeof(_pending.hookCalls));
+		memcpy(_block->hookUs, _pending.hookUs, sizeof(_pending.hookUs));
+		memcpy(_block->ikRotResidual, _pending.ikRotResidual, sizeof(_pending.ikRotResidual));
+		memcpy(_block->ikFlags, _pending.ikFlags, sizeof(_pending.ikFlags));
+		_block->postureResidual = _pending.postureResidual;
+
+		std::atomic_thread_fence(std::memory_order_release);
+		_block->sequence = seq + 2;
+	}
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include "F4VRBody.h"
+#include "api/FRIKTelemetry.h"
+
+namespace F4VRBody {
+
+	// Writes the per frame stage timings, work counters, mode flags and ik residuals into a named shared memory block
+	// (layout in api/FRIKTelemetry.h) so an overlay or a console tool can watch FRIK live instead of digging through the log.
+	// Writing is a plain copy bracketed by the sequence counter, readers never block the game.
+	class Telemetry {
+	public:
+		Telemetry();
+		~Telemetry();
+
+		bool isOpen() {
+			return _block != nullptr;
+		}
+
+		void beginFrame();
+
+		// time since the previous mark (or beginFrame) goes to a_stage
+		void mark(FRIKTelemetryStage a_stage);
+
+		void endFrame(UInt32 a_flags);
+
+	private:
+		HANDLE _mapping;
+		FRIKTelemetry* _block;
+		FRIKTelemetry _pending;
+
+		LARGE_INTEGER _freq;
+		LARGE_INTEGER _frameStart;
+		LARGE_INTEGER _last;
+	};
+
+	extern Telemetry* g_telemetry;
+
+	inline void InitTelemetry() {
+		if (c_enableTelemetry) {
+			g_telemetry = new Telemetry();
+		}
+	}
+}
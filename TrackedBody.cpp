@@ -0,0 +1,70 @@
+#include "TrackedBody.h"
+
+namespace F4VRBody {
+
+	TrackedBody* g_trackedBody = nullptr;
+
+	static const char* partNames[kTracked_Count] = { "waist", "left foot", "right foot" };
+
+	void TrackedBody::assign() {
+		_assigned = true;
+
+		const std::string* serials[kTracked_Count] = { &c_waistTracker, &c_leftFootTracker, &c_rightFootTracker };
+		static const char* roles[kTracked_Count] = { "waist", "left_foot", "right_foot" };
+
+		for (auto& tracker : VRHook::g_vrHook->getViveTrackers()) {
+			std::string role = VRHook::g_vrHook->getTrackerRole(tracker.second);
+
+			for (auto i = 0; i < kTracked_Count; i++) {
+				// a serial in the ini wins over the steamvr role
+				bool bySerial = !serials[i]->empty() && tracker.first == *serials[i];
+				bool byRole = serials[i]->empty() && role.find(roles[i]) != std::string::npos;
+
+				if ((bySerial || byRole) && _index[i] == vr::k_unTrackedDeviceIndexInvalid) {
+					_index[i] = tracker.second;
+					_MESSAGE("tracker %s (%s) drives the %s", tracker.first.c_str(), role.c_str(), partNames[i]);
+				}
+			}
+		}
+	}
+
+	void TrackedBody::update(NiNode* a_roomNode) {
+		for (auto i = 0; i < kTracked_Count; i++) {
+			_valid[i] = false;
+		}
+
+		if (!c_enableBodyTrackers || !VRHook::g_vrHook || !VRHook::g_vrHook->viveTrackersPresent()) {
+			return;
+		}
+
+		if (!_assigned) {
+			assign();
+		}
+
+		VRHook::g_vrHook->setRoomNode(a_roomNode);
+		VRHook::g_vrHook->updatePoses();
+
+		for (auto i = 0; i < kTracked_Count; i++) {
+			if (_index[i] != vr::k_unTrackedDeviceIndexInvalid) {
+				_valid[i] = VRHook::g_vrHook->getTrackerWorldPose(_index[i], &_pose[i]);
+			}
+		}
+	}
+
+	void TrackedBody::calibrate(TrackedPart a_part, NiPoint3 a_bone) {
+		_offset[a_part] = _pose[a_part].rot.Transpose() * (a_bone - _pose[a_part].pos);
+		_calibrated[a_part] = true;
+
+		_MESSAGE("calibrated %s tracker: %f %f %f", partNames[a_part], _offset[a_part].x, _offset[a_part].y, _offset[a_part].z);
+	}
+
+	void TrackedBody::resetCalibration() {
+		for (auto i = 0; i < kTracked_Count; i++) {
+			_calibrated[i] = false;
+		}
+	}
+
+	NiPoint3 TrackedBody::getTarget(TrackedPart a_part) {
+		return _pose[a_part].pos + _pose[a_part].rot * _offset[a_part];
+	}
+}
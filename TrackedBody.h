@@ -0,0 +1,65 @@
+#pragma once
+#include "F4VRBody.h"
+#include "VR.h"
+
+namespace F4VRBody {
+
+	enum TrackedPart {
+		kTracked_Waist = 0,
+		kTracked_LeftFoot,
+		kTracked_RightFoot,
+		kTracked_Count
+	};
+
+	// Optional vive / tundra trackers for the lower body.   Trackers are matched to a part by the serial set in the ini or
+	// else by the role picked in SteamVR.   The first frame a tracker has a valid pose the offset from it to its bone is
+	// stored in the tracker's own space, after that the bone target follows the tracker and the procedural posture / stepping
+	// for that part is skipped.   Calibrate from the holotape (standing straight) takes the offsets again.
+	class TrackedBody {
+	public:
+		TrackedBody() {
+			for (auto i = 0; i < kTracked_Count; i++) {
+				_index[i] = vr::k_unTrackedDeviceIndexInvalid;
+				_valid[i] = false;
+				_calibrated[i] = false;
+			}
+			_assigned = false;
+		}
+
+		// once a frame before the posture.   a_roomNode is needed for world space poses
+		void update(NiNode* a_roomNode);
+
+		// tracking and calibrated, the bone should follow the tracker
+		bool isActive(TrackedPart a_part) {
+			return _valid[a_part] && _calibrated[a_part];
+		}
+
+		bool needsCalibration(TrackedPart a_part) {
+			return _valid[a_part] && !_calibrated[a_part];
+		}
+
+		// a_bone is where the bone is in world space right now
+		void calibrate(TrackedPart a_part, NiPoint3 a_bone);
+
+		// offsets are taken again on the next frame
+		void resetCalibration();
+
+		NiPoint3 getTarget(TrackedPart a_part);
+
+	private:
+		void assign();
+
+		bool _assigned;
+		vr::TrackedDeviceIndex_t _index[kTracked_Count];
+		bool _valid[kTracked_Count];
+		bool _calibrated[kTracked_Count];
+		NiTransform _pose[kTracked_Count];
+		NiPoint3 _offset[kTracked_Count];
+	};
+
+	extern TrackedBody* g_trackedBody;
+
+	inline void InitTrackedBody() {
+		g_trackedBody = new TrackedBody();
+	}
+}
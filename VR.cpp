@@ -39,6 +39,27 @@ namespace VRHook {
 		}
 	}
 
+	// same as above but the rotation is brought into world space too.   false if the tracker lost tracking or there is no room node yet
+	bool VRSystem::getTrackerWorldPose(vr::TrackedDeviceIndex_t idx, NiTransform* transform) {
+		vr::TrackedDevicePose_t pose = renderPoses[idx];
+
+		if (!pose.bPoseIsValid || !pose.bDeviceIsConnected || vrDataStruct == nullptr || roomNode == nullptr) {
+			return false;
+		}
+
+		HmdMatrixToNiTransform(transform, &pose);
+
+		NiMatrix43* worldSpaceMat = (NiMatrix43*)((char*)(*vrDataStruct) + 0x210);
+		NiPoint3* worldSpaceVec = (NiPoint3*)((char*)(*vrDataStruct) + 0x158);
+		transform->pos = transform->pos - *worldSpaceVec;
+		transform->pos = *worldSpaceMat * transform->pos;
+
+		Matrix44 mat;
+		mat.makeTransformMatrix(*worldSpaceMat, NiPoint3(0, 0, 0));
+		transform->rot = mat.multiply43Right(transform->rot);
+		return true;
+	}
+
 	void VRSystem::getControllerNiTransformByName(std::string trackerName, NiTransform* transform) {
 		vr::TrackedDevicePose_t pose = renderPoses[controllers[trackerName]];
 		HmdMatrixToNiTransform(transform, &pose);
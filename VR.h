@@ -31,7 +31,8 @@ namespace VRHook {
 			for (vr::TrackedDeviceIndex_t i = 0; i < vr::k_unMaxTrackedDeviceCount; i++) {
 				auto dc = vrHook->GetVRSystem()->GetTrackedDeviceClass(i);
 				if (dc == vr::ETrackedDeviceClass::TrackedDeviceClass_GenericTracker) {
-					viveTrackers.insert({ getProperty(vr::ETrackedDeviceProperty::Prop_ModelNumber_String, i), i });
+					// every vive tracker has the same model number so key them by serial
+					viveTrackers.insert({ getProperty(vr::ETrackedDeviceProperty::Prop_SerialNumber_String, i), i });
 				}
 				else if (dc == vr::ETrackedDeviceClass::TrackedDeviceClass_Controller) {
 					std::string prop = getProperty(vr::ETrackedDeviceProperty::Prop_ModelNumber_String, i);
@@ -63,6 +64,13 @@ namespace VRHook {
 
 		inline bool viveTrackersPresent() const { return !viveTrackers.empty(); }
 
+		inline const std::map<std::string, vr::TrackedDeviceIndex_t>& getViveTrackers() const { return viveTrackers; }
+
+		// the role picked for the tracker in SteamVR's "Manage Trackers" ends up in the controller type, e.g. vive_tracker_waist
+		inline std::string getTrackerRole(vr::TrackedDeviceIndex_t idx) {
+			return getProperty(vr::ETrackedDeviceProperty::Prop_ControllerType_String, idx);
+		}
+
 		inline void setVRControllerState() {
 			if (vrHook != nullptr) {
 
@@ -94,6 +102,7 @@ namespace VRHook {
 
 		void getTrackerNiTransformByName(std::string trackerName, NiTransform* transform);
 		void getTrackerNiTransformByIndex(vr::TrackedDeviceIndex_t idx, NiTransform* transform);
+		bool getTrackerWorldPose(vr::TrackedDeviceIndex_t idx, NiTransform* transform);
 		void getControllerNiTransformByName(std::string trackerName, NiTransform* transform);
 		void debugPrint();
 
@@ -0,0 +1,185 @@
+#include "Visibility.h"
+#include "F4VRBody.h"
+#include "utils.h"
+
+namespace F4VRBody {
+
+	VisibilityManager::VisibilityManager() {
+		for (auto i = 0; i < kVis_Count; i++) {
+			_desired[i] = true;
+		}
+		_desired[kVis_FistHelpers] = false;
+		_desired[kVis_WandUIPoint] = false;
+		_desired[kVis_Weapon] = false;
+
+		_pipboyHidden = false;
+		_writes = 0;
+		invalidate();
+	}
+
+	void VisibilityManager::invalidate() {
+		_bound = false;
+		_retryFrames = 0;
+
+		_wands[0] = WandMesh();
+		_wands[1] = WandMesh();
+		for (auto i = 0; i < kFistHelpers; i++) {
+			_fistHelpers[i] = nullptr;
+		}
+		_uiPoint = nullptr;
+		_weapon = nullptr;
+		_paHud = nullptr;
+		_backOfHand = nullptr;
+	}
+
+	// first trishape child, or the unnamed node the mesh sits under
+	void VisibilityManager::bindWand(NiNode* a_wand, WandMesh& a_mesh) {
+		a_mesh = WandMesh();
+
+		if (!a_wand) {
+			return;
+		}
+
+		for (auto i = 0; i < a_wand->m_children.m_emptyRunStart; i++) {
+			NiAVObject* child = a_wand->m_children.m_data[i];
+			if (!child) {
+				continue;
+			}
+
+			if (child->GetAsBSTriShape()) {
+				a_mesh.nodes[0] = child;
+				a_mesh.index = i;
+				return;
+			}
+
+			NiNode* node = child->GetAsNiNode();
+			if (node && !_stricmp(node->m_name.c_str(), "")) {
+				a_mesh.nodes[0] = node;
+				a_mesh.nodes[1] = node->m_children.m_emptyRunStart > 0 ? node->m_children.m_data[0] : nullptr;
+				a_mesh.index = i;
+				return;
+			}
+		}
+	}
+
+	bool VisibilityManager::wandValid(NiNode* a_wand, WandMesh& a_mesh) {
+		return a_wand && a_mesh.index >= 0 && a_mesh.index < a_wand->m_children.m_emptyRunStart &&
+			   a_wand->m_children.m_data[a_mesh.index] == a_mesh.nodes[0];
+	}
+
+	void VisibilityManager::bind(const VisibilityAttach& a_attach) {
+		invalidate();
+		_bound = true;
+		_attach = a_attach;
+		_pipboyHidden = false;    // new 3D starts out shown
+
+		bindWand(a_attach.primaryWand, _wands[0]);
+		bindWand(a_attach.secondaryWand, _wands[1]);
+
+		NiNode* rightWand = a_attach.leftHanded ? a_attach.secondaryWand : a_attach.primaryWand;
+		NiNode* leftWand = a_attach.leftHanded ? a_attach.primaryWand : a_attach.secondaryWand;
+		static const char* rightHelpers[3] = { "fist_M_Right_HELPER", "fist_F_Right_HELPER", "PA_fist_R_HELPER" };
+		static const char* leftHelpers[3] = { "fist_M_Left_HELPER", "fist_F_Left_HELPER", "PA_fist_L_HELPER" };
+
+		for (auto i = 0; i < 3; i++) {
+			_fistHelpers[i] = rightWand ? getChildNode(rightHelpers[i], rightWand) : nullptr;
+			_fistHelpers[i + 3] = leftWand ? getChildNode(leftHelpers[i], leftWand) : nullptr;
+		}
+
+		_uiPoint = a_attach.secondaryWand ? getChildNode("Point002", a_attach.secondaryWand) : nullptr;
+
+		if (a_attach.rightHand) {
+			_weapon = getObjectByName(a_attach.rightHand, "Weapon");
+		}
+		if (a_attach.uiAttach) {
+			_backOfHand = (NiNode*)getObjectByName(a_attach.uiAttach, "BackOfHand");
+		}
+
+		// the whole room node, only worth it in power armor
+		if (a_attach.inPowerArmor && a_attach.roomNode) {
+			_paHud = getChildNode("PowerArmorHelmetRoot", a_attach.roomNode);
+		}
+	}
+
+	void VisibilityManager::setCull(NiAVObject* a_node, bool a_hide) {
+		if (!a_node || ((a_node->flags & 0x1) != 0) == a_hide) {
+			return;
+		}
+
+		if (a_hide) {
+			a_node->flags |= 0x1;     // first bit sets the cull flag so it will be hidden
+		}
+		else {
+			a_node->flags &= 0xfffffffffffffffe;
+		}
+		_writes++;
+	}
+
+	void VisibilityManager::setScale(NiAVObject* a_node, float a_scale) {
+		if (!a_node || a_node->m_localTransform.scale == a_scale) {
+			return;
+		}
+
+		a_node->m_localTransform.scale = a_scale;
+		_writes++;
+	}
+
+	void VisibilityManager::apply(const VisibilityAttach& a_attach) {
+		_writes = 0;
+
+		// missing pieces (the PA helmet hud loads a little late) get looked for again every so often
+		bool missing = !_weapon || !_backOfHand || (a_attach.inPowerArmor && !_paHud);
+		if (!_bound || !(_attach == a_attach) || (missing && ++_retryFrames >= kRetryFrames)) {
+			bind(a_attach);
+		}
+
+		for (auto i = 0; i < 2; i++) {
+			NiNode* wand = i == 0 ? a_attach.primaryWand : a_attach.secondaryWand;
+			if (!wandValid(wand, _wands[i])) {
+				bindWand(wand, _wands[i]);
+			}
+
+			bool hide = !_desired[kVis_RightWand + i];
+			setCull(_wands[i].nodes[0], hide);
+			setCull(_wands[i].nodes[1], hide);
+		}
+
+		for (auto i = 0; i < kFistHelpers; i++) {
+			setCull(_fistHelpers[i], !_desired[kVis_FistHelpers]);
+		}
+
+		setScale(_uiPoint, _desired[kVis_WandUIPoint] ? 1.0f : 0.0f);
+
+		// the weapon's children change with the equipped weapon so they are checked every time, reading is cheap
+		if (_weapon) {
+			bool hide = !_desired[kVis_Weapon];
+			float scale = hide ? 0.0f : 1.0f;
+
+			setCull(_weapon, hide);
+			setScale(_weapon, scale);
+
+			NiNode* weapon = _weapon->GetAsNiNode();
+			for (auto i = 0; weapon && i < weapon->m_children.m_emptyRunStart; ++i) {
+				NiAVObject* child = weapon->m_children.m_data[i];
+				if (child && child->GetAsNiNode()) {
+					setCull(child, hide);
+					setScale(child, scale);
+				}
+			}
+		}
+
+		if (a_attach.pipboyBone) {
+			bool hide = !_desired[kVis_Pipboy];
+			NiAVObject* pipboy = a_attach.pipboyBone;
+
+			setScale(pipboy, hide ? 0.0f : 1.0f);
+			if (hide != _pipboyHidden && pipboy->GetAsNiNode()) {
+				toggleVis(pipboy->GetAsNiNode(), hide, true);
+				_writes++;
+			}
+			_pipboyHidden = hide;
+		}
+
+		setScale(_paHud, _desired[kVis_PAHud] ? 1.0f : 0.0f);
+	}
+}
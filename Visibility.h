@@ -0,0 +1,93 @@
+#pragma once
+#include "f4se/NiNodes.h"
+#include "f4se/NiObjects.h"
+
+namespace F4VRBody {
+
+	enum VisibilityItem {
+		kVis_RightWand = 0,     // wand mesh on primaryWandNode
+		kVis_LeftWand,          // wand mesh on SecondaryWandNode
+		kVis_FistHelpers,
+		kVis_WandUIPoint,       // Point002 on the secondary wand
+		kVis_Weapon,            // the weapon on the 3rd person body, the 1st person one is what gets seen
+		kVis_Pipboy,            // PipboyBone on the pipboy arm
+		kVis_PAHud,
+		kVis_Count
+	};
+
+	// what the bound nodes hang off of.   when any of these change the nodes are looked up again
+	struct VisibilityAttach {
+		NiNode* primaryWand = nullptr;
+		NiNode* secondaryWand = nullptr;
+		NiNode* roomNode = nullptr;
+		NiNode* uiAttach = nullptr;
+		NiAVObject* rightHand = nullptr;
+		NiAVObject* pipboyBone = nullptr;   // from PipboyInteraction
+		bool leftHanded = false;
+		bool inPowerArmor = false;
+
+		bool operator==(const VisibilityAttach& a_other) const {
+			return primaryWand == a_other.primaryWand && secondaryWand == a_other.secondaryWand && roomNode == a_other.roomNode &&
+				   uiAttach == a_other.uiAttach && rightHand == a_other.rightHand && pipboyBone == a_other.pipboyBone &&
+				   leftHanded == a_other.leftHanded && inPowerArmor == a_other.inPowerArmor;
+		}
+	};
+
+	// Everything FRIK shows or hides on the player.   Code during the frame only says what it wants with setVisible() and
+	// apply() at the end of the frame writes cull flags and scales, and only on the nodes that aren't already in that
+	// state.   Nodes are looked up once and kept until the 3D they hang off changes.
+	class VisibilityManager {
+	public:
+		VisibilityManager();
+
+		void invalidate();
+
+		void setVisible(VisibilityItem a_item, bool a_visible) {
+			_desired[a_item] = a_visible;
+		}
+
+		void apply(const VisibilityAttach& a_attach);
+
+		// BackOfHand on the primary UI attach node, showHidePAHUD moves it around in power armor
+		NiNode* getBackOfHand() {
+			return _backOfHand;
+		}
+
+		// scene graph writes done by the last apply()
+		UInt32 getWrites() {
+			return _writes;
+		}
+
+	private:
+		static const int kRetryFrames = 90;
+		static const int kFistHelpers = 6;
+
+		struct WandMesh {
+			NiAVObject* nodes[2] = { nullptr, nullptr };
+			int index = -1;       // child slot on the wand node, used to notice the mesh being swapped
+		};
+
+		void bind(const VisibilityAttach& a_attach);
+		void bindWand(NiNode* a_wand, WandMesh& a_mesh);
+		bool wandValid(NiNode* a_wand, WandMesh& a_mesh);
+
+		void setCull(NiAVObject* a_node, bool a_hide);
+		void setScale(NiAVObject* a_node, float a_scale);
+
+		bool _bound;
+		int _retryFrames;
+		VisibilityAttach _attach;
+
+		bool _desired[kVis_Count];
+		bool _pipboyHidden;      // last applied, the subtree flags can't be read back cheaply
+
+		WandMesh _wands[2];
+		NiAVObject* _fistHelpers[kFistHelpers];
+		NiAVObject* _uiPoint;
+		NiAVObject* _weapon;
+		NiAVObject* _paHud;
+		NiNode* _backOfHand;
+
+		UInt32 _writes;
+	};
+}
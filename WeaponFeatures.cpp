@@ -0,0 +1,70 @@
+#include "WeaponFeatures.h"
+#include "Offsets.h"
+#include "utils.h"
+
+namespace F4VRBody {
+
+	WeaponFeatureCache* g_weaponFeatures = nullptr;
+
+	void WeaponFeatureCache::update() {
+		NiNode* firstPerson = (*g_player)->firstPersonSkeleton ? (*g_player)->firstPersonSkeleton->GetAsNiNode() : nullptr;
+		if (firstPerson != _boundFirstPerson) {
+			_boundFirstPerson = firstPerson;
+			_weapon = firstPerson ? getChildNode("Weapon", firstPerson) : nullptr;
+			_model = nullptr;
+		}
+
+		auto equipData = (*g_player)->middleProcess->unk08->equipData;
+		TESForm* form = equipData ? equipData->item : nullptr;
+
+		void* equippedData = equipData ? equipData->equippedData : nullptr;
+		if (equippedData != _equippedData) {
+			_equippedData = equippedData;
+			_isWeaponData = equippedData && ((*(uint64_t*)equippedData & 0xFFFF) == (Offsets::EquippedWeaponData_vfunc & 0xFFFF));
+		}
+
+		NiAVObject* model = (_weapon && _weapon->m_children.m_emptyRunStart > 0) ? _weapon->m_children.m_data[0] : nullptr;
+		if (form == _form && model == _model) {
+			return;
+		}
+
+		_form = form;
+		_model = model;
+		build();
+	}
+
+	void WeaponFeatureCache::build() {
+		_features = WeaponFeatures();
+		if (!_weapon || !_model) {
+			return;
+		}
+
+		_features = measureWeaponFeatures(_weapon);
+
+		if (c_verbose) {
+			_MESSAGE("weapon features: barrel %f %f %f muzzle %d %f %f %f grip %f - %f scope %d", _features.barrelAxis.x, _features.barrelAxis.y, _features.barrelAxis.z,
+				_features.hasMuzzle, _features.muzzle.x, _features.muzzle.y, _features.muzzle.z, _features.gripNear, _features.gripFar, _features.reticle != nullptr);
+		}
+	}
+
+	NiPoint3 WeaponFeatureCache::toWeaponSpace(NiPoint3 a_worldPos) {
+		return F4VRBody::toWeaponSpace(_weapon->m_worldTransform, a_worldPos);
+	}
+
+	bool WeaponFeatureCache::inForegrip(NiPoint3 a_worldPos) {
+		if (!_weapon) {
+			return false;
+		}
+
+		return F4VRBody::inForegrip(_features, _weapon->m_worldTransform, a_worldPos);
+	}
+
+	MuzzleFlash* WeaponFeatureCache::getMuzzleFlash() {
+		if (!_isWeaponData) {
+			return nullptr;
+		}
+
+		// the muzzle flash itself comes and goes with firing, only the type check is cached
+		return reinterpret_cast<MuzzleFlash*>((*g_player)->middleProcess->unk08->equipData->equippedData->unk28);
+	}
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include "F4VRBody.h"
+#include "MuzzleFlash.h"
+#include "WeaponGeometry.h"
+
+namespace F4VRBody {
+
+	// Rebuilds the features whenever the equipped weapon or the model under the Weapon node changes, so the per frame code
+	// just does one transform into weapon space instead of node searches.   Also keeps the Weapon node itself and whether
+	// the equipped data is weapon data for the muzzle flash fix.
+	class WeaponFeatureCache {
+	public:
+		// once a frame before the weapon code runs
+		void update();
+
+		NiNode* getWeaponNode() {
+			return _weapon;
+		}
+
+		const WeaponFeatures& get() {
+			return _features;
+		}
+
+		// world position into weapon node space
+		NiPoint3 toWeaponSpace(NiPoint3 a_worldPos);
+
+		// true if a_worldPos is in front of the grip and close enough to the barrel line to grab it
+		bool inForegrip(NiPoint3 a_worldPos);
+
+		// muzzle flash of the equipped weapon or nullptr
+		MuzzleFlash* getMuzzleFlash();
+
+	private:
+		void build();
+
+		NiNode* _boundFirstPerson = nullptr;
+		NiNode* _weapon = nullptr;
+		TESForm* _form = nullptr;
+		NiAVObject* _model = nullptr;
+		WeaponFeatures _features;
+
+		void* _equippedData = nullptr;
+		bool _isWeaponData = false;
+	};
+
+	extern WeaponFeatureCache* g_weaponFeatures;
+
+	inline void InitWeaponFeatures() {
+		g_weaponFeatures = new WeaponFeatureCache();
+	}
+}
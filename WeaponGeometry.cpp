@@ -0,0 +1,62 @@
+#include "WeaponGeometry.h"
+#include "utils.h"
+
+namespace F4VRBody {
+
+	// projectile nodes that point further off the weapon's Y than this are modelled oddly, keep the old fixed barrel then
+	static const float minBarrelAlignment = 0.985f;
+
+	// same cone the old offHandToBarrel check used
+	static const float foregripCone = 0.955f;
+
+	WeaponFeatures measureWeaponFeatures(NiNode* a_weapon) {
+		WeaponFeatures features;
+
+		// walk the local transforms up from the projectile node to the weapon node
+		static BSFixedString projectileNodeName("ProjectileNode");
+		NiAVObject* projectile = getObjectByName(a_weapon, projectileNodeName);
+
+		if (projectile) {
+			NiPoint3 pos(0, 0, 0);
+			NiPoint3 axis(0, 1, 0);
+			NiAVObject* node = projectile;
+			while (node && node != a_weapon) {
+				pos = node->m_localTransform.rot * (pos * node->m_localTransform.scale) + node->m_localTransform.pos;
+				axis = node->m_localTransform.rot * axis;
+				node = node->m_parent;
+			}
+
+			if (node == a_weapon) {
+				axis = vec3_norm(axis);
+				if (vec3_dot(axis, NiPoint3(0, 1, 0)) > minBarrelAlignment) {
+					features.barrelAxis = axis;
+				}
+
+				// a little past the muzzle still counts, hands on suppressors and long barrels
+				features.muzzle = pos;
+				features.hasMuzzle = true;
+				features.gripFar = vec3_dot(pos, features.barrelAxis) + features.gripNear;
+			}
+		}
+
+		static BSFixedString reticleNodeName("ReticleNode");
+		features.reticle = getObjectByName(a_weapon, reticleNodeName);
+
+		features.valid = true;
+		return features;
+	}
+
+	NiPoint3 toWeaponSpace(const NiTransform& a_weaponWorld, NiPoint3 a_worldPos) {
+		return a_weaponWorld.rot.Transpose() * (a_worldPos - a_weaponWorld.pos) / a_weaponWorld.scale;
+	}
+
+	bool inForegrip(const WeaponFeatures& a_features, const NiTransform& a_weaponWorld, NiPoint3 a_worldPos) {
+		NiPoint3 local = toWeaponSpace(a_weaponWorld, a_worldPos);
+		float along = vec3_dot(local, a_features.barrelAxis);
+		if (along < a_features.gripNear || (a_features.gripFar > 0.0f && along > a_features.gripFar)) {
+			return false;
+		}
+
+		return vec3_dot(vec3_norm(local), a_features.barrelAxis) > foregripCone;
+	}
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include "f4se/NiNodes.h"
+#include "f4se/NiObjects.h"
+
+namespace F4VRBody {
+
+	// What the two handed and scope code needs to know about the equipped weapon, measured once from its 3D.
+	// Everything is in the space of the "Weapon" node so it stays valid however the weapon gets moved around.
+	struct WeaponFeatures {
+		bool valid = false;
+		NiPoint3 barrelAxis = NiPoint3(0, 1, 0);   // unit vector down the barrel
+		NiPoint3 muzzle = NiPoint3(0, 0, 0);
+		bool hasMuzzle = false;
+		float gripNear = 10.0f;                    // where along the barrel the offhand can grab
+		float gripFar = 0.0f;                      // 0 when there is no muzzle to measure to
+		NiAVObject* reticle = nullptr;             // ReticleNode, only scoped weapons have one
+	};
+
+	// the weapon's features from the model under a_weapon.   only local transforms are used, on the frame the weapon gets
+	// equipped the world transforms aren't updated yet
+	WeaponFeatures measureWeaponFeatures(NiNode* a_weapon);
+
+	// world position into the space of a node with world transform a_weaponWorld
+	NiPoint3 toWeaponSpace(const NiTransform& a_weaponWorld, NiPoint3 a_worldPos);
+
+	// true if a_worldPos is in front of the grip and close enough to the barrel line to grab it
+	bool inForegrip(const WeaponFeatures& a_features, const NiTransform& a_weaponWorld, NiPoint3 a_worldPos);
+}
@@ -0,0 +1,84 @@
+#include "WorkCounters.h"
+
+namespace F4VRBody {
+
+	WorkCounters g_workCounters;
+
+	static const char* workCounterNames[kWork_Count] = {
+		"nodeLookups",
+		"nodesVisited",
+		"objectByName",
+		"worldUpdates",
+		"mapLookups",
+		"fixedStrings",
+		"papyrusEvents",
+	};
+
+	WorkCounters::WorkCounters() {
+		QueryPerformanceFrequency(&_freq);
+		QueryPerformanceCounter(&_windowStart);
+
+		for (auto i = 0; i < kWork_Count; i++) {
+			_frame[i] = 0;
+			_window[i] = 0;
+			_windowPeak[i] = 0;
+			_perFrame[i] = 0.0f;
+			_peakPerFrame[i] = 0.0f;
+		}
+		_windowFrames = 0;
+		_lastFrames = 0;
+	}
+
+	void WorkCounters::endFrame() {
+		for (auto i = 0; i < kWork_Count; i++) {
+			_window[i] += _frame[i];
+			_windowPeak[i] = _frame[i] > _windowPeak[i] ? _frame[i] : _windowPeak[i];
+			_frame[i] = 0;
+		}
+		_windowFrames++;
+
+		LARGE_INTEGER now;
+		QueryPerformanceCounter(&now);
+
+		if ((now.QuadPart - _windowStart.QuadPart) < _freq.QuadPart) {
+			return;
+		}
+
+		for (auto i = 0; i < kWork_Count; i++) {
+			_perFrame[i] = (float)_window[i] / _windowFrames;
+			_peakPerFrame[i] = (float)_windowPeak[i];
+			_window[i] = 0;
+			_windowPeak[i] = 0;
+		}
+		_lastFrames = _windowFrames;
+		_windowFrames = 0;
+		_windowStart = now;
+
+		if (c_logWorkCounters) {
+			_MESSAGE("%s", getSummary().c_str());
+		}
+	}
+
+	float WorkCounters::getPerFrame(WorkCounter a_counter) {
+		return _perFrame[a_counter];
+	}
+
+	float WorkCounters::getPeakPerFrame(WorkCounter a_counter) {
+		return _peakPerFrame[a_counter];
+	}
+
+	std::string WorkCounters::getSummary() {
+		char buf[128];
+		std::string summary;
+
+		sprintf_s(buf, "work per frame over %d frames:", _lastFrames);
+		summary = buf;
+
+		for (auto i = 0; i < kWork_Count; i++) {
+			sprintf_s(buf, " %s %.1f (peak %.0f)", workCounterNames[i], _perFrame[i], _peakPerFrame[i]);
+			summary += buf;
+		}
+
+		return summary;
+	}
+}
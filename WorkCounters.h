@@ -0,0 +1,70 @@
+#pragma once
+#include "F4VRBody.h"
+
+namespace F4VRBody {
+
+	enum WorkCounter {
+		kWork_NodeLookups = 0,      // getNode / getChildNode / get1stChildNode calls
+		kWork_NodesVisited,         // nodes those searches walked through
+		kWork_ObjectByName,         // GetObjectByName calls
+		kWork_WorldUpdates,         // UpdateWorldData and updateTransforms calls
+		kWork_MapLookups,           // string keyed map lookups (boneTreeMap, _handBones, fingerRelations ...)
+		kWork_FixedStrings,         // BSFixedString constructions on the per frame path
+		kWork_PapyrusEvents,        // papyrus events sent
+		kWork_Count
+	};
+
+	// Counts how much scene graph work update() does.   The counts are summed every frame and rolled into a summary
+	// once a second so they can be read from the console or papyrus without adding anything to the hot path besides an add.
+	// Only meant to be touched from the main thread.
+	class WorkCounters {
+	public:
+		WorkCounters();
+
+		inline void add(WorkCounter a_counter, UInt32 a_amount = 1) {
+			_frame[a_counter] += a_amount;
+		}
+
+		void endFrame();
+
+		// running count for the frame in progress
+		UInt64 getThisFrame(WorkCounter a_counter) {
+			return _frame[a_counter];
+		}
+
+		// per frame average over the last full second
+		float getPerFrame(WorkCounter a_counter);
+		float getPeakPerFrame(WorkCounter a_counter);
+
+		std::string getSummary();
+
+	private:
+		LARGE_INTEGER _freq;
+		LARGE_INTEGER _windowStart;
+
+		UInt64 _frame[kWork_Count];
+		UInt64 _window[kWork_Count];
+		UInt64 _windowPeak[kWork_Count];
+		UInt32 _windowFrames;
+
+		float _perFrame[kWork_Count];
+		float _peakPerFrame[kWork_Count];
+		UInt32 _lastFrames;
+	};
+
+	// plain object rather than a pointer so nodes found during plugin load can be counted before anything is initialized
+	extern WorkCounters g_workCounters;
+
+	// string keyed map lookups that count themselves
+	template <class Map, class Key>
+	inline typename Map::mapped_type& countedLookup(Map& a_map, const Key& a_key) {
+		g_workCounters.add(kWork_MapLookups);
+		return a_map[a_key];
+	}
+
+	template <class Map, class Key>
+	inline typename Map::iterator countedFind(Map& a_map, const Key& a_key) {
+		g_workCounters.add(kWork_MapLookups);
+		return a_map.find(a_key);
+	}
+}
@@ -0,0 +1,97 @@
+#include "WorkerPool.h"
+
+namespace F4VRBody {
+
+	WorkerPool* g_ikWorkers = nullptr;
+
+	WorkerPool::WorkerPool(int a_numThreads) {
+		for (auto i = 0; i < a_numThreads; i++) {
+			_threads.emplace_back(&WorkerPool::workerLoop, this);
+		}
+		_MESSAGE("started %d ik worker threads", a_numThreads);
+	}
+
+	WorkerPool::~WorkerPool() {
+		{
+			std::lock_guard<std::mutex> lock(_lock);
+			_quit = true;
+		}
+		_wake.notify_all();
+
+		for (auto& thread : _threads) {
+			thread.join();
+		}
+	}
+
+	void WorkerPool::run(WorkerJob* a_jobs, int a_count) {
+
+		if (_threads.empty() || (a_count < 2)) {
+			for (auto i = 0; i < a_count; i++) {
+				a_jobs[i].fn(a_jobs[i].arg);
+			}
+			return;
+		}
+
+		int count = a_count;
+
+		{
+			std::lock_guard<std::mutex> lock(_lock);
+			_jobs = a_jobs;
+			_count = count;
+			_next = 0;
+			_finished = 0;
+			_generation++;
+		}
+		_wake.notify_all();
+
+		runJobs(a_jobs, count);
+
+		// join - wait for the other jobs and for any worker still holding onto this batch
+		std::unique_lock<std::mutex> lock(_lock);
+		_done.wait(lock, [&] { return (_finished == count) && (_active == 0); });
+		_jobs = nullptr;
+		_count = 0;
+	}
+
+	void WorkerPool::runJobs(WorkerJob* a_jobs, int a_count) {
+		if (!a_jobs) {
+			return;
+		}
+
+		for (int i = _next++; i < a_count; i = _next++) {
+			a_jobs[i].fn(a_jobs[i].arg);
+			_finished++;
+		}
+	}
+
+	void WorkerPool::workerLoop() {
+		uint64_t seen = 0;
+
+		while (true) {
+			WorkerJob* jobs;
+			int count;
+
+			{
+				std::unique_lock<std::mutex> lock(_lock);
+				_wake.wait(lock, [&] { return _quit || (_generation != seen); });
+
+				if (_quit) {
+					return;
+				}
+
+				seen = _generation;
+				jobs = _jobs;
+				count = _count;
+				_active++;
+			}
+
+			runJobs(jobs, count);
+
+			{
+				std::lock_guard<std::mutex> lock(_lock);
+				_active--;
+				_done.notify_all();
+			}
+		}
+	}
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include "F4VRBody.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace F4VRBody {
+
+	// a plain function and what to call it with, so handing out a batch never allocates
+	struct WorkerJob {
+		void (*fn)(void* a_arg);
+		void* arg;
+	};
+
+	// Small persistent pool for the limb IK jobs.   run() hands the jobs out to the workers, works on them itself
+	// as well and only returns once every job is done, so callers can treat it as a fork/join barrier.
+	// With no worker threads everything just runs inline on the calling thread.
+	class WorkerPool {
+	public:
+		WorkerPool(int a_numThreads);
+		~WorkerPool();
+
+		void run(WorkerJob* a_jobs, int a_count);
+
+		int numThreads() {
+			return (int)_threads.size();
+		}
+
+	private:
+		void workerLoop();
+		void runJobs(WorkerJob* a_jobs, int a_count);
+
+		std::vector<std::thread> _threads;
+		std::mutex _lock;
+		std::condition_variable _wake;
+		std::condition_variable _done;
+		WorkerJob* _jobs = nullptr;
+		int _count = 0;
+		int _active = 0;
+		std::atomic<int> _next = 0;
+		std::atomic<int> _finished = 0;
+		uint64_t _generation = 0;
+		bool _quit = false;
+	};
+
+	extern WorkerPool* g_ikWorkers;
+
+	inline void InitIKWorkers() {
+		// arms and legs are solved in pairs so one extra thread is all that is ever useful
+		g_ikWorkers = new WorkerPool(c_parallelIK ? 1 : 0);
+	}
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <stdint.h>
+
+// FRIK's solved pose, published for other native plugins so they don't have to search the scene graph again after FRIK runs.
+//
+// Getting the buffer: register an F4SE messaging listener for "F4VRBody".   At kMessage_PostPostLoad FRIK broadcasts a
+// message of type FRIK_MESSAGE_POSE_BUFFER whose data is a FRIKPoseBuffer*.   The pointer stays valid for the whole session.
+// If you missed the broadcast, Dispatch FRIK_MESSAGE_POSE_BUFFER_QUERY to "F4VRBody" any time after kMessage_PostLoad and
+// FRIK sends the same FRIK_MESSAGE_POSE_BUFFER message back to just your plugin.
+//
+// Reading: FRIK fills frames[] alternately at the end of its update and then sets latest to the frame it just finished.
+// From the main thread after FRIK's update a plain read of frames[latest] is fine.   From any other thread read frameNumber,
+// copy the frame and read frameNumber again - FRIK zeroes it while rewriting a frame, so if it is 0 or changed the copy
+// is torn and you should just read latest again.
+//
+// Transforms use the same layout as NiTransform (3x4 rotation rows, position, scale) and are world space.
+// Only ever add fields to the end and bump FRIK_POSE_BUFFER_VERSION when the layout changes.
+
+#define FRIK_MESSAGE_POSE_BUFFER    20
+#define FRIK_MESSAGE_POSE_BUFFER_QUERY  21
+#define FRIK_POSE_BUFFER_VERSION    1
+
+enum FRIKPoseBone {
+	FRIK_BONE_ROOT = 0,
+	FRIK_BONE_COM,
+	FRIK_BONE_PELVIS,
+	FRIK_BONE_SPINE1,
+	FRIK_BONE_SPINE2,
+	FRIK_BONE_CHEST,
+	FRIK_BONE_NECK,
+	FRIK_BONE_HEAD,
+	FRIK_BONE_RIGHT_CLAVICLE,
+	FRIK_BONE_RIGHT_UPPERARM,
+	FRIK_BONE_RIGHT_FOREARM,
+	FRIK_BONE_RIGHT_HAND,
+	FRIK_BONE_LEFT_CLAVICLE,
+	FRIK_BONE_LEFT_UPPERARM,
+	FRIK_BONE_LEFT_FOREARM,
+	FRIK_BONE_LEFT_HAND,
+	FRIK_BONE_RIGHT_THIGH,
+	FRIK_BONE_RIGHT_CALF,
+	FRIK_BONE_RIGHT_FOOT,
+	FRIK_BONE_LEFT_THIGH,
+	FRIK_BONE_LEFT_CALF,
+	FRIK_BONE_LEFT_FOOT,
+	FRIK_BONE_COUNT
+};
+
+// thumb, index, middle, ring, pinky
+#define FRIK_FINGER_COUNT   5
+
+#define FRIK_POSE_VALID         0x01    // bones are filled in
+#define FRIK_POSE_HAS_WEAPON    0x02    // weaponGrip is filled in
+#define FRIK_POSE_POWER_ARMOR   0x04
+#define FRIK_POSE_LEFT_HANDED   0x08
+
+#pragma pack(push, 8)
+struct FRIKPoseTransform {
+	float rot[3][4];
+	float pos[3];
+	float scale;
+};
+
+struct FRIKPoseFrame {
+	volatile uint64_t frameNumber;
+	uint32_t flags;                                     // FRIK_POSE_*
+	uint32_t pad;
+	struct FRIKPoseTransform bones[FRIK_BONE_COUNT];
+	float fingerCurl[2][FRIK_FINGER_COUNT];             // [0] right, [1] left.   0 = open, 1 = closed
+	struct FRIKPoseTransform weaponGrip;                // first person weapon node
+};
+
+struct FRIKPoseBuffer {
+	uint32_t version;
+	uint32_t size;                                      // sizeof(FRIKPoseBuffer) on FRIK's side
+	volatile uint32_t latest;                           // index into frames of the newest complete pose
+	uint32_t pad;
+	struct FRIKPoseFrame frames[2];
+};
+#pragma pack(pop)
@@ -0,0 +1,58 @@
+#pragma once
+#include <stdint.h>
+
+// Layout of the skeleton snapshot files FRIK writes (FRIK_Snapshots.frks next to FRIK.ini), read by tools/FRIKSnapshotView.
+//
+// A file is a FRIKSnapshotFileHeader followed by chunks, each a FRIKSnapshotChunk and then size bytes of payload:
+//   FRIK_SNAPSHOT_NAMES   uint32_t first id, uint32_t count, then count zero terminated names.   names are interned once
+//                         per file, ids are handed out in order so every names chunk continues where the last one stopped
+//   FRIK_SNAPSHOT_POSE    a FRIKSnapshotPose and then nodeCount FRIKSnapshotNodes in depth first order, parents always
+//                         come before their children
+//
+// Rotations are quaternions with w >= 0 stored as int16 / 32767.   Unknown chunk types can be skipped by size.
+// Only ever add chunk types or fields to the end and bump FRIK_SNAPSHOT_VERSION when the layout changes.
+
+#define FRIK_SNAPSHOT_MAGIC     0x534B5246      // "FRKS"
+#define FRIK_SNAPSHOT_VERSION   1
+#define FRIK_SNAPSHOT_LABEL     32
+
+enum FRIKSnapshotChunkType {
+	FRIK_SNAPSHOT_NAMES = 1,
+	FRIK_SNAPSHOT_POSE = 2
+};
+
+#pragma pack(push, 4)
+
+struct FRIKSnapshotFileHeader {
+	uint32_t magic;
+	uint32_t version;
+};
+
+struct FRIKSnapshotChunk {
+	uint32_t type;
+	uint32_t size;
+};
+
+struct FRIKSnapshotPose {
+	uint64_t sequence;                      // counts up over the session
+	double time;                            // seconds since the plugin loaded
+	char label[FRIK_SNAPSHOT_LABEL];
+	uint32_t nodeCount;
+	uint32_t reserved;
+};
+
+struct FRIKSnapshotNode {
+	uint32_t name;                          // id from the names chunks
+	int32_t parent;                         // index in this pose, -1 for the captured root
+	uint32_t flags;                         // low bits of the node flags, 0x1 is culled
+	int16_t localRot[4];                    // x y z w
+	float localPos[3];
+	float localScale;
+	int16_t worldRot[4];
+	float worldPos[3];
+	float worldScale;
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(FRIKSnapshotNode) == 60, "FRIKSnapshotNode layout changed");
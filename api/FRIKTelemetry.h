@@ -0,0 +1,99 @@
+#pragma once
+#include <stdint.h>
+
+// Layout of the live telemetry block FRIK publishes once per frame when EnableTelemetry is on.
+// On Windows it is a named file mapping (FRIK_TELEMETRY_NAME), anything can open it read only and sample it at any rate.
+//
+// Reading: the plugin bumps sequence to an odd number before it writes and back to an even number when it is done.
+// Copy the block, then read sequence again - if it is odd or changed during the copy throw the copy away and retry.
+//
+// Only ever add fields to the end and bump FRIK_TELEMETRY_VERSION when the layout changes.
+
+#define FRIK_TELEMETRY_NAME     "FRIK_Telemetry"
+#define FRIK_TELEMETRY_VERSION  3
+
+enum FRIKTelemetryStage {
+	FRIK_STAGE_BODY = 0,        // restore locals, head, body under hmd, posture
+	FRIK_STAGE_LEGS,            // knees, walk, leg ik
+	FRIK_STAGE_ARMS,            // weapon nodes, arm ik
+	FRIK_STAGE_ATTACHMENTS,     // pipboy, weapon, hud and mesh hiding, selfie
+	FRIK_STAGE_HANDS,           // hand ui, finger poses, pipboy operation, bone spheres
+	FRIK_STAGE_WEAPON,          // reload, two handed and scope
+	FRIK_STAGE_FINISH,          // bounds and bone array updates
+	FRIK_STAGE_COUNT
+};
+
+enum FRIKTelemetryCounter {
+	FRIK_COUNTER_NODE_LOOKUPS = 0,
+	FRIK_COUNTER_NODES_VISITED,
+	FRIK_COUNTER_OBJECT_BY_NAME,
+	FRIK_COUNTER_WORLD_UPDATES,
+	FRIK_COUNTER_MAP_LOOKUPS,
+	FRIK_COUNTER_FIXED_STRINGS,
+	FRIK_COUNTER_PAPYRUS_EVENTS,
+	FRIK_COUNTER_COUNT
+};
+
+enum FRIKTelemetryLimb {
+	FRIK_LIMB_RIGHT_ARM = 0,
+	FRIK_LIMB_LEFT_ARM,
+	FRIK_LIMB_RIGHT_LEG,
+	FRIK_LIMB_LEFT_LEG,
+	FRIK_LIMB_COUNT
+};
+
+// detours FRIK puts into the game.   the patches at the end only count calls, their time is always 0
+enum FRIKTelemetryHook {
+	FRIK_HOOK_BODY_UPDATE = 0,
+	FRIK_HOOK_MAIN_UPDATE_PLAYER,
+	FRIK_HOOK_SMOOTH_MOVEMENT,
+	FRIK_HOOK_REEQUIP_ALL,
+	FRIK_HOOK_SET_MULTIBOUND_REF,
+	FRIK_HOOK_GUN_RELOAD_INIT,
+	FRIK_HOOK_ANIMATION_UPDATE,
+	FRIK_HOOK_PATCH_INVENTORY,
+	FRIK_HOOK_PATCH_LOCK_FOR_READ,
+	FRIK_HOOK_PATCH_PIPE_GUN_SCOPE,
+	FRIK_HOOK_COUNT
+};
+
+#define FRIK_FLAG_POWER_ARMOR       0x01
+#define FRIK_FLAG_ARMS_ONLY         0x02
+#define FRIK_FLAG_REPOSITION        0x04
+#define FRIK_FLAG_SCOPE             0x08
+#define FRIK_FLAG_LEFT_HANDED       0x10
+#define FRIK_FLAG_SELFIE            0x20
+
+// what happened inside a limb's ik solve this frame
+#define FRIK_IK_SOLVED              0x01    // solved this frame rather than reused from the last one
+#define FRIK_IK_OUT_OF_REACH        0x02    // arm: target too far away, only the shoulder moved
+#define FRIK_IK_STRETCHED           0x04    // bones lengthened to reach the target
+#define FRIK_IK_ACOS_CLAMPED        0x08    // a joint angle fell outside acos and was forced back into range
+#define FRIK_IK_DEGENERATE          0x10    // target on top of the hip / shoulder
+#define FRIK_IK_ELBOW_BEHIND        0x20    // arm: elbow limits driven by the hand being behind the body
+#define FRIK_IK_ELBOW_CROSSED       0x40    // arm: elbow limits driven by the hand across the chest
+#define FRIK_IK_ELBOW_BEHIND_HEAD   0x80    // arm: elbow twisted forward for a hand behind the head
+
+#pragma pack(push, 8)
+struct FRIKTelemetry {
+	uint32_t version;
+	uint32_t size;                              // sizeof(FRIKTelemetry) on the writer side
+	volatile uint32_t sequence;                 // odd while a frame is being written
+	uint32_t flags;                             // FRIK_FLAG_*
+	uint64_t frame;
+	float frameMs;                              // time spent in FRIK's update this frame
+	float averageMs;                            // frame governor moving average
+	uint32_t governorLevel;
+	uint32_t pad;
+	float stageMs[FRIK_STAGE_COUNT];
+	uint32_t counters[FRIK_COUNTER_COUNT];      // this frame's work counters
+	float ikResidual[FRIK_LIMB_COUNT];          // distance between the ik target and where the hand/foot ended up
+	// version 2
+	uint32_t hookCalls[FRIK_HOOK_COUNT];        // calls during the last frame
+	float hookUs[FRIK_HOOK_COUNT];              // microseconds spent in each detour during the last frame
+	// version 3
+	float ikRotResidual[FRIK_LIMB_COUNT];       // degrees between the hand and its target rotation, always 0 for the feet
+	uint32_t ikFlags[FRIK_LIMB_COUNT];          // FRIK_IK_*
+	float postureResidual;                      // distance between the neck and where the posture solve put it
+};
+#pragma pack(pop)
@@ -3,6 +3,7 @@
 #include "f4se/GameReferences.h"
 #include "f4se/GameCamera.h"
 #include "GunReload.h"
+#include "HookStats.h"
 
 #include "xbyak/xbyak.h"
 
@@ -249,15 +250,16 @@ void hookMain() {
 //	g_branchTrampoline.Write5Call(hookEndUpdate.GetUIntPtr(), (uintptr_t)&hookIt);
 	//g_branchTrampoline.Write5Call(hookMainDrawCandidate.GetUIntPtr(), (uintptr_t)&hook2);
 //	g_branchTrampoline.Write5Call(hookMultiBoundCulling.GetUIntPtr(), (uintptr_t)&hook4);
-	g_branchTrampoline.Write5Call(hookSomeRandomFunc.GetUIntPtr(), (uintptr_t)&hook5);
+	// every detour goes in through a HookThunk so its calls and time show up in the hook stats
+	g_branchTrampoline.Write5Call(hookSomeRandomFunc.GetUIntPtr(), (uintptr_t)&F4VRBody::HookThunk<F4VRBody::kHook_BodyUpdate, &hook5>::call);
 
-	g_branchTrampoline.Write5Call(hookMainUpdatePlayer.GetUIntPtr(), (uintptr_t)&hook_main_update_player);
-	g_branchTrampoline.Write5Call(hook_smoothMovementHook.GetUIntPtr(), (uintptr_t)&hookSmoothMovement);
+	g_branchTrampoline.Write5Call(hookMainUpdatePlayer.GetUIntPtr(), (uintptr_t)&F4VRBody::HookThunk<F4VRBody::kHook_MainUpdatePlayer, &hook_main_update_player>::call);
+	g_branchTrampoline.Write5Call(hook_smoothMovementHook.GetUIntPtr(), (uintptr_t)&F4VRBody::HookThunk<F4VRBody::kHook_SmoothMovement, &hookSmoothMovement>::call);
 
-	g_branchTrampoline.Write5Call(hookActor_ReEquipAllExit.GetUIntPtr(), (uintptr_t)&fixPA3D);
-	g_branchTrampoline.Write5Call(hookExtraData_SetMultiBoundRef.GetUIntPtr(), (uintptr_t)&fixPA3DEnter);
-	g_branchTrampoline.Write5Call(hookActor_GetCurrentWeaponForGunReload.GetUIntPtr(), (uintptr_t)&gunReloadInit);
-	g_branchTrampoline.Write5Call(hookActor_SetupAnimationUpdateDataForRefernce.GetUIntPtr(), (uintptr_t)&updatePlayerAnimationHook);
+	g_branchTrampoline.Write5Call(hookActor_ReEquipAllExit.GetUIntPtr(), (uintptr_t)&F4VRBody::HookThunk<F4VRBody::kHook_ReEquipAll, &fixPA3D>::call);
+	g_branchTrampoline.Write5Call(hookExtraData_SetMultiBoundRef.GetUIntPtr(), (uintptr_t)&F4VRBody::HookThunk<F4VRBody::kHook_SetMultiBoundRef, &fixPA3DEnter>::call);
+	g_branchTrampoline.Write5Call(hookActor_GetCurrentWeaponForGunReload.GetUIntPtr(), (uintptr_t)&F4VRBody::HookThunk<F4VRBody::kHook_GunReloadInit, &gunReloadInit>::call);
+	g_branchTrampoline.Write5Call(hookActor_SetupAnimationUpdateDataForRefernce.GetUIntPtr(), (uintptr_t)&F4VRBody::HookThunk<F4VRBody::kHook_AnimationUpdate, &updatePlayerAnimationHook>::call);
 
 //	_MESSAGE("hooking main loop function");
 //	g_branchTrampoline.Write5Call(hookMainLoopFunc.GetUIntPtr(), (uintptr_t)updateCounter);
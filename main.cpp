@@ -16,6 +16,22 @@
 #include "patches.h"
 #include "GunReload.h"
 #include "VR.h"
+#include "WorkerPool.h"
+#include "FrameGovernor.h"
+#include "Telemetry.h"
+#include "PoseBuffer.h"
+#include "ConfigBatch.h"
+#include "BetterScopesChannel.h"
+#include "Haptics.h"
+#include "HeightField.h"
+#include "TrackedBody.h"
+#include "FingerTracking.h"
+#include "ActorIK.h"
+#include "Startup.h"
+#include "SkeletonSnapshot.h"
+#include "WeaponFeatures.h"
+#include "weaponOffset.h"
+#include "BoneQuery.h"
 
 
 
@@ -40,9 +56,20 @@ void PatchBody() {
 
 void OnBetterScopesMessage(F4SEMessagingInterface::Message* msg) {
 	if (msg) {
-		if (msg->type == 15) {
+		if (msg->type == F4VRBody::kScopes_GripConfig) {
 			F4VRBody::c_isLookingThroughScope = (bool)msg->data;
 		}
+		else if (msg->type == F4VRBody::kScopes_RateLimit) {
+			F4VRBody::g_scopesChannel->setMinInterval((UInt32)(uintptr_t)msg->data);
+		}
+	}
+}
+
+
+// other plugins asking for things they missed the broadcast of
+void OnPluginMessage(F4SEMessagingInterface::Message* msg) {
+	if (msg && msg->type == FRIK_MESSAGE_POSE_BUFFER_QUERY && msg->sender) {
+		F4VRBody::g_poseBuffer->announce(msg->sender);
 	}
 }
 
@@ -54,6 +81,9 @@ void OnF4SEMessage(F4SEMessagingInterface::Message* msg)
 	{
 		if (msg->type == F4SEMessagingInterface::kMessage_GameLoaded)
 		{
+			// loaders started in F4SEPlugin_Load have to be done before the first update
+			F4VRBody::g_startup->join();
+
 			F4VRBody::startUp();
 			SmoothMovementVR::StartFunctions();
 
@@ -64,10 +94,17 @@ void OnF4SEMessage(F4SEMessagingInterface::Message* msg)
 
 		}
 		if (msg->type == F4SEMessagingInterface::kMessage_PostLoad) {
-			bool gripConfig = !F4VRBody::c_staticGripping;
-			g_messaging->Dispatch(g_pluginHandle, 15, (void*) gripConfig, sizeof(bool), "FO4VRBETTERSCOPES");
+			F4VRBody::g_scopesChannel->sendGripConfig(!F4VRBody::c_staticGripping, true);
 
 			g_messaging->RegisterListener(g_pluginHandle, "FO4VRBETTERSCOPES", OnBetterScopesMessage);
+			g_messaging->RegisterListener(g_pluginHandle, nullptr, OnPluginMessage);
+		}
+		if (msg->type == F4SEMessagingInterface::kMessage_PreLoadGame || msg->type == F4SEMessagingInterface::kMessage_NewGame) {
+			F4VRBody::clearBoneQueries();
+		}
+		if (msg->type == F4SEMessagingInterface::kMessage_PostPostLoad) {
+			// every plugin has had its PostLoad to register listeners by now
+			F4VRBody::g_poseBuffer->announce();
 		}
 	}
 }
@@ -75,11 +112,12 @@ void OnF4SEMessage(F4SEMessagingInterface::Message* msg)
 extern "C" {
 	bool F4SEPlugin_Query(const F4SEInterface* a_f4se, PluginInfo* a_info)
 	{
-		Sleep(5000);
 		gLog.OpenRelative(CSIDL_MYDOCUMENTS, R"(\\My Games\\Fallout4VR\\F4SE\\Fallout4VRBody.log)");
 		gLog.SetPrintLevel(IDebugLog::kLevel_DebugMessage);
 		gLog.SetLogLevel(IDebugLog::kLevel_DebugMessage);
 
+		F4VRBody::waitForDebugger();
+
 		g_moduleHandle = reinterpret_cast<void*>(GetModuleHandleA("SkyrimUncapper.dll"));
 
 		_MESSAGE("F4VRBODY v%s", F4VRBODY_VERSION_VERSTRING);
@@ -108,6 +146,8 @@ extern "C" {
 	{
 		_MESSAGE("F4VRBody Init");
 
+		F4VRBody::InitStartup();
+
 		g_pluginHandle = a_f4se->GetPluginHandle();
 
 		if (g_pluginHandle == kPluginHandle_Invalid) {
@@ -130,11 +170,15 @@ extern "C" {
 			return false;
 		}
 
-		if (!F4VRBody::loadConfig()) {
+		if (!F4VRBody::g_startup->run("config", F4VRBody::loadConfig)) {
 			_ERROR("could not open ini config file");
 			return false;
 		}
 
+		// these only read files, the hooks and patches go in meanwhile
+		F4VRBody::g_startup->spawn("weapon offsets", F4VRBody::readOffsetJson);
+		F4VRBody::g_startup->spawn("cull lists", F4VRBody::loadCullLists);
+
 		g_papyrus = (F4SEPapyrusInterface*)a_f4se->QueryInterface(kInterface_Papyrus);
 
 
@@ -142,18 +186,43 @@ extern "C" {
 
 		if (!g_papyrus->Register(F4VRBody::RegisterFuncs)) {
 			_MESSAGE("FAILED TO REGISTER PAPYRUS FUNCTIONS!!");
+			F4VRBody::g_startup->join();
 			return false;
 		}
 
-		PatchBody();
-		
-		if (!patches::patchAll()) {
+		bool patched = F4VRBody::g_startup->run("patches", []() {
+			PatchBody();
+			return patches::patchAll();
+		});
+
+		if (!patched) {
 			_MESSAGE("error loading misc patches");
+			F4VRBody::g_startup->join();
 			return false;
 		}
 
-		F4VRBody::InitGunReloadSystem();
-		hookMain();
+		F4VRBody::g_startup->run("systems", []() {
+			F4VRBody::InitGunReloadSystem();
+			F4VRBody::InitIKWorkers();
+			F4VRBody::InitFrameGovernor();
+			F4VRBody::InitTelemetry();
+			F4VRBody::InitPoseBuffer();
+			F4VRBody::InitConfigTransactions();
+			F4VRBody::InitScopesChannel();
+			F4VRBody::InitHaptics();
+			F4VRBody::InitHeightField();
+			F4VRBody::InitTrackedBody();
+			F4VRBody::InitFingerTracking();
+			F4VRBody::InitActorIK();
+			F4VRBody::InitSkeletonSnapshots();
+			F4VRBody::InitWeaponFeatures();
+			return true;
+		});
+
+		F4VRBody::g_startup->run("hooks", []() {
+			hookMain();
+			return true;
+		});
 
 		_MESSAGE("F4VRBody Loaded");
 
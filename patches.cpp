@@ -7,6 +7,8 @@
 
 #include "xbyak/xbyak.h"
 
+#include "HookStats.h"
+
 
 namespace patches {
 
@@ -24,12 +26,24 @@ namespace patches {
 	RelocAddr<std::uint64_t> shaderEffectContinue(0x28d323f);
 	RelocAddr<std::uint64_t> shaderEffectReturn(0x28d4ec8);
 
+	// bumps the patch's hook counter without changing any register or flag the patched code relies on
+	static void countCall(Xbyak::CodeGenerator& a_code, F4VRBody::HookId a_hook) {
+		a_code.push(a_code.rax);
+		a_code.pushf();
+		a_code.mov(a_code.rax, (size_t)F4VRBody::g_hookStats.getCallCounter(a_hook));
+		a_code.lock();
+		a_code.inc(a_code.qword[a_code.rax]);
+		a_code.popf();
+		a_code.pop(a_code.rax);
+	}
+
 	void patchInventoryInfBug() {
 
 		struct PatchShortVar : Xbyak::CodeGenerator {
 			PatchShortVar(void* buf) : Xbyak::CodeGenerator(2048, buf) {
 				Xbyak::Label retLab;
-				
+
+				countCall(*this, F4VRBody::kHook_PatchInventory);
 				and (edi, 0xffff);   // edi is an int but should be treated as a short.  Should allow for loop to exit.
 
 				mov(r12d, 0xffff);
@@ -90,6 +104,7 @@ namespace patches {
 			PatchMoreMask(void* buf) : Xbyak::CodeGenerator(2048, buf) {
 				Xbyak::Label retLab;
 
+				countCall(*this, F4VRBody::kHook_PatchLockForRead);
 				and (dword[rdi + 0x4], 0xFFFFFFF);
 				mov(rcx, 1);
 				jmp(ptr[rip + retLab]);
@@ -114,7 +129,7 @@ namespace patches {
 				Xbyak::Label retLab;
 				Xbyak::Label contLab;
 
-
+				countCall(*this, F4VRBody::kHook_PatchPipeGunScope);
 				mov(r15, ptr[rsi + 0x78]);
 				test(r15,r15);
 				jz("null_pointer");
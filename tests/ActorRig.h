@@ -0,0 +1,75 @@
+#pragma once
+// A whole plain body made of nodes, for going through LimbIK the way Skeleton and ActorBody do.   Same proportions as
+// IKRig.h, bones point down their local x.
+#include "IKRig.h"
+#include "LimbIK.h"
+
+#include <memory>
+#include <vector>
+
+inline void updateWorld(NiNode* a_node) {
+	if (a_node->m_parent) {
+		a_node->m_worldTransform = childWorld(a_node->m_parent->m_worldTransform, a_node->m_localTransform);
+	}
+	else {
+		a_node->m_worldTransform = a_node->m_localTransform;
+	}
+	for (auto i = 0; i < a_node->m_children.m_emptyRunStart; i++) {
+		updateWorld((NiNode*)a_node->m_children.m_data[i]);
+	}
+}
+
+struct ActorRig {
+	std::vector<std::unique_ptr<NiNode>> owned;
+	std::vector<std::pair<NiNode*, NiTransform>> bindPose;
+
+	NiNode* root;
+	NiNode* chest;
+	NiNode* hip[2];
+	NiNode* knee[2];
+	NiNode* foot[2];
+	ArmNodes arm[2];    // right, left
+	LimbIK limbs;
+
+	NiNode* make(NiNode* a_parent, NiPoint3 a_pos) {
+		NiNode* node = new NiNode();
+		node->m_localTransform = makeLocal(0.0f);
+		node->m_localTransform.pos = a_pos;
+		owned.emplace_back(node);
+		bindPose.push_back({ node, node->m_localTransform });
+		if (a_parent) {
+			a_parent->AttachChild(node, true);
+		}
+		return node;
+	}
+
+	// same proportions as IKRig.h, bones point down their local x
+	explicit ActorRig(NiPoint3 a_pos) {
+		root = make(nullptr, a_pos);
+		NiNode* pelvis = make(root, NiPoint3(0, 0, 90));
+		chest = make(pelvis, NiPoint3(0, 0, 20));
+
+		for (auto side = 0; side < 2; side++) {
+			float x = side == 0 ? 1.0f : -1.0f;
+			hip[side] = make(pelvis, NiPoint3(10.0f * x, 0, 0));
+			knee[side] = make(hip[side], NiPoint3(45, 0, 0));
+			foot[side] = make(knee[side], NiPoint3(45, 0, 0));
+
+			NiNode* shoulder = make(chest, NiPoint3(8.0f * x, 0, 10));
+			NiNode* upper = make(shoulder, NiPoint3(12, 0, 0));
+			NiNode* forearm1 = make(upper, NiPoint3(28, 0, 0));
+			NiNode* forearm2 = make(forearm1, NiPoint3(8, 0, 0));
+			NiNode* forearm3 = make(forearm2, NiPoint3(8, 0, 0));
+			NiNode* hand = make(forearm3, NiPoint3(10, 0, 0));
+			arm[side] = { shoulder, upper, nullptr, forearm1, forearm2, forearm3, hand };
+		}
+	}
+
+	// what the animation graph does every frame before the ik gets to the actor
+	void animate() {
+		for (auto& bone : bindPose) {
+			bone.first->m_localTransform = bone.second;
+		}
+		updateWorld(root);
+	}
+};
@@ -0,0 +1,195 @@
+// Runs 1 to 64 plain actor rigs through LimbIK the way ActorBody::solve does (animation pose, prepare, both legs then both
+// arms on the ik workers, apply, world update) and prints the cost per actor, once with every target moving and once
+// with them held still so the solve cache takes over.   Also checks each actor's residuals and flags come out like the
+// player body's do, and that an actor the scheduler has no time for keeps its last solve instead of the animated pose.
+#include "TestUtil.h"
+#include "ActorRig.h"
+#include "WorkerPool.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+struct ActorTargets {
+	NiPoint3 foot[2];
+	NiPoint3 hand[2];
+};
+
+static ActorTargets targetsAt(const ActorRig& a_rig, int a_frame, bool a_moving) {
+	float t = a_moving ? a_frame * 0.05f : 0.0f;
+	NiPoint3 base = a_rig.root->m_localTransform.pos;
+	ActorTargets targets;
+
+	for (auto side = 0; side < 2; side++) {
+		float x = side == 0 ? 1.0f : -1.0f;
+		targets.foot[side] = base + NiPoint3(10.0f * x + 60.0f, sinf(t + side) * 20.0f, 90.0f + cosf(t + side) * 10.0f);
+		targets.hand[side] = base + NiPoint3(8.0f * x + 30.0f, 25.0f + sinf(t * 1.3f + side) * 10.0f, 110.0f + cosf(t) * 8.0f);
+	}
+	return targets;
+}
+
+// ActorBody::solve without the game
+static void solveActor(WorkerPool& a_pool, ActorRig& a_rig, const ActorTargets& a_targets) {
+	LegJob legs[2];
+	ArmJob arms[2];
+	bool solve[2];
+	WorkerJob jobs[2];
+	int count = 0;
+
+	a_rig.limbs.beginFrame();
+
+	for (auto i = 0; i < 2; i++) {
+		legs[i].hip = a_rig.hip[i];
+		legs[i].knee = a_rig.knee[i];
+		legs[i].foot = a_rig.foot[i];
+		legs[i].in.isLeft = i == 1;
+		legs[i].in.inPowerArmor = false;
+		legs[i].in.footPos = a_targets.foot[i];
+		solve[i] = a_rig.limbs.prepareLeg(legs[i]);
+		if (solve[i]) {
+			jobs[count++] = { runLegJob, &legs[i] };
+		}
+	}
+
+	a_pool.run(jobs, count);
+
+	for (auto i = 0; i < 2; i++) {
+		if (solve[i]) {
+			a_rig.limbs.applyLeg(legs[i]);
+		}
+		updateWorld(a_rig.hip[i]);
+	}
+
+	count = 0;
+	for (auto i = 0; i < 2; i++) {
+		ArmIKInput& in = arms[i].in;
+		arms[i].arm = a_rig.arm[i];
+		in.isLeft = i == 1;
+		in.inPowerArmor = false;
+		in.handPos = a_targets.hand[i];
+		in.handRot = a_rig.arm[i].hand->m_worldTransform.rot;
+		in.forwardDir = NiPoint3(0, 1, 0);
+		in.sidewaysRDir = NiPoint3(1, 0, 0);
+		in.chestZ = a_rig.chest->m_worldTransform.pos.z;
+		in.rootScale = 1.0f;
+		in.armLength = 36.74f;
+		solve[i] = a_rig.limbs.prepareArm(arms[i]);
+		if (solve[i]) {
+			jobs[count++] = { runArmJob, &arms[i] };
+		}
+	}
+
+	a_pool.run(jobs, count);
+
+	for (auto i = 0; i < 2; i++) {
+		if (solve[i]) {
+			a_rig.limbs.applyArm(arms[i]);
+		}
+		updateWorld(a_rig.arm[i].shoulder->GetAsNiNode());
+	}
+}
+
+// ActorBody::reapply without the game, every limb here has a target
+static void keepActor(ActorRig& a_rig) {
+	a_rig.limbs.beginFrame();
+
+	for (auto i = 0; i < 2; i++) {
+		if (a_rig.limbs.reapply((FRIKTelemetryLimb)(FRIK_LIMB_RIGHT_LEG + i))) {
+			updateWorld(a_rig.hip[i]);
+		}
+	}
+
+	for (auto i = 0; i < 2; i++) {
+		if (a_rig.limbs.reapply((FRIKTelemetryLimb)(FRIK_LIMB_RIGHT_ARM + i))) {
+			updateWorld(a_rig.arm[i].shoulder->GetAsNiNode());
+		}
+	}
+}
+
+// solved once, then out of budget for a while as the animation keeps writing over it
+static void testStarvedActor(WorkerPool& a_pool) {
+	ActorRig rig(NiPoint3(0, 0, 0));
+	ActorTargets targets = targetsAt(rig, 7, true);
+
+	// nothing solved yet, nothing to keep
+	rig.animate();
+	NiPoint3 animatedFoot = rig.foot[0]->m_worldTransform.pos;
+	keepActor(rig);
+	CHECK(vec3_len(rig.foot[0]->m_worldTransform.pos - animatedFoot) < 1e-4f);
+
+	solveActor(a_pool, rig, targets);
+	NiPoint3 feet[2] = { rig.foot[0]->m_worldTransform.pos, rig.foot[1]->m_worldTransform.pos };
+	NiPoint3 hands[2] = { rig.arm[0].hand->m_worldTransform.pos, rig.arm[1].hand->m_worldTransform.pos };
+	CHECK(vec3_len(feet[0] - animatedFoot) > 10.0f);
+
+	float worst = 0.0f;
+	for (auto frame = 0; frame < 30; frame++) {
+		rig.animate();
+		keepActor(rig);
+
+		for (auto i = 0; i < 2; i++) {
+			worst = (std::max)(worst, vec3_len(rig.foot[i]->m_worldTransform.pos - feet[i]));
+			worst = (std::max)(worst, vec3_len(rig.arm[i].hand->m_worldTransform.pos - hands[i]));
+		}
+		// put back rather than solved
+		CHECK(rig.limbs.getFlags(FRIK_LIMB_LEFT_LEG) == 0);
+	}
+
+	CHECK(worst < 1e-3f);
+	CHECK(rig.limbs.getResidual(FRIK_LIMB_RIGHT_LEG) < 0.05f);
+}
+
+struct ScalingResult {
+	double usPerActor;
+	int solvedLimbs;
+	float maxLegResidual;
+};
+
+static ScalingResult runActors(WorkerPool& a_pool, int a_actors, bool a_moving) {
+	const int frames = 200;
+	std::vector<std::unique_ptr<ActorRig>> rigs;
+	for (auto i = 0; i < a_actors; i++) {
+		rigs.emplace_back(new ActorRig(NiPoint3(i * 150.0f, 0, 0)));
+	}
+
+	ScalingResult result = { 0.0, 0, 0.0f };
+	double start = testNow();
+
+	for (auto frame = 0; frame < frames; frame++) {
+		for (auto& rig : rigs) {
+			rig->animate();
+			solveActor(a_pool, *rig, targetsAt(*rig, frame, a_moving));
+
+			for (auto limb = 0; limb < FRIK_LIMB_COUNT; limb++) {
+				result.solvedLimbs += (rig->limbs.getFlags((FRIKTelemetryLimb)limb) & FRIK_IK_SOLVED) != 0;
+			}
+			result.maxLegResidual = (std::max)(result.maxLegResidual, rig->limbs.getResidual(FRIK_LIMB_RIGHT_LEG));
+			result.maxLegResidual = (std::max)(result.maxLegResidual, rig->limbs.getResidual(FRIK_LIMB_LEFT_LEG));
+		}
+	}
+
+	result.usPerActor = (testNow() - start) * 1e6 / ((double)frames * a_actors);
+	return result;
+}
+
+int main() {
+	WorkerPool pool(1);
+	testStarvedActor(pool);
+
+	printf("actors   moving us/actor   still us/actor\n");
+	for (auto actors = 1; actors <= 64; actors *= 2) {
+		ScalingResult moving = runActors(pool, actors, true);
+		ScalingResult still = runActors(pool, actors, false);
+		printf("%6d   %15.2f   %14.2f\n", actors, moving.usPerActor, still.usPerActor);
+
+		// every limb solved every frame while the targets move, the feet land on them
+		CHECK(moving.solvedLimbs == actors * 200 * FRIK_LIMB_COUNT);
+		CHECK(moving.maxLegResidual < 0.05f);
+
+		// held still the cache puts the last solve back and the feet stay put through the animation writing over them
+		CHECK(still.solvedLimbs < moving.solvedLimbs / 4);
+		CHECK(still.maxLegResidual < 0.1f);
+	}
+
+	return testResult("ActorScaling");
+}
@@ -0,0 +1,184 @@
+// BoneQuery against a made up flattened bone tree and the mock VMArray.   Names are looked up once per tree, every later
+// call is only the pushes, and what lands in the array is what a script expects: x y z per bone for positions, plus
+// heading roll attitude in degrees for transforms, zeros for bones the tree doesn't have.
+#include "TestUtil.h"
+#include "F4VRBody.h"
+#include "BoneQuery.h"
+#include "IKRig.h"
+
+#include <string>
+#include <vector>
+
+using namespace F4VRBody;
+
+static UInt64 g_indexLookups = 0;
+
+namespace F4VRBody {
+	// the game's lookup is a hash, this is a walk but the test only counts the calls
+	int BSFlattenedBoneTree_GetBoneIndex(NiAVObject* a_tree, BSFixedString* a_name) {
+		g_indexLookups++;
+		BSFlattenedBoneTree* tree = (BSFlattenedBoneTree*)a_tree;
+		for (auto i = 0; i < tree->numTransforms; i++) {
+			if (!_stricmp(tree->transforms[i].name.c_str(), a_name->c_str())) {
+				return i;
+			}
+		}
+		return -1;
+	}
+}
+
+// Bone0 .. BoneN-1 with the fingertips at the end, each bone a unit further along x than the one before
+struct FakeBoneTree {
+	BSFlattenedBoneTree tree;
+	std::vector<BSFlattenedBoneTree::BoneTransforms> bones;
+
+	FakeBoneTree(int a_count, float a_offset) {
+		static const char* tips[10] = {
+			"RArm_Finger13", "RArm_Finger23", "RArm_Finger33", "RArm_Finger43", "RArm_Finger53",
+			"LArm_Finger13", "LArm_Finger23", "LArm_Finger33", "LArm_Finger43", "LArm_Finger53"
+		};
+
+		bones.resize(a_count + 10);
+		char name[32];
+		for (auto i = 0; i < (int)bones.size(); i++) {
+			sprintf_s(name, "Bone%d", i);
+			bones[i].name = BSFixedString(i < a_count ? name : tips[i - a_count]);
+			bones[i].world.rot = identityRot();
+			bones[i].world.pos = NiPoint3(a_offset + i, 2.0f * i, -1.0f * i);
+			bones[i].world.scale = 1.0f;
+		}
+		tree.numTransforms = (int)bones.size();
+		tree.transforms = bones.data();
+	}
+};
+
+static std::vector<BSFixedString> names(std::initializer_list<const char*> a_names) {
+	std::vector<BSFixedString> out;
+	for (auto name : a_names) {
+		out.push_back(BSFixedString(name));
+	}
+	return out;
+}
+
+static void testPositions() {
+	FakeBoneTree body(60, 0.0f);
+	std::vector<BSFixedString> query = names({ "Bone3", "bone10", "NotABone", "Bone59" });
+	BoneQuery bones(query);
+
+	UInt64 lookups = g_indexLookups;
+	UInt64 pushes = VMArrayCalls::pushes;
+	VMArray<float> out;
+	bones.getPositions(&body.tree, out);
+
+	// names resolve on the first call, case doesn't matter, one push per float
+	CHECK(g_indexLookups - lookups == 4);
+	CHECK(VMArrayCalls::pushes - pushes == 12);
+	CHECK(out.Length() == 12);
+
+	std::vector<float>& f = out.items();
+	CHECK(f[0] == 3.0f && f[1] == 6.0f && f[2] == -3.0f);
+	CHECK(f[3] == 10.0f && f[4] == 20.0f && f[5] == -10.0f);
+	CHECK(f[6] == 0.0f && f[7] == 0.0f && f[8] == 0.0f);
+	CHECK(f[9] == 59.0f && f[10] == 118.0f && f[11] == -59.0f);
+
+	// same tree, no lookups, and it follows the bones when they move
+	body.bones[3].world.pos.x = 100.0f;
+	lookups = g_indexLookups;
+	VMArray<float> again;
+	bones.getPositions(&body.tree, again);
+	CHECK(g_indexLookups == lookups);
+	CHECK(again.items()[0] == 100.0f);
+
+	// a different bone tree (power armor) resolves again, and a bone past its end counts as unknown
+	FakeBoneTree armor(5, 1000.0f);
+	lookups = g_indexLookups;
+	VMArray<float> inArmor;
+	bones.getPositions(&armor.tree, inArmor);
+	CHECK(g_indexLookups - lookups == 4);
+	CHECK(inArmor.Length() == 12);
+	CHECK(inArmor.items()[0] == 1003.0f);
+	CHECK(inArmor.items()[3] == 0.0f && inArmor.items()[9] == 0.0f);
+}
+
+static void testTransforms() {
+	FakeBoneTree body(60, 0.0f);
+
+	// heading is about x, attitude about y and roll about z
+	body.bones[7].world.rot = getRotationAxisAngle(NiPoint3(1, 0, 0), degrees_to_rads(20.0f));
+	body.bones[8].world.rot = getRotationAxisAngle(NiPoint3(0, 1, 0), degrees_to_rads(30.0f));
+	body.bones[9].world.rot = getRotationAxisAngle(NiPoint3(0, 0, 1), degrees_to_rads(-40.0f));
+
+	std::vector<BSFixedString> query = names({ "Bone1", "Bone7", "Bone8", "Bone9", "Missing" });
+	BoneQuery bones(query);
+
+	UInt64 pushes = VMArrayCalls::pushes;
+	VMArray<float> out;
+	bones.getTransforms(&body.tree, out);
+	CHECK(VMArrayCalls::pushes - pushes == 30);
+	CHECK(out.Length() == 30);
+
+	// x y z heading roll attitude
+	const float expected[5][6] = {
+		{ 1.0f, 2.0f, -1.0f, 0.0f, 0.0f, 0.0f },
+		{ 7.0f, 14.0f, -7.0f, 20.0f, 0.0f, 0.0f },
+		{ 8.0f, 16.0f, -8.0f, 0.0f, 0.0f, 30.0f },
+		{ 9.0f, 18.0f, -9.0f, 0.0f, -40.0f, 0.0f },
+		{ 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f },
+	};
+	for (auto bone = 0; bone < 5; bone++) {
+		for (auto i = 0; i < 6; i++) {
+			CHECK_NEAR(out.items()[bone * 6 + i], expected[bone][i], 1e-3f);
+		}
+	}
+}
+
+// one batched query against looking the names up on every call, in game lookups and VM calls per frame
+static void benchmarkFingertips() {
+	const int frames = 20000;
+	FakeBoneTree body(120, 0.0f);
+	BoneQuery* tips = getFingertipQuery();
+
+	UInt64 lookups = g_indexLookups;
+	UInt64 pushes = VMArrayCalls::pushes;
+	double start = testNow();
+	for (auto frame = 0; frame < frames; frame++) {
+		VMArray<float> out;
+		tips->getPositions(&body.tree, out);
+	}
+	double batched = testNow() - start;
+	UInt64 batchedLookups = g_indexLookups - lookups;
+	UInt64 batchedPushes = VMArrayCalls::pushes - pushes;
+
+	// the same ten bones looked up by name every call
+	lookups = g_indexLookups;
+	pushes = VMArrayCalls::pushes;
+	start = testNow();
+	for (auto frame = 0; frame < frames; frame++) {
+		VMArray<float> out;
+		for (auto i = 0; i < 10; i++) {
+			std::vector<BSFixedString> one = { body.bones[120 + i].name };
+			BoneQuery single(one);
+			single.getPositions(&body.tree, out);
+		}
+	}
+	double perBone = testNow() - start;
+	UInt64 perBoneLookups = g_indexLookups - lookups;
+	UInt64 perBonePushes = VMArrayCalls::pushes - pushes;
+
+	printf("fingertips over %d frames\n", frames);
+	printf("  batched query   %.2f lookups  %.0f pushes per frame  %.3f us\n", (double)batchedLookups / frames, (double)batchedPushes / frames, batched * 1e6 / frames);
+	printf("  lookup per call %.2f lookups  %.0f pushes per frame  %.3f us\n", (double)perBoneLookups / frames, (double)perBonePushes / frames, perBone * 1e6 / frames);
+
+	// names are only looked up the first frame
+	CHECK(batchedLookups == 10);
+	CHECK(batchedPushes == (UInt64)frames * 30);
+	CHECK(perBoneLookups == (UInt64)frames * 10);
+}
+
+int main() {
+	testPositions();
+	testTransforms();
+	benchmarkFingertips();
+
+	return testResult("BoneQueryCalls");
+}
@@ -0,0 +1,204 @@
+// ConfigTransactions driven the way the papyrus natives do it, from several script threads at once, with applyPending on
+// the main thread.   A bad key or value throws away the whole batch, nothing lands in the settings before applyPending,
+// the main thread never sees half a batch, and the ini is saved once per applyPending however many batches asked.
+#include "TestUtil.h"
+#include "F4VRBody.h"
+#include "ConfigBatch.h"
+#include "BetterScopesChannel.h"
+#include "Skeleton.h"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace F4VRBody;
+
+static int g_saves = 0;
+static int g_bodyLenUpdates = 0;
+// grip configs that went to better scopes
+static int g_gripMessages = 0;
+static float g_fingers[2][5];
+static int g_fingerCalls = 0;
+static Setting g_vrScaleSetting;
+
+namespace F4VRBody {
+	Skeleton* playerSkelly = nullptr;
+
+	void Skeleton::setBodyLen() {
+		g_bodyLenUpdates++;
+	}
+
+	void saveSettings() {
+		g_saves++;
+	}
+
+	void setFingerPositionScalar(StaticFunctionTag*, bool isLeft, float thumb, float index, float middle, float ring, float pinky) {
+		float* f = g_fingers[isLeft ? 1 : 0];
+		f[0] = thumb;
+		f[1] = index;
+		f[2] = middle;
+		f[3] = ring;
+		f[4] = pinky;
+		g_fingerCalls++;
+	}
+}
+
+Setting* GetINISetting(const char* a_name) {
+	return !strcmp(a_name, "fVrScale:VR") ? &g_vrScaleSetting : nullptr;
+}
+
+static bool countDispatch(PluginHandle, UInt32 a_type, void*, UInt32, const char* a_receiver) {
+	g_gripMessages += a_type == kScopes_GripConfig && a_receiver && !strcmp(a_receiver, "FO4VRBETTERSCOPES") ? 1 : 0;
+	return true;
+}
+
+// one script's BeginConfig, SetConfigFloats / SetConfigBools, CommitConfig
+static bool scriptCommit(ConfigTransactions& a_config, std::vector<std::string> a_floatKeys, std::vector<float> a_floats,
+	std::vector<std::string> a_boolKeys, std::vector<bool> a_bools, bool a_persist) {
+	UInt32 batch = a_config.begin();
+	bool staged = a_config.setFloats(batch, a_floatKeys, a_floats);
+	staged = a_config.setBools(batch, a_boolKeys, a_bools) && staged;
+	return a_config.commit(batch, a_persist) && staged;
+}
+
+static void testRejectsWholeBatch() {
+	ConfigTransactions config;
+
+	// every key but one is fine, none of them go in
+	CHECK(!scriptCommit(config, { "armLength", "handUI_X", "notASetting" }, { 40.0f, 5.0f, 1.0f }, { "HideHead" }, { true }, true));
+	CHECK(!scriptCommit(config, { "armLength" }, { 40.0f }, { "HideHead", "bNoSuchThing" }, { true, true }, true));
+
+	// out of range and not a number are just as bad
+	CHECK(!scriptCommit(config, { "armLength", "PlayerHeight" }, { 40.0f, 500.0f }, {}, {}, true));
+	CHECK(!scriptCommit(config, { "armLength", "handUI_Y" }, { 40.0f, NAN }, {}, {}, true));
+
+	UInt32 fingers = config.begin();
+	std::vector<float> curl = { 0.5f, 0.5f, 1.5f, 0.5f, 0.5f };
+	std::vector<std::string> keys = { "armLength" };
+	std::vector<float> values = { 40.0f };
+	CHECK(config.setFingers(fingers, false, curl));
+	CHECK(config.setFloats(fingers, keys, values));
+	CHECK(!config.commit(fingers, true));
+
+	config.applyPending();
+	CHECK_NEAR(c_armLength, 36.74f, 1e-5f);
+	CHECK_NEAR(c_handUI_X, 0.0f, 1e-5f);
+	CHECK(!c_hideHead);
+	CHECK(g_fingerCalls == 0);
+	CHECK(g_saves == 0);
+
+	// a rejected batch is gone, staging more into it fails
+	CHECK(!config.setFloats(fingers, keys, values));
+}
+
+static void testAppliedTogether() {
+	ConfigTransactions config;
+
+	UInt32 batch = config.begin();
+	std::vector<std::string> floatKeys = { "armLength", "PlayerHeight", "fVrScale" };
+	std::vector<float> floats = { 42.0f, 120.0f, 80.0f };
+	std::vector<std::string> boolKeys = { "hidehead", "EnableStaticGripping" };
+	std::vector<bool> bools = { true, true };
+	std::vector<float> curl = { 0.1f, 0.2f, 0.3f, 0.4f, 0.5f };
+	CHECK(config.setFloats(batch, floatKeys, floats));
+	CHECK(config.setBools(batch, boolKeys, bools));
+	CHECK(config.setFingers(batch, true, curl));
+	CHECK(config.commit(batch, true));
+
+	// committed but not applied yet
+	CHECK_NEAR(c_armLength, 36.74f, 1e-5f);
+	CHECK(!c_hideHead);
+	CHECK(g_bodyLenUpdates == 0 && g_gripMessages == 0 && g_fingerCalls == 0);
+
+	// a second batch asking for a save as well
+	CHECK(scriptCommit(config, { "handUI_Z" }, { 3.0f }, {}, {}, true));
+
+	config.applyPending();
+	CHECK_NEAR(c_armLength, 42.0f, 1e-5f);
+	CHECK_NEAR(c_playerHeight, 120.0f, 1e-5f);
+	CHECK_NEAR(c_fVrScale, 80.0f, 1e-5f);
+	CHECK_NEAR(c_handUI_Z, 3.0f, 1e-5f);
+	CHECK(c_hideHead);
+	CHECK(c_staticGripping);
+	CHECK(g_bodyLenUpdates == 0);
+	CHECK_NEAR(g_vrScaleSetting.data.f64, 80.0, 1e-5);
+	CHECK(g_gripMessages == 1);
+	CHECK(g_fingerCalls == 1);
+	CHECK_NEAR(g_fingers[1][4], 0.5f, 1e-5f);
+	CHECK(g_saves == 1);
+
+	// nothing left over
+	config.applyPending();
+	CHECK(g_saves == 1);
+
+	// with a skeleton around the height goes through to it
+	Skeleton skelly;
+	playerSkelly = &skelly;
+	CHECK(scriptCommit(config, { "PlayerHeight" }, { 130.0f }, {}, {}, false));
+	config.applyPending();
+	CHECK(g_bodyLenUpdates == 1);
+	CHECK(g_saves == 1);
+	playerSkelly = nullptr;
+}
+
+// Script threads commit batches that set all three hand ui offsets to the same value while the main thread applies them,
+// after every applyPending the three have to agree.   Bad batches mixed in never show up.
+static void testScriptThreads() {
+	const int threads = 4;
+	const int batchesPerThread = 2000;
+	ConfigTransactions config;
+	c_handUI_X = c_handUI_Y = c_handUI_Z = 0.0f;
+	std::atomic<int> running(threads);
+	std::atomic<int> committed(0);
+
+	std::vector<std::thread> scripts;
+	for (auto t = 0; t < threads; t++) {
+		scripts.emplace_back([&, t]() {
+			for (auto i = 0; i < batchesPerThread; i++) {
+				float value = (float)((t * batchesPerThread + i) % 100) - 49.0f;
+				if (i % 10 == 9) {
+					// out of range for handUI_Y
+					scriptCommit(config, { "handUI_X", "handUI_Y", "handUI_Z" }, { 7.0f, 99.0f, 7.0f }, {}, {}, false);
+					continue;
+				}
+				if (scriptCommit(config, { "handUI_X", "handUI_Y", "handUI_Z" }, { value, value, value }, {}, {}, false)) {
+					committed++;
+				}
+			}
+			running--;
+		});
+	}
+
+	int applies = 0;
+	int mismatched = 0;
+	int rejectedSeen = 0;
+	while (running.load() > 0) {
+		config.applyPending();
+		applies++;
+		mismatched += (c_handUI_X != c_handUI_Y || c_handUI_Y != c_handUI_Z) ? 1 : 0;
+		rejectedSeen += c_handUI_Y == 99.0f ? 1 : 0;
+	}
+	for (auto& script : scripts) {
+		script.join();
+	}
+	config.applyPending();
+	mismatched += (c_handUI_X != c_handUI_Y || c_handUI_Y != c_handUI_Z) ? 1 : 0;
+
+	printf("script threads: %d batches committed, main thread applied %d times\n", committed.load(), applies);
+	CHECK(committed.load() == threads * batchesPerThread * 9 / 10);
+	CHECK(mismatched == 0);
+	CHECK(rejectedSeen == 0);
+}
+
+int main() {
+	g_messaging = new F4SEMessagingInterface();
+	g_messaging->Dispatch = countDispatch;
+	g_scopesChannel = new BetterScopesChannel();
+
+	testRejectsWholeBatch();
+	testAppliedTogether();
+	testScriptThreads();
+
+	return testResult("ConfigBatchApply");
+}
@@ -0,0 +1,211 @@
+// FingerCurl fed a grip the way GetSkeletalBoneData hands it over, 31 parent space bone rotations per hand per frame.
+// The frames are put together here the way an Index controller reports them: every bone has its own rest rotation and
+// bend axis, the fingers close one after the other, the thumb lags, there is a little sensor jitter and now and then a
+// quaternion comes back in the other hemisphere.   The curl follows each joint's bend from the open hand reference to the
+// fist, clamps past either end, and picks the same fraction of the way between FRIK's own open and closed poses.
+#include "TestUtil.h"
+#include "F4VRBody.h"
+#include "FingerCurl.h"
+#include "utils.h"
+
+#include <algorithm>
+
+using namespace F4VRBody;
+
+static const int kBones = FingerCurl::kOpenVRBoneCount;
+
+// the OpenVR bone behind each FRIK slot, as FingerCurl maps them
+static const int kSlotBones[FingerCurl::kBonesPerHand] = { 2, 3, 4, 7, 8, 9, 12, 13, 14, 17, 18, 19, 22, 23, 24 };
+
+static Quaternion axisAngle(NiPoint3 a_axis, float a_angle) {
+	Quaternion q;
+	q.setAngleAxis(a_angle, a_axis);
+	return q;
+}
+
+// one controller's hand, rest rotation, bend axis and full bend in radians per bone
+struct SkeletalHand {
+	Quaternion rest[kBones];
+	NiPoint3 axis[kBones];
+	float bend[kBones];
+
+	explicit SkeletalHand(uint32_t a_seed) {
+		TestRandom random(a_seed);
+		for (auto i = 0; i < kBones; i++) {
+			NiPoint3 restAxis(random.signedUnit(), random.signedUnit(), random.signedUnit() + 2.0f);
+			rest[i] = axisAngle(restAxis, random.signedUnit() * 1.5f);
+			axis[i] = vec3_norm(NiPoint3(random.signedUnit() * 0.3f, random.signedUnit() * 0.3f, 1.0f));
+			bend[i] = 1.2f + 0.4f * random.signedUnit();
+		}
+	}
+
+	Quaternion pose(int a_bone, float a_curl) {
+		return rest[a_bone] * axisAngle(axis[a_bone], a_curl * bend[a_bone]);
+	}
+
+	void frame(const float* a_fingerCurl, Quaternion* a_out, TestRandom* a_jitter = nullptr) {
+		for (auto i = 0; i < kBones; i++) {
+			// bones 1 to 5 are the thumb, then 5 per finger
+			int finger = i < 2 ? 0 : std::min((i - 1) / 5, 4);
+			a_out[i] = pose(i, a_fingerCurl[finger]);
+			if (a_jitter) {
+				a_out[i] = a_out[i] * axisAngle(NiPoint3(a_jitter->signedUnit(), a_jitter->signedUnit(), a_jitter->signedUnit() + 0.01f), 0.002f);
+				if ((a_jitter->next() & 7) == 0) {
+					a_out[i] = a_out[i] * -1.0f;
+				}
+			}
+		}
+	}
+
+	void reference(Quaternion* a_open, Quaternion* a_fist) {
+		const float open[5] = { 0, 0, 0, 0, 0 };
+		const float fist[5] = { 1, 1, 1, 1, 1 };
+		frame(open, a_open);
+		frame(fist, a_fist);
+	}
+};
+
+// FRIK's open pose is the identity and the closed one a bend about z, further for the joints nearer the tip
+static void setFrikPoses(FingerCurl& a_curl) {
+	for (auto slot = 0; slot < 2 * FingerCurl::kBonesPerHand; slot++) {
+		float closed = degrees_to_rads(40.0f + 15.0f * (slot % 3));
+		a_curl.setPose(slot, getRotationAxisAngle(NiPoint3(1, 0, 0), 0.0f), getRotationAxisAngle(NiPoint3(0, 0, 1), closed));
+	}
+}
+
+static void testSlots() {
+	CHECK(FingerCurl::getSlot("RArm_Finger11") == 0);
+	CHECK(FingerCurl::getSlot("RArm_Finger53") == 14);
+	CHECK(FingerCurl::getSlot("LArm_Finger11") == 15);
+	CHECK(FingerCurl::getSlot("LArm_Finger32") == 15 + 7);
+	CHECK(FingerCurl::getSlot("larm_finger23") == 15 + 5);
+
+	CHECK(FingerCurl::getSlot("RArm_Finger61") == -1);
+	CHECK(FingerCurl::getSlot("RArm_Finger14") == -1);
+	CHECK(FingerCurl::getSlot("RArm_Finger1") == -1);
+	CHECK(FingerCurl::getSlot("RArm_Finger111") == -1);
+	CHECK(FingerCurl::getSlot("RArm_Hand") == -1);
+	CHECK(FingerCurl::getSlot("RLeg_Finger11") == -1);
+}
+
+static void testReferencePoses() {
+	SkeletalHand right(11);
+	FingerCurl curl;
+	Quaternion open[kBones], fist[kBones], bones[kBones];
+	right.reference(open, fist);
+
+	CHECK(!curl.hasReference(0));
+	curl.setReference(0, open, fist);
+	CHECK(curl.hasReference(0) && !curl.hasReference(1));
+
+	// the references themselves, half way, past the fist and the other hemisphere
+	const float cases[][2] = { { 0.0f, 0.0f }, { 1.0f, 1.0f }, { 0.5f, 0.5f }, { 0.25f, 0.25f }, { 1.3f, 1.0f } };
+	for (auto& c : cases) {
+		const float fingers[5] = { c[0], c[0], c[0], c[0], c[0] };
+		right.frame(fingers, bones);
+		curl.setBones(0, bones);
+		for (auto slot = 0; slot < FingerCurl::kBonesPerHand; slot++) {
+			CHECK_NEAR(curl.getCurl(slot), c[1], 2e-3f);
+		}
+
+		for (auto& bone : bones) {
+			bone = bone * -1.0f;
+		}
+		curl.setBones(0, bones);
+		CHECK_NEAR(curl.getCurl(7), c[1], 2e-3f);
+	}
+
+	// a controller that reports the same pose for open and fist has no range, the fingers stay open
+	FingerCurl flat;
+	flat.setReference(1, open, open);
+	const float half[5] = { 0.5f, 0.5f, 0.5f, 0.5f, 0.5f };
+	right.frame(half, bones);
+	flat.setBones(1, bones);
+	CHECK(flat.getCurl(15) == 0.0f && flat.getCurl(29) == 0.0f);
+}
+
+// a two second grip at 90 Hz on both hands, open to fist and back
+static void testRecordedGrip() {
+	const int frames = 180;
+	SkeletalHand hands[2] = { SkeletalHand(21), SkeletalHand(22) };
+	FingerCurl curl;
+	setFrikPoses(curl);
+
+	Quaternion open[kBones], fist[kBones];
+	for (auto hand = 0; hand < 2; hand++) {
+		hands[hand].reference(open, fist);
+		curl.setReference(hand, open, fist);
+	}
+
+	TestRandom jitter(5);
+	float worstCurl = 0.0f;
+	float worstPose = 0.0f;
+	for (auto frame = 0; frame < frames; frame++) {
+		float t = (float)frame / (frames - 1);
+		float fingers[2][5];
+		for (auto hand = 0; hand < 2; hand++) {
+			for (auto finger = 0; finger < 5; finger++) {
+				// index first, pinky last, thumb after all of them, the left hand a little behind the right
+				float delay = (finger == 0 ? 0.15f : 0.03f * finger) + 0.05f * hand;
+				float phase = std::clamp((t - delay) / (1.0f - 0.2f - delay), 0.0f, 1.0f);
+				fingers[hand][finger] = sinf(phase * 3.14159265f);
+			}
+
+			Quaternion bones[kBones];
+			hands[hand].frame(fingers[hand], bones, &jitter);
+			curl.setBones(hand, bones);
+		}
+
+		for (auto slot = 0; slot < 2 * FingerCurl::kBonesPerHand; slot++) {
+			int hand = slot / FingerCurl::kBonesPerHand;
+			float expected = fingers[hand][(slot % FingerCurl::kBonesPerHand) / 3];
+			float got = curl.getCurl(slot);
+			worstCurl = fmaxf(worstCurl, fabsf(got - expected));
+
+			// FRIK's pose for it reads back as the same curl
+			NiMatrix43 target = curl.getTarget(slot).getRot().make43();
+			worstPose = fmaxf(worstPose, fabsf(curl.getPoseCurl(slot, target) - got));
+		}
+	}
+
+	printf("recorded grip: %d frames, worst curl error %.4f, worst pose round trip %.4f\n", frames, worstCurl, worstPose);
+	CHECK(worstCurl < 0.01f);
+	CHECK(worstPose < 0.01f);
+}
+
+static void testTargets() {
+	FingerCurl curl;
+	setFrikPoses(curl);
+
+	// no skeletal data yet is the open pose
+	NiMatrix43 rot = curl.getTarget(4).getRot().make43();
+	CHECK_NEAR(curl.getPoseCurl(4, rot), 0.0f, 1e-4f);
+
+	// the fist is FRIK's closed pose, a bone bent further than that still reads as closed
+	SkeletalHand right(31);
+	Quaternion open[kBones], fist[kBones];
+	right.reference(open, fist);
+	curl.setReference(0, open, fist);
+	curl.setBones(0, fist);
+	rot = curl.getTarget(4).getRot().make43();
+	NiMatrix43 closed = getRotationAxisAngle(NiPoint3(0, 0, 1), degrees_to_rads(55.0f));
+	for (auto r = 0; r < 3; r++) {
+		for (auto c = 0; c < 3; c++) {
+			CHECK_NEAR(rot.data[r][c], closed.data[r][c], 1e-4f);
+		}
+	}
+	CHECK_NEAR(curl.getPoseCurl(4, getRotationAxisAngle(NiPoint3(0, 0, 1), degrees_to_rads(70.0f))), 1.0f, 1e-4f);
+
+	// a slot without a pose range reads as open whatever the bone does
+	FingerCurl unposed;
+	CHECK(unposed.getPoseCurl(4, closed) == 0.0f);
+}
+
+int main() {
+	testSlots();
+	testReferencePoses();
+	testRecordedGrip();
+	testTargets();
+
+	return testResult("FingerCurlReplay");
+}
@@ -0,0 +1,177 @@
+// FrameGovernor driven with made up stage costs instead of a real frame.   Over budget it has to slow the optional stages
+// down one step at a time in priority order without ever stopping one, hold each step for a while, come back once the
+// cost drops well under the budget and leave everything alone while the cost sits in between.
+#include "TestUtil.h"
+#include "FrameGovernor.h"
+
+using namespace F4VRBody;
+
+// ms each stage adds to a frame it runs on, on top of the fixed part of update()
+struct FrameCosts {
+	double base;
+	double stage[kStage_Count];
+};
+
+struct RunStats {
+	int levelChanges;
+	int minFramesBetweenChanges;
+	int runs[kStage_Count];
+};
+
+static const double kNsPerMs = 1000000.0;
+
+// a_frames frames of update(): each stage the governor lets through costs its share of the simulated clock
+static RunStats runFrames(FrameGovernor& a_governor, const FrameCosts& a_costs, int a_frames) {
+	RunStats stats = {};
+	stats.minFramesBetweenChanges = a_frames;
+	int lastLevel = a_governor.getLevel();
+	int sinceChange = 0;
+
+	for (auto frame = 0; frame < a_frames; frame++) {
+		a_governor.beginFrame();
+		double ms = a_costs.base;
+		for (auto stage = 0; stage < kStage_Count; stage++) {
+			if (a_governor.shouldRun((GovernedStage)stage)) {
+				ms += a_costs.stage[stage];
+				stats.runs[stage]++;
+			}
+		}
+		g_stubPerfCounter += (long long)(ms * kNsPerMs);
+		a_governor.endFrame();
+
+		sinceChange++;
+		if (a_governor.getLevel() != lastLevel) {
+			// one step at a time, only switching the governor off drops straight to 0
+			CHECK(!c_enableFrameGovernor || std::abs(a_governor.getLevel() - lastLevel) == 1);
+			if (stats.levelChanges > 0) {
+				stats.minFramesBetweenChanges = (std::min)(stats.minFramesBetweenChanges, sinceChange);
+			}
+			stats.levelChanges++;
+			lastLevel = a_governor.getLevel();
+			sinceChange = 0;
+		}
+	}
+	return stats;
+}
+
+static void testUnderBudget() {
+	FrameGovernor governor;
+	FrameCosts cheap = { 0.5, { 0.2, 0.2, 0.2, 0.2 } };
+
+	RunStats stats = runFrames(governor, cheap, 600);
+	CHECK(governor.getLevel() == 0);
+	CHECK(stats.levelChanges == 0);
+	for (auto stage = 0; stage < kStage_Count; stage++) {
+		CHECK(stats.runs[stage] == 600);
+	}
+}
+
+static void testOverBudget() {
+	FrameGovernor governor;
+	FrameCosts heavy = { 1.0, { 1.5, 0.6, 0.5, 0.4 } };
+
+	// the debug spheres are the first thing slowed down, everything else is still at full rate
+	int frames = 0;
+	while (governor.getLevel() == 0 && frames < 1000) {
+		runFrames(governor, heavy, 1);
+		frames++;
+	}
+	CHECK(governor.getLevel() == 1);
+	RunStats first = runFrames(governor, heavy, 20);
+	CHECK(first.runs[kStage_DebugSpheres] == 5);
+	CHECK(first.runs[kStage_CullGeometry] == 20);
+	CHECK(first.runs[kStage_FingerPose] == 20);
+
+	RunStats stats = runFrames(governor, heavy, 600);
+	printf("over budget: level %d, average %.2f ms, debug spheres ran %d of 600 frames\n", governor.getLevel(), governor.getAverageMs(),
+		stats.runs[kStage_DebugSpheres]);
+
+	// settles once under budget instead of climbing to the top, each step held for at least 30 frames
+	CHECK(governor.getAverageMs() < c_frameBudgetMs);
+	CHECK(stats.minFramesBetweenChanges >= 30);
+	CHECK(stats.runs[kStage_DebugSpheres] < 600 / 3);
+
+	// nothing is ever switched off
+	for (auto stage = 0; stage < kStage_Count; stage++) {
+		CHECK(stats.runs[stage] > 0);
+	}
+
+	// the cost goes back down, every stage comes back to every frame one step per 90 frames
+	int level = governor.getLevel();
+	FrameCosts cheap = { 0.5, { 0.2, 0.2, 0.2, 0.2 } };
+	RunStats back = runFrames(governor, cheap, 90 * level + 200);
+	CHECK(governor.getLevel() == 0);
+	CHECK(back.levelChanges == level);
+	CHECK(back.minFramesBetweenChanges >= 90);
+}
+
+static void testHysteresis() {
+	FrameGovernor governor;
+	FrameCosts heavy = { 1.0, { 1.5, 0.6, 0.5, 0.4 } };
+	runFrames(governor, heavy, 300);
+	int level = governor.getLevel();
+	CHECK(level > 0);
+
+	// between 70% of the budget and the budget nothing moves either way
+	FrameCosts middle = { 1.6, { 0.0, 0.0, 0.0, 0.0 } };
+	RunStats stats = runFrames(governor, middle, 1000);
+	CHECK(stats.levelChanges == 0);
+	CHECK(governor.getLevel() == level);
+}
+
+static void testMaxLevel() {
+	// far over budget whatever gets slowed down, it stops at the last step and still runs everything now and then
+	FrameGovernor governor;
+	FrameCosts hopeless = { 5.0, { 0.1, 0.1, 0.1, 0.1 } };
+	RunStats stats = runFrames(governor, hopeless, 2000);
+	CHECK(governor.getLevel() == 7);
+	for (auto stage = 0; stage < kStage_Count; stage++) {
+		CHECK(stats.runs[stage] >= 2000 / 4);
+	}
+}
+
+static void testStaggered() {
+	// at the same interval the stages take turns instead of all landing on the same frame
+	FrameGovernor governor;
+	FrameCosts heavy = { 5.0, { 0.0, 0.0, 0.0, 0.0 } };
+	runFrames(governor, heavy, 200);
+	CHECK(governor.getLevel() >= 4);
+
+	int together = 0;
+	for (auto frame = 0; frame < 100; frame++) {
+		governor.beginFrame();
+		together += governor.shouldRun(kStage_CullGeometry) && governor.shouldRun(kStage_BoneSpheres);
+		g_stubPerfCounter += (long long)(5.0 * kNsPerMs);
+		governor.endFrame();
+	}
+	CHECK(together < 100);
+}
+
+static void testDisabled() {
+	FrameGovernor governor;
+	FrameCosts heavy = { 1.0, { 1.5, 0.6, 0.5, 0.4 } };
+	runFrames(governor, heavy, 300);
+	CHECK(governor.getLevel() > 0);
+
+	// switching it off puts everything straight back
+	c_enableFrameGovernor = false;
+	RunStats stats = runFrames(governor, heavy, 300);
+	CHECK(governor.getLevel() == 0);
+	CHECK(stats.runs[kStage_DebugSpheres] >= 299);
+	c_enableFrameGovernor = true;
+}
+
+int main() {
+	g_stubPerfCounter = 0;
+	c_enableFrameGovernor = true;
+	c_frameBudgetMs = 2.0f;
+
+	testUnderBudget();
+	testOverBudget();
+	testHysteresis();
+	testMaxLevel();
+	testStaggered();
+	testDisabled();
+
+	return testResult("FrameGovernor");
+}
@@ -0,0 +1,117 @@
+// HandVelocity at the frame rates headsets run at.   A steady hand has to read the same speed at all of them, the let go
+// threshold has to be crossed at the same moment give or take a frame, and moving the body along with the hand (or the
+// body moving under a still hand) has to count only the hand's movement relative to it.
+#include "TestUtil.h"
+#include "HandVelocity.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace F4VRBody;
+
+static const double kRates[] = { 45.0, 72.0, 80.0, 90.0, 120.0, 144.0 };
+static const float kLetGo = 225.0f;
+
+// frame timestamps with up to a_jitter of the frame time either way, like a compositor missing its slot now and then
+static double frameTime(int a_frame, double a_rate, double a_jitter, TestRandom& a_rng) {
+	return (a_frame + a_rng.signedUnit() * a_jitter) / a_rate;
+}
+
+static void testSteadySpeed() {
+	for (double rate : kRates) {
+		HandVelocity v;
+		TestRandom rng(5);
+		for (auto frame = 0; frame < 60; frame++) {
+			double t = frameTime(frame, rate, 0.0, rng);
+			v.addSample(t, NiPoint3(0, (float)(t * 150.0), 0), NiPoint3(0, 0, 0));
+		}
+		CHECK_NEAR(v.getSpeed(), 150.0, 0.01);
+	}
+}
+
+// hand still, then pulled away with a constant acceleration.   returns when the speed first goes over the threshold
+static double letGoTime(double a_rate, double a_jitter, uint32_t a_seed) {
+	const double start = 0.5;
+	const double accel = 3000.0;
+	HandVelocity v;
+	TestRandom rng(a_seed);
+
+	for (auto frame = 0; frame < (int)(a_rate * 2.0); frame++) {
+		double t = frameTime(frame, a_rate, a_jitter, rng);
+		double moving = (std::max)(0.0, t - start);
+		NiPoint3 hand(0, 0, (float)(0.5 * accel * moving * moving));
+		v.addSample(t, hand, NiPoint3(0, 0, 0));
+		if (v.getSpeed() > kLetGo) {
+			return t;
+		}
+	}
+	return -1.0;
+}
+
+static void testLetGoAcrossRates() {
+	double reference = letGoTime(90.0, 0.0, 1);
+	CHECK(reference > 0.5);
+
+	for (double rate : kRates) {
+		double t = letGoTime(rate, 0.0, 1);
+		double jittered = letGoTime(rate, 0.2, 9);
+		printf("%5.0f Hz: lets go at %.1f ms, %.1f ms with jitter (90 Hz %.1f ms)\n", rate, t * 1000.0, jittered * 1000.0, reference * 1000.0);
+
+		CHECK(std::fabs(t - reference) <= 1.0 / rate + 1e-6);
+		CHECK(std::fabs(jittered - reference) <= 1.5 / rate);
+	}
+}
+
+static void testBodyMovement() {
+	for (double rate : kRates) {
+		// walking while holding the gun, hand and body go together
+		HandVelocity together;
+		// the body moves under a hand held still in the world, relative to the body the hand moves
+		HandVelocity still;
+		// hand forward while the body strafes at the same speed, the lengths match but the directions don't
+		HandVelocity crossed;
+
+		for (auto frame = 0; frame < 60; frame++) {
+			float t = (float)(frame / rate);
+			NiPoint3 body(t * 300.0f, 0, 0);
+			together.addSample(frame / rate, body + NiPoint3(20, 30, 0), body);
+			still.addSample(frame / rate, NiPoint3(20, 30, 0), body);
+			crossed.addSample(frame / rate, NiPoint3(0, t * 300.0f, 0), body);
+		}
+
+		CHECK_NEAR(together.getSpeed(), 0.0, 0.01);
+		CHECK_NEAR(still.getSpeed(), 300.0, 0.05);
+		CHECK_NEAR(crossed.getSpeed(), 300.0 * std::sqrt(2.0), 0.05);
+	}
+}
+
+static void testReset() {
+	HandVelocity v;
+	v.addSample(0.0, NiPoint3(0, 0, 0), NiPoint3(0, 0, 0));
+	CHECK(v.getSpeed() == 0.0f);
+	v.addSample(0.01, NiPoint3(0, 0, 5), NiPoint3(0, 0, 0));
+	CHECK_NEAR(v.getSpeed(), 500.0, 0.01);
+
+	// grabbing again starts over, the jump from the old hand position isn't a speed
+	v.reset();
+	v.addSample(0.02, NiPoint3(0, 100, 0), NiPoint3(0, 0, 0));
+	CHECK(v.getSpeed() == 0.0f);
+	v.addSample(0.03, NiPoint3(0, 100, 1), NiPoint3(0, 0, 0));
+	CHECK_NEAR(v.getSpeed(), 100.0, 0.01);
+
+	// a repeated or backwards timestamp is a new start, not a divide by zero
+	HandVelocity same;
+	same.addSample(1.0, NiPoint3(0, 0, 0), NiPoint3(0, 0, 0));
+	same.addSample(1.0, NiPoint3(0, 0, 50), NiPoint3(0, 0, 0));
+	same.addSample(0.5, NiPoint3(0, 0, 60), NiPoint3(0, 0, 0));
+	CHECK(same.getSpeed() == 0.0f);
+}
+
+int main() {
+	testSteadySpeed();
+	testLetGoAcrossRates();
+	testBodyMovement();
+	testReset();
+
+	return testResult("HandVelocity");
+}
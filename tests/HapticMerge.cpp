@@ -0,0 +1,170 @@
+// HapticScheduler against a recording FO4VRTools sink.   Requests in one frame merge to one pulse per controller with the
+// highest priority winning, a playing pulse is only cut off by the same or higher priority, and the submitted and merged
+// counts add up to what was asked for.
+#include "TestUtil.h"
+#include "F4VRBody.h"
+#include "Haptics.h"
+#include "api/PapyrusVRAPI.h"
+
+#include <vector>
+
+using namespace F4VRBody;
+
+struct Pulse {
+	unsigned int controller;
+	float duration;
+	float intensity;
+};
+
+class RecordingSink : public OpenVRHookManagerAPI {
+public:
+	void StartHaptics(unsigned int trackedControllerId, float hapticTime, float hapticIntensity) override {
+		pulses.push_back({ trackedControllerId, hapticTime, hapticIntensity });
+	}
+
+	std::vector<Pulse> pulses;
+};
+
+static RecordingSink g_sink;
+OpenVRHookManagerAPI* vrhook = &g_sink;
+
+// one 90 Hz frame
+static void nextFrame(HapticScheduler& a_haptics) {
+	a_haptics.submit();
+	g_stubTickCount += 11;
+}
+
+static void testMergedPerFrame() {
+	HapticScheduler haptics;
+	g_sink.pulses.clear();
+
+	// the stronger one wins whichever order they came in
+	haptics.play("tick", kHaptic_Right);
+	haptics.play("reposition", kHaptic_Right, 2.0f);
+	haptics.play("tick", kHaptic_Right);
+	nextFrame(haptics);
+
+	CHECK(g_sink.pulses.size() == 1);
+	CHECK(g_sink.pulses[0].controller == kHaptic_Right);
+	CHECK_NEAR(g_sink.pulses[0].duration, 0.2f, 1e-6f);
+	CHECK(haptics.getSubmitted() == 1);
+	CHECK(haptics.getMerged() == 2);
+
+	// both is one request per hand, each merged on its own
+	haptics.play("scopeZoom", kHaptic_Both);
+	haptics.play("tick", kHaptic_Left);
+	g_stubTickCount += 1000;
+	nextFrame(haptics);
+	CHECK(g_sink.pulses.size() == 3);
+	CHECK(g_sink.pulses[1].controller == kHaptic_Left && g_sink.pulses[2].controller == kHaptic_Right);
+	CHECK(haptics.getSubmitted() == 3);
+	CHECK(haptics.getMerged() == 3);
+
+	// unknown patterns and empty frames send nothing
+	haptics.play("noSuchPattern", kHaptic_Left);
+	nextFrame(haptics);
+	CHECK(g_sink.pulses.size() == 3);
+	CHECK(haptics.getSubmitted() == 3);
+	CHECK(haptics.getMerged() == 3);
+}
+
+static void testPlayingPulse() {
+	HapticScheduler haptics;
+	g_sink.pulses.clear();
+
+	// a 100 ms priority 3 pulse, ticks during it are dropped
+	haptics.play("reposition", kHaptic_Left);
+	nextFrame(haptics);
+	for (auto frame = 0; frame < 5; frame++) {
+		haptics.play("tick", kHaptic_Left);
+		nextFrame(haptics);
+	}
+	CHECK(g_sink.pulses.size() == 1);
+	CHECK(haptics.getSubmitted() == 1);
+	CHECK(haptics.getMerged() == 5);
+
+	// the other hand isn't affected
+	haptics.play("tick", kHaptic_Right);
+	nextFrame(haptics);
+	CHECK(g_sink.pulses.size() == 2);
+
+	// same priority cuts it off
+	haptics.play("reposition", kHaptic_Left, 0.5f);
+	nextFrame(haptics);
+	CHECK(g_sink.pulses.size() == 3);
+	CHECK_NEAR(g_sink.pulses[2].duration, 0.05f, 1e-6f);
+
+	// once it ended anything goes again
+	g_stubTickCount += 100;
+	haptics.play("tick", kHaptic_Left);
+	nextFrame(haptics);
+	CHECK(g_sink.pulses.size() == 4);
+	CHECK(haptics.getSubmitted() == 4);
+	CHECK(haptics.getMerged() == 5);
+}
+
+// the pipboy finger ticking every frame while a scope zooms, never more than one pulse per hand per frame
+static void testBusyFrames() {
+	HapticScheduler haptics;
+	g_sink.pulses.clear();
+	g_stubTickCount += 1000;
+
+	const int frames = 90;
+	UInt32 requests = 0;
+	for (auto frame = 0; frame < frames; frame++) {
+		size_t before = g_sink.pulses.size();
+		haptics.play("tick", kHaptic_Right);
+		haptics.play("tick", kHaptic_Right);
+		requests += 2;
+		if (frame % 10 == 0) {
+			haptics.play("scopeZoom", kHaptic_Both);
+			requests += 2;
+		}
+		nextFrame(haptics);
+		CHECK(g_sink.pulses.size() - before <= 2);
+	}
+
+	printf("busy frames: %u requests, %u submitted, %u merged over %d frames\n", requests, haptics.getSubmitted(), haptics.getMerged(), frames);
+	CHECK(haptics.getSubmitted() == g_sink.pulses.size());
+	CHECK(haptics.getSubmitted() + haptics.getMerged() == requests);
+	CHECK(haptics.getSubmitted() <= (UInt32)frames + frames / 10);
+}
+
+static void testIniPatterns() {
+	HapticScheduler haptics;
+	g_sink.pulses.clear();
+	g_stubTickCount += 1000;
+
+	CSimpleIniA ini;
+	ini.LoadData(
+		"[Haptics]\n"
+		"tick = 0.02, 0.9, 5\n"
+		"heavy = 0.5, 1.0, 9\n"
+		"broken = loud\n");
+	haptics.loadPatterns(ini);
+
+	haptics.play("tick", kHaptic_Left);
+	haptics.play("reposition", kHaptic_Left);
+	nextFrame(haptics);
+	CHECK(g_sink.pulses.size() == 1);
+	CHECK_NEAR(g_sink.pulses[0].intensity, 0.9f, 1e-6f);
+	CHECK_NEAR(g_sink.pulses[0].duration, 0.02f, 1e-6f);
+
+	haptics.play("heavy", kHaptic_Right);
+	haptics.play("broken", kHaptic_Right);
+	nextFrame(haptics);
+	CHECK(g_sink.pulses.size() == 2);
+	CHECK_NEAR(g_sink.pulses[1].duration, 0.5f, 1e-6f);
+	CHECK(haptics.getMerged() == 1);
+}
+
+int main() {
+	g_stubTickCount = 1000;
+
+	testMergedPerFrame();
+	testPlayingPulse();
+	testBusyFrames();
+	testIniPatterns();
+
+	return testResult("HapticMerge");
+}
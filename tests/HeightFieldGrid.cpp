@@ -0,0 +1,169 @@
+// HeightField against made up terrain.   Lookups are bilinear between grid points that are each asked for once, the grid
+// only moves when the player gets near its edge or changes cell, and no land, no cell or a point off the grid all come
+// back false without asking the sampler.
+#include "TestUtil.h"
+#include "F4VRBody.h"
+#include "HeightField.h"
+
+using namespace F4VRBody;
+
+// what the sampler's context points at instead of a cell
+struct Terrain {
+	float base;
+	float slopeX;
+	float slopeY;
+	float wave;         // adds a sine so bilinear isn't exact between grid points
+	float landEndsAt;   // no land past this x
+	UInt32 calls;
+};
+
+static float terrainHeight(const Terrain& a_terrain, float a_x, float a_y) {
+	return a_terrain.base + a_terrain.slopeX * a_x + a_terrain.slopeY * a_y + a_terrain.wave * sinf(a_x / 50.0f) * cosf(a_y / 70.0f);
+}
+
+static bool sampleTerrain(void* a_context, float a_x, float a_y, float* a_height) {
+	Terrain* terrain = (Terrain*)a_context;
+	terrain->calls++;
+	*a_height = terrainHeight(*terrain, a_x, a_y);
+	return a_x <= terrain->landEndsAt;
+}
+
+static Terrain slope() {
+	return { 100.0f, 0.5f, -0.25f, 0.0f, 1e9f, 0 };
+}
+
+static void testBilinear() {
+	Terrain plane = slope();
+	HeightField field(sampleTerrain, 24.0f);
+	field.setRegion(&plane, NiPoint3(0, 0, 0));
+
+	// a plane comes back exactly, from the four corners of its square
+	float height;
+	CHECK(field.getHeight(10.0f, -7.0f, &height));
+	CHECK_NEAR(height, terrainHeight(plane, 10.0f, -7.0f), 1e-3f);
+	CHECK(plane.calls == 4);
+	CHECK(field.getQueries() == 4);
+
+	// the same square again asks for nothing, the next one over only for its far side
+	CHECK(field.getHeight(3.0f, -20.0f, &height));
+	CHECK(plane.calls == 4);
+	CHECK(field.getHeight(30.0f, -7.0f, &height));
+	CHECK_NEAR(height, terrainHeight(plane, 30.0f, -7.0f), 1e-3f);
+	CHECK(plane.calls == 6);
+
+	// on rolling ground the grid points are exact and in between is the blend of the four around it
+	Terrain hills = { 0.0f, 0.0f, 0.0f, 40.0f, 1e9f, 0 };
+	HeightField hilly(sampleTerrain, 24.0f);
+	hilly.setRegion(&hills, NiPoint3(0, 0, 0));
+	CHECK(hilly.getHeight(48.0f, 24.0f, &height));
+	CHECK_NEAR(height, terrainHeight(hills, 48.0f, 24.0f), 1e-3f);
+	CHECK(hilly.getHeight(60.0f, 36.0f, &height));
+	float corners = terrainHeight(hills, 48.0f, 24.0f) + terrainHeight(hills, 72.0f, 24.0f) + terrainHeight(hills, 48.0f, 48.0f) + terrainHeight(hills, 72.0f, 48.0f);
+	CHECK_NEAR(height, corners / 4, 1e-3f);
+}
+
+// two feet a step apart following the player for a long walk, one lookup per foot per frame like Skeleton does
+static void testWalk() {
+	const int frames = 3000;
+	Terrain ground = slope();
+	ground.wave = 10.0f;
+	HeightField field(sampleTerrain, 24.0f);
+
+	int found = 0;
+	float worst = 0.0f;
+	for (auto frame = 0; frame < frames; frame++) {
+		NiPoint3 player(frame * 1.5f, frame * 0.5f, 0.0f);
+		field.setRegion(&ground, player);
+
+		for (auto side = -1; side <= 1; side += 2) {
+			float x = player.x + 15.0f * side;
+			float y = player.y - 10.0f * side;
+			float height;
+			if (field.getHeight(x, y, &height)) {
+				found++;
+				worst = fmaxf(worst, fabsf(height - terrainHeight(ground, x, y)));
+			}
+		}
+	}
+
+	printf("walk: %d foot lookups, %u sampler calls, worst error %.2f\n", frames * 2, ground.calls, worst);
+	CHECK(found == frames * 2);
+	CHECK(ground.calls == field.getQueries());
+	// new ground is only sampled as the feet reach it
+	CHECK(ground.calls * 5 < (UInt32)frames * 2);
+	// grid points are 24 apart, the wave bends at most this much between them
+	CHECK(worst < 1.0f);
+}
+
+static void testRegion() {
+	Terrain first = slope();
+	Terrain second = slope();
+	second.base = 150.0f;
+	HeightField field(sampleTerrain, 24.0f);
+	float height;
+
+	// indoors nothing is looked up
+	field.setRegion(nullptr, NiPoint3(0, 0, 0));
+	CHECK(!field.getHeight(0.0f, 0.0f, &height));
+	CHECK(field.getQueries() == 0);
+
+	field.setRegion(&first, NiPoint3(0, 0, 0));
+	CHECK(field.getHeight(0.0f, 0.0f, &height));
+	CHECK_NEAR(height, 100.0f, 1e-3f);
+	CHECK(first.calls == 4);
+
+	// off the grid is false rather than a guess, and costs nothing
+	CHECK(!field.getHeight(1000.0f, 0.0f, &height));
+	CHECK(!field.getHeight(0.0f, -500.0f, &height));
+	CHECK(first.calls == 4);
+
+	// a short step keeps the grid
+	field.setRegion(&first, NiPoint3(50, -50, 0));
+	CHECK(field.getHeight(0.0f, 0.0f, &height));
+	CHECK(first.calls == 4);
+
+	// far enough from the middle it moves and the old samples are dropped
+	field.setRegion(&first, NiPoint3(150, 0, 0));
+	CHECK(field.getHeight(150.0f, 0.0f, &height));
+	CHECK_NEAR(height, terrainHeight(first, 150.0f, 0.0f), 1e-3f);
+	CHECK(first.calls == 8);
+
+	// a new cell starts over with its own land even standing still
+	field.setRegion(&second, NiPoint3(150, 0, 0));
+	CHECK(field.getHeight(150.0f, 0.0f, &height));
+	CHECK_NEAR(height, terrainHeight(second, 150.0f, 0.0f), 1e-3f);
+	CHECK(first.calls == 8 && second.calls == 4);
+
+	// and back inside
+	field.setRegion(nullptr, NiPoint3(150, 0, 0));
+	CHECK(!field.getHeight(150.0f, 0.0f, &height));
+	CHECK(field.getQueries() == 12);
+}
+
+static void testNoLand() {
+	Terrain edge = slope();
+	edge.landEndsAt = 40.0f;
+	HeightField field(sampleTerrain, 24.0f);
+	field.setRegion(&edge, NiPoint3(0, 0, 0));
+	float height;
+
+	// the square from 24 to 48 has a corner without land
+	CHECK(field.getHeight(20.0f, 0.0f, &height));
+	CHECK(!field.getHeight(30.0f, 0.0f, &height));
+	UInt32 calls = edge.calls;
+
+	// a missing sample is remembered like a found one
+	for (auto i = 0; i < 100; i++) {
+		CHECK(!field.getHeight(30.0f + i * 0.1f, 0.0f, &height));
+	}
+	CHECK(edge.calls == calls);
+}
+
+int main() {
+	testBilinear();
+	testWalk();
+	testRegion();
+	testNoLand();
+
+	return testResult("HeightFieldGrid");
+}
@@ -0,0 +1,157 @@
+// HookThunk around ordinary functions instead of game code.   The thunk has to pass arguments and results through
+// untouched (values, pointers, references, structs, void), every call has to be counted once even with several threads
+// calling at the same time, and endFrame() has to turn the running totals into per frame numbers.   Also prints what the
+// counting costs per call.
+#include "TestUtil.h"
+#include "HookStats.h"
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace F4VRBody;
+
+static int add(int a_a, int a_b) {
+	return a_a + a_b;
+}
+
+static void fill(int* a_out, int a_value) {
+	*a_out = a_value;
+}
+
+static void bump(int& a_value) {
+	a_value++;
+}
+
+static const char* pick(bool a_first, const char* a_a, const char* a_b) {
+	return a_first ? a_a : a_b;
+}
+
+static NiPoint3 scaled(NiPoint3 a_pt, float a_scale) {
+	return a_pt * a_scale;
+}
+
+static volatile UInt64 g_sink = 0;
+
+__attribute__((noinline)) static UInt64 spin(int a_loops) {
+	UInt64 sum = 0;
+	for (auto i = 0; i < a_loops; i++) {
+		sum += (UInt64)i * i;
+		g_sink = sum;
+	}
+	return sum;
+}
+
+__attribute__((noinline)) static void nothing() {
+	g_sink = g_sink + 1;
+}
+
+static void testPassThrough() {
+	g_hookStats.endFrame();
+
+	CHECK((HookThunk<kHook_BodyUpdate, &add>::call(3, 4) == 7));
+
+	int out = 0;
+	HookThunk<kHook_MainUpdatePlayer, &fill>::call(&out, 42);
+	CHECK(out == 42);
+
+	int counter = 1;
+	HookThunk<kHook_SmoothMovement, &bump>::call(counter);
+	HookThunk<kHook_SmoothMovement, &bump>::call(counter);
+	CHECK(counter == 3);
+
+	const char* a = "a";
+	const char* b = "b";
+	CHECK((HookThunk<kHook_ReEquipAll, &pick>::call(true, a, b) == a));
+	CHECK((HookThunk<kHook_ReEquipAll, &pick>::call(false, a, b) == b));
+
+	NiPoint3 pt = HookThunk<kHook_SetMultiBoundRef, &scaled>::call(NiPoint3(1, 2, 3), 2.0f);
+	CHECK(pt.x == 2.0f && pt.y == 4.0f && pt.z == 6.0f);
+
+	g_hookStats.endFrame();
+	CHECK(g_hookStats.getCallsLastFrame(kHook_BodyUpdate) == 1);
+	CHECK(g_hookStats.getCallsLastFrame(kHook_MainUpdatePlayer) == 1);
+	CHECK(g_hookStats.getCallsLastFrame(kHook_SmoothMovement) == 2);
+	CHECK(g_hookStats.getCallsLastFrame(kHook_ReEquipAll) == 2);
+	CHECK(g_hookStats.getCallsLastFrame(kHook_SetMultiBoundRef) == 1);
+	CHECK(g_hookStats.getCallsLastFrame(kHook_GunReloadInit) == 0);
+
+	// the next frame starts from zero again
+	g_hookStats.endFrame();
+	CHECK(g_hookStats.getCallsLastFrame(kHook_BodyUpdate) == 0);
+	CHECK(g_hookStats.getCallsLastFrame(kHook_SmoothMovement) == 0);
+}
+
+static void testTiming() {
+	g_hookStats.endFrame();
+
+	HookThunk<kHook_GunReloadInit, &spin>::call(2000000);
+	HookThunk<kHook_AnimationUpdate, &nothing>::call();
+
+	g_hookStats.endFrame();
+	CHECK(g_hookStats.getCallsLastFrame(kHook_GunReloadInit) == 1);
+
+	// the detour's own time is what's counted, a long one has to show up well above an empty one
+	float slow = g_hookStats.getMicrosLastFrame(kHook_GunReloadInit);
+	float fast = g_hookStats.getMicrosLastFrame(kHook_AnimationUpdate);
+	CHECK(slow > 0.0f);
+	CHECK(slow > fast * 10.0f);
+}
+
+static void testThreads() {
+	const int threads = 4;
+	const int calls = 100000;
+
+	g_hookStats.endFrame();
+
+	std::vector<std::thread> workers;
+	for (auto t = 0; t < threads; t++) {
+		workers.emplace_back([]() {
+			for (auto i = 0; i < calls; i++) {
+				HookThunk<kHook_AnimationUpdate, &nothing>::call();
+			}
+		});
+	}
+	for (auto& worker : workers) {
+		worker.join();
+	}
+
+	g_hookStats.endFrame();
+	CHECK(g_hookStats.getCallsLastFrame(kHook_AnimationUpdate) == (UInt32)(threads * calls));
+}
+
+static void testSummary() {
+	std::string summary = g_hookStats.getSummary();
+	CHECK(summary.find("bodyUpdate") != std::string::npos);
+	CHECK(summary.find("patchPipeGunScope") != std::string::npos);
+}
+
+static void benchmark() {
+	const int calls = 10000000;
+	void (*volatile direct)() = &nothing;
+	void (*volatile thunk)() = &HookThunk<kHook_AnimationUpdate, &nothing>::call;
+
+	double start = testNow();
+	for (auto i = 0; i < calls; i++) {
+		direct();
+	}
+	double directTime = testNow() - start;
+
+	start = testNow();
+	for (auto i = 0; i < calls; i++) {
+		thunk();
+	}
+	double thunkTime = testNow() - start;
+
+	printf("direct %.2f ns, through the thunk %.2f ns per call\n", directTime * 1e9 / calls, thunkTime * 1e9 / calls);
+}
+
+int main() {
+	testPassThrough();
+	testTiming();
+	testThreads();
+	testSummary();
+	benchmark();
+
+	return testResult("HookThunks");
+}
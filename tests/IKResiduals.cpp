@@ -0,0 +1,262 @@
+// The residuals and FRIK_IK_* flags LimbIK reports, for targets the limbs can reach, ones they can't and ones sitting on
+// the joint they hang from.   Reachable targets have to report next to no error and no clamps, the rest have to say what
+// happened, and none of them may leave a NaN in the nodes.   IKStats then has to roll the same numbers up.
+#include "TestUtil.h"
+#include "ActorRig.h"
+#include "IKStats.h"
+
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <thread>
+
+static const uint32_t kClampFlags = FRIK_IK_OUT_OF_REACH | FRIK_IK_STRETCHED | FRIK_IK_ACOS_CLAMPED | FRIK_IK_DEGENERATE;
+static const uint32_t kElbowFlags = FRIK_IK_ELBOW_BEHIND | FRIK_IK_ELBOW_CROSSED | FRIK_IK_ELBOW_BEHIND_HEAD;
+
+struct LimbResult {
+	float residual;
+	float rotation;
+	uint32_t flags;
+	bool finite;
+};
+
+static bool finite(NiAVObject* a_node) {
+	const NiTransform& t = a_node->m_worldTransform;
+	bool ok = std::isfinite(t.pos.x) && std::isfinite(t.pos.y) && std::isfinite(t.pos.z);
+	for (auto i = 0; i < 3; i++) {
+		for (auto j = 0; j < 3; j++) {
+			ok = ok && std::isfinite(t.rot.data[i][j]);
+		}
+	}
+	return ok;
+}
+
+// one leg through LimbIK the way Skeleton's single leg path does it: solve, apply, world update, then read back
+static LimbResult solveLeg(ActorRig& a_rig, int a_side, NiPoint3 a_target) {
+	a_rig.animate();
+	a_rig.limbs.invalidate();
+	a_rig.limbs.beginFrame();
+
+	LegJob job;
+	job.hip = a_rig.hip[a_side];
+	job.knee = a_rig.knee[a_side];
+	job.foot = a_rig.foot[a_side];
+	job.in.isLeft = a_side == 1;
+	job.in.inPowerArmor = false;
+	job.in.footPos = a_target;
+	if (a_rig.limbs.prepareLeg(job)) {
+		solveLegIK(job.in, job.out);
+		a_rig.limbs.applyLeg(job);
+	}
+	updateWorld(a_rig.hip[a_side]);
+
+	FRIKTelemetryLimb limb = a_side == 1 ? FRIK_LIMB_LEFT_LEG : FRIK_LIMB_RIGHT_LEG;
+	return { a_rig.limbs.getResidual(limb), a_rig.limbs.getRotationResidual(limb), a_rig.limbs.getFlags(limb), finite(a_rig.foot[a_side]) };
+}
+
+static LimbResult solveArm(ActorRig& a_rig, int a_side, NiPoint3 a_target, NiMatrix43 a_rot) {
+	a_rig.animate();
+	a_rig.limbs.invalidate();
+	a_rig.limbs.beginFrame();
+
+	ArmJob job;
+	job.arm = a_rig.arm[a_side];
+	ArmIKInput& in = job.in;
+	in.isLeft = a_side == 1;
+	in.inPowerArmor = false;
+	in.handPos = a_target;
+	in.handRot = a_rot;
+	in.forwardDir = NiPoint3(0, 1, 0);
+	in.sidewaysRDir = NiPoint3(1, 0, 0);
+	in.chestZ = a_rig.chest->m_worldTransform.pos.z;
+	in.rootScale = 1.0f;
+	in.armLength = 36.74f;
+	if (a_rig.limbs.prepareArm(job)) {
+		solveArmIK(job.in, job.out);
+		a_rig.limbs.applyArm(job);
+	}
+	updateWorld(a_rig.arm[a_side].shoulder->GetAsNiNode());
+
+	FRIKTelemetryLimb limb = a_side == 1 ? FRIK_LIMB_LEFT_ARM : FRIK_LIMB_RIGHT_ARM;
+	return { a_rig.limbs.getResidual(limb), a_rig.limbs.getRotationResidual(limb), a_rig.limbs.getFlags(limb), finite(a_rig.arm[a_side].hand) };
+}
+
+// a hand rotation with the palm roughly in, like holding something in front
+static NiMatrix43 handRotation(TestRandom& a_rng) {
+	NiMatrix43 base = getRotationAxisAngle(NiPoint3(0, 0, 1), (float)PI / 2);
+	NiMatrix43 wobble = getRotationAxisAngle(NiPoint3(a_rng.signedUnit(), a_rng.signedUnit(), 1.0f), a_rng.signedUnit() * 0.5f);
+	return composeRot(wobble, base);
+}
+
+static void testReachable() {
+	ActorRig rig(NiPoint3(0, 0, 0));
+	rig.animate();
+	TestRandom rng(17);
+	float worstLeg = 0.0f;
+	float worstArm = 0.0f;
+	float worstRot = 0.0f;
+	int clamped = 0;
+
+	for (auto i = 0; i < 500; i++) {
+		int side = i & 1;
+		NiPoint3 hip = rig.hip[side]->m_worldTransform.pos;
+
+		// below the hip, between 30 and 85 away
+		NiPoint3 dir = vec3_norm(NiPoint3(rng.signedUnit() * 0.5f, rng.signedUnit() * 0.5f, -1.0f));
+		LimbResult leg = solveLeg(rig, side, hip + dir * (57.5f + rng.signedUnit() * 27.5f));
+		CHECK(leg.finite);
+		CHECK((leg.flags & FRIK_IK_SOLVED) != 0);
+		clamped += (leg.flags & kClampFlags) != 0;
+		worstLeg = (std::max)(worstLeg, leg.residual);
+		CHECK(leg.rotation == 0.0f);
+
+		// in front of the body on the hand's own side, inside arm's length
+		float x = side == 0 ? 1.0f : -1.0f;
+		NiPoint3 target(x * (15.0f + rng.signedUnit() * 8.0f), 30.0f + rng.signedUnit() * 12.0f, 115.0f + rng.signedUnit() * 15.0f);
+		LimbResult arm = solveArm(rig, side, target, handRotation(rng));
+		CHECK(arm.finite);
+		clamped += (arm.flags & kClampFlags) != 0;
+		worstArm = (std::max)(worstArm, arm.residual);
+		worstRot = (std::max)(worstRot, arm.rotation);
+	}
+
+	printf("reachable: leg %.4f, arm %.4f, hand rotation %.3f degrees, %d clamped\n", worstLeg, worstArm, worstRot, clamped);
+	CHECK(worstLeg < 0.05f);
+	CHECK(worstArm < 0.05f);
+	CHECK(worstRot < 0.5f);
+	CHECK(clamped == 0);
+}
+
+static void testUnreachable() {
+	ActorRig rig(NiPoint3(0, 0, 0));
+	rig.animate();
+	TestRandom rng(2);
+
+	// further than the leg goes, the bones stretch to get there
+	NiPoint3 hip = rig.hip[0]->m_worldTransform.pos;
+	LimbResult leg = solveLeg(rig, 0, hip + NiPoint3(0, 40, -140));
+	CHECK(leg.finite);
+	CHECK((leg.flags & FRIK_IK_STRETCHED) != 0);
+	CHECK(leg.residual < 0.05f);
+
+	// the same for an arm a little out of reach
+	LimbResult arm = solveArm(rig, 0, NiPoint3(20, 75, 120), handRotation(rng));
+	CHECK(arm.finite);
+	CHECK((arm.flags & FRIK_IK_STRETCHED) != 0);
+	CHECK(!(arm.flags & FRIK_IK_OUT_OF_REACH));
+	CHECK(arm.residual < 0.05f);
+
+	// way out of reach only the shoulder turns, the residual says how far off the hand is
+	NiPoint3 far(20, 250, 120);
+	arm = solveArm(rig, 0, far, handRotation(rng));
+	CHECK(arm.finite);
+	CHECK(arm.flags == (FRIK_IK_OUT_OF_REACH | FRIK_IK_SOLVED));
+	CHECK(arm.residual > 150.0f);
+	CHECK_NEAR(arm.residual, vec3_len(rig.arm[0].hand->m_worldTransform.pos - far), 1e-3);
+	CHECK(arm.rotation > 10.0f);
+}
+
+static void testDegenerate() {
+	ActorRig rig(NiPoint3(0, 0, 0));
+	rig.animate();
+	TestRandom rng(8);
+
+	// foot target right on the hip
+	LimbResult leg = solveLeg(rig, 1, rig.hip[1]->m_worldTransform.pos);
+	CHECK(leg.finite);
+	CHECK((leg.flags & FRIK_IK_DEGENERATE) != 0);
+
+	// hand target right on the upper arm
+	LimbResult arm = solveArm(rig, 0, rig.arm[0].upper->m_worldTransform.pos, handRotation(rng));
+	CHECK(arm.finite);
+	CHECK((arm.flags & FRIK_IK_DEGENERATE) != 0);
+
+	// a thigh longer than the calf can't fold up onto a target this close, acos goes out of range and gets clamped
+	rig.knee[0]->m_localTransform.pos = NiPoint3(55, 0, 0);
+	rig.foot[0]->m_localTransform.pos = NiPoint3(35, 0, 0);
+	for (auto& bone : rig.bindPose) {
+		bone.second = bone.first->m_localTransform;
+	}
+	leg = solveLeg(rig, 0, rig.hip[0]->m_worldTransform.pos + NiPoint3(0, 2, -5));
+	CHECK(leg.finite);
+	CHECK((leg.flags & FRIK_IK_ACOS_CLAMPED) != 0);
+
+	// the hand crossing through the shoulder in small steps never leaves a NaN behind
+	int bad = 0;
+	for (auto i = -50; i <= 50; i++) {
+		NiPoint3 upper = rig.arm[1].upper->m_worldTransform.pos;
+		arm = solveArm(rig, 1, upper + NiPoint3(i * 0.01f, i * 0.003f, -i * 0.005f), handRotation(rng));
+		bad += !arm.finite;
+	}
+	CHECK(bad == 0);
+}
+
+static void testElbowBranches() {
+	ActorRig rig(NiPoint3(0, 0, 0));
+	rig.animate();
+	TestRandom rng(4);
+	NiMatrix43 rot = handRotation(rng);
+
+	// out in front on its own side nothing steers the elbow
+	CHECK((solveArm(rig, 0, NiPoint3(22, 35, 95), rot).flags & kElbowFlags) == 0);
+
+	// behind the body
+	CHECK((solveArm(rig, 0, NiPoint3(25, -30, 100), rot).flags & FRIK_IK_ELBOW_BEHIND) != 0);
+
+	// across the chest
+	CHECK((solveArm(rig, 0, NiPoint3(-12, 22, 105), rot).flags & FRIK_IK_ELBOW_CROSSED) != 0);
+
+	// up behind the head
+	CHECK((solveArm(rig, 0, NiPoint3(10, -8, 150), rot).flags & FRIK_IK_ELBOW_BEHIND_HEAD) != 0);
+
+	// mirrored for the left arm
+	CHECK((solveArm(rig, 1, NiPoint3(12, 22, 105), rot).flags & FRIK_IK_ELBOW_CROSSED) != 0);
+	CHECK((solveArm(rig, 1, NiPoint3(-25, -30, 100), rot).flags & FRIK_IK_ELBOW_BEHIND) != 0);
+}
+
+static void testStats() {
+	ActorRig rig(NiPoint3(0, 0, 0));
+	rig.animate();
+	TestRandom rng(6);
+	IKStats stats;
+	const int frames = 20;
+
+	// a right hand reaching for something it can't get every frame, everything else in reach
+	for (auto frame = 0; frame < frames; frame++) {
+		LimbResult far = solveArm(rig, 0, NiPoint3(20, 250, 120), handRotation(rng));
+		LimbResult near = solveArm(rig, 1, NiPoint3(-20, 30, 110), handRotation(rng));
+		LimbResult leg = solveLeg(rig, 0, rig.hip[0]->m_worldTransform.pos + NiPoint3(0, 10, -80));
+
+		stats.setLimb(FRIK_LIMB_RIGHT_ARM, far.residual, far.rotation, far.flags);
+		stats.setLimb(FRIK_LIMB_LEFT_ARM, near.residual, near.rotation, near.flags);
+		stats.setLimb(FRIK_LIMB_RIGHT_LEG, leg.residual, 0.0f, leg.flags);
+		stats.setPosture(0.5f);
+
+		CHECK(stats.getThisFrame(FRIK_LIMB_RIGHT_ARM).position == far.residual);
+		CHECK(stats.getThisFrame(FRIK_LIMB_RIGHT_ARM).flags == far.flags);
+		CHECK(stats.getThisFrame(FRIK_LIMB_LEFT_ARM).position < 0.05f);
+
+		// the last frame closes the one second window
+		if (frame == frames - 1) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(1050));
+		}
+		stats.endFrame();
+	}
+
+	std::string summary = stats.getSummary();
+	printf("%s\n", summary.c_str());
+	CHECK(summary.find("ik over 20 frames") != std::string::npos);
+	CHECK(summary.find("outOfReach 20") != std::string::npos);
+	CHECK(summary.find("solved 20") != std::string::npos);
+	CHECK(summary.find("posture 0.50") != std::string::npos);
+}
+
+int main() {
+	testReachable();
+	testUnreachable();
+	testDegenerate();
+	testElbowBranches();
+	testStats();
+
+	return testResult("IKResiduals");
+}
@@ -0,0 +1,126 @@
+#pragma once
+// A plain arm and leg for feeding the solvers without the game.   Bones point down their local x like the game's do,
+// forward kinematics go through the same Matrix44 helpers Skeleton uses.
+#include "IKSolver.h"
+#include "matrix.h"
+
+using namespace F4VRBody;
+
+inline NiMatrix43 identityRot() {
+	NiMatrix43 m;
+	m.MakeIdentity();
+	return m;
+}
+
+inline NiMatrix43 composeRot(const NiMatrix43& a_local, const NiMatrix43& a_parent) {
+	Matrix44 m;
+	m.makeTransformMatrix(a_local, NiPoint3(0, 0, 0));
+	return m.multiply43Left(a_parent);
+}
+
+inline NiTransform childWorld(const NiTransform& a_parent, const NiTransform& a_local) {
+	NiTransform out;
+	out.pos = a_parent.pos + a_parent.rot * (a_local.pos * a_parent.scale);
+	out.rot = composeRot(a_local.rot, a_parent.rot);
+	out.scale = a_parent.scale * a_local.scale;
+	return out;
+}
+
+// degrees between two rotations.   from the size of their difference, acos of the trace is too coarse near 0 in floats
+inline float rotationDelta(const NiMatrix43& a, const NiMatrix43& b) {
+	double sum = 0.0;
+	for (int i = 0; i < 3; i++) {
+		for (int j = 0; j < 3; j++) {
+			double d = (double)a.data[i][j] - b.data[i][j];
+			sum += d * d;
+		}
+	}
+	double s = sqrt(sum) / (2.0 * sqrt(2.0));
+	return (float)(2.0 * asin(s > 1.0 ? 1.0 : s) * 180.0 / PI);
+}
+
+inline NiTransform makeLocal(float a_x) {
+	NiTransform t;
+	t.rot = identityRot();
+	t.pos = NiPoint3(a_x, 0, 0);
+	t.scale = 1.0f;
+	return t;
+}
+
+inline ArmIKInput makeArmInput(bool a_left, NiPoint3 a_handPos, NiMatrix43 a_handRot) {
+	ArmIKInput in;
+	in.isLeft = a_left;
+	in.inPowerArmor = false;
+	in.hasForearmTwist = true;
+	in.handPos = a_handPos;
+	in.handRot = a_handRot;
+	in.shoulderWorld.rot = identityRot();
+	in.shoulderWorld.pos = NiPoint3(a_left ? -8.0f : 8.0f, 0, 120);
+	in.shoulderWorld.scale = 1.0f;
+	in.shoulderLocalRot = identityRot();
+	in.shoulderParentRot = identityRot();
+	in.upperLocal = makeLocal(12.0f);
+	in.upperWorldPos = in.shoulderWorld.pos + NiPoint3(12.0f, 0, 0);
+	in.upperWorldScale = 1.0f;
+	in.forearm1Local = makeLocal(28.0f);
+	in.forearm2Local = makeLocal(8.0f);
+	in.forearm3Local = makeLocal(8.0f);
+	in.handLocal = makeLocal(10.0f);
+	in.handToForearmLen = 26.0f;
+	in.forwardDir = NiPoint3(0, 1, 0);
+	in.sidewaysRDir = NiPoint3(1, 0, 0);
+	in.chestZ = 100.0f;
+	in.rootScale = 1.0f;
+	in.armLength = 36.74f;    // adjusted arm length of exactly 1
+	in.prevTwistAngle = 0.0f;
+	return in;
+}
+
+// where the solved arm put the hand
+inline NiTransform armHandWorld(const ArmIKInput& in, const ArmIKOutput& out) {
+	NiTransform clavicle;
+	clavicle.pos = in.shoulderWorld.pos;
+	clavicle.rot = composeRot(out.shoulderLocalRot, in.shoulderParentRot);
+	clavicle.scale = in.shoulderWorld.scale;
+
+	NiTransform upper = in.upperLocal;
+	upper.rot = out.upperLocalRot;
+	upper = childWorld(clavicle, upper);
+
+	NiTransform forearm = childWorld(upper, out.forearm1Local);
+	forearm = childWorld(forearm, out.forearm2Local);
+	forearm = childWorld(forearm, out.forearm3Local);
+	return childWorld(forearm, out.handLocal);
+}
+
+inline LegIKInput makeLegInput(bool a_left, NiPoint3 a_footPos) {
+	LegIKInput in;
+	in.isLeft = a_left;
+	in.inPowerArmor = false;
+	in.footPos = a_footPos;
+	in.hipWorld.rot = identityRot();
+	in.hipWorld.pos = NiPoint3(a_left ? -10.0f : 10.0f, 0, 90);
+	in.hipWorld.scale = 1.0f;
+	in.hipParentRot = identityRot();
+	in.hipLocalRot = identityRot();
+	in.kneeLocal = makeLocal(45.0f);
+	in.footLocalPos = NiPoint3(45.0f, 0, 0);
+	in.kneeWorldScale = 1.0f;
+	return in;
+}
+
+inline NiPoint3 legFootWorld(const LegIKInput& in, const LegIKOutput& out) {
+	NiTransform hip;
+	hip.pos = in.hipWorld.pos;
+	hip.rot = composeRot(out.hipLocalRot, in.hipParentRot);
+	hip.scale = in.hipWorld.scale;
+
+	NiTransform knee;
+	knee.pos = out.kneeLocalPos;
+	knee.rot = out.kneeLocalRot;
+	knee.scale = 1.0f;
+	knee = childWorld(hip, knee);
+	knee.scale = in.kneeWorldScale;
+
+	return knee.pos + knee.rot * (out.footLocalPos * knee.scale);
+}
@@ -0,0 +1,136 @@
+// The limb solves on the ik workers have to give exactly what the serial solves give, bit for bit, otherwise turning
+// ParallelIK on would change the pose.   Also times a frame's worth of arm and leg pairs both ways, the hand off to the
+// worker costs more than the solves it moves so ParallelIK stays off by default.
+#include "TestUtil.h"
+#include "IKRig.h"
+#include "WorkerPool.h"
+
+#include <cstring>
+#include <vector>
+
+struct ArmPair {
+	ArmIKInput in[2];
+	ArmIKOutput out[2];
+};
+
+struct LegPair {
+	LegIKInput in[2];
+	LegIKOutput out[2];
+};
+
+struct ArmSolve {
+	const ArmIKInput* in;
+	ArmIKOutput* out;
+};
+
+struct LegSolve {
+	const LegIKInput* in;
+	LegIKOutput* out;
+};
+
+static void runArm(void* a_arg) {
+	ArmSolve* job = (ArmSolve*)a_arg;
+	solveArmIK(*job->in, *job->out);
+}
+
+static void runLeg(void* a_arg) {
+	LegSolve* job = (LegSolve*)a_arg;
+	solveLegIK(*job->in, *job->out);
+}
+
+static void makePairs(std::vector<ArmPair>& a_arms, std::vector<LegPair>& a_legs, int a_count) {
+	TestRandom rng(52);
+
+	for (int i = 0; i < a_count; i++) {
+		ArmPair arms{};
+		LegPair legs{};
+
+		for (int side = 0; side < 2; side++) {
+			// some of these are out of reach or behind the body on purpose
+			NiPoint3 hand(rng.signedUnit() * 70.0f, rng.signedUnit() * 70.0f, 110.0f + rng.signedUnit() * 60.0f);
+			NiMatrix43 rot = getRotationAxisAngle(NiPoint3(rng.signedUnit(), rng.signedUnit(), rng.signedUnit()), rng.signedUnit() * 3.0f);
+			arms.in[side] = makeArmInput(side == 1, hand, rot);
+			arms.in[side].prevTwistAngle = rng.signedUnit();
+
+			NiPoint3 foot((side ? -10.0f : 10.0f) + rng.signedUnit() * 30.0f, rng.signedUnit() * 40.0f, 5.0f + rng.signedUnit() * 30.0f);
+			legs.in[side] = makeLegInput(side == 1, foot);
+		}
+
+		a_arms.push_back(arms);
+		a_legs.push_back(legs);
+	}
+}
+
+static double solveAll(WorkerPool* a_pool, std::vector<ArmPair>& a_arms, std::vector<LegPair>& a_legs) {
+	double start = testNow();
+
+	for (size_t i = 0; i < a_arms.size(); i++) {
+		if (!a_pool) {
+			for (int side = 0; side < 2; side++) {
+				solveLegIK(a_legs[i].in[side], a_legs[i].out[side]);
+			}
+			for (int side = 0; side < 2; side++) {
+				solveArmIK(a_arms[i].in[side], a_arms[i].out[side]);
+			}
+			continue;
+		}
+
+		// the same two batches Skeleton hands the pool each frame
+		LegSolve legs[2] = { { &a_legs[i].in[0], &a_legs[i].out[0] }, { &a_legs[i].in[1], &a_legs[i].out[1] } };
+		WorkerJob legJobs[2] = { { runLeg, &legs[0] }, { runLeg, &legs[1] } };
+		a_pool->run(legJobs, 2);
+
+		ArmSolve arms[2] = { { &a_arms[i].in[0], &a_arms[i].out[0] }, { &a_arms[i].in[1], &a_arms[i].out[1] } };
+		WorkerJob armJobs[2] = { { runArm, &arms[0] }, { runArm, &arms[1] } };
+		a_pool->run(armJobs, 2);
+	}
+
+	return testNow() - start;
+}
+
+int main() {
+	const int pairs = 5000;
+
+	std::vector<ArmPair> serialArms, inlineArms, parallelArms;
+	std::vector<LegPair> serialLegs, inlineLegs, parallelLegs;
+	makePairs(serialArms, serialLegs, pairs);
+	inlineArms = parallelArms = serialArms;
+	inlineLegs = parallelLegs = serialLegs;
+
+	WorkerPool inlinePool(0);
+	WorkerPool parallelPool(1);
+
+	double serialTime = solveAll(nullptr, serialArms, serialLegs);
+	double inlineTime = solveAll(&inlinePool, inlineArms, inlineLegs);
+	double parallelTime = solveAll(&parallelPool, parallelArms, parallelLegs);
+
+	int armMismatch = 0;
+	int legMismatch = 0;
+	for (int i = 0; i < pairs; i++) {
+		armMismatch += memcmp(serialArms[i].out, inlineArms[i].out, sizeof(serialArms[i].out)) != 0;
+		armMismatch += memcmp(serialArms[i].out, parallelArms[i].out, sizeof(serialArms[i].out)) != 0;
+		legMismatch += memcmp(serialLegs[i].out, inlineLegs[i].out, sizeof(serialLegs[i].out)) != 0;
+		legMismatch += memcmp(serialLegs[i].out, parallelLegs[i].out, sizeof(serialLegs[i].out)) != 0;
+	}
+
+	CHECK(armMismatch == 0);
+	CHECK(legMismatch == 0);
+
+	// and a second parallel run lands on the same bits again
+	std::vector<ArmPair> againArms = serialArms;
+	std::vector<LegPair> againLegs = serialLegs;
+	solveAll(&parallelPool, againArms, againLegs);
+	int againMismatch = 0;
+	for (int i = 0; i < pairs; i++) {
+		againMismatch += memcmp(againArms[i].out, parallelArms[i].out, sizeof(againArms[i].out)) != 0;
+		againMismatch += memcmp(againLegs[i].out, parallelLegs[i].out, sizeof(againLegs[i].out)) != 0;
+	}
+	CHECK(againMismatch == 0);
+
+	printf("%d frames of two legs and two arms\n", pairs);
+	printf("  serial            %.2f us per frame\n", serialTime * 1e6 / pairs);
+	printf("  pool, no threads  %.2f us per frame\n", inlineTime * 1e6 / pairs);
+	printf("  pool, 1 worker    %.2f us per frame\n", parallelTime * 1e6 / pairs);
+
+	return testResult("IKWorkers");
+}
@@ -0,0 +1,203 @@
+// MagazinePool's slot policy against a pretend reference table.   Free slots and ones the game has let go of get a new
+// reference, a full pool moves the oldest magazine of the same kind, and with none of that kind the oldest slot is
+// retired and gets a new reference.   A cell change starts over and the mesh stays with its slot.
+#include "TestUtil.h"
+#include "F4VRBody.h"
+#include "MagazinePool.h"
+#include "f4se/GameReferences.h"
+
+#include <memory>
+#include <vector>
+
+using namespace F4VRBody;
+
+class TESBoundObject {};
+class TESObjectCELL {};
+
+// every reference the pool asked for, the handle is the index plus one
+struct FakeRef {
+	std::unique_ptr<TESObjectREFR> refr;
+	TESBoundObject* object;
+	NiPoint3 location;
+	bool loaded;
+	bool retired;
+};
+
+static std::vector<FakeRef> g_refs;
+static TESObjectCELL g_cells[2];
+static TESObjectCELL* g_cell = &g_cells[0];
+static bool g_createFails = false;
+static int g_moves = 0;
+
+static TESObjectCELL* fakeCell() {
+	return g_cell;
+}
+
+static void fakeCreate(TESBoundObject* a_object, NiPoint3 a_location, NiPoint3, UInt64* a_handle) {
+	if (g_createFails) {
+		return;
+	}
+	g_refs.push_back({ std::unique_ptr<TESObjectREFR>(new TESObjectREFR()), a_object, a_location, true, false });
+	*a_handle = g_refs.size();
+}
+
+static TESObjectREFR* fakeResolve(UInt64* a_handle) {
+	FakeRef& ref = g_refs[*a_handle - 1];
+	return ref.loaded ? ref.refr.get() : nullptr;
+}
+
+static FakeRef* findRef(TESObjectREFR* a_refr) {
+	for (auto& ref : g_refs) {
+		if (ref.refr.get() == a_refr) {
+			return &ref;
+		}
+	}
+	return nullptr;
+}
+
+static void fakeMove(TESObjectREFR* a_refr, NiPoint3 a_location, NiPoint3) {
+	findRef(a_refr)->location = a_location;
+	g_moves++;
+}
+
+static void fakeRetire(TESObjectREFR* a_refr) {
+	findRef(a_refr)->retired = true;
+}
+
+static const MagazineCalls fakeCalls = { fakeCell, fakeCreate, fakeResolve, fakeMove, fakeRetire };
+
+static TESBoundObject g_mags[4];
+static TESBoundObject* const A = &g_mags[0];
+static TESBoundObject* const B = &g_mags[1];
+static TESBoundObject* const C = &g_mags[2];
+static TESBoundObject* const D = &g_mags[3];
+
+static void reset() {
+	g_refs.clear();
+	g_cell = &g_cells[0];
+	g_createFails = false;
+	g_moves = 0;
+}
+
+static NiPoint3 spot(int a_index) {
+	return NiPoint3((float)a_index, 0, 0);
+}
+
+static void testPolicy() {
+	reset();
+	MagazinePool pool(fakeCalls);
+	NiNode mesh;
+
+	// empty slots fill in order
+	TESBoundObject* fill[] = { A, B, A, C };
+	TESObjectREFR* refrs[MagazinePool::kCapacity];
+	for (auto i = 0; i < MagazinePool::kCapacity; i++) {
+		refrs[i] = pool.acquire(fill[i], spot(i), NiPoint3());
+		CHECK(pool.getLastSlot() == i);
+		CHECK(refrs[i] == g_refs[i].refr.get());
+	}
+	CHECK(pool.getCreated() == 4);
+	CHECK(pool.getMesh() == nullptr);
+	pool.setMesh(&mesh);
+
+	// full, the A that has been lying around longest is moved, then the other one
+	CHECK(pool.acquire(A, spot(10), NiPoint3()) == refrs[0]);
+	CHECK(pool.getLastSlot() == 0);
+	CHECK(g_refs[0].location.x == 10.0f);
+	CHECK(pool.acquire(A, spot(11), NiPoint3()) == refrs[2]);
+	CHECK(g_refs[2].location.x == 11.0f);
+	CHECK(pool.acquire(A, spot(12), NiPoint3()) == refrs[0]);
+	CHECK(g_moves == 3);
+	CHECK(g_refs.size() == 4);
+
+	// the slot's mesh comes back with it
+	CHECK(pool.getMesh() == nullptr);
+	pool.acquire(C, spot(13), NiPoint3());
+	CHECK(pool.getLastSlot() == 3 && pool.getMesh() == &mesh);
+
+	// no D anywhere, B's slot is the oldest and gets a new reference after the old one is hidden
+	TESObjectREFR* d = pool.acquire(D, spot(14), NiPoint3());
+	CHECK(pool.getLastSlot() == 1);
+	CHECK(g_refs[1].retired);
+	CHECK(g_refs.size() == 5 && d == g_refs[4].refr.get() && g_refs[4].object == D);
+	CHECK(pool.getCreated() == 5);
+	CHECK(g_moves == 4);
+
+	// and the next one that doesn't fit takes the oldest after that, slot 2
+	pool.acquire(B, spot(15), NiPoint3());
+	CHECK(pool.getLastSlot() == 2);
+	CHECK(g_refs[2].retired && !g_refs[0].retired && !g_refs[3].retired);
+
+	int retired = 0;
+	for (auto& ref : g_refs) {
+		retired += ref.retired ? 1 : 0;
+	}
+	CHECK(retired == 2);
+}
+
+static void testLostReferences() {
+	reset();
+	MagazinePool pool(fakeCalls);
+
+	for (auto i = 0; i < MagazinePool::kCapacity; i++) {
+		pool.acquire(A, spot(i), NiPoint3());
+	}
+
+	// the game unloaded slot 2's reference, it is refilled before anything is moved
+	g_refs[2].loaded = false;
+	TESObjectREFR* refr = pool.acquire(A, spot(20), NiPoint3());
+	CHECK(pool.getLastSlot() == 2);
+	CHECK(refr == g_refs[4].refr.get());
+	CHECK(g_moves == 0 && !g_refs[2].retired);
+
+	// a new cell took every reference with it, the pool starts from slot 0 again without moving or hiding anything
+	g_cell = &g_cells[1];
+	refr = pool.acquire(A, spot(21), NiPoint3());
+	CHECK(pool.getLastSlot() == 0);
+	CHECK(refr == g_refs[5].refr.get());
+	CHECK(g_moves == 0);
+	CHECK(pool.getCreated() == 6);
+
+	// the game wouldn't make one, the slot stays free for the next try
+	g_createFails = true;
+	CHECK(pool.acquire(B, spot(22), NiPoint3()) == nullptr);
+	CHECK(pool.getLastSlot() == 1);
+	g_createFails = false;
+	refr = pool.acquire(B, spot(23), NiPoint3());
+	CHECK(pool.getLastSlot() == 1 && refr == g_refs[6].refr.get());
+}
+
+// a long session of reloads with a few weapons never holds more than kCapacity references at once
+static void testSession() {
+	reset();
+	MagazinePool pool(fakeCalls);
+	TestRandom random(3);
+	TESBoundObject* weapons[] = { A, A, A, B, B, C };
+
+	for (auto reload = 0; reload < 1000; reload++) {
+		if (reload % 250 == 249) {
+			g_cell = g_cell == &g_cells[0] ? &g_cells[1] : &g_cells[0];
+			for (auto& ref : g_refs) {
+				ref.loaded = false;
+			}
+		}
+		pool.acquire(weapons[random.next() % 6], spot(reload), NiPoint3());
+
+		int live = 0;
+		for (auto& ref : g_refs) {
+			live += ref.loaded && !ref.retired ? 1 : 0;
+		}
+		CHECK(live <= MagazinePool::kCapacity);
+	}
+
+	printf("session: 1000 reloads, %u references made, %d moved\n", pool.getCreated(), g_moves);
+	CHECK(pool.getCreated() < 100);
+}
+
+int main() {
+	testPolicy();
+	testLostReferences();
+	testSession();
+
+	return testResult("MagazineSlots");
+}
@@ -0,0 +1,246 @@
+// PipboyInteraction against a made up pipboy on a made up arm.   bind finds every part once and then answers from what
+// it kept until the attach points change, a part that's missing is looked for again after kRetryFrames, and isTouching /
+// isLookedAt give the same answers as a world space distance and facing check would.
+#include "TestUtil.h"
+#include "F4VRBody.h"
+#include "IKRig.h"
+#include "PipboyInteraction.h"
+#include "WorkCounters.h"
+#include "utils.h"
+
+#include <memory>
+#include <vector>
+
+using namespace F4VRBody;
+
+// utils.cpp links against these, nothing in here reads the ini
+RelocPtr<INISettingCollection*> g_iniSettings(0);
+RelocPtr<INIPrefSettingCollection*> g_iniPrefSettings(0);
+
+Setting* GetINISetting(const char*) {
+	return nullptr;
+}
+
+namespace F4VRBody {
+	std::map<std::string, int> boneTreeMap = { { "RArm_Finger23", 41 }, { "LArm_Finger23", 17 } };
+}
+
+// shoulder, forearms, PipboyBone and the PipboyRoot the finger touches, and a wand with the pipboy nif and its screen.
+// both roots are turned and scaled so the checks can't pass by staying in world space.
+struct FakePipboy {
+	std::vector<std::unique_ptr<NiAVObject>> owned;
+	NiNode* shoulder;
+	NiNode* forearm1;
+	NiNode* forearm3;
+	NiNode* touchRoot;
+	NiNode* wand;
+	NiNode* wandPipboy;
+	NiNode* screen;
+
+	FakePipboy(bool a_withScreen = true) {
+		shoulder = add("LArm_UpperArm", nullptr, NiPoint3(10, 20, 120));
+		forearm1 = add("LArm_ForeArm1", shoulder, NiPoint3(15, 0, 0));
+		forearm3 = add("LArm_ForeArm3", forearm1, NiPoint3(10, 0, 0));
+		NiNode* bone = add("PipboyBone", forearm3, NiPoint3(2, 0, 1));
+		touchRoot = add("PipboyRoot", bone, NiPoint3(1, 2, 3));
+		touchRoot->m_localTransform.rot = getRotationAxisAngle(NiPoint3(0, 0, 1), degrees_to_rads(70.0f));
+		touchRoot->m_localTransform.scale = 2.0f;
+
+		wand = add("SecondaryWandNode", nullptr, NiPoint3(30, 15, 110));
+		wand->m_localTransform.rot = getRotationAxisAngle(NiPoint3(1, 0, 0), degrees_to_rads(-35.0f));
+		wandPipboy = add("PipboyRoot_NIF_ONLY", wand, NiPoint3(0, 3, 0));
+		screen = add("Screen:0", nullptr, NiPoint3(0, 0, 2));
+		screen->m_localTransform.rot = getRotationAxisAngle(NiPoint3(0, 1, 0), degrees_to_rads(50.0f));
+		if (a_withScreen) {
+			wandPipboy->AttachChild(screen, true);
+		}
+
+		update();
+	}
+
+	NiNode* add(const char* a_name, NiNode* a_parent, NiPoint3 a_pos) {
+		NiNode* node = new NiNode();
+		node->m_name = BSFixedString(a_name);
+		node->m_localTransform.rot = identityRot();
+		node->m_localTransform.pos = a_pos;
+		node->m_worldTransform.rot = identityRot();
+		node->m_worldTransform.pos = a_pos;
+		owned.emplace_back(node);
+		if (a_parent) {
+			a_parent->AttachChild(node, true);
+		}
+		return node;
+	}
+
+	void update() {
+		updateTransformsDown(shoulder, false);
+		updateTransformsDown(wand, false);
+	}
+
+	PipboyAttach attach(bool a_leftHanded = false) {
+		PipboyAttach out;
+		out.wand = wand;
+		out.wandPipboy = wandPipboy;
+		out.shoulder = shoulder;
+		out.forearm1 = forearm1;
+		out.forearm3 = forearm3;
+		out.leftHanded = a_leftHanded;
+		return out;
+	}
+};
+
+// lookups bind made since the last call
+struct Lookups {
+	UInt64 before;
+
+	Lookups() : before(count()) {}
+
+	static UInt64 count() {
+		return g_workCounters.getThisFrame(kWork_NodeLookups) + g_workCounters.getThisFrame(kWork_ObjectByName) +
+			g_workCounters.getThisFrame(kWork_MapLookups);
+	}
+
+	UInt64 added() {
+		UInt64 now = count();
+		UInt64 out = now - before;
+		before = now;
+		return out;
+	}
+};
+
+static void testBind() {
+	FakePipboy pipboy;
+	PipboyInteraction interaction;
+	Lookups lookups;
+
+	CHECK(interaction.bind(pipboy.attach(), 3.0f));
+	CHECK(interaction.getTouchRoot() == pipboy.touchRoot);
+	CHECK(interaction.getWandPipboy() == pipboy.wandPipboy);
+	CHECK(interaction.getScreen() == pipboy.screen);
+	CHECK(interaction.getPipboyBone() != nullptr);
+	CHECK(interaction.getFingerBone() == 41);
+	CHECK(lookups.added() > 0);
+
+	// every frame after that is free
+	for (auto frame = 0; frame < 500; frame++) {
+		CHECK(interaction.bind(pipboy.attach(), 3.0f));
+	}
+	CHECK(lookups.added() == 0);
+
+	// the pipboy on the other arm points with the other finger
+	CHECK(interaction.bind(pipboy.attach(true), 3.0f));
+	CHECK(interaction.getFingerBone() == 17);
+	CHECK(lookups.added() > 0);
+
+	// a new wand node is a new pipboy 3D
+	FakePipboy swapped;
+	PipboyAttach attach = pipboy.attach(true);
+	attach.wand = swapped.wand;
+	attach.wandPipboy = swapped.wandPipboy;
+	CHECK(interaction.bind(attach, 3.0f));
+	CHECK(interaction.getScreen() == swapped.screen);
+	CHECK(lookups.added() > 0);
+
+	// and invalidate forces it
+	interaction.invalidate();
+	CHECK(interaction.bind(attach, 3.0f));
+	CHECK(lookups.added() > 0);
+	CHECK(interaction.bind(attach, 3.0f));
+	CHECK(lookups.added() == 0);
+
+	// without an arm or a finger there is nothing to touch
+	PipboyAttach noArm = attach;
+	noArm.shoulder = nullptr;
+	CHECK(!interaction.bind(noArm, 3.0f));
+	CHECK(!interaction.isTouching(pipboy.touchRoot->m_worldTransform.pos));
+	boneTreeMap.erase("LArm_Finger23");
+	CHECK(!interaction.bind(attach, 3.0f));
+	boneTreeMap["LArm_Finger23"] = 17;
+}
+
+// the screen shows up after the rest of the pipboy
+static void testRetry() {
+	FakePipboy pipboy(false);
+	PipboyInteraction interaction;
+
+	CHECK(interaction.bind(pipboy.attach(), 3.0f));
+	CHECK(interaction.getScreen() == nullptr);
+	CHECK(!interaction.isLookedAt(NiPoint3(0, 1, 0), 0.0f));
+
+	pipboy.wandPipboy->AttachChild(pipboy.screen, true);
+	pipboy.update();
+
+	Lookups lookups;
+	int frame = 1;
+	for (; frame < 200 && !interaction.getScreen(); frame++) {
+		interaction.bind(pipboy.attach(), 3.0f);
+		if (!interaction.getScreen()) {
+			CHECK(lookups.added() == 0);
+		}
+	}
+	CHECK(frame - 1 == 90);
+	CHECK(interaction.getScreen() == pipboy.screen);
+
+	// complete now, no more looking
+	lookups.added();
+	for (auto i = 0; i < 200; i++) {
+		interaction.bind(pipboy.attach(), 3.0f);
+	}
+	CHECK(lookups.added() == 0);
+}
+
+// the local space checks against the plain world space ones, at random points and directions
+static void testHitTests() {
+	const float range = 3.0f;
+	const float gate = 0.5f;
+	FakePipboy pipboy;
+	PipboyInteraction interaction;
+	CHECK(interaction.bind(pipboy.attach(), range));
+
+	NiPoint3 rootPos = pipboy.touchRoot->m_worldTransform.pos;
+	NiPoint3 screenOut = pipboy.screen->m_worldTransform.rot * NiPoint3(0, -1, 0);
+
+	CHECK(interaction.isTouching(rootPos + NiPoint3(2.9f, 0, 0)));
+	CHECK(!interaction.isTouching(rootPos + NiPoint3(0, 0, 3.1f)));
+	CHECK(interaction.isLookedAt(screenOut * -1.0f, gate));
+	CHECK(!interaction.isLookedAt(screenOut, gate));
+
+	TestRandom random(7);
+	int touchMismatch = 0;
+	int lookMismatch = 0;
+	int touches = 0;
+	int looks = 0;
+	for (auto i = 0; i < 10000; i++) {
+		NiPoint3 offset(random.signedUnit() * 5.0f, random.signedUnit() * 5.0f, random.signedUnit() * 5.0f);
+		float distance = vec3_len(offset);
+		// stay clear of the edge where float rounding could go either way
+		if (fabsf(distance - range) > 1e-3f) {
+			bool touching = distance <= range;
+			touches += touching ? 1 : 0;
+			touchMismatch += interaction.isTouching(rootPos + offset) != touching ? 1 : 0;
+		}
+
+		NiPoint3 dir(random.signedUnit(), random.signedUnit(), random.signedUnit());
+		if (vec3_len(dir) > 0.1f) {
+			float facing = vec3_dot(vec3_norm(dir), screenOut);
+			if (fabsf(facing + gate) > 1e-3f) {
+				bool looking = facing < -gate;
+				looks += looking ? 1 : 0;
+				lookMismatch += interaction.isLookedAt(dir * 4.0f, gate) != looking ? 1 : 0;
+			}
+		}
+	}
+
+	printf("hit tests: %d of 10000 touching, %d looking\n", touches, looks);
+	CHECK(touches > 0 && looks > 0);
+	CHECK(touchMismatch == 0);
+	CHECK(lookMismatch == 0);
+}
+
+int main() {
+	testBind();
+	testRetry();
+	testHitTests();
+
+	return testResult("PipboyBind");
+}
@@ -0,0 +1,160 @@
+// The double buffered FRIKPoseBuffer written through PoseSlots and read the way api/FRIKPoseBuffer.h tells other
+// plugins to.   Frames alternate slots and latest always points at a finished one, and a reader on another thread that
+// follows the frameNumber rule never keeps a torn or older frame.
+#include "TestUtil.h"
+#include "F4VRBody.h"
+#include "PoseSlots.h"
+
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+using namespace F4VRBody;
+
+// every float in the frame follows from the frame number, a torn copy mixes two of them
+static void fillFrame(FRIKPoseFrame& a_frame, uint64_t a_number) {
+	float value = (float)a_number;
+	a_frame.flags = FRIK_POSE_VALID | ((a_number & 1) ? FRIK_POSE_HAS_WEAPON : 0);
+	for (auto i = 0; i < FRIK_BONE_COUNT; i++) {
+		for (auto r = 0; r < 3; r++) {
+			for (auto c = 0; c < 4; c++) {
+				a_frame.bones[i].rot[r][c] = value;
+			}
+			a_frame.bones[i].pos[r] = value + i;
+		}
+		a_frame.bones[i].scale = value;
+	}
+	for (auto i = 0; i < FRIK_FINGER_COUNT; i++) {
+		a_frame.fingerCurl[0][i] = value;
+		a_frame.fingerCurl[1][i] = value;
+	}
+	a_frame.weaponGrip.scale = value;
+}
+
+static bool wholeFrame(const FRIKPoseFrame& a_frame) {
+	float value = (float)a_frame.frameNumber;
+	bool whole = a_frame.flags == (FRIK_POSE_VALID | ((a_frame.frameNumber & 1) ? FRIK_POSE_HAS_WEAPON : 0));
+	for (auto i = 0; i < FRIK_BONE_COUNT; i++) {
+		for (auto r = 0; r < 3; r++) {
+			for (auto c = 0; c < 4; c++) {
+				whole = whole && a_frame.bones[i].rot[r][c] == value;
+			}
+			whole = whole && a_frame.bones[i].pos[r] == value + i;
+		}
+		whole = whole && a_frame.bones[i].scale == value;
+	}
+	for (auto i = 0; i < FRIK_FINGER_COUNT; i++) {
+		whole = whole && a_frame.fingerCurl[0][i] == value && a_frame.fingerCurl[1][i] == value;
+	}
+	return whole && a_frame.weaponGrip.scale == value;
+}
+
+// the off main thread read from api/FRIKPoseBuffer.h
+static bool readPose(const FRIKPoseBuffer* a_buffer, FRIKPoseFrame& a_out, uint32_t& a_slot) {
+	a_slot = a_buffer->latest;
+	const FRIKPoseFrame& frame = a_buffer->frames[a_slot];
+
+	uint64_t before = frame.frameNumber;
+	std::atomic_thread_fence(std::memory_order_acquire);
+	if (!before) {
+		return false;
+	}
+
+	memcpy(&a_out, (const void*)&frame, sizeof(FRIKPoseFrame));
+
+	std::atomic_thread_fence(std::memory_order_acquire);
+	return frame.frameNumber == before;
+}
+
+static void testSlots() {
+	PoseSlots slots;
+	FRIKPoseBuffer* buffer = slots.getBuffer();
+	CHECK(buffer->version == FRIK_POSE_BUFFER_VERSION);
+	CHECK(buffer->size == sizeof(FRIKPoseBuffer));
+
+	// nothing published yet, a reader gets nothing rather than an empty pose
+	FRIKPoseFrame copy;
+	uint32_t slot;
+	CHECK(!readPose(buffer, copy, slot));
+
+	// the first frame goes into the slot latest isn't pointing at
+	FRIKPoseFrame& first = slots.begin();
+	CHECK(&first == &buffer->frames[1]);
+	fillFrame(first, 1);
+	CHECK(!readPose(buffer, copy, slot));
+	slots.commit();
+	CHECK(buffer->latest == 1);
+	CHECK(readPose(buffer, copy, slot) && copy.frameNumber == 1 && wholeFrame(copy));
+
+	// the second flips back and leaves the first alone
+	FRIKPoseFrame& second = slots.begin();
+	CHECK(&second == &buffer->frames[0]);
+	fillFrame(second, 2);
+	slots.commit();
+	CHECK(buffer->latest == 0);
+	CHECK(buffer->frames[0].frameNumber == 2);
+	CHECK(buffer->frames[1].frameNumber == 1);
+
+	// while a slot is being rewritten its frame number reads 0 and latest still points at the other one
+	FRIKPoseFrame& third = slots.begin();
+	CHECK(&third == &buffer->frames[1]);
+	CHECK(buffer->frames[1].frameNumber == 0);
+	CHECK(buffer->latest == 0);
+	CHECK(readPose(buffer, copy, slot) && slot == 0 && copy.frameNumber == 2);
+	fillFrame(third, 3);
+	slots.commit();
+	CHECK(readPose(buffer, copy, slot) && slot == 1 && copy.frameNumber == 3 && wholeFrame(copy));
+}
+
+static void testConcurrentReader() {
+	const uint64_t frames = 200000;
+	PoseSlots slots;
+	const FRIKPoseBuffer* buffer = slots.getBuffer();
+
+	std::atomic<bool> done(false);
+	int reads = 0;
+	int torn = 0;
+	int wrongSlot = 0;
+	int backwards = 0;
+
+	std::thread reader([&]() {
+		FRIKPoseFrame copy;
+		uint32_t slot;
+		uint64_t last = 0;
+		while (!done.load()) {
+			if (!readPose(buffer, copy, slot)) {
+				continue;
+			}
+			reads++;
+			torn += wholeFrame(copy) ? 0 : 1;
+			// odd frames land in slot 1, even ones in slot 0
+			wrongSlot += (copy.frameNumber & 1) == slot ? 0 : 1;
+			backwards += copy.frameNumber < last ? 1 : 0;
+			last = copy.frameNumber;
+		}
+	});
+
+	for (uint64_t number = 1; number <= frames; number++) {
+		fillFrame(slots.begin(), number);
+		slots.commit();
+	}
+	done = true;
+	reader.join();
+
+	printf("concurrent reader: %d whole poses read while %llu were published\n", reads, (unsigned long long)frames);
+	CHECK(reads > 0);
+	CHECK(torn == 0);
+	CHECK(wrongSlot == 0);
+	CHECK(backwards == 0);
+
+	FRIKPoseFrame copy;
+	uint32_t slot;
+	CHECK(readPose(buffer, copy, slot) && copy.frameNumber == frames && wholeFrame(copy));
+}
+
+int main() {
+	testSlots();
+	testConcurrentReader();
+
+	return testResult("PoseSlots");
+}
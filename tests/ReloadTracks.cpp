@@ -0,0 +1,266 @@
+// ReloadKeyframes against a made up reload.   The magazine is pulled and put back and the hands circle while the weapon
+// itself is swung around, the stored track has to give back every bone relative to the Weapon node at any time, with
+// far fewer keys than frames.   Tracks belong to the weapon and its parts, and a recording that gets cut off or switches
+// weapon halfway is never kept.
+#include "TestUtil.h"
+#include "F4VRBody.h"
+#include "IKRig.h"
+#include "ReloadKeyframes.h"
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+using namespace F4VRBody;
+
+// utils.cpp needs the game, this does the same walk over the fake skeleton
+namespace F4VRBody {
+	NiNode* getChildNode(const char* nodeName, NiNode* nde) {
+		if (!_stricmp(nodeName, nde->m_name.c_str())) {
+			return nde;
+		}
+		for (auto i = 0; i < nde->m_children.m_emptyRunStart; i++) {
+			NiNode* child = nde->m_children.m_data[i] ? nde->m_children.m_data[i]->GetAsNiNode() : nullptr;
+			NiNode* found = child ? getChildNode(nodeName, child) : nullptr;
+			if (found) {
+				return found;
+			}
+		}
+		return nullptr;
+	}
+}
+
+static const UInt32 kPistol = 0x0004822B;
+static const UInt32 kRifle = 0x0001F278;
+static const float kFrame = 1.0f / 90.0f;
+static const float kLength = 2.0f;
+
+struct FakeFirstPerson {
+	std::vector<std::unique_ptr<NiNode>> owned;
+	NiNode* root;
+	NiNode* weapon;
+	NiNode* model = nullptr;
+	NiNode* bones[kReloadBone_Count] = {};
+
+	NiNode* make(const char* a_name, NiNode* a_parent) {
+		NiNode* node = new NiNode();
+		node->m_name = BSFixedString(a_name);
+		node->m_worldTransform.rot = identityRot();
+		node->m_worldTransform.scale = 1.0f;
+		owned.emplace_back(node);
+		if (a_parent) {
+			a_parent->AttachChild(node, true);
+		}
+		return node;
+	}
+
+	explicit FakeFirstPerson(const char* a_magazine) {
+		root = make("Root", nullptr);
+		weapon = make("Weapon", root);
+		bones[kReloadBone_LeftHand] = make("LArm_Hand", root);
+		bones[kReloadBone_RightHand] = make("RArm_Hand", root);
+		swapModel(a_magazine);
+	}
+
+	// what equipping or modding does, the model under Weapon is replaced
+	void swapModel(const char* a_magazine) {
+		model = make("10mmPistol", nullptr);
+		model->m_parent = weapon;
+		if (weapon->m_children.m_emptyRunStart > 0) {
+			weapon->m_children.set(0, model);
+		}
+		else {
+			weapon->AttachChild(model, true);
+		}
+		make("Receiver", model);
+		NiNode* magazine = make("WeaponMagazine", model);
+		make(a_magazine, magazine);
+		bones[kReloadBone_Magazine] = magazine;
+	}
+};
+
+// where each bone is relative to the weapon a_time into the reload
+static NiTransform reloadPose(ReloadBone a_bone, float a_time) {
+	NiTransform t;
+	t.scale = 1.0f;
+	if (a_bone == kReloadBone_Magazine) {
+		// straight down and out, held, back in, turning as it goes
+		float out = a_time < 0.3f ? 0.0f : a_time < 0.8f ? (a_time - 0.3f) / 0.5f : a_time < 1.2f ? 1.0f : a_time < 1.6f ? 1.0f - (a_time - 1.2f) / 0.4f : 0.0f;
+		t.pos = NiPoint3(0, 8, -4 - 20 * out);
+		t.rot = getRotationAxisAngle(NiPoint3(1, 0, 0), 0.6f * out);
+	}
+	else {
+		float side = a_bone == kReloadBone_LeftHand ? -1.0f : 1.0f;
+		float angle = a_time * 3.0f * side;
+		t.pos = NiPoint3(side * 6.0f + cosf(angle) * 5.0f, 10.0f + sinf(angle) * 5.0f, -6.0f);
+		t.rot = getRotationAxisAngle(NiPoint3(0, 0, 1), angle * 0.5f);
+	}
+	return t;
+}
+
+// the weapon is swung around while it reloads, the recording has to take that back out
+static NiTransform weaponWorld(float a_time) {
+	NiTransform t;
+	t.pos = NiPoint3(20.0f * sinf(a_time), 30.0f, 100.0f + 5.0f * a_time);
+	t.rot = composeRot(getRotationAxisAngle(NiPoint3(0, 0, 1), a_time * 0.7f), getRotationAxisAngle(NiPoint3(1, 0, 0), 0.2f));
+	t.scale = 1.0f;
+	return t;
+}
+
+static void poseFrame(FakeFirstPerson& a_fp, float a_time) {
+	NiTransform weapon = weaponWorld(a_time);
+	a_fp.weapon->m_worldTransform = weapon;
+	for (auto i = 0; i < kReloadBone_Count; i++) {
+		a_fp.bones[i]->m_worldTransform = childWorld(weapon, reloadPose((ReloadBone)i, a_time));
+	}
+}
+
+// one reload through the same calls GunReload::DoAnimationCapture makes, stopping after a_until seconds
+static void record(ReloadKeyframes& a_frames, FakeFirstPerson& a_fp, UInt32 a_form, float a_until, bool a_complete) {
+	a_frames.bind(a_form, a_fp.root);
+	a_frames.beginCapture();
+	for (auto frame = 0; frame * kFrame <= a_until; frame++) {
+		float t = frame * kFrame;
+		poseFrame(a_fp, t);
+		a_frames.bind(a_form, a_fp.root);
+		a_frames.addFrame(t);
+	}
+	a_frames.endCapture(a_complete);
+}
+
+static float rotDistance(const NiMatrix43& a_a, const NiMatrix43& a_b) {
+	float worst = 0.0f;
+	for (auto r = 0; r < 3; r++) {
+		for (auto c = 0; c < 3; c++) {
+			worst = (std::max)(worst, fabsf(a_a.data[r][c] - a_b.data[r][c]));
+		}
+	}
+	return worst;
+}
+
+static void testPlayback() {
+	FakeFirstPerson fp("10mmMagLarge");
+	ReloadKeyframes frames;
+
+	NiTransform out;
+	CHECK(frames.bind(kPistol, fp.root));
+	CHECK(!frames.has());
+	CHECK(!frames.sample(kReloadBone_Magazine, 0.5f, out));
+
+	record(frames, fp, kPistol, kLength, true);
+	CHECK(frames.has());
+	CHECK(!frames.isCapturing());
+
+	// in between the recorded frames too, and past both ends where it holds the first and last pose
+	float maxPos = 0.0f;
+	float maxRot = 0.0f;
+	TestRandom rng(3);
+	for (auto i = 0; i < 2000; i++) {
+		float t = (rng.signedUnit() * 0.5f + 0.5f) * kLength;
+		for (auto bone = 0; bone < kReloadBone_Count; bone++) {
+			NiTransform expected = reloadPose((ReloadBone)bone, t);
+			CHECK(frames.sample((ReloadBone)bone, t, out));
+			maxPos = (std::max)(maxPos, vec3_len(out.pos - expected.pos));
+			maxRot = (std::max)(maxRot, rotDistance(out.rot, expected.rot));
+		}
+	}
+	printf("playback error: %.4f position, %.5f rotation\n", maxPos, maxRot);
+	CHECK(maxPos < 0.15f);
+	CHECK(maxRot < 0.02f);
+
+	CHECK(frames.sample(kReloadBone_Magazine, -1.0f, out));
+	CHECK(vec3_len(out.pos - reloadPose(kReloadBone_Magazine, 0.0f).pos) < 0.01f);
+	CHECK(frames.sample(kReloadBone_Magazine, 10.0f, out));
+	CHECK(vec3_len(out.pos - reloadPose(kReloadBone_Magazine, kLength).pos) < 0.01f);
+
+	// a second reload of the same weapon doesn't record again
+	frames.beginCapture();
+	CHECK(!frames.isCapturing());
+}
+
+static void testKeying() {
+	FakeFirstPerson fp("10mmMagLarge");
+	ReloadKeyframes frames;
+	record(frames, fp, kPistol, kLength, true);
+	UInt64 large = ReloadKeyframes::weaponKey(kPistol, fp.model);
+
+	// the model is rebuilt the same, the track still applies
+	fp.swapModel("10mmMagLarge");
+	frames.bind(kPistol, fp.root);
+	CHECK(frames.has());
+	CHECK(ReloadKeyframes::weaponKey(kPistol, fp.model) == large);
+
+	// a different magazine mod is a different reload
+	fp.swapModel("10mmMagSmall");
+	frames.bind(kPistol, fp.root);
+	CHECK(!frames.has());
+	CHECK(ReloadKeyframes::weaponKey(kPistol, fp.model) != large);
+
+	// and so is another weapon with the same parts
+	fp.swapModel("10mmMagLarge");
+	frames.bind(kRifle, fp.root);
+	CHECK(!frames.has());
+	frames.bind(kPistol, fp.root);
+	CHECK(frames.has());
+
+	// nothing equipped, nothing to key to
+	CHECK(!frames.bind(0, fp.root));
+	CHECK(!frames.has());
+	CHECK(!frames.bind(kPistol, nullptr));
+}
+
+static void testIncomplete() {
+	FakeFirstPerson fp("10mmMagLarge");
+	ReloadKeyframes frames;
+
+	// cut off before the end
+	record(frames, fp, kPistol, 1.0f, false);
+	frames.bind(kPistol, fp.root);
+	CHECK(!frames.has());
+
+	// the weapon is modded halfway through, the half that was recorded is thrown away
+	frames.bind(kPistol, fp.root);
+	frames.beginCapture();
+	for (auto frame = 0; frame < 90; frame++) {
+		if (frame == 45) {
+			fp.swapModel("10mmMagSmall");
+		}
+		poseFrame(fp, frame * kFrame);
+		frames.bind(kPistol, fp.root);
+		frames.addFrame(frame * kFrame);
+	}
+	CHECK(!frames.isCapturing());
+	frames.endCapture(true);
+	CHECK(!frames.has());
+	fp.swapModel("10mmMagLarge");
+	frames.bind(kPistol, fp.root);
+	CHECK(!frames.has());
+
+	// the next full reload is kept
+	record(frames, fp, kPistol, kLength, true);
+	CHECK(frames.has());
+}
+
+static void testCompression() {
+	FakeFirstPerson fp("10mmMagLarge");
+	ReloadKeyframes frames;
+
+	record(frames, fp, kPistol, kLength, true);
+	NiTransform a;
+	NiTransform b;
+
+	// the held part of the magazine pull collapses to its ends, the pose in the middle is still exact
+	CHECK(frames.sample(kReloadBone_Magazine, 1.0f, a));
+	CHECK(vec3_len(a.pos - reloadPose(kReloadBone_Magazine, 1.0f).pos) < 0.01f);
+	CHECK(frames.sample(kReloadBone_Magazine, 0.9f, b));
+	CHECK(vec3_len(a.pos - b.pos) < 0.01f);
+}
+
+int main() {
+	testPlayback();
+	testKeying();
+	testIncomplete();
+	testCompression();
+
+	return testResult("ReloadTracks");
+}
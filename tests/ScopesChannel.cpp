@@ -0,0 +1,189 @@
+// Drives BetterScopesChannel against a recording Dispatch: thumbstick moves coalesce to one per flush, the receiver's
+// rate limit holds the latest move back instead of dropping it, one-off commands keep their order behind a pending
+// move and the grip config only goes out when it changes.
+#include "TestUtil.h"
+#include "BetterScopesChannel.h"
+
+#include <string>
+#include <vector>
+
+using namespace F4VRBody;
+
+struct SentMessage {
+	PluginHandle sender;
+	std::string receiver;
+	UInt32 type;
+	UInt32 len;
+	bool grip;
+	NiPoint3 value;
+	UInt32 sequence;
+};
+
+static std::vector<SentMessage> g_sent;
+
+static bool recordDispatch(PluginHandle a_sender, UInt32 a_type, void* a_data, UInt32 a_len, const char* a_receiver) {
+	SentMessage msg = {};
+	msg.sender = a_sender;
+	msg.receiver = a_receiver ? a_receiver : "";
+	msg.type = a_type;
+	msg.len = a_len;
+
+	if (a_type == kScopes_GripConfig) {
+		msg.grip = (bool)a_data;
+	}
+	else if (a_type == kScopes_Reticle) {
+		BetterScopesPayload* payload = (BetterScopesPayload*)a_data;
+		msg.value = payload->value;
+		msg.sequence = payload->sequence;
+	}
+
+	g_sent.push_back(msg);
+	return true;
+}
+
+static void checkReticle(const SentMessage& a_msg, float a_x, float a_y, float a_z) {
+	CHECK(a_msg.type == kScopes_Reticle);
+	CHECK(a_msg.len == sizeof(BetterScopesPayload));
+	CHECK_NEAR(a_msg.value.x, a_x, 0.0);
+	CHECK_NEAR(a_msg.value.y, a_y, 0.0);
+	CHECK_NEAR(a_msg.value.z, a_z, 0.0);
+}
+
+static void testGripConfig() {
+	BetterScopesChannel channel;
+	g_sent.clear();
+
+	channel.sendGripConfig(true);
+	channel.sendGripConfig(true);
+	CHECK(g_sent.size() == 1);
+	CHECK(g_sent[0].type == kScopes_GripConfig && g_sent[0].grip);
+
+	channel.sendGripConfig(false);
+	CHECK(g_sent.size() == 2);
+	CHECK(!g_sent[1].grip);
+
+	// startup always sends it, whatever was sent before
+	channel.sendGripConfig(false, true);
+	CHECK(g_sent.size() == 3);
+}
+
+static void testCoalescing() {
+	BetterScopesChannel channel;
+	g_sent.clear();
+
+	for (auto i = 1; i <= 5; i++) {
+		channel.moveReticle((float)i, (float)-i);
+	}
+	CHECK(g_sent.empty());
+
+	channel.flush();
+	CHECK(g_sent.size() == 1);
+	checkReticle(g_sent[0], 5, 0, -5);
+
+	// nothing new, nothing sent
+	channel.flush();
+	CHECK(g_sent.size() == 1);
+}
+
+static void testRateLimit() {
+	BetterScopesChannel channel;
+	channel.setMinInterval(50);
+	g_sent.clear();
+
+	g_stubTickCount = 1000;
+	channel.moveReticle(1, 1);
+	channel.flush();
+	CHECK(g_sent.size() == 1);
+
+	// held back, not dropped, and the newest value wins once the interval is up
+	g_stubTickCount = 1020;
+	channel.moveReticle(2, 2);
+	channel.flush();
+	g_stubTickCount = 1049;
+	channel.moveReticle(3, 3);
+	channel.flush();
+	CHECK(g_sent.size() == 1);
+
+	g_stubTickCount = 1050;
+	channel.flush();
+	CHECK(g_sent.size() == 2);
+	checkReticle(g_sent[1], 3, 0, 3);
+
+	// a 90 fps stick held for a second goes out at most 1000 / 50 + 1 times, and no less than once per 50 ms plus a frame
+	g_sent.clear();
+	for (auto frame = 0; frame < 90; frame++) {
+		g_stubTickCount = 2000 + frame * 1000 / 90;
+		channel.moveReticle((float)frame, 0);
+		channel.flush();
+	}
+	CHECK(g_sent.size() <= 21);
+	CHECK(g_sent.size() >= 1000 / (50 + 12));
+
+	channel.setMinInterval(0);
+	g_sent.clear();
+	for (auto frame = 0; frame < 90; frame++) {
+		channel.moveReticle((float)frame, 0);
+		channel.flush();
+	}
+	CHECK(g_sent.size() == 90);
+}
+
+static void testOrdering() {
+	BetterScopesChannel channel;
+	channel.setMinInterval(0);
+	g_sent.clear();
+
+	// a pending move lands before the zoom toggle and before the save
+	channel.moveReticle(4, 2);
+	channel.sendZoomToggle();
+	CHECK(g_sent.size() == 2);
+	checkReticle(g_sent[0], 4, 0, 2);
+	CHECK(g_sent[1].type == kScopes_ZoomToggle);
+
+	channel.moveReticle(6, 1);
+	channel.sendReticleSave();
+	CHECK(g_sent.size() == 4);
+	checkReticle(g_sent[2], 6, 0, 1);
+	checkReticle(g_sent[3], 0, 1, 0);
+
+	// reset throws the pending move away
+	channel.moveReticle(9, 9);
+	channel.sendReticleReset();
+	channel.flush();
+	CHECK(g_sent.size() == 5);
+	checkReticle(g_sent[4], 0, 0, 0);
+}
+
+static void testSequence() {
+	BetterScopesChannel channel;
+	g_sent.clear();
+
+	channel.sendGripConfig(true);
+	channel.moveReticle(1, 0);
+	channel.flush();
+	channel.sendZoomToggle();
+	channel.sendReticleReset();
+
+	CHECK(channel.getSequence() == 4);
+	CHECK(g_sent[1].sequence == 2);
+	CHECK(g_sent[3].sequence == 4);
+
+	// all of it from FRIK to better scopes only, never a broadcast
+	for (auto& msg : g_sent) {
+		CHECK(msg.sender == g_pluginHandle);
+		CHECK(msg.receiver == "FO4VRBETTERSCOPES");
+	}
+}
+
+int main() {
+	F4SEMessagingInterface messaging = { recordDispatch };
+	g_messaging = &messaging;
+
+	testGripConfig();
+	testCoalescing();
+	testRateLimit();
+	testOrdering();
+	testSequence();
+
+	return testResult("ScopesChannel");
+}
@@ -0,0 +1,173 @@
+// Replays a resting, drifting and then moving hand through the arm solve with and without the SolveCache in front of it,
+// the way Skeleton::prepareArm and applyArm use it.   Checks the reused results never stray further from the target than
+// the tolerances allow and prints how much solving the cache saved.
+#include "TestUtil.h"
+#include "IKRig.h"
+#include "SolveCache.h"
+
+#include <vector>
+
+struct ArmRigNodes {
+	NiNode shoulder, upper, forearm1, forearm2, forearm3, hand;
+};
+
+struct ReplayFrame {
+	NiPoint3 handPos;
+	NiMatrix43 handRot;
+};
+
+static std::vector<ReplayFrame> makeReplay() {
+	std::vector<ReplayFrame> frames;
+	TestRandom rng(7);
+
+	const double dt = 1.0 / 90.0;
+	NiPoint3 base(20.0f, 30.0f, 100.0f);
+	NiMatrix43 baseRot = getRotationAxisAngle(NiPoint3(0.3f, 1.0f, 0.2f), 0.8f);
+
+	for (int i = 0; i < 10 * 90; i++) {
+		double t = i * dt;
+		NiPoint3 pos = base;
+		float angle = 0.0f;
+
+		if (t < 3.0) {
+			// resting, tracking noise only
+		}
+		else if (t < 6.0) {
+			// slow drift, 1 unit and 1 degree a second
+			pos += NiPoint3(1.0f, 0.0f, 0.0f) * (float)(t - 3.0);
+			angle = degrees_to_rads((float)(t - 3.0));
+		}
+		else if (t < 8.0) {
+			float a = (float)((t - 6.0) * 2.0 * PI);
+			pos += NiPoint3(3.0f, 0.0f, 0.0f) + NiPoint3(cosf(a), 0.0f, sinf(a)) * 15.0f;
+			angle = degrees_to_rads(3.0f) + a * 0.3f;
+		}
+		else {
+			// wrist turning slowly with the hand held still, what the single tolerance let drift
+			pos += NiPoint3(3.0f, 0.0f, 0.0f);
+			angle = degrees_to_rads(2.0f * (float)(t - 8.0));
+		}
+
+		if (t < 8.0) {
+			pos += NiPoint3(rng.signedUnit(), rng.signedUnit(), rng.signedUnit()) * 0.02f;
+			angle += degrees_to_rads(0.02f) * rng.signedUnit();
+		}
+
+		Matrix44 m;
+		m.makeTransformMatrix(getRotationAxisAngle(NiPoint3(0.0f, 0.0f, 1.0f), angle), NiPoint3(0, 0, 0));
+		frames.push_back({ pos, m.multiply43Left(baseRot) });
+	}
+
+	return frames;
+}
+
+struct ReplayResult {
+	float maxPosError = 0.0f;
+	float maxRotError = 0.0f;
+	int solves = 0;
+	double seconds = 0.0;
+};
+
+static ReplayResult replay(const std::vector<ReplayFrame>& a_frames, const SolveCacheSettings& a_settings) {
+	SolveCache::settings = a_settings;
+
+	SolveCache cache;
+	ArmRigNodes nodes;
+	float prevTwist = 0.0f;
+	ReplayResult result;
+
+	double start = testNow();
+
+	for (auto& frame : a_frames) {
+		ArmIKInput in = makeArmInput(false, frame.handPos, frame.handRot);
+		in.prevTwistAngle = prevTwist;
+
+		cache.beginInputs();
+		cache.addInput(in.handPos);
+		cache.addInput(in.handRot);
+		cache.addInput(in.shoulderWorld);
+		cache.addDirection(in.forwardDir);
+		cache.addInput(in.chestZ);
+		cache.addScale(in.rootScale);
+		cache.addAngle(in.prevTwistAngle);
+		cache.addInput(in.armLength);
+
+		if (!cache.tryReuse()) {
+			ArmIKOutput out;
+			solveArmIK(in, out);
+			result.solves++;
+
+			nodes.shoulder.m_localTransform.rot = out.shoulderLocalRot;
+			nodes.upper.m_localTransform.rot = out.upperLocalRot;
+			nodes.forearm1.m_localTransform = out.forearm1Local;
+			nodes.forearm2.m_localTransform = out.forearm2Local;
+			nodes.forearm3.m_localTransform = out.forearm3Local;
+			nodes.hand.m_localTransform = out.handLocal;
+			prevTwist = out.twistAngle;
+
+			cache.beginOutputs();
+			cache.addOutput(&nodes.shoulder);
+			cache.addOutput(&nodes.upper);
+			cache.addOutput(&nodes.forearm1);
+			cache.addOutput(&nodes.forearm2);
+			cache.addOutput(&nodes.forearm3);
+			cache.addOutput(&nodes.hand);
+			cache.commit();
+		}
+
+		ArmIKOutput applied;
+		applied.shoulderLocalRot = nodes.shoulder.m_localTransform.rot;
+		applied.upperLocalRot = nodes.upper.m_localTransform.rot;
+		applied.forearm1Local = nodes.forearm1.m_localTransform;
+		applied.forearm2Local = nodes.forearm2.m_localTransform;
+		applied.forearm3Local = nodes.forearm3.m_localTransform;
+		applied.handLocal = nodes.hand.m_localTransform;
+
+		NiTransform hand = armHandWorld(in, applied);
+		float posError = vec3_len(hand.pos - frame.handPos);
+		float rotError = rotationDelta(hand.rot, frame.handRot);
+		result.maxPosError = posError > result.maxPosError ? posError : result.maxPosError;
+		result.maxRotError = rotError > result.maxRotError ? rotError : result.maxRotError;
+	}
+
+	result.seconds = testNow() - start;
+	return result;
+}
+
+int main() {
+	std::vector<ReplayFrame> frames = makeReplay();
+
+	SolveCacheSettings off;
+	off.enabled = false;
+	ReplayResult always = replay(frames, off);
+
+	SolveCacheSettings split;
+	split.positionTolerance = 0.05f;
+	split.angleTolerance = degrees_to_rads(0.1f);
+	ReplayResult cached = replay(frames, split);
+
+	// the old single tolerance, for comparison
+	SolveCacheSettings single;
+	single.positionTolerance = 0.01f;
+	single.angleTolerance = 0.01f;
+	ReplayResult old = replay(frames, single);
+
+	printf("%d frames\n", (int)frames.size());
+	printf("  every frame     %4d solves  %.3f ms  max error %.4f units %.3f deg\n", always.solves, always.seconds * 1000.0, always.maxPosError, always.maxRotError);
+	printf("  split tolerance %4d solves  %.3f ms  max error %.4f units %.3f deg\n", cached.solves, cached.seconds * 1000.0, cached.maxPosError, cached.maxRotError);
+	printf("  single 0.01     %4d solves  %.3f ms  max error %.4f units %.3f deg\n", old.solves, old.seconds * 1000.0, old.maxPosError, old.maxRotError);
+
+	// solving every frame hits the target, the arm rig is well inside reach
+	CHECK(always.solves == (int)frames.size());
+	CHECK(always.maxPosError < 0.01f);
+	CHECK(always.maxRotError < 0.01f);
+
+	// a reused solve is at most one tolerance step behind on every axis
+	CHECK(cached.maxPosError <= 0.05f * sqrtf(3.0f) + 0.01f);
+	CHECK(cached.maxRotError <= 0.1f * 2.0f + 0.01f);
+
+	// resting is 3 of the 10 seconds, at least most of that has to come from the cache
+	CHECK(cached.solves < always.solves - 2 * 90);
+
+	return testResult("SolveCacheReplay");
+}
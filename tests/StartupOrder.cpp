@@ -0,0 +1,184 @@
+// StartupGraph with stand-in loaders the way F4SEPlugin_Load uses it: config run first, the file loaders spawned, the
+// patches and hooks run on the loader thread while they go, join before the first update.   Spawned loaders run next to
+// the run phases, join waits for them, and nothing a loader logs reaches the log until join writes it from the joining
+// thread under its phase's line.
+#include "TestUtil.h"
+#include "F4VRBody.h"
+#include "Startup.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace F4VRBody;
+
+struct LogLine {
+	std::string text;
+	std::thread::id thread;
+};
+
+static std::mutex g_logLock;
+static std::vector<LogLine> g_log;
+
+static void recordLine(const char* a_line) {
+	std::lock_guard<std::mutex> lock(g_logLock);
+	g_log.push_back({ a_line, std::this_thread::get_id() });
+}
+
+static size_t logSize() {
+	std::lock_guard<std::mutex> lock(g_logLock);
+	return g_log.size();
+}
+
+static int findLine(const char* a_text, size_t a_from = 0) {
+	std::lock_guard<std::mutex> lock(g_logLock);
+	for (auto i = a_from; i < g_log.size(); i++) {
+		if (g_log[i].text.find(a_text) != std::string::npos) {
+			return (int)i;
+		}
+	}
+	return -1;
+}
+
+// the loaders hold until a run phase lets them go, so they can only finish if they run alongside it
+struct Gate {
+	std::mutex lock;
+	std::condition_variable changed;
+	bool open = false;
+
+	void release() {
+		std::lock_guard<std::mutex> guard(lock);
+		open = true;
+		changed.notify_all();
+	}
+
+	bool wait() {
+		std::unique_lock<std::mutex> guard(lock);
+		return changed.wait_for(guard, std::chrono::seconds(5), [this]() { return open; });
+	}
+};
+
+static void testLoadOrder() {
+	StartupGraph startup;
+	Gate gate;
+	std::atomic<int> loadersDone(0);
+	std::atomic<bool> loaderSawGate(true);
+	std::vector<std::string> order;
+	std::thread::id mainThread = std::this_thread::get_id();
+	std::thread::id loaderThreads[2];
+
+	CHECK(startup.run("config", [&]() {
+		order.push_back("config");
+		return true;
+	}));
+
+	auto loader = [&](int a_index, const char* a_name) {
+		return [&, a_index, a_name]() {
+			loaderThreads[a_index] = std::this_thread::get_id();
+			startupLog("%s: reading", a_name);
+			loaderSawGate = gate.wait() && loaderSawGate;
+			Sleep(20);
+			startupLog("%s: %d entries", a_name, 10 + a_index);
+			loadersDone++;
+		};
+	};
+
+	size_t before = logSize();
+	startup.spawn("weapon offsets", loader(0, "weapon offsets"));
+	startup.spawn("cull lists", loader(1, "cull lists"));
+
+	// the patches run while both loaders are still held
+	CHECK(startup.run("patches", [&]() {
+		order.push_back("patches");
+		CHECK(loadersDone.load() == 0);
+		gate.release();
+		return true;
+	}));
+
+	// a phase that fails says so, the caller decides what happens next
+	CHECK(!startup.run("hooks", [&]() {
+		order.push_back("hooks");
+		return false;
+	}));
+
+	// on the loader thread the lines are kept back, on this one they go straight out
+	for (auto i = 0; i < 500 && loadersDone.load() < 2; i++) {
+		Sleep(10);
+	}
+	CHECK(loadersDone.load() == 2);
+	CHECK(findLine("weapon offsets: reading", before) < 0);
+	CHECK(findLine("cull lists: 11 entries", before) < 0);
+	startupLog("main thread line");
+	CHECK(findLine("main thread line", before) >= 0);
+
+	startup.join();
+	CHECK(loaderSawGate.load());
+	CHECK(order.size() == 3 && order[0] == "config" && order[1] == "patches" && order[2] == "hooks");
+	CHECK(loaderThreads[0] != mainThread && loaderThreads[1] != mainThread && loaderThreads[0] != loaderThreads[1]);
+
+	// every phase gets a line, the loader lines follow their own phase's line in the order they were logged
+	int config = findLine("startup: config", before);
+	int offsets = findLine("startup: weapon offsets", before);
+	int cull = findLine("startup: cull lists", before);
+	int waited = findLine("startup: waited", before);
+	CHECK(config >= 0 && offsets >= 0 && cull >= 0 && waited >= 0);
+	CHECK(findLine("startup: patches", before) > config);
+	CHECK(findLine("startup: hooks", before) > config);
+	CHECK(findLine("weapon offsets: reading", before) == offsets + 1);
+	CHECK(findLine("weapon offsets: 10 entries", before) == offsets + 2);
+	CHECK(findLine("cull lists: reading", before) == cull + 1);
+	CHECK(findLine("cull lists: 11 entries", before) == cull + 2);
+	CHECK(findLine("loader thread", offsets) == offsets);
+	CHECK(waited == (int)logSize() - 1);
+
+	// join wrote everything from the joining thread
+	int otherThreads = 0;
+	{
+		std::lock_guard<std::mutex> lock(g_logLock);
+		for (auto i = before; i < g_log.size(); i++) {
+			otherThreads += g_log[i].thread != mainThread ? 1 : 0;
+		}
+	}
+	CHECK(otherThreads == 0);
+
+	// only the first join does anything
+	size_t joined = logSize();
+	startup.join();
+	CHECK(logSize() == joined);
+}
+
+// a failed load joins straight away, join still waits for loaders that haven't finished
+static void testJoinWaits() {
+	StartupGraph startup;
+	std::atomic<bool> finished(false);
+
+	startup.spawn("slow loader", [&]() {
+		Sleep(50);
+		startupLog("slow loader done");
+		finished = true;
+	});
+
+	size_t before = logSize();
+	startup.join();
+	CHECK(finished.load());
+	int phase = findLine("startup: slow loader", before);
+	CHECK(phase >= 0 && findLine("slow loader done", before) == phase + 1);
+}
+
+int main() {
+	g_stubMessageSink = recordLine;
+
+	testLoadOrder();
+	testJoinWaits();
+
+	// no ini next to the test, it doesn't wait
+	double start = testNow();
+	waitForDebugger();
+	CHECK(testNow() - start < 0.5);
+
+	g_stubMessageSink = nullptr;
+	return testResult("StartupOrder");
+}
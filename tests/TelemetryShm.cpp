@@ -0,0 +1,150 @@
+// Telemetry.cpp writing the block and the tools/ reader reading it back through POSIX shared memory.   The reader maps
+// the block on its own like it would from another process, and a reader thread hammering it while frames are written
+// should only ever see whole frames.
+#include "TestUtil.h"
+#include "F4VRBody.h"
+#include "Telemetry.h"
+#include "FrameGovernor.h"
+#include "WorkCounters.h"
+#include "FRIKTelemetryBlock.h"
+
+#include <atomic>
+#include <thread>
+#include <sys/mman.h>
+
+using namespace F4VRBody;
+
+static void writeFrame(Telemetry& a_telemetry, uint64_t a_frame) {
+	a_telemetry.beginFrame();
+	for (auto i = 0; i < kWork_Count; i++) {
+		g_workCounters.add((WorkCounter)i, (UInt32)(a_frame * (i + 1)));
+	}
+	a_telemetry.endFrame((UInt32)(a_frame & 0x3f));
+	g_workCounters.endFrame();
+}
+
+// every field written above follows from the frame number, a torn copy mixes two frames
+static bool wholeFrame(const FRIKTelemetry& a_copy) {
+	if (a_copy.flags != (a_copy.frame & 0x3f)) {
+		return false;
+	}
+	for (auto i = 0; i < FRIK_COUNTER_COUNT; i++) {
+		if (a_copy.counters[i] != (uint32_t)(a_copy.frame * (i + 1))) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static void testReadBack(Telemetry& a_telemetry, const FRIKTelemetry* a_block) {
+	CHECK(a_block->version == FRIK_TELEMETRY_VERSION);
+	CHECK(a_block->size == sizeof(FRIKTelemetry));
+
+	FRIKTelemetry copy;
+	CHECK(readBlock(a_block, copy));
+	CHECK(copy.frame == 0);
+
+	// made up stage costs, 0.5 ms per stage further down the frame
+	g_stubPerfCounter = 1000000000;
+	a_telemetry.beginFrame();
+	for (auto i = 0; i < FRIK_STAGE_COUNT; i++) {
+		g_stubPerfCounter += 500000 * (i + 1);
+		a_telemetry.mark((FRIKTelemetryStage)i);
+	}
+	g_workCounters.add(kWork_NodesVisited, 42);
+	a_telemetry.endFrame(FRIK_FLAG_SCOPE | FRIK_FLAG_LEFT_HANDED);
+	g_workCounters.endFrame();
+	g_stubPerfCounter = -1;
+
+	CHECK(readBlock(a_block, copy));
+	CHECK(copy.frame == 1);
+	CHECK(copy.sequence == 2);
+	CHECK(copy.flags == (FRIK_FLAG_SCOPE | FRIK_FLAG_LEFT_HANDED));
+	CHECK(copy.counters[FRIK_COUNTER_NODES_VISITED] == 42);
+	CHECK(copy.counters[FRIK_COUNTER_NODE_LOOKUPS] == 0);
+	CHECK(copy.governorLevel == 0);
+	float total = 0.0f;
+	for (auto i = 0; i < FRIK_STAGE_COUNT; i++) {
+		CHECK_NEAR(copy.stageMs[i], 0.5f * (i + 1), 1e-4f);
+		total += copy.stageMs[i];
+	}
+	CHECK_NEAR(copy.frameMs, total, 1e-3f);
+
+	// a write caught half way is never handed out.   the reader's view is read only, this plays the writer
+	int fd = shm_open("/" FRIK_TELEMETRY_NAME, O_RDWR, 0);
+	CHECK(fd >= 0);
+	void* view = mmap(nullptr, sizeof(FRIKTelemetry), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	CHECK(view != MAP_FAILED);
+	if (view != MAP_FAILED) {
+		FRIKTelemetry* writable = (FRIKTelemetry*)view;
+		writable->sequence++;
+		CHECK(!readBlock(a_block, copy));
+		writable->sequence++;
+		CHECK(readBlock(a_block, copy));
+		CHECK(copy.sequence == 4);
+		munmap(view, sizeof(FRIKTelemetry));
+	}
+}
+
+static void testConcurrentReader(Telemetry& a_telemetry, const FRIKTelemetry* a_block) {
+	const uint64_t frames = 200000;
+	std::atomic<bool> done(false);
+	int reads = 0;
+	int torn = 0;
+	int backwards = 0;
+
+	std::thread reader([&]() {
+		FRIKTelemetry copy;
+		uint64_t last = 0;
+		while (!done.load()) {
+			if (!readBlock(a_block, copy)) {
+				continue;
+			}
+			reads++;
+			// frame 1 is testReadBack's
+			torn += (copy.sequence & 1) || (copy.frame > 1 && !wholeFrame(copy)) ? 1 : 0;
+			backwards += copy.frame < last ? 1 : 0;
+			last = copy.frame;
+		}
+	});
+
+	// the block's frame number carries on from testReadBack
+	for (uint64_t frame = 2; frame < frames; frame++) {
+		writeFrame(a_telemetry, frame);
+	}
+	done = true;
+	reader.join();
+
+	printf("concurrent reader: %d whole frames read while %llu were written\n", reads, (unsigned long long)frames);
+	CHECK(reads > 0);
+	CHECK(torn == 0);
+	CHECK(backwards == 0);
+
+	FRIKTelemetry copy;
+	CHECK(readBlock(a_block, copy));
+	CHECK(copy.frame == frames - 1);
+	CHECK(wholeFrame(copy));
+}
+
+int main() {
+	shm_unlink("/" FRIK_TELEMETRY_NAME);
+	CHECK(openBlock() == nullptr);
+
+	g_frameGovernor = new FrameGovernor();
+	{
+		Telemetry telemetry;
+		CHECK(telemetry.isOpen());
+
+		const FRIKTelemetry* block = openBlock();
+		CHECK(block != nullptr);
+		if (block) {
+			testReadBack(telemetry, block);
+			testConcurrentReader(telemetry, block);
+			munmap((void*)block, sizeof(FRIKTelemetry));
+		}
+	}
+	shm_unlink("/" FRIK_TELEMETRY_NAME);
+
+	return testResult("TelemetryShm");
+}
@@ -0,0 +1,51 @@
+#pragma once
+// Tiny check macros for the headless tests.   Each test is its own executable, main returns the failure count.
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+static int g_failures = 0;
+
+#define CHECK(cond) \
+	do { \
+		if (!(cond)) { \
+			printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+			g_failures++; \
+		} \
+	} while (0)
+
+#define CHECK_NEAR(a, b, tol) \
+	do { \
+		double _a = (a), _b = (b); \
+		if (!(std::fabs(_a - _b) <= (tol))) { \
+			printf("%s:%d: CHECK_NEAR(%s, %s) failed: %g vs %g (tolerance %g)\n", __FILE__, __LINE__, #a, #b, _a, _b, (double)(tol)); \
+			g_failures++; \
+		} \
+	} while (0)
+
+inline int testResult(const char* a_name) {
+	printf("%s: %s\n", a_name, g_failures ? "FAILED" : "ok");
+	return g_failures;
+}
+
+// seconds
+inline double testNow() {
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// same numbers on every platform, unlike rand()
+struct TestRandom {
+	uint32_t state;
+
+	explicit TestRandom(uint32_t a_seed) : state(a_seed) {}
+
+	uint32_t next() {
+		state = state * 1664525u + 1013904223u;
+		return state;
+	}
+
+	// -1 .. 1
+	float signedUnit() {
+		return (float)((next() >> 8) & 0xffffff) / 8388607.5f - 1.0f;
+	}
+};
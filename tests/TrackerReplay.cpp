@@ -0,0 +1,282 @@
+// Replays waist and foot tracker streams (stand, step in place, walk a circle, kick, tracker dropping out) through
+// TrackedBody and on into solveLegIK, the way Skeleton::setTrackedPosture / setTrackedFeet / setLegs use them.   The
+// calibrated targets have to land on the bones whatever way the trackers are strapped on, the solved feet have to
+// reach them, and the same stream has to give the same legs bit for bit.
+#include "TestUtil.h"
+#include "IKRig.h"
+#include "TrackedBody.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace VRHook {
+	VRSystem* g_vrHook = nullptr;
+}
+
+static const vr::TrackedDeviceIndex_t kWaistIndex = 3;
+static const vr::TrackedDeviceIndex_t kLeftIndex = 4;
+static const vr::TrackedDeviceIndex_t kRightIndex = 7;
+
+// where each tracker sits from its bone, in the bone's space.   on the back of the belt and on the outside of the ankles
+static const NiPoint3 kWaistMount(0.0f, -12.0f, 3.0f);
+static const NiPoint3 kLeftMount(-5.0f, 2.0f, 9.0f);
+static const NiPoint3 kRightMount(5.0f, 2.0f, 9.0f);
+
+struct TrackerFrame {
+	NiTransform pelvis;     // the bones the trackers are strapped to
+	NiTransform foot[2];
+	NiPoint3 waistNoise;    // tracking noise on top of the waist tracker, the bone underneath doesn't have it
+	bool footTracked[2];
+};
+
+static NiMatrix43 rotZ(float a_angle) {
+	return getRotationAxisAngle(NiPoint3(0, 0, 1), a_angle);
+}
+
+static NiTransform bone(NiPoint3 a_pos, NiMatrix43 a_rot) {
+	NiTransform t;
+	t.pos = a_pos;
+	t.rot = a_rot;
+	t.scale = 1.0f;
+	return t;
+}
+
+static NiTransform trackerOn(const NiTransform& a_bone, const NiPoint3& a_mount, const NiMatrix43& a_strapRot) {
+	return bone(a_bone.pos + a_bone.rot * a_mount, composeRot(a_strapRot, a_bone.rot));
+}
+
+static std::vector<TrackerFrame> makeStream() {
+	std::vector<TrackerFrame> stream;
+	TestRandom rng(11);
+	const float dt = 1.0f / 90.0f;
+	float heading = 0.0f;
+	NiPoint3 pos(0, 0, 0);
+
+	for (auto frame = 0; frame < 8 * 90; frame++) {
+		float t = frame * dt;
+		float lift[2] = { 0.0f, 0.0f };
+		float swing[2] = { 0.0f, 0.0f };
+		float pitch[2] = { 0.0f, 0.0f };
+		float crouch = 0.0f;
+		float kick = 0.0f;
+
+		if (t < 1.0f) {
+			// standing for calibration
+		}
+		else if (t < 3.0f) {
+			// stepping in place, one foot up at a time
+			float phase = (t - 1.0f) * 2.0f * (float)PI;
+			lift[0] = (std::max)(0.0f, sinf(phase)) * 25.0f;
+			lift[1] = (std::max)(0.0f, -sinf(phase)) * 25.0f;
+			pitch[0] = lift[0] * 0.02f;
+			pitch[1] = lift[1] * 0.02f;
+		}
+		else if (t < 5.0f) {
+			// walking a circle, feet swing ahead and behind with the toes up on the way down
+			float phase = (t - 3.0f) * 2.0f * (float)PI;
+			heading += 0.01f;
+			pos += NiPoint3(-sinf(heading), cosf(heading), 0.0f) * (100.0f * dt);
+			swing[0] = sinf(phase) * 20.0f;
+			swing[1] = -swing[0];
+			lift[0] = (std::max)(0.0f, cosf(phase)) * 10.0f;
+			lift[1] = (std::max)(0.0f, -cosf(phase)) * 10.0f;
+			pitch[0] = -swing[0] * 0.01f;
+			pitch[1] = -swing[1] * 0.01f;
+			crouch = 3.0f;
+		}
+		else if (t < 6.0f) {
+			// kick with the right foot, further than the leg goes
+			kick = sinf((t - 5.0f) * (float)PI) * 70.0f;
+			lift[1] = kick * 0.8f;
+			swing[1] = kick * 1.5f;
+		}
+
+		TrackerFrame f;
+		NiMatrix43 yaw = rotZ(heading);
+		f.pelvis = bone(pos + NiPoint3(0, 0, 90.0f - crouch), yaw);
+		for (auto side = 0; side < 2; side++) {
+			NiPoint3 local(side == 0 ? -10.0f : 10.0f, swing[side], 8.0f + lift[side]);
+			NiMatrix43 footRot = composeRot(getRotationAxisAngle(NiPoint3(1, 0, 0), pitch[side]), yaw);
+			f.foot[side] = bone(pos + yaw * local, footRot);
+		}
+
+		f.waistNoise = NiPoint3(rng.signedUnit(), rng.signedUnit(), rng.signedUnit()) * 0.05f;
+
+		// the left foot tracker loses sight for half a second
+		f.footTracked[0] = !(frame >= 585 && frame < 630);
+		f.footTracked[1] = true;
+		stream.push_back(f);
+	}
+
+	return stream;
+}
+
+static void setPoses(VRHook::VRSystem& a_vr, const TrackerFrame& a_frame) {
+	static const NiMatrix43 waistStrap = getRotationAxisAngle(NiPoint3(0, 0, 1), (float)PI);
+	static const NiMatrix43 leftStrap = getRotationAxisAngle(NiPoint3(0.2f, 1.0f, 0.1f), 1.3f);
+	static const NiMatrix43 rightStrap = getRotationAxisAngle(NiPoint3(0.2f, -1.0f, -0.1f), 1.1f);
+
+	a_vr.poses.clear();
+	a_vr.poses[kWaistIndex] = trackerOn(a_frame.pelvis, kWaistMount, waistStrap);
+	a_vr.poses[kWaistIndex].pos += a_frame.waistNoise;
+	if (a_frame.footTracked[0]) {
+		a_vr.poses[kLeftIndex] = trackerOn(a_frame.foot[0], kLeftMount, leftStrap);
+	}
+	if (a_frame.footTracked[1]) {
+		a_vr.poses[kRightIndex] = trackerOn(a_frame.foot[1], kRightMount, rightStrap);
+	}
+}
+
+struct ReplayLegs {
+	NiPoint3 target[2];
+	LegIKOutput out[2];
+	bool tracked[2];
+};
+
+struct ReplayStats {
+	float maxTargetError = 0.0f;
+	float maxFootError = 0.0f;
+	int trackedFrames = 0;
+	int stretchedFrames = 0;
+	int droppedFrames = 0;
+};
+
+// the lower body part of Skeleton's frame: pelvis from the waist tracker, feet from theirs, calibration on the first
+// tracked frame against where the bones are
+static std::vector<ReplayLegs> replay(const std::vector<TrackerFrame>& a_stream, ReplayStats& a_stats) {
+	VRHook::VRSystem vr;
+	vr.addTracker("LHR-WAIST", kWaistIndex, "vive_tracker_waist");
+	vr.addTracker("LHR-LEFT", kLeftIndex, "vive_tracker_left_foot");
+	vr.addTracker("LHR-RIGHT", kRightIndex, "vive_tracker_handed");
+	VRHook::g_vrHook = &vr;
+
+	TrackedBody body;
+	std::vector<ReplayLegs> legs(a_stream.size(), ReplayLegs{});
+	NiNode roomNode;
+
+	for (size_t i = 0; i < a_stream.size(); i++) {
+		const TrackerFrame& f = a_stream[i];
+		setPoses(vr, f);
+		body.update(&roomNode);
+
+		NiPoint3 pelvis = body.isActive(kTracked_Waist) ? body.getTarget(kTracked_Waist) : f.pelvis.pos;
+		if (body.isActive(kTracked_Waist)) {
+			a_stats.maxTargetError = (std::max)(a_stats.maxTargetError, vec3_len(pelvis - f.pelvis.pos));
+		}
+
+		for (auto side = 0; side < 2; side++) {
+			TrackedPart part = side == 0 ? kTracked_LeftFoot : kTracked_RightFoot;
+			ReplayLegs& l = legs[i];
+			l.tracked[side] = body.isActive(part);
+
+			if (l.tracked[side]) {
+				l.target[side] = body.getTarget(part);
+				a_stats.maxTargetError = (std::max)(a_stats.maxTargetError, vec3_len(l.target[side] - f.foot[side].pos));
+			}
+			else {
+				// stand in for the procedural foot
+				l.target[side] = f.pelvis.pos + NiPoint3(side == 0 ? -10.0f : 10.0f, 0.0f, -82.0f);
+			}
+
+			LegIKInput in = makeLegInput(side == 0, l.target[side]);
+			in.hipWorld.pos = pelvis + f.pelvis.rot * NiPoint3(side == 0 ? -10.0f : 10.0f, 0, 0);
+			in.hipWorld.rot = f.pelvis.rot;
+			in.hipParentRot = f.pelvis.rot;
+			solveLegIK(in, l.out[side]);
+
+			NiPoint3 solved = legFootWorld(in, l.out[side]);
+			CHECK(std::isfinite(solved.x) && std::isfinite(solved.y) && std::isfinite(solved.z));
+			a_stats.maxFootError = (std::max)(a_stats.maxFootError, vec3_len(solved - l.target[side]));
+
+			if (l.tracked[side]) {
+				a_stats.trackedFrames++;
+				if (l.out[side].flags & FRIK_IK_STRETCHED) {
+					a_stats.stretchedFrames++;
+				}
+			}
+			else if (i > 90) {
+				a_stats.droppedFrames++;
+			}
+		}
+
+		// Skeleton::calibrateTrackers, after the legs.   the bones are where the body was standing
+		if (body.needsCalibration(kTracked_Waist)) {
+			body.calibrate(kTracked_Waist, f.pelvis.pos);
+		}
+		if (body.needsCalibration(kTracked_LeftFoot)) {
+			body.calibrate(kTracked_LeftFoot, f.foot[0].pos);
+		}
+		if (body.needsCalibration(kTracked_RightFoot)) {
+			body.calibrate(kTracked_RightFoot, f.foot[1].pos);
+		}
+	}
+
+	VRHook::g_vrHook = nullptr;
+	return legs;
+}
+
+static void testReplay(const std::vector<TrackerFrame>& a_stream) {
+	ReplayStats stats;
+	std::vector<ReplayLegs> legs = replay(a_stream, stats);
+
+	printf("tracked %d foot frames, %d stretched, %d dropped, target error %.4f, foot error %.4f\n", stats.trackedFrames,
+		stats.stretchedFrames, stats.droppedFrames, stats.maxTargetError, stats.maxFootError);
+
+	// the right tracker is only found by its serial, its role says nothing about feet
+	CHECK(legs[1].tracked[1]);
+	CHECK(!legs[0].tracked[0] && !legs[0].tracked[1]);
+
+	// calibration noise on the waist is up to 0.05 each way, the feet have none
+	CHECK(stats.maxTargetError < 0.2f);
+	CHECK(stats.maxFootError < 0.05f);
+	CHECK(stats.stretchedFrames > 0);
+	CHECK(stats.droppedFrames == 45);
+
+	// once it comes back the left foot follows its tracker again without another calibration
+	CHECK(legs[7 * 90 + 1].tracked[0]);
+}
+
+static void testDeterministic(const std::vector<TrackerFrame>& a_stream) {
+	ReplayStats stats;
+	std::vector<ReplayLegs> a = replay(a_stream, stats);
+	std::vector<ReplayLegs> b = replay(a_stream, stats);
+
+	int mismatch = 0;
+	for (size_t i = 0; i < a.size(); i++) {
+		// member by member, the padding after tracked isn't part of the result
+		mismatch += memcmp(a[i].target, b[i].target, sizeof(a[i].target)) != 0 || memcmp(a[i].out, b[i].out, sizeof(a[i].out)) != 0 ||
+			a[i].tracked[0] != b[i].tracked[0] || a[i].tracked[1] != b[i].tracked[1];
+	}
+	CHECK(mismatch == 0);
+}
+
+static void testOff(const std::vector<TrackerFrame>& a_stream) {
+	// with the ini switch off nothing is read and nothing turns active
+	c_enableBodyTrackers = false;
+	VRHook::VRSystem vr;
+	vr.addTracker("LHR-WAIST", kWaistIndex, "vive_tracker_waist");
+	VRHook::g_vrHook = &vr;
+
+	TrackedBody body;
+	setPoses(vr, a_stream[0]);
+	body.update(nullptr);
+	CHECK(!body.needsCalibration(kTracked_Waist));
+	CHECK(vr.updates == 0);
+
+	VRHook::g_vrHook = nullptr;
+	c_enableBodyTrackers = true;
+}
+
+int main() {
+	c_enableBodyTrackers = true;
+	c_rightFootTracker = "LHR-RIGHT";
+
+	std::vector<TrackerFrame> stream = makeStream();
+
+	testReplay(stream);
+	testDeterministic(stream);
+	testOff(stream);
+
+	return testResult("TrackerReplay");
+}
@@ -0,0 +1,233 @@
+// VisibilityManager against a fake player tree.   Once things settle an unchanged frame must write nothing, a single
+// toggle must write only its own nodes, and anything the game flips back behind FRIK's back gets corrected because the
+// diff is against the nodes, not against what was written last.
+#include "TestUtil.h"
+#include "F4VRBody.h"
+#include "Visibility.h"
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+using namespace F4VRBody;
+
+// utils.cpp needs the game, these do the same walks over the fake tree
+namespace F4VRBody {
+	static NiNode* findChild(const char* a_name, NiNode* a_node) {
+		if (!_stricmp(a_name, a_node->m_name.c_str())) {
+			return a_node;
+		}
+		for (auto i = 0; i < a_node->m_children.m_emptyRunStart; i++) {
+			NiNode* child = a_node->m_children.m_data[i] ? a_node->m_children.m_data[i]->GetAsNiNode() : nullptr;
+			NiNode* found = child ? findChild(a_name, child) : nullptr;
+			if (found) {
+				return found;
+			}
+		}
+		return nullptr;
+	}
+
+	NiNode* getChildNode(const char* nodeName, NiNode* nde) {
+		return findChild(nodeName, nde);
+	}
+
+	NiAVObject* getObjectByName(NiAVObject* root, const char* name) {
+		NiNode* node = root->GetAsNiNode();
+		return node ? findChild(name, node) : nullptr;
+	}
+
+	void toggleVis(NiNode* nde, bool hide, bool updateSelf) {
+		if (updateSelf) {
+			nde->flags = hide ? (nde->flags | 0x1) : (nde->flags & ~(UInt64)0x1);
+		}
+		for (auto i = 0; i < nde->m_children.m_emptyRunStart; ++i) {
+			NiNode* child = nde->m_children.m_data[i] ? nde->m_children.m_data[i]->GetAsNiNode() : nullptr;
+			if (child) {
+				toggleVis(child, hide, true);
+			}
+		}
+	}
+}
+
+struct FakePlayer {
+	std::vector<std::unique_ptr<NiAVObject>> owned;
+
+	NiNode* primaryWand;
+	NiNode* secondaryWand;
+	NiNode* roomNode;
+	NiNode* uiAttach;
+	NiNode* rightHand;
+	NiNode* weapon;
+	NiNode* pipboyBone;
+	BSTriShape* primaryMesh;
+	NiNode* secondaryMesh;
+	NiNode* uiPoint;
+	NiNode* paHud;
+
+	template <class T>
+	T* make(const char* a_name, NiNode* a_parent) {
+		T* node = new T();
+		node->m_name = BSFixedString(a_name);
+		owned.emplace_back(node);
+		if (a_parent) {
+			a_parent->AttachChild(node, true);
+		}
+		return node;
+	}
+
+	FakePlayer() {
+		primaryWand = make<NiNode>("PrimaryWandNode", nullptr);
+		secondaryWand = make<NiNode>("SecondaryWandNode", nullptr);
+		roomNode = make<NiNode>("RoomNode", nullptr);
+		uiAttach = make<NiNode>("PrimaryUIAttachNode", nullptr);
+		rightHand = make<NiNode>("RArm_Hand", nullptr);
+
+		primaryMesh = make<BSTriShape>("wand mesh", primaryWand);
+		make<NiNode>("fist_M_Right_HELPER", primaryWand);
+		make<NiNode>("fist_F_Right_HELPER", primaryWand);
+		make<NiNode>("PA_fist_R_HELPER", primaryWand);
+
+		// secondary wand mesh sits under an unnamed node
+		secondaryMesh = make<NiNode>("", secondaryWand);
+		make<NiNode>("mesh", secondaryMesh);
+		make<NiNode>("fist_M_Left_HELPER", secondaryWand);
+		make<NiNode>("fist_F_Left_HELPER", secondaryWand);
+		make<NiNode>("PA_fist_L_HELPER", secondaryWand);
+		uiPoint = make<NiNode>("Point002", secondaryWand);
+
+		weapon = make<NiNode>("Weapon", rightHand);
+		make<NiNode>("Receiver", weapon);
+		make<NiNode>("Barrel", weapon);
+
+		make<NiNode>("BackOfHand", uiAttach);
+
+		pipboyBone = make<NiNode>("PipboyBone", nullptr);
+		make<NiNode>("Screen", pipboyBone);
+
+		paHud = make<NiNode>("PowerArmorHelmetRoot", roomNode);
+	}
+
+	VisibilityAttach attach(bool a_inPowerArmor) {
+		VisibilityAttach a;
+		a.primaryWand = primaryWand;
+		a.secondaryWand = secondaryWand;
+		a.roomNode = roomNode;
+		a.uiAttach = uiAttach;
+		a.rightHand = rightHand;
+		a.pipboyBone = pipboyBone;
+		a.inPowerArmor = a_inPowerArmor;
+		return a;
+	}
+};
+
+static bool culled(NiAVObject* a_node) {
+	return (a_node->flags & 0x1) != 0;
+}
+
+static void testSteadyState() {
+	FakePlayer player;
+	VisibilityManager vis;
+	VisibilityAttach attach = player.attach(false);
+
+	// defaults hide the 6 fist helpers, zero the ui point and hide + zero the weapon and its two children
+	vis.apply(attach);
+	CHECK(vis.getWrites() == 6 + 1 + 6);
+	CHECK(culled(player.weapon));
+	CHECK(!culled(player.primaryMesh));
+
+	for (auto frame = 0; frame < 10; frame++) {
+		vis.apply(attach);
+		CHECK(vis.getWrites() == 0);
+	}
+}
+
+static void testSingleToggle() {
+	FakePlayer player;
+	VisibilityManager vis;
+	VisibilityAttach attach = player.attach(false);
+	vis.apply(attach);
+
+	// one trishape
+	vis.setVisible(kVis_RightWand, false);
+	vis.apply(attach);
+	CHECK(vis.getWrites() == 1);
+	CHECK(culled(player.primaryMesh));
+
+	// unnamed node and the mesh under it
+	vis.setVisible(kVis_LeftWand, false);
+	vis.apply(attach);
+	CHECK(vis.getWrites() == 2);
+
+	// asking again for what is already there writes nothing
+	vis.setVisible(kVis_RightWand, false);
+	vis.apply(attach);
+	CHECK(vis.getWrites() == 0);
+
+	vis.setVisible(kVis_WandUIPoint, true);
+	vis.apply(attach);
+	CHECK(vis.getWrites() == 1);
+	CHECK_NEAR(player.uiPoint->m_localTransform.scale, 1.0, 0.0);
+
+	// pipboy is a scale plus one subtree toggle, and only on the frame it changes
+	vis.setVisible(kVis_Pipboy, false);
+	vis.apply(attach);
+	CHECK(vis.getWrites() == 2);
+	CHECK(culled(player.pipboyBone->m_children.m_data[0]));
+	vis.apply(attach);
+	CHECK(vis.getWrites() == 0);
+}
+
+static void testGameOverrides() {
+	FakePlayer player;
+	VisibilityManager vis;
+	VisibilityAttach attach = player.attach(false);
+	vis.apply(attach);
+
+	// the game shows a weapon part again on equip, the next apply hides just that one
+	NiAVObject* receiver = player.weapon->m_children.m_data[0];
+	receiver->flags &= ~(UInt64)0x1;
+	vis.apply(attach);
+	CHECK(vis.getWrites() == 1);
+	CHECK(culled(receiver));
+
+	// the wand mesh gets swapped, the new one is found and gets the wanted state
+	vis.setVisible(kVis_RightWand, false);
+	vis.apply(attach);
+	BSTriShape* newMesh = player.make<BSTriShape>("new wand mesh", nullptr);
+	newMesh->m_parent = player.primaryWand;
+	player.primaryWand->m_children.set(0, newMesh);
+	vis.apply(attach);
+	CHECK(vis.getWrites() == 1);
+	CHECK(culled(newMesh));
+}
+
+static void testRebind() {
+	FakePlayer player;
+	VisibilityManager vis;
+	vis.apply(player.attach(false));
+
+	// into power armor the hud root gets bound and its scale set once
+	vis.setVisible(kVis_PAHud, false);
+	vis.apply(player.attach(true));
+	CHECK(vis.getWrites() == 1);
+	CHECK_NEAR(player.paHud->m_localTransform.scale, 0.0, 0.0);
+	vis.apply(player.attach(true));
+	CHECK(vis.getWrites() == 0);
+
+	// a different right hand means new 3D, its weapon gets hidden
+	FakePlayer other;
+	VisibilityAttach attach = player.attach(true);
+	attach.rightHand = other.rightHand;
+	vis.apply(attach);
+	CHECK(culled(other.weapon));
+	CHECK(vis.getBackOfHand() != nullptr);
+}
+
+int main() {
+	testSteadyState();
+	testSingleToggle();
+	testGameOverrides();
+	testRebind();
+
+	return testResult("VisibilityDiff");
+}
@@ -0,0 +1,176 @@
+// measureWeaponFeatures and inForegrip against made up weapon models.   The barrel and muzzle come from the local
+// transforms down to ProjectileNode so they are right before the game updates the world transforms, odd projectile nodes
+// keep the old straight barrel, and the grab zone follows the weapon wherever it is held.
+#include "TestUtil.h"
+#include "F4VRBody.h"
+#include "IKRig.h"
+#include "WeaponGeometry.h"
+
+#include <memory>
+#include <vector>
+
+using namespace F4VRBody;
+
+// utils.cpp needs the game, this does the same walk over the fake model
+namespace F4VRBody {
+	NiAVObject* getObjectByName(NiAVObject* root, BSFixedString& name) {
+		if (!_stricmp(name.c_str(), root->m_name.c_str())) {
+			return root;
+		}
+		NiNode* node = root->GetAsNiNode();
+		if (!node) {
+			return nullptr;
+		}
+		for (auto i = 0; i < node->m_children.m_emptyRunStart; i++) {
+			NiAVObject* found = node->m_children.m_data[i] ? getObjectByName(node->m_children.m_data[i], name) : nullptr;
+			if (found) {
+				return found;
+			}
+		}
+		return nullptr;
+	}
+}
+
+struct FakeWeapon {
+	std::vector<std::unique_ptr<NiNode>> owned;
+	NiNode* weapon;
+	NiNode* model;
+
+	FakeWeapon() {
+		weapon = make("Weapon", nullptr, NiPoint3(0, 0, 0));
+		model = make("10mmPistol", weapon, NiPoint3(0, 0, 0));
+	}
+
+	NiNode* make(const char* a_name, NiNode* a_parent, NiPoint3 a_pos, NiMatrix43 a_rot = identityRot()) {
+		NiNode* node = new NiNode();
+		node->m_name = BSFixedString(a_name);
+		node->m_localTransform.pos = a_pos;
+		node->m_localTransform.rot = a_rot;
+		node->m_localTransform.scale = 1.0f;
+		owned.emplace_back(node);
+		if (a_parent) {
+			a_parent->AttachChild(node, true);
+		}
+		return node;
+	}
+};
+
+static bool near(NiPoint3 a_a, NiPoint3 a_b, float a_eps) {
+	return vec3_len(a_a - a_b) < a_eps;
+}
+
+static NiTransform heldAt(NiPoint3 a_pos, NiMatrix43 a_rot, float a_scale) {
+	NiTransform t;
+	t.pos = a_pos;
+	t.rot = a_rot;
+	t.scale = a_scale;
+	return t;
+}
+
+static void testTiltedBarrel() {
+	// barrel tipped down a few degrees, the projectile node sits at its end
+	FakeWeapon gun;
+	NiMatrix43 tilt = getRotationAxisAngle(NiPoint3(1, 0, 0), 0.1f);
+	NiNode* barrel = gun.make("Barrel", gun.model, NiPoint3(0, 5, 2), tilt);
+	gun.make("ProjectileNode", barrel, NiPoint3(0, 30, 0));
+
+	WeaponFeatures f = measureWeaponFeatures(gun.weapon);
+	CHECK(f.valid);
+	CHECK(f.hasMuzzle);
+	CHECK(f.reticle == nullptr);
+
+	NiPoint3 axis = tilt * NiPoint3(0, 1, 0);
+	CHECK(near(f.barrelAxis, axis, 1e-4f));
+	CHECK(near(f.muzzle, NiPoint3(0, 5, 2) + tilt * NiPoint3(0, 30, 0), 1e-3f));
+	CHECK_NEAR(f.gripFar, vec3_dot(f.muzzle, axis) + f.gripNear, 1e-3);
+
+	// the world transforms are never looked at, junk in them changes nothing
+	barrel->m_worldTransform.pos = NiPoint3(1000, 1000, 1000);
+	WeaponFeatures again = measureWeaponFeatures(gun.weapon);
+	CHECK(again.muzzle == f.muzzle);
+}
+
+static void testOddProjectile() {
+	// projectile node pointing sideways, the barrel stays down the weapon's y but the muzzle is still where the node is
+	FakeWeapon gun;
+	NiMatrix43 sideways = getRotationAxisAngle(NiPoint3(0, 0, 1), 1.2f);
+	gun.make("ProjectileNode", gun.model, NiPoint3(0, 40, 3), sideways);
+
+	WeaponFeatures f = measureWeaponFeatures(gun.weapon);
+	CHECK(f.hasMuzzle);
+	CHECK(f.barrelAxis == NiPoint3(0, 1, 0));
+	CHECK(near(f.muzzle, NiPoint3(0, 40, 3), 1e-4f));
+	CHECK_NEAR(f.gripFar, 40.0f + f.gripNear, 1e-4);
+}
+
+static void testNoProjectile() {
+	// melee and some mods have no projectile node, grab anywhere past the grip
+	FakeWeapon gun;
+	gun.make("Blade", gun.model, NiPoint3(0, 20, 0));
+
+	WeaponFeatures f = measureWeaponFeatures(gun.weapon);
+	CHECK(f.valid);
+	CHECK(!f.hasMuzzle);
+	CHECK(f.barrelAxis == NiPoint3(0, 1, 0));
+	CHECK(f.gripFar == 0.0f);
+
+	NiTransform held = heldAt(NiPoint3(0, 0, 0), identityRot(), 1.0f);
+	CHECK(inForegrip(f, held, NiPoint3(0, 200, 0)));
+}
+
+static void testScaledModel() {
+	// the model node is scaled, the muzzle distance has to be scaled with it
+	FakeWeapon gun;
+	gun.model->m_localTransform.scale = 1.5f;
+	NiNode* barrel = gun.make("Barrel", gun.model, NiPoint3(0, 10, 0));
+	gun.make("ProjectileNode", barrel, NiPoint3(0, 20, 0));
+
+	WeaponFeatures f = measureWeaponFeatures(gun.weapon);
+	CHECK(near(f.muzzle, NiPoint3(0, 45, 0), 1e-4f));
+}
+
+static void testReticle() {
+	FakeWeapon gun;
+	NiNode* scope = gun.make("Scope", gun.model, NiPoint3(0, 5, 6));
+	NiNode* reticle = gun.make("ReticleNode", scope, NiPoint3(0, 2, 0));
+	gun.make("ProjectileNode", gun.model, NiPoint3(0, 40, 0));
+
+	WeaponFeatures f = measureWeaponFeatures(gun.weapon);
+	CHECK(f.reticle == reticle);
+}
+
+static void testForegrip() {
+	FakeWeapon gun;
+	gun.make("ProjectileNode", gun.model, NiPoint3(0, 40, 0));
+	WeaponFeatures f = measureWeaponFeatures(gun.weapon);
+
+	// held off to the side, turned and slightly scaled like a player would have it
+	NiMatrix43 rot = composeRot(getRotationAxisAngle(NiPoint3(0, 0, 1), 0.7f), getRotationAxisAngle(NiPoint3(1, 0, 0), -0.3f));
+	NiTransform held = heldAt(NiPoint3(30, -20, 110), rot, 1.1f);
+	auto world = [&](NiPoint3 a_local) { return held.pos + held.rot * (a_local * held.scale); };
+
+	CHECK(near(toWeaponSpace(held, world(NiPoint3(1, 2, 3))), NiPoint3(1, 2, 3), 1e-4f));
+
+	// halfway down the barrel, a bit under it
+	CHECK(inForegrip(f, held, world(NiPoint3(0, 25, -1))));
+
+	// behind the grip, past the muzzle and the reach past it, and well off to the side
+	CHECK(!inForegrip(f, held, world(NiPoint3(0, 5, 0))));
+	CHECK(!inForegrip(f, held, world(NiPoint3(0, f.gripFar + 1.0f, 0))));
+	CHECK(inForegrip(f, held, world(NiPoint3(0, f.gripFar - 1.0f, 0))));
+	CHECK(!inForegrip(f, held, world(NiPoint3(15, 25, 0))));
+
+	// the same point in world space without the weapon's rotation is nowhere near the barrel
+	CHECK(!inForegrip(f, held, held.pos + NiPoint3(0, 25, -1)));
+}
+
+int main() {
+	testTiltedBarrel();
+	testOddProjectile();
+	testNoProjectile();
+	testScaledModel();
+	testReticle();
+	testForegrip();
+
+	return testResult("WeaponGeometry");
+}
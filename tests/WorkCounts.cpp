@@ -0,0 +1,173 @@
+// The counting wrappers in utils.cpp against a made up tree of known size.   Every lookup, visited node, GetObjectByName,
+// fixed string and world update should land in g_workCounters exactly once, and the one second window should roll the
+// frames up into the per frame average and peak.
+#include "TestUtil.h"
+#include "F4VRBody.h"
+#include "IKRig.h"
+#include "WorkCounters.h"
+#include "utils.h"
+#include "f4se/BSGeometry.h"
+
+#include <memory>
+#include <vector>
+
+using namespace F4VRBody;
+
+// utils.cpp links against these, nothing in here reads the ini
+RelocPtr<INISettingCollection*> g_iniSettings(0);
+RelocPtr<INIPrefSettingCollection*> g_iniPrefSettings(0);
+
+Setting* GetINISetting(const char*) {
+	return nullptr;
+}
+
+// Root, three A nodes, three B nodes under each and two tri shapes under every B:  13 nodes and 18 shapes
+static const int kBranches = 3;
+static const int kShapes = 2;
+static const int kNodes = 1 + kBranches + kBranches * kBranches;
+static const int kTriShapes = kBranches * kBranches * kShapes;
+
+struct FakeTree {
+	std::vector<std::unique_ptr<NiAVObject>> owned;
+	NiNode* root;
+
+	FakeTree() {
+		root = add(new NiNode(), "Root", nullptr);
+		root->m_worldTransform.rot = identityRot();
+
+		char name[32];
+		for (int a = 0; a < kBranches; a++) {
+			sprintf_s(name, "A%d", a);
+			NiNode* aNode = add(new NiNode(), name, root);
+			for (int b = 0; b < kBranches; b++) {
+				sprintf_s(name, "A%d_B%d", a, b);
+				NiNode* bNode = add(new NiNode(), name, aNode);
+				for (int s = 0; s < kShapes; s++) {
+					sprintf_s(name, "A%d_B%d_S%d", a, b, s);
+					add(new BSTriShape(), name, bNode);
+				}
+			}
+		}
+	}
+
+	template <class T>
+	T* add(T* a_object, const char* a_name, NiNode* a_parent) {
+		a_object->m_name = BSFixedString(a_name);
+		a_object->m_localTransform.rot = identityRot();
+		a_object->m_localTransform.pos = NiPoint3(1, 0, 0);
+		owned.emplace_back(a_object);
+		if (a_parent) {
+			a_parent->AttachChild(a_object, true);
+		}
+		return a_object;
+	}
+};
+
+// what a call added to the frame in progress
+struct Counts {
+	UInt64 before[kWork_Count];
+
+	Counts() {
+		for (auto i = 0; i < kWork_Count; i++) {
+			before[i] = g_workCounters.getThisFrame((WorkCounter)i);
+		}
+	}
+
+	UInt64 added(WorkCounter a_counter) {
+		return g_workCounters.getThisFrame(a_counter) - before[a_counter];
+	}
+};
+
+static void testChildLookups(FakeTree& a_tree) {
+	// depth first, so the last B of the last A is only found after walking every node
+	Counts last;
+	CHECK(getChildNode("A2_B2", a_tree.root) != nullptr);
+	CHECK(last.added(kWork_NodeLookups) == 1);
+	CHECK(last.added(kWork_NodesVisited) == kNodes);
+
+	Counts missing;
+	CHECK(getChildNode("Nothing", a_tree.root) == nullptr);
+	CHECK(missing.added(kWork_NodesVisited) == kNodes);
+
+	Counts first;
+	CHECK(getChildNode("A0", a_tree.root) != nullptr);
+	CHECK(first.added(kWork_NodesVisited) == 2);
+
+	// only the direct children, whether it finds one or not
+	Counts direct;
+	CHECK(get1stChildNode("A1", a_tree.root) != nullptr);
+	CHECK(get1stChildNode("A1_B0", a_tree.root) == nullptr);
+	CHECK(direct.added(kWork_NodeLookups) == 2);
+	CHECK(direct.added(kWork_NodesVisited) == 2 * kBranches);
+}
+
+static void testObjectByName(FakeTree& a_tree) {
+	Counts byString;
+	NiAVObject* shape = getObjectByName(a_tree.root, "A1_B2_S1");
+	CHECK(shape != nullptr && shape->GetAsBSTriShape() != nullptr);
+	CHECK(byString.added(kWork_ObjectByName) == 1);
+	CHECK(byString.added(kWork_FixedStrings) == 1);
+
+	// a name made up front doesn't count as a new string
+	BSFixedString name("A0_B0");
+	Counts byFixed;
+	CHECK(getObjectByName(a_tree.root, name) != nullptr);
+	CHECK(byFixed.added(kWork_ObjectByName) == 1);
+	CHECK(byFixed.added(kWork_FixedStrings) == 0);
+	CHECK(byFixed.added(kWork_NodesVisited) == 0);
+}
+
+static void testWorldUpdates(FakeTree& a_tree) {
+	// every node below the root and every shape, the root itself is left alone
+	Counts down;
+	updateTransformsDown(a_tree.root, false);
+	CHECK(down.added(kWork_WorldUpdates) == kNodes - 1 + kTriShapes);
+
+	Counts self;
+	updateTransformsDown(a_tree.root->m_children.m_data[0]->GetAsNiNode(), true);
+	CHECK(self.added(kWork_WorldUpdates) == 1 + kBranches + kBranches * kShapes);
+
+	// each level is one unit further out
+	NiAVObject* shape = getObjectByName(a_tree.root, "A2_B1_S0");
+	CHECK_NEAR(shape->m_worldTransform.pos.x, 3.0f, 1e-5f);
+
+	Counts game;
+	updateWorldData(a_tree.root);
+	CHECK(game.added(kWork_WorldUpdates) == 1);
+}
+
+static void testWindow() {
+	g_stubPerfCounter = 0;
+	WorkCounters counters;
+
+	UInt64 perFrame[] = { 30, 10, 20 };
+	for (auto lookups : perFrame) {
+		counters.add(kWork_NodeLookups, (UInt32)lookups);
+		CHECK(counters.getThisFrame(kWork_NodeLookups) == lookups);
+		g_stubPerfCounter += 400000000;
+		counters.endFrame();
+		CHECK(counters.getThisFrame(kWork_NodeLookups) == 0);
+	}
+
+	// the window closed on the third frame, 1.2 s in
+	CHECK_NEAR(counters.getPerFrame(kWork_NodeLookups), 20.0f, 1e-4f);
+	CHECK_NEAR(counters.getPeakPerFrame(kWork_NodeLookups), 30.0f, 1e-4f);
+	CHECK_NEAR(counters.getPerFrame(kWork_WorldUpdates), 0.0f, 1e-4f);
+
+	// nothing rolls over until another second has passed
+	counters.add(kWork_NodeLookups, 1000);
+	g_stubPerfCounter += 400000000;
+	counters.endFrame();
+	CHECK_NEAR(counters.getPerFrame(kWork_NodeLookups), 20.0f, 1e-4f);
+	g_stubPerfCounter = -1;
+}
+
+int main() {
+	FakeTree tree;
+	testChildLookups(tree);
+	testObjectByName(tree);
+	testWorldUpdates(tree);
+	testWindow();
+
+	return testResult("WorkCounts");
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "f4se/NiNodes.h"
+
+namespace F4VRBody {
+	// the game's name to index lookup, tests that use the bone tree define it
+	int BSFlattenedBoneTree_GetBoneIndex(NiAVObject* a_tree, BSFixedString* a_name);
+
+	// only the fields FRIK reads
+	class BSFlattenedBoneTree : public NiNode
+	{
+	public:
+
+		struct BoneTransforms {
+			NiTransform local;
+			NiTransform world;
+			short parPos;
+			short childPos;
+			NiNode* refNode;
+			BSFixedString name;
+		};
+
+		int numTransforms = 0;
+		BoneTransforms* transforms = nullptr;
+	};
+}
@@ -0,0 +1,158 @@
+#pragma once
+// Stands in for the plugin's main header in the headless build.   Only the f4se stand-ins, the log call and the
+// settings the tested sources read, the settings are defined in F4VRBodyStub.cpp with the plugin's defaults.
+#include "f4se/NiNodes.h"
+#include "f4se/BSGeometry.h"
+#include "f4se/GameSettings.h"
+#include "f4se/PapyrusArgs.h"
+#include "include/SimpleIni.h"
+
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <string>
+#include <strings.h>
+#include <thread>
+
+typedef unsigned long long ULONGLONG;
+typedef UInt32 PluginHandle;
+struct StaticFunctionTag;
+
+// tests move the clock by hand
+extern ULONGLONG g_stubTickCount;
+inline ULONGLONG GetTickCount64() {
+	return g_stubTickCount;
+}
+
+// same shape as f4se's, tests point Dispatch at their own recorder
+struct F4SEMessagingInterface {
+	bool (*Dispatch)(PluginHandle a_sender, UInt32 a_type, void* a_data, UInt32 a_len, const char* a_receiver);
+};
+
+extern PluginHandle g_pluginHandle;
+extern F4SEMessagingInterface* g_messaging;
+
+// the performance counter in nanoseconds
+union LARGE_INTEGER {
+	long long QuadPart;
+};
+
+// tests that need made up frame costs set this, while it is negative the counter follows the real clock
+extern long long g_stubPerfCounter;
+
+inline bool QueryPerformanceFrequency(LARGE_INTEGER* a_freq) {
+	a_freq->QuadPart = 1000000000LL;
+	return true;
+}
+
+inline bool QueryPerformanceCounter(LARGE_INTEGER* a_count) {
+	if (g_stubPerfCounter >= 0) {
+		a_count->QuadPart = g_stubPerfCounter;
+		return true;
+	}
+	a_count->QuadPart = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	return true;
+}
+
+template <size_t N>
+inline int sprintf_s(char (&a_buf)[N], const char* a_fmt, ...) {
+	va_list args;
+	va_start(args, a_fmt);
+	int written = vsnprintf(a_buf, N, a_fmt, args);
+	va_end(args);
+	return written;
+}
+
+#define sscanf_s sscanf
+
+inline int _stricmp(const char* a_str1, const char* a_str2) {
+	return strcasecmp(a_str1, a_str2);
+}
+
+inline int _strnicmp(const char* a_str1, const char* a_str2, size_t a_count) {
+	return strncasecmp(a_str1, a_str2, a_count);
+}
+
+// named file mappings on top of POSIX shared memory, the name gets the leading slash shm_open wants.   Like the
+// tools/ reader does when it is bridged out of a Proton prefix.
+typedef void* HANDLE;
+typedef unsigned long DWORD;
+#define INVALID_HANDLE_VALUE ((HANDLE)-1)
+#define PAGE_READWRITE 0x04
+#define FILE_MAP_ALL_ACCESS 0xf001f
+
+HANDLE CreateFileMappingA(HANDLE a_file, void* a_attributes, DWORD a_protect, DWORD a_sizeHigh, DWORD a_sizeLow, const char* a_name);
+void* MapViewOfFile(HANDLE a_mapping, DWORD a_access, DWORD a_offsetHigh, DWORD a_offsetLow, size_t a_size);
+bool UnmapViewOfFile(const void* a_view);
+bool CloseHandle(HANDLE a_handle);
+DWORD GetLastError();
+
+// tests that check what reaches the log point this at their own recorder, otherwise lines go to stdout
+extern void (*g_stubMessageSink)(const char* a_line);
+
+inline void _MESSAGE(const char* a_fmt, ...) {
+	char line[1024];
+	va_list args;
+	va_start(args, a_fmt);
+	vsnprintf(line, sizeof(line), a_fmt, args);
+	va_end(args);
+
+	if (g_stubMessageSink) {
+		g_stubMessageSink(line);
+	}
+	else {
+		printf("%s\n", line);
+	}
+}
+
+// no debugger ever shows up
+inline bool IsDebuggerPresent() {
+	return false;
+}
+
+inline void Sleep(DWORD a_ms) {
+	std::this_thread::sleep_for(std::chrono::milliseconds(a_ms));
+}
+
+namespace F4VRBody {
+	extern bool c_parallelIK;
+	extern bool c_verbose;
+	extern bool c_logWorkCounters;
+	extern bool c_enableTelemetry;
+	extern bool c_enableFrameGovernor;
+	extern float c_frameBudgetMs;
+	extern int c_scopeMessageIntervalMs;
+	extern bool c_enableBodyTrackers;
+	extern std::string c_waistTracker;
+	extern std::string c_leftFootTracker;
+	extern std::string c_rightFootTracker;
+
+	// the settings ConfigBatch.cpp can change
+	extern float c_playerHeight;
+	extern float c_fVrScale;
+	extern float c_playerOffset_forward;
+	extern float c_playerOffset_up;
+	extern float c_powerArmor_forward;
+	extern float c_powerArmor_up;
+	extern float c_armLength;
+	extern float c_cameraHeight;
+	extern float c_PACameraHeight;
+	extern float c_handUI_X;
+	extern float c_handUI_Y;
+	extern float c_handUI_Z;
+	extern float c_dampenHandsRotation;
+	extern float c_dampenHandsTranslation;
+	extern bool c_showPAHUD;
+	extern bool c_hidePipboy;
+	extern bool c_armsOnly;
+	extern bool c_staticGripping;
+	extern bool c_hideHead;
+	extern bool c_dampenHands;
+	extern bool c_selfieMode;
+	extern bool c_repositionMasterMode;
+	extern bool c_leftHandedMode;
+
+	// F4VRBody.cpp's, tests that need them define them
+	void saveSettings();
+	void setFingerPositionScalar(StaticFunctionTag* base, bool isLeft, float thumb, float index, float middle, float ring, float pinky);
+}
@@ -0,0 +1,101 @@
+#include "F4VRBody.h"
+
+#include <cerrno>
+#include <map>
+#include <mutex>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+ULONGLONG g_stubTickCount = 0;
+long long g_stubPerfCounter = -1;
+void (*g_stubMessageSink)(const char* a_line) = nullptr;
+UInt64 VMArrayCalls::pushes = 0;
+UInt64 VMArrayCalls::gets = 0;
+PluginHandle g_pluginHandle = 1;
+F4SEMessagingInterface* g_messaging = nullptr;
+
+namespace F4VRBody {
+	bool c_parallelIK = false;
+	bool c_verbose = false;
+	bool c_logWorkCounters = false;
+	bool c_enableTelemetry = false;
+	bool c_enableFrameGovernor = false;
+	float c_frameBudgetMs = 2.0f;
+	int c_scopeMessageIntervalMs = 0;
+	bool c_enableBodyTrackers = false;
+	std::string c_waistTracker;
+	std::string c_leftFootTracker;
+	std::string c_rightFootTracker;
+
+	float c_playerHeight = 0.0;
+	float c_fVrScale = 72.0;
+	float c_playerOffset_forward = -4.0;
+	float c_playerOffset_up = -2.0;
+	float c_powerArmor_forward = 0.0f;
+	float c_powerArmor_up = 0.0f;
+	float c_armLength = 36.74;
+	float c_cameraHeight = 0.0;
+	float c_PACameraHeight = 0.0;
+	float c_handUI_X = 0.0;
+	float c_handUI_Y = 0.0;
+	float c_handUI_Z = 0.0;
+	float c_dampenHandsRotation = 0.7;
+	float c_dampenHandsTranslation = 0.7;
+	bool c_showPAHUD = true;
+	bool c_hidePipboy = false;
+	bool c_armsOnly = false;
+	bool c_staticGripping = false;
+	bool c_hideHead = false;
+	bool c_dampenHands = true;
+	bool c_selfieMode = false;
+	bool c_repositionMasterMode = false;
+	bool c_leftHandedMode = false;
+}
+
+// munmap needs the size MapViewOfFile was given
+static std::mutex g_viewLock;
+static std::map<const void*, size_t> g_viewSizes;
+
+HANDLE CreateFileMappingA(HANDLE, void*, DWORD, DWORD, DWORD a_sizeLow, const char* a_name) {
+	std::string name = std::string("/") + a_name;
+	int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0600);
+	if (fd < 0) {
+		return nullptr;
+	}
+	if (ftruncate(fd, a_sizeLow) != 0) {
+		close(fd);
+		return nullptr;
+	}
+	// fd + 1 so descriptor 0 doesn't read as a failure
+	return (HANDLE)(intptr_t)(fd + 1);
+}
+
+void* MapViewOfFile(HANDLE a_mapping, DWORD, DWORD, DWORD a_offsetLow, size_t a_size) {
+	void* view = mmap(nullptr, a_size, PROT_READ | PROT_WRITE, MAP_SHARED, (int)(intptr_t)a_mapping - 1, a_offsetLow);
+	if (view == MAP_FAILED) {
+		return nullptr;
+	}
+	std::lock_guard<std::mutex> lock(g_viewLock);
+	g_viewSizes[view] = a_size;
+	return view;
+}
+
+bool UnmapViewOfFile(const void* a_view) {
+	std::lock_guard<std::mutex> lock(g_viewLock);
+	auto found = g_viewSizes.find(a_view);
+	if (found == g_viewSizes.end()) {
+		return false;
+	}
+	munmap((void*)a_view, found->second);
+	g_viewSizes.erase(found);
+	return true;
+}
+
+bool CloseHandle(HANDLE a_handle) {
+	return close((int)(intptr_t)a_handle - 1) == 0;
+}
+
+DWORD GetLastError() {
+	return (DWORD)errno;
+}
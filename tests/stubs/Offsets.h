@@ -0,0 +1,12 @@
+#pragma once
+#include "f4se/GameReferences.h"
+
+#include <cstdint>
+
+class TESObjectCELL;
+
+namespace Offsets {
+	// never called headless, tests hand HeightField their own sampler
+	typedef uint64_t(*_TESObjectCELL_GetLandHeight)(TESObjectCELL* cell, NiPoint3* coord, float* height);
+	inline RelocAddr<_TESObjectCELL_GetLandHeight> TESObjectCell_GetLandHeight(0);
+}
@@ -0,0 +1,11 @@
+#pragma once
+#include "F4VRBody.h"
+
+namespace F4VRBody {
+
+	// the bits of the player skeleton settings code pokes, tests that use it define them
+	class Skeleton {
+	public:
+		void setBodyLen();
+	};
+}
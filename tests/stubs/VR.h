@@ -0,0 +1,66 @@
+#pragma once
+// Stands in for VR.h in the headless build.   Trackers and their world poses are set by the test instead of coming
+// from OpenVR, the room node is ignored since the poses are handed over in world space already.
+#include "f4se/NiTypes.h"
+#include "f4se/NiNodes.h"
+
+#include <map>
+#include <string>
+
+namespace vr {
+	typedef uint32_t TrackedDeviceIndex_t;
+	static const TrackedDeviceIndex_t k_unTrackedDeviceIndexInvalid = 0xFFFFFFFF;
+}
+
+namespace VRHook {
+
+	class VRSystem {
+	public:
+		VRSystem() {
+			roomNode = nullptr;
+			updates = 0;
+		}
+
+		inline void setRoomNode(NiNode* a_node) {
+			roomNode = a_node;
+		}
+
+		inline void updatePoses() {
+			updates++;
+		}
+
+		inline bool viveTrackersPresent() const { return !viveTrackers.empty(); }
+
+		inline const std::map<std::string, vr::TrackedDeviceIndex_t>& getViveTrackers() const { return viveTrackers; }
+
+		inline std::string getTrackerRole(vr::TrackedDeviceIndex_t idx) {
+			return roles[idx];
+		}
+
+		inline bool getTrackerWorldPose(vr::TrackedDeviceIndex_t idx, NiTransform* transform) {
+			auto it = poses.find(idx);
+			if (it == poses.end()) {
+				return false;
+			}
+			*transform = it->second;
+			return true;
+		}
+
+		// test side
+		inline void addTracker(const std::string& a_serial, vr::TrackedDeviceIndex_t a_idx, const std::string& a_role) {
+			viveTrackers[a_serial] = a_idx;
+			roles[a_idx] = a_role;
+		}
+
+		// no pose is the same as SteamVR losing the tracker
+		std::map<vr::TrackedDeviceIndex_t, NiTransform> poses;
+		NiNode* roomNode;
+		int updates;
+
+	private:
+		std::map<std::string, vr::TrackedDeviceIndex_t> viveTrackers;
+		std::map<vr::TrackedDeviceIndex_t, std::string> roles;
+	};
+
+	extern VRSystem* g_vrHook;
+}
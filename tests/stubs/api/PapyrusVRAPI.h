@@ -0,0 +1,8 @@
+#pragma once
+
+// only the FO4VRTools call FRIK makes without OpenVR, tests hand in their own
+class OpenVRHookManagerAPI
+{
+public:
+	virtual void StartHaptics(unsigned int trackedControllerId, float hapticTime, float hapticIntensity) = 0;
+};
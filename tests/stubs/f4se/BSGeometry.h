@@ -0,0 +1,12 @@
+#pragma once
+#include "f4se/NiNodes.h"
+
+class BSGeometry : public NiAVObject {
+public:
+	BSGeometry* GetAsBSGeometry() override { return this; }
+};
+
+class BSTriShape : public BSGeometry {
+public:
+	BSTriShape* GetAsBSTriShape() override { return this; }
+};
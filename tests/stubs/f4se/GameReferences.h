@@ -0,0 +1,20 @@
+#pragma once
+#include "f4se/NiNodes.h"
+
+#include <cstdint>
+
+// address of something inside the game, never called headless
+template <typename T>
+class RelocAddr {
+public:
+	RelocAddr(uintptr_t a_offset) {}
+	operator T() const { return nullptr; }
+};
+
+class TESForm {};
+class TESObjectREFR : public TESForm {};
+
+class Actor : public TESObjectREFR {
+public:
+	class MiddleProcess;
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "f4se/GameReferences.h"
+
+// the ini settings utils.cpp touches, a plain value instead of the game's collections
+class Setting {
+public:
+	union {
+		double f64;
+		UInt8 u8;
+	} data = {};
+
+	void SetDouble(double a_value) { data.f64 = a_value; }
+};
+
+class SettingCollectionList {};
+class INISettingCollection : public SettingCollectionList {};
+class INIPrefSettingCollection : public INISettingCollection {};
+
+// pointer to something inside the game, never followed headless
+template <typename T>
+class RelocPtr {
+public:
+	RelocPtr(uintptr_t) {}
+	T& operator*() const { return *_value; }
+
+private:
+	T* _value = nullptr;
+};
+
+extern RelocPtr<INISettingCollection*> g_iniSettings;
+extern RelocPtr<INIPrefSettingCollection*> g_iniPrefSettings;
+
+Setting* GetINISetting(const char* a_name);
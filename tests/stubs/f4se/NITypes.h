@@ -0,0 +1,3 @@
+#pragma once
+// Quaternion.h includes the f4se header with this spelling, fine on Windows but not here
+#include "NiTypes.h"
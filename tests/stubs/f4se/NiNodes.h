@@ -0,0 +1,59 @@
+#pragma once
+#include "f4se/NiObjects.h"
+
+#include <vector>
+
+// f4se's NiTArray fields, backed by a vector so tests can build trees
+template <typename T>
+class NiTArray {
+public:
+	T* m_data = nullptr;
+	UInt16 m_capacity = 0;
+	UInt16 m_emptyRunStart = 0;
+	UInt16 m_size = 0;
+
+	void push(T a_item) {
+		_items.push_back(a_item);
+		sync();
+	}
+
+	void set(UInt16 a_index, T a_item) {
+		_items[a_index] = a_item;
+		sync();
+	}
+
+private:
+	void sync() {
+		m_data = _items.data();
+		m_capacity = (UInt16)_items.capacity();
+		m_emptyRunStart = (UInt16)_items.size();
+		m_size = (UInt16)_items.size();
+	}
+
+	std::vector<T> _items;
+};
+
+class NiNode : public NiAVObject {
+public:
+	NiNode* GetAsNiNode() override { return this; }
+
+	NiAVObject* GetObjectByName(const BSFixedString* a_name) override {
+		if (auto found = NiAVObject::GetObjectByName(a_name)) {
+			return found;
+		}
+		for (auto i = 0; i < m_children.m_emptyRunStart; ++i) {
+			auto found = m_children.m_data[i] ? m_children.m_data[i]->GetObjectByName(a_name) : nullptr;
+			if (found) {
+				return found;
+			}
+		}
+		return nullptr;
+	}
+
+	void AttachChild(NiAVObject* a_child, bool a_firstAvail) {
+		a_child->m_parent = this;
+		m_children.push(a_child);
+	}
+
+	NiTArray<NiAVObject*> m_children;
+};
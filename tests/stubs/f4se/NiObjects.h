@@ -0,0 +1,48 @@
+#pragma once
+#include "f4se/NiTypes.h"
+
+#include <string>
+#include <strings.h>
+
+class NiNode;
+class BSGeometry;
+class BSTriShape;
+
+// owns its string, f4se's points into the game's string cache
+class BSFixedString {
+public:
+	BSFixedString() {}
+	BSFixedString(const char* a_string) : _string(a_string ? a_string : "") {}
+
+	const char* c_str() const { return _string.c_str(); }
+	explicit operator bool() const { return true; }
+
+private:
+	std::string _string;
+};
+
+class NiAVObject {
+public:
+	virtual ~NiAVObject() {}
+
+	virtual NiNode* GetAsNiNode() { return nullptr; }
+	virtual BSGeometry* GetAsBSGeometry() { return nullptr; }
+	virtual BSTriShape* GetAsBSTriShape() { return nullptr; }
+
+	struct NiUpdateData {
+		float timer;
+		UInt32 flags;
+	};
+
+	virtual NiAVObject* GetObjectByName(const BSFixedString* a_name) {
+		return !strcasecmp(a_name->c_str(), m_name.c_str()) ? this : nullptr;
+	}
+
+	virtual void UpdateWorldData(NiUpdateData*) {}
+
+	NiNode* m_parent = nullptr;
+	BSFixedString m_name;
+	NiTransform m_localTransform;
+	NiTransform m_worldTransform;
+	UInt64 flags = 0;
+};
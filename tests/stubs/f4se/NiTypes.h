@@ -0,0 +1,80 @@
+#pragma once
+// Just enough of the f4se math types for the headless tests.   Layout and operator behaviour follow f4se so the
+// solvers see the same numbers they would in game.
+#include <cstdint>
+#include <cstring>
+
+typedef uint8_t UInt8;
+typedef uint16_t UInt16;
+typedef uint32_t UInt32;
+typedef uint64_t UInt64;
+typedef int8_t SInt8;
+typedef int16_t SInt16;
+typedef int32_t SInt32;
+typedef int64_t SInt64;
+
+class NiPoint3 {
+public:
+	float x;
+	float y;
+	float z;
+
+	NiPoint3() : x(0.0f), y(0.0f), z(0.0f) {}
+	NiPoint3(float X, float Y, float Z) : x(X), y(Y), z(Z) {}
+
+	NiPoint3 operator-() const { return NiPoint3(-x, -y, -z); }
+	NiPoint3 operator+(const NiPoint3& pt) const { return NiPoint3(x + pt.x, y + pt.y, z + pt.z); }
+	NiPoint3 operator-(const NiPoint3& pt) const { return NiPoint3(x - pt.x, y - pt.y, z - pt.z); }
+	NiPoint3& operator+=(const NiPoint3& pt) { x += pt.x; y += pt.y; z += pt.z; return *this; }
+	NiPoint3& operator-=(const NiPoint3& pt) { x -= pt.x; y -= pt.y; z -= pt.z; return *this; }
+
+	NiPoint3 operator*(float s) const { return NiPoint3(x * s, y * s, z * s); }
+	NiPoint3 operator/(float s) const { return NiPoint3(x / s, y / s, z / s); }
+	NiPoint3& operator*=(float s) { x *= s; y *= s; z *= s; return *this; }
+	NiPoint3& operator/=(float s) { x /= s; y /= s; z /= s; return *this; }
+
+	bool operator==(const NiPoint3& pt) const { return x == pt.x && y == pt.y && z == pt.z; }
+	bool operator!=(const NiPoint3& pt) const { return !(*this == pt); }
+};
+
+class NiMatrix43 {
+public:
+	union {
+		float data[3][4];
+		float arr[12];
+	};
+
+	NiMatrix43() {
+		memset(arr, 0, sizeof(arr));
+	}
+
+	NiMatrix43 Transpose() const {
+		NiMatrix43 out;
+		for (int i = 0; i < 3; i++) {
+			for (int j = 0; j < 3; j++) {
+				out.data[i][j] = data[j][i];
+			}
+		}
+		return out;
+	}
+
+	// the game keeps rotations transposed, f4se multiplies by the columns
+	NiPoint3 operator*(const NiPoint3& pt) const {
+		return NiPoint3(
+			data[0][0] * pt.x + data[1][0] * pt.y + data[2][0] * pt.z,
+			data[0][1] * pt.x + data[1][1] * pt.y + data[2][1] * pt.z,
+			data[0][2] * pt.x + data[1][2] * pt.y + data[2][2] * pt.z);
+	}
+
+	void MakeIdentity() {
+		memset(arr, 0, sizeof(arr));
+		data[0][0] = data[1][1] = data[2][2] = 1.0f;
+	}
+};
+
+class NiTransform {
+public:
+	NiMatrix43 rot;
+	NiPoint3 pos;
+	float scale = 1.0f;
+};
@@ -0,0 +1,32 @@
+#pragma once
+#include "f4se/NiTypes.h"
+
+#include <vector>
+
+// Stands in for the VM's array.   Every Push and Get is a call into the VM in the game, the mock counts them.
+struct VMArrayCalls {
+	static UInt64 pushes;
+	static UInt64 gets;
+};
+
+template <typename T>
+class VMArray {
+public:
+	UInt32 Length() const { return (UInt32)_items.size(); }
+
+	void Get(T* a_dst, const UInt32 a_index) {
+		VMArrayCalls::gets++;
+		*a_dst = _items[a_index];
+	}
+
+	void Push(T* a_src) {
+		VMArrayCalls::pushes++;
+		_items.push_back(*a_src);
+	}
+
+	// test side, not part of f4se's
+	std::vector<T>& items() { return _items; }
+
+private:
+	std::vector<T> _items;
+};
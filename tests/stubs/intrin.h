@@ -0,0 +1,3 @@
+#pragma once
+// MSVC's intrinsics header, only __rdtsc is used
+#include <x86intrin.h>
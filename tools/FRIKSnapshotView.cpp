@@ -0,0 +1,248 @@
+// Viewer and diff for the skeleton snapshots FRIK writes to FRIK_Snapshots.frks (api/FRIKSnapshot.h).
+//
+// Windows:  cl /EHsc /I.. FRIKSnapshotView.cpp
+// Linux:    g++ -O2 -std=c++17 -I.. FRIKSnapshotView.cpp -o frik-snapshot
+//
+// usage: FRIKSnapshotView <file>                               list the snapshots
+//        FRIKSnapshotView <file> <n>                           print snapshot n as a tree
+//        FRIKSnapshotView <file> <n> <m> [other file] [min]    nodes that differ between n and m (m taken from the
+//                                                              other file if given), min is the smallest change in
+//                                                              game units or degrees worth printing, 0.01 by default
+
+#include "api/FRIKSnapshot.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+struct Snapshot {
+	FRIKSnapshotPose pose;
+	std::vector<FRIKSnapshotNode> nodes;
+};
+
+struct SnapshotFile {
+	std::vector<std::string> names;
+	std::vector<Snapshot> snapshots;
+};
+
+static bool readFile(const char* path, SnapshotFile& out) {
+	FILE* file = fopen(path, "rb");
+	if (!file) {
+		fprintf(stderr, "could not open %s\n", path);
+		return false;
+	}
+
+	FRIKSnapshotFileHeader header;
+	if (fread(&header, sizeof(header), 1, file) != 1 || header.magic != FRIK_SNAPSHOT_MAGIC) {
+		fprintf(stderr, "%s is not a FRIK snapshot file\n", path);
+		fclose(file);
+		return false;
+	}
+	if (header.version != FRIK_SNAPSHOT_VERSION) {
+		fprintf(stderr, "%s is version %u, this viewer reads version %d\n", path, header.version, FRIK_SNAPSHOT_VERSION);
+		fclose(file);
+		return false;
+	}
+
+	FRIKSnapshotChunk chunk;
+	std::vector<char> payload;
+	while (fread(&chunk, sizeof(chunk), 1, file) == 1) {
+		payload.resize(chunk.size);
+		if (chunk.size && fread(payload.data(), 1, chunk.size, file) != chunk.size) {
+			fprintf(stderr, "%s: last chunk is cut off, the game was probably still writing\n", path);
+			break;
+		}
+
+		if (chunk.type == FRIK_SNAPSHOT_NAMES && chunk.size >= 8) {
+			uint32_t first, count;
+			memcpy(&first, &payload[0], 4);
+			memcpy(&count, &payload[4], 4);
+			if (first != out.names.size()) {
+				fprintf(stderr, "%s: names chunk starts at %u, expected %zu\n", path, first, out.names.size());
+				break;
+			}
+
+			size_t at = 8;
+			for (uint32_t i = 0; i < count && at < payload.size(); i++) {
+				std::string name(&payload[at]);
+				at += name.size() + 1;
+				out.names.push_back(name);
+			}
+		}
+		else if (chunk.type == FRIK_SNAPSHOT_POSE && chunk.size >= sizeof(FRIKSnapshotPose)) {
+			Snapshot snap;
+			memcpy(&snap.pose, payload.data(), sizeof(FRIKSnapshotPose));
+			snap.pose.label[FRIK_SNAPSHOT_LABEL - 1] = 0;
+
+			size_t count = (chunk.size - sizeof(FRIKSnapshotPose)) / sizeof(FRIKSnapshotNode);
+			snap.nodes.resize(count);
+			memcpy(snap.nodes.data(), &payload[sizeof(FRIKSnapshotPose)], count * sizeof(FRIKSnapshotNode));
+			out.snapshots.push_back(snap);
+		}
+	}
+
+	fclose(file);
+	return true;
+}
+
+static const char* nameOf(const SnapshotFile& file, uint32_t id) {
+	return id < file.names.size() ? file.names[id].c_str() : "?";
+}
+
+static void toQuat(const int16_t* q, double* out) {
+	for (int i = 0; i < 4; i++) {
+		out[i] = q[i] / 32767.0;
+	}
+}
+
+// angle between two quantized rotations in degrees
+static double angleBetween(const int16_t* a, const int16_t* b) {
+	double qa[4], qb[4];
+	toQuat(a, qa);
+	toQuat(b, qb);
+
+	double dot = fabs(qa[0] * qb[0] + qa[1] * qb[1] + qa[2] * qb[2] + qa[3] * qb[3]);
+	dot = dot > 1.0 ? 1.0 : dot;
+	return 2.0 * acos(dot) * 180.0 / 3.14159265358979;
+}
+
+static double distance(const float* a, const float* b) {
+	double dx = a[0] - b[0], dy = a[1] - b[1], dz = a[2] - b[2];
+	return sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+// names repeat between skeletons (two "Weapon" nodes, every mesh's "Scene Root") so nodes are matched by their path
+static std::string pathOf(const SnapshotFile& file, const Snapshot& snap, size_t index) {
+	std::string path = nameOf(file, snap.nodes[index].name);
+	for (int32_t p = snap.nodes[index].parent; p >= 0 && (size_t)p < snap.nodes.size(); p = snap.nodes[p].parent) {
+		path = std::string(nameOf(file, snap.nodes[p].name)) + "/" + path;
+	}
+	return path;
+}
+
+static void list(const SnapshotFile& file) {
+	for (size_t i = 0; i < file.snapshots.size(); i++) {
+		auto& pose = file.snapshots[i].pose;
+		printf("%4zu  #%llu  %9.3f s  %5u nodes  %s\n", i, (unsigned long long)pose.sequence, pose.time, pose.nodeCount, pose.label);
+	}
+	printf("%zu snapshots, %zu names\n", file.snapshots.size(), file.names.size());
+}
+
+static void print(const SnapshotFile& file, const Snapshot& snap) {
+	printf("#%llu  %.3f s  %s\n", (unsigned long long)snap.pose.sequence, snap.pose.time, snap.pose.label);
+
+	std::vector<int> depth(snap.nodes.size(), 0);
+	for (size_t i = 0; i < snap.nodes.size(); i++) {
+		auto& node = snap.nodes[i];
+		depth[i] = node.parent >= 0 ? depth[node.parent] + 1 : 0;
+
+		double lq[4], wq[4];
+		toQuat(node.localRot, lq);
+		toQuat(node.worldRot, wq);
+
+		printf("%*s%s%s  local %.2f %.2f %.2f (%.3f %.3f %.3f %.3f) x%.2f  world %.2f %.2f %.2f (%.3f %.3f %.3f %.3f) x%.2f\n",
+			depth[i] * 2, "", nameOf(file, node.name), (node.flags & 0x1) ? " [culled]" : "",
+			node.localPos[0], node.localPos[1], node.localPos[2], lq[0], lq[1], lq[2], lq[3], node.localScale,
+			node.worldPos[0], node.worldPos[1], node.worldPos[2], wq[0], wq[1], wq[2], wq[3], node.worldScale);
+	}
+}
+
+static void diff(const SnapshotFile& fileA, const Snapshot& a, const SnapshotFile& fileB, const Snapshot& b, double minChange) {
+	std::map<std::string, size_t> inB;
+	for (size_t i = 0; i < b.nodes.size(); i++) {
+		inB.emplace(pathOf(fileB, b, i), i);
+	}
+
+	int changed = 0, missing = 0;
+	for (size_t i = 0; i < a.nodes.size(); i++) {
+		std::string path = pathOf(fileA, a, i);
+		auto found = inB.find(path);
+		if (found == inB.end()) {
+			printf("- %s\n", path.c_str());
+			missing++;
+			continue;
+		}
+
+		auto& na = a.nodes[i];
+		auto& nb = b.nodes[found->second];
+		inB.erase(found);
+
+		double localMove = distance(na.localPos, nb.localPos);
+		double worldMove = distance(na.worldPos, nb.worldPos);
+		double localTurn = angleBetween(na.localRot, nb.localRot);
+		double worldTurn = angleBetween(na.worldRot, nb.worldRot);
+		bool culled = (na.flags & 0x1) != (nb.flags & 0x1);
+
+		if (localMove < minChange && worldMove < minChange && localTurn < minChange && worldTurn < minChange && !culled) {
+			continue;
+		}
+
+		printf("~ %s  local %.2f u %.2f deg  world %.2f u %.2f deg%s\n", path.c_str(), localMove, localTurn, worldMove, worldTurn,
+			culled ? ((nb.flags & 0x1) ? "  now culled" : "  now shown") : "");
+		changed++;
+	}
+
+	for (auto& left : inB) {
+		printf("+ %s\n", left.first.c_str());
+		missing++;
+	}
+
+	printf("%d nodes changed, %d only in one snapshot\n", changed, missing);
+}
+
+static const Snapshot* pick(const SnapshotFile& file, const char* arg) {
+	long index = atol(arg);
+	if (index < 0 || (size_t)index >= file.snapshots.size()) {
+		fprintf(stderr, "no snapshot %s, there are %zu\n", arg, file.snapshots.size());
+		return nullptr;
+	}
+	return &file.snapshots[index];
+}
+
+int main(int argc, char** argv) {
+	if (argc < 2) {
+		fprintf(stderr, "usage: %s <file> [n] [m] [other file] [min change]\n", argv[0]);
+		return 1;
+	}
+
+	SnapshotFile file;
+	if (!readFile(argv[1], file)) {
+		return 1;
+	}
+
+	if (argc == 2) {
+		list(file);
+		return 0;
+	}
+
+	const Snapshot* a = pick(file, argv[2]);
+	if (!a) {
+		return 1;
+	}
+
+	if (argc == 3) {
+		print(file, *a);
+		return 0;
+	}
+
+	SnapshotFile other;
+	const SnapshotFile* fileB = &file;
+	if (argc > 4) {
+		if (!readFile(argv[4], other)) {
+			return 1;
+		}
+		fileB = &other;
+	}
+
+	const Snapshot* b = pick(*fileB, argv[3]);
+	if (!b) {
+		return 1;
+	}
+
+	diff(file, *a, *fileB, *b, argc > 5 ? atof(argv[5]) : 0.01);
+	return 0;
+}
@@ -0,0 +1,53 @@
+#pragma once
+// Opening and reading the FRIK telemetry block (api/FRIKTelemetry.h), shared by the reader and its test.
+
+#include "api/FRIKTelemetry.h"
+
+#include <atomic>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+inline const FRIKTelemetry* openBlock() {
+#ifdef _WIN32
+	HANDLE mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, FRIK_TELEMETRY_NAME);
+	if (!mapping) {
+		return nullptr;
+	}
+	return (const FRIKTelemetry*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, sizeof(FRIKTelemetry));
+#else
+	int fd = shm_open("/" FRIK_TELEMETRY_NAME, O_RDONLY, 0);
+	if (fd < 0) {
+		return nullptr;
+	}
+	void* mem = mmap(nullptr, sizeof(FRIKTelemetry), PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	return mem == MAP_FAILED ? nullptr : (const FRIKTelemetry*)mem;
+#endif
+}
+
+// seqlock read - retry until we get a copy that wasn't written to while we were copying it
+inline bool readBlock(const FRIKTelemetry* block, FRIKTelemetry& out) {
+	for (int tries = 0; tries < 100; tries++) {
+		uint32_t before = block->sequence;
+		std::atomic_thread_fence(std::memory_order_acquire);
+
+		if (before & 1) {
+			continue;
+		}
+
+		memcpy(&out, (const void*)block, sizeof(FRIKTelemetry));
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (block->sequence == before) {
+			return true;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,76 @@
+// Small console reader for the FRIK telemetry block (api/FRIKTelemetry.h).
+//
+// Windows:  cl /EHsc /I.. FRIKTelemetryReader.cpp
+// Linux:    g++ -O2 -I.. FRIKTelemetryReader.cpp -o frik-telemetry -lrt
+//           (reads the POSIX shared memory object /FRIK_Telemetry, e.g. when bridged out of a Proton prefix)
+//
+// usage: FRIKTelemetryReader [samples per second]
+
+#include "FRIKTelemetryBlock.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+static const char* stageNames[FRIK_STAGE_COUNT] = { "body", "legs", "arms", "attach", "hands", "weapon", "finish" };
+static const char* counterNames[FRIK_COUNTER_COUNT] = { "lookups", "visited", "byName", "worldUpd", "mapLkp", "fixedStr", "papyrus" };
+static const char* limbNames[FRIK_LIMB_COUNT] = { "rArm", "lArm", "rLeg", "lLeg" };
+
+int main(int argc, char** argv) {
+	int rate = argc > 1 ? atoi(argv[1]) : 4;
+	rate = rate > 0 ? rate : 4;
+
+	const FRIKTelemetry* block = openBlock();
+	if (!block) {
+		fprintf(stderr, "could not open %s - is FRIK running with EnableTelemetry = true?\n", FRIK_TELEMETRY_NAME);
+		return 1;
+	}
+
+	// fields are only ever appended, a newer writer still has everything this reader knows about
+	if (block->version < FRIK_TELEMETRY_VERSION || block->size < sizeof(FRIKTelemetry)) {
+		fprintf(stderr, "telemetry version %u size %u, this reader needs at least version %d size %zu\n",
+			block->version, block->size, FRIK_TELEMETRY_VERSION, sizeof(FRIKTelemetry));
+		return 1;
+	}
+
+	FRIKTelemetry t;
+	uint64_t lastFrame = 0;
+
+	while (true) {
+		if (readBlock(block, t) && (t.frame != lastFrame)) {
+			lastFrame = t.frame;
+
+			printf("frame %llu  %.3f ms (avg %.3f, governor %u)  flags%s%s%s%s%s%s\n",
+				(unsigned long long)t.frame, t.frameMs, t.averageMs, t.governorLevel,
+				(t.flags & FRIK_FLAG_POWER_ARMOR) ? " PA" : "",
+				(t.flags & FRIK_FLAG_ARMS_ONLY) ? " armsOnly" : "",
+				(t.flags & FRIK_FLAG_REPOSITION) ? " reposition" : "",
+				(t.flags & FRIK_FLAG_SCOPE) ? " scope" : "",
+				(t.flags & FRIK_FLAG_LEFT_HANDED) ? " leftHanded" : "",
+				(t.flags & FRIK_FLAG_SELFIE) ? " selfie" : "");
+
+			printf("  stages ");
+			for (int i = 0; i < FRIK_STAGE_COUNT; i++) {
+				printf(" %s %.3f", stageNames[i], t.stageMs[i]);
+			}
+			printf("\n  work   ");
+			for (int i = 0; i < FRIK_COUNTER_COUNT; i++) {
+				printf(" %s %u", counterNames[i], t.counters[i]);
+			}
+			printf("\n  ik     ");
+			for (int i = 0; i < FRIK_LIMB_COUNT; i++) {
+				printf(" %s %.2f %.1fdeg%s%s%s", limbNames[i], t.ikResidual[i], t.ikRotResidual[i],
+					(t.ikFlags[i] & FRIK_IK_SOLVED) ? "" : " reused",
+					(t.ikFlags[i] & FRIK_IK_STRETCHED) ? " stretched" : "",
+					(t.ikFlags[i] & FRIK_IK_ACOS_CLAMPED) ? " clamped" : "");
+			}
+			printf(" posture %.2f\n", t.postureResidual);
+			fflush(stdout);
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(1000 / rate));
+	}
+
+	return 0;
+}
@@ -47,6 +47,11 @@ namespace F4VRBody {
 	NiNode* getChildNode(const char* nodeName, NiNode* nde);
 	NiNode* get1stChildNode(const char* nodeName, NiNode* nde);
 
+	// these count themselves in g_workCounters, use them instead of calling the game directly
+	NiAVObject* getObjectByName(NiAVObject* root, BSFixedString& name);
+	NiAVObject* getObjectByName(NiAVObject* root, const char* name);
+	void updateWorldData(NiAVObject* node);
+
 	Setting* GetINISettingNative(const char* name);
 
 	// get elapsed time when needed
@@ -1,4 +1,5 @@
 #include "weaponOffset.h"
+#include "Startup.h"
 
 #include <iostream>
 #include <fstream>
@@ -73,7 +74,7 @@ namespace F4VRBody {
 				path = file.path().wstring();
 			}
 			catch (std::exception& e) {
-				_WARNING("Unable to convert path to string: %s", e.what());
+				startupLog("Unable to convert path to string: %s", e.what());
 			}
 			if (file.exists() && !file.is_directory())
 				loadOffsetJsonFile(file.path().string());
@@ -87,7 +88,7 @@ namespace F4VRBody {
 		inF.open(file, std::ios::in);
 
 		if (inF.fail()) {
-			_WARNING("cannot open %s", file.c_str());
+			startupLog("cannot open %s", file.c_str());
 			inF.close();
 			return;
 		}
@@ -97,7 +98,7 @@ namespace F4VRBody {
 		}
 		catch (json::parse_error& ex)
 		{
-			_MESSAGE("cannot open %s: parse error at byte %d", file.c_str(), ex.byte);
+			startupLog("cannot open %s: parse error at byte %d", file.c_str(), ex.byte);
 			inF.close();
 			return;
 		}
@@ -117,7 +118,7 @@ namespace F4VRBody {
 			g_weaponOffsets->addOffset(key, data);
 
 		}
-		_MESSAGE("Successfully loaded %d offsets from %s: total %d", weaponJson.size(), file.c_str(), g_weaponOffsets->getSize());
+		startupLog("Successfully loaded %d offsets from %s: total %d", (int)weaponJson.size(), file.c_str(), (int)g_weaponOffsets->getSize());
 	}
 
 	void saveOffsetJsonFile(const json& weaponJson, const std::string& file) {